@@ -8,6 +8,7 @@
 #include <fstream>
 #include "../../src/core/collective_optimizer.h"
 #include "../../src/algorithms/topology_aware_broadcast.h"
+#include "../../src/algorithms/topology_aware_barrier.h"
 #include "../../src/utils/performance_measurement.h"
 
 using namespace TopologyAwareResearch;
@@ -42,7 +43,7 @@ public:
     void run_all_collectives_benchmark() {
         if (world_rank_ == 0) {
             std::cout << "=== Collective Operations Comprehensive Benchmark ===" << std::endl;
-            std::cout << "Testing: Broadcast, Allreduce, Reduce, Allgather, Barrier" << std::endl;
+            std::cout << "Testing: Broadcast, Allreduce, Reduce, Allgather, Reduce_scatter, Barrier" << std::endl;
         }
 
         std::map<std::string, std::map<int, PerformanceMetrics>> results;
@@ -52,7 +53,11 @@ public:
         results["Allreduce"] = benchmark_allreduce();
         results["Reduce"] = benchmark_reduce();
         results["Allgather"] = benchmark_allgather();
+        results["ReduceScatter"] = benchmark_reduce_scatter(false);
+        results["ReduceScatter (optimized)"] = benchmark_reduce_scatter(true);
         results["Barrier"] = benchmark_barrier();
+        results["Barrier (dissemination)"] = benchmark_barrier(AlgorithmType::DISSEMINATION_BARRIER);
+        results["Barrier (hierarchical)"] = benchmark_barrier(AlgorithmType::HIERARCHICAL_BARRIER);
 
         // Analyze and report results
         if (world_rank_ == 0) {
@@ -252,9 +257,69 @@ public:
         return results;
     }
 
-    std::map<int, PerformanceMetrics> benchmark_barrier() {
+    // Size is the per-rank block; the optimized variant goes through the
+    // optimizer's algorithm selection instead of MPI_Reduce_scatter_block
+    std::map<int, PerformanceMetrics> benchmark_reduce_scatter(bool optimized) {
         if (world_rank_ == 0) {
-            std::cout << "\n--- Benchmarking Barrier ---" << std::endl;
+            std::cout << "\n--- Benchmarking Reduce_scatter" << (optimized ? " (optimized)" : "")
+                << " ---" << std::endl;
+        }
+
+        std::map<int, PerformanceMetrics> results;
+
+        for (int size : message_sizes_) {
+            std::vector<double> send_buffer(size * world_size_);
+            std::vector<double> recv_buffer(size);
+            initialize_buffer(send_buffer.data(), size * world_size_, world_rank_);
+
+            PerformanceMetrics metrics;
+            std::vector<double> execution_times;
+
+            auto run_once = [&]() {
+                if (optimized) {
+                    optimizer_.optimize_reduce_scatter_block(send_buffer.data(), recv_buffer.data(),
+                        size, MPI_DOUBLE, MPI_SUM, comm_);
+                }
+                else {
+                    MPI_Reduce_scatter_block(send_buffer.data(), recv_buffer.data(),
+                        size, MPI_DOUBLE, MPI_SUM, comm_);
+                }
+            };
+
+            // Warmup
+            for (int i = 0; i < warmup_iterations_; ++i) {
+                run_once();
+            }
+
+            // Measurement
+            for (int i = 0; i < iterations_; ++i) {
+                MPI_Barrier(comm_);
+                auto start = MPI_Wtime();
+
+                run_once();
+
+                auto end = MPI_Wtime();
+                execution_times.push_back(end - start);
+            }
+
+            metrics = calculate_metrics(execution_times, size);
+            results[size] = metrics;
+
+            if (world_rank_ == 0) {
+                std::cout << "  Size " << size << ": " << metrics.execution_time * 1000 << " ms" << std::endl;
+            }
+        }
+
+        return results;
+    }
+
+    std::map<int, PerformanceMetrics> benchmark_barrier(AlgorithmType algo = AlgorithmType::NATIVE_MPI) {
+        std::string label = "Barrier";
+        if (algo == AlgorithmType::DISSEMINATION_BARRIER) label += " (dissemination)";
+        if (algo == AlgorithmType::HIERARCHICAL_BARRIER) label += " (hierarchical)";
+
+        if (world_rank_ == 0) {
+            std::cout << "\n--- Benchmarking " << label << " ---" << std::endl;
         }
 
         std::map<int, PerformanceMetrics> results;
@@ -264,17 +329,18 @@ public:
 
         PerformanceMetrics metrics;
         std::vector<double> execution_times;
+        TopologyAwareBarrier barrier(NetworkCharacteristics{});
 
-        // Warmup
+        // Warmup (also builds the cached node communicators and window)
         for (int i = 0; i < warmup_iterations_; ++i) {
-            MPI_Barrier(comm_);
+            barrier.execute(algo, comm_);
         }
 
         // Measurement
         for (int i = 0; i < iterations_; ++i) {
             auto start = MPI_Wtime();
 
-            MPI_Barrier(comm_);
+            barrier.execute(algo, comm_);
 
             auto end = MPI_Wtime();
             execution_times.push_back(end - start);
@@ -284,7 +350,7 @@ public:
         results[dummy_size] = metrics;
 
         if (world_rank_ == 0) {
-            std::cout << "  Barrier: " << metrics.execution_time * 1000 << " ms" << std::endl;
+            std::cout << "  " << label << ": " << metrics.execution_time * 1000 << " ms" << std::endl;
         }
 
         return results;
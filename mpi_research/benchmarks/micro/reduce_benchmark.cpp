@@ -10,6 +10,7 @@
 #include <limits>
 #include <cmath>
 #include "../../src/core/collective_optimizer.h"
+#include "../../src/algorithms/topology_aware_reduce.h"
 #include "../../src/utils/performance_measurement.h"
 
 using namespace TopologyAwareResearch;
@@ -150,12 +151,16 @@ public:
         // Benchmark different approaches
         auto native_metrics = benchmark_native_reduce(test_size, test_op, root);
         auto optimized_metrics = benchmark_optimized_reduce(test_size, test_op, root);
-        auto binomial_metrics = benchmark_binomial_reduce(test_size, test_op, root);
+        auto binomial_metrics = benchmark_library_reduce(AlgorithmType::SEGMENTED_BINOMIAL_REDUCE, test_size, test_op, root);
+        auto rabenseifner_metrics = benchmark_library_reduce(AlgorithmType::RABENSEIFNER_REDUCE, test_size, test_op, root);
+        auto chain_metrics = benchmark_library_reduce(AlgorithmType::PIPELINED_CHAIN_REDUCE, test_size, test_op, root);
 
         if (world_rank_ == 0) {
             std::cout << "Native MPI_Reduce: " << native_metrics.execution_time * 1000 << " ms" << std::endl;
             std::cout << "Optimized Reduce: " << optimized_metrics.execution_time * 1000 << " ms" << std::endl;
             std::cout << "Binomial Tree Reduce: " << binomial_metrics.execution_time * 1000 << " ms" << std::endl;
+            std::cout << "Rabenseifner Reduce: " << rabenseifner_metrics.execution_time * 1000 << " ms" << std::endl;
+            std::cout << "Pipelined Chain Reduce: " << chain_metrics.execution_time * 1000 << " ms" << std::endl;
 
             double improvement = (native_metrics.execution_time - optimized_metrics.execution_time)
                 / native_metrics.execution_time * 100;
@@ -216,12 +221,12 @@ public:
         return metrics;
     }
 
-    PerformanceMetrics benchmark_binomial_reduce(int message_size, MPI_Op op, int root) {
-        // Custom binomial tree reduce implementation
+    PerformanceMetrics benchmark_library_reduce(AlgorithmType algo, int message_size, MPI_Op op, int root) {
         std::vector<double> send_buffer(message_size);
         std::vector<double> recv_buffer(message_size);
         initialize_buffer(send_buffer.data(), message_size, world_rank_);
 
+        TopologyAwareReduce reduce(NetworkCharacteristics{});
         PerformanceMetrics metrics;
         std::vector<double> execution_times;
 
@@ -229,7 +234,7 @@ public:
             MPI_Barrier(comm_);
             auto start = MPI_Wtime();
 
-            binomial_tree_reduce(send_buffer.data(), recv_buffer.data(),
+            reduce.execute(algo, send_buffer.data(), recv_buffer.data(),
                 message_size, MPI_DOUBLE, op, root, comm_);
 
             auto end = MPI_Wtime();
@@ -240,56 +245,6 @@ public:
         return metrics;
     }
 
-    void binomial_tree_reduce(const void* sendbuf, void* recvbuf, int count,
-        MPI_Datatype datatype, MPI_Op op, int root, MPI_Comm comm) {
-        int rank, size;
-        MPI_Comm_rank(comm, &rank);
-        MPI_Comm_size(comm, &size);
-
-        if (size == 1) {
-            if (sendbuf != MPI_IN_PLACE) {
-                MPI_Type_size(datatype, nullptr); // Get type size if needed
-                memcpy(recvbuf, sendbuf, count * sizeof(double)); // Simplified
-            }
-            return;
-        }
-
-        // Temporary buffer for intermediate results
-        std::vector<double> temp_buffer(count);
-
-        int relative_rank = (rank - root + size) % size;
-        int mask = 1;
-
-        while (mask < size) {
-            if (relative_rank & mask) {
-                int source = (rank - mask + size) % size;
-                MPI_Recv(temp_buffer.data(), count, datatype, source, 0, comm, MPI_STATUS_IGNORE);
-
-                // Perform reduction
-                if (op == MPI_SUM) {
-                    const double* send_data = (rank == root) ? static_cast<const double*>(recvbuf)
-                        : static_cast<const double*>(sendbuf);
-                    for (int i = 0; i < count; ++i) {
-                        static_cast<double*>(recvbuf)[i] = send_data[i] + temp_buffer[i];
-                    }
-                }
-                // Add other operations as needed
-
-                break;
-            }
-            mask <<= 1;
-        }
-
-        mask >>= 1;
-        while (mask > 0) {
-            if ((relative_rank + mask) < size) {
-                int dest = (rank + mask) % size;
-                MPI_Send(recvbuf, count, datatype, dest, 0, comm);
-            }
-            mask >>= 1;
-        }
-    }
-
     void analyze_operation_performance(int root,
         const std::map<MPI_Op, std::map<int, PerformanceMetrics>>& results) {
         std::cout << "\n--- Performance Analysis for Root " << root << " ---" << std::endl;
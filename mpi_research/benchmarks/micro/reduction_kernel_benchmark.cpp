@@ -0,0 +1,245 @@
+#include <mpi.h>
+#include <iostream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <chrono>
+#include <complex>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+#include "../../src/core/reduction_ops.h"
+#include "../../src/core/reduction_simd.h"
+#include "../../src/core/reduction_half.h"
+
+using namespace TopologyAwareResearch;
+
+// Single-process timing of the local reduction kernels: every (datatype, op,
+// SIMD level, size, alignment) combination in GB/s and elements per cycle,
+// against MPI_Reduce_local and a memcpy roofline. Needs no launcher:
+//
+//   ./reduction_kernel_benchmark           sizes up to 64 MiB per buffer
+//   ./reduction_kernel_benchmark --quick   up to 1 MiB, for CI containers
+class ReductionKernelBenchmark {
+private:
+    struct Case {
+        std::string name;
+        MPI_Datatype datatype;
+        MPI_Op op;
+        std::function<void(char*, size_t)> fill;  // count elements, values near 1
+    };
+
+    // 64-byte aligned buffer, touched once so page faults stay out of timings
+    struct Buffer {
+        char* base = nullptr;
+        explicit Buffer(size_t bytes) {
+            size_t rounded = (bytes + 64 + 63) / 64 * 64;
+            base = static_cast<char*>(std::aligned_alloc(64, rounded));
+            std::memset(base, 0, rounded);
+        }
+        ~Buffer() { std::free(base); }
+        Buffer(const Buffer&) = delete;
+        Buffer& operator=(const Buffer&) = delete;
+    };
+
+    std::vector<Case> cases_;
+    std::vector<size_t> sizes_;       // Bytes per operand
+    std::vector<size_t> offsets_;     // Bytes past a 64-byte boundary
+    double min_seconds_;              // Per measurement batch
+
+public:
+    ReductionKernelBenchmark(bool quick) {
+        cases_ = {
+            { "float", MPI_FLOAT, MPI_SUM, fill_with<float>(1.0f) },
+            { "float", MPI_FLOAT, MPI_MAX, fill_with<float>(1.0f) },
+            { "double", MPI_DOUBLE, MPI_SUM, fill_with<double>(1.0) },
+            { "double", MPI_DOUBLE, MPI_PROD, fill_with<double>(1.0) },
+            { "int", MPI_INT, MPI_SUM, fill_with<int>(1) },
+            { "int", MPI_INT, MPI_BXOR, fill_with<int>(1) },
+            { "long", MPI_LONG, MPI_MIN, fill_with<long>(1) },
+            { "uint8", MPI_UNSIGNED_CHAR, MPI_MAX, fill_with<unsigned char>(1) },
+            { "float16", float16_datatype(), MPI_SUM, fill_with<uint16_t>(float_to_half(1.0f)) },
+            { "bfloat16", bfloat16_datatype(), MPI_SUM, fill_with<uint16_t>(float_to_bfloat16(1.0f)) },
+            { "double_int", MPI_DOUBLE_INT, MPI_MAXLOC, fill_pairs },
+            { "complex128", MPI_C_DOUBLE_COMPLEX, MPI_PROD, fill_with<std::complex<double>>(1.0) }
+        };
+        sizes_ = { size_t(4) << 10, size_t(64) << 10, size_t(1) << 20 };
+        if (!quick) {
+            sizes_.push_back(size_t(16) << 20);
+            sizes_.push_back(size_t(64) << 20);
+        }
+        offsets_ = { 0, 16 };
+        min_seconds_ = quick ? 0.002 : 0.02;
+    }
+
+    void run() {
+        SimdLevel detected = detect_simd_level();
+        size_t cache_bytes = last_level_cache_bytes();
+        std::cout << "=== Reduction Kernel Benchmark ===" << std::endl;
+        std::cout << "SIMD: " << simd_level_name(detected) << ", LLC: " << (cache_bytes >> 10) << " KiB"
+            << ", streaming stores from " << format_bytes(streaming_store_threshold()) << std::endl;
+        std::cout << "GB/s counts two operands read and one written; elem/cyc uses TSC cycles;"
+            << " vs MPI and vs memcpy are ratios to MPI_Reduce_local and memcpy GB/s" << std::endl;
+        std::cout << std::left << std::setw(12) << "type" << std::setw(11) << "op" << std::setw(9) << "level"
+            << std::right << std::setw(9) << "bytes" << std::setw(6) << "off" << std::setw(8) << "where"
+            << std::setw(9) << "GB/s" << std::setw(10) << "elem/cyc" << std::setw(9) << "vs MPI"
+            << std::setw(11) << "vs memcpy" << std::endl;
+
+        for (size_t bytes : sizes_) {
+            // Three operands of this size either fit the last-level cache or not
+            const char* where = 3 * bytes <= cache_bytes ? "cache" : "memory";
+            double memcpy_gbs = time_memcpy(bytes);
+            for (const Case& c : cases_) {
+                MPI_Aint lower_bound, extent;
+                MPI_Type_get_extent(c.datatype, &lower_bound, &extent);
+                int count = static_cast<int>(bytes / extent);
+                for (size_t offset : offsets_) {
+                    double mpi_gbs = time_reduce_local(c, count, extent, offset);
+                    for (SimdLevel level : { SimdLevel::SCALAR, SimdLevel::SSE42, SimdLevel::AVX2, SimdLevel::AVX512 }) {
+                        if (level > detected) {
+                            continue;
+                        }
+                        set_simd_level(level);
+                        double cycles = 0.0;
+                        double gbs = time_kernel(c, count, extent, offset, cycles);
+                        std::cout << std::left << std::setw(12) << c.name << std::setw(11) << op_name(c.op)
+                            << std::setw(9) << simd_level_name(level) << std::right << std::setw(9)
+                            << format_bytes(bytes) << std::setw(6) << offset << std::setw(8) << where
+                            << std::fixed << std::setprecision(2) << std::setw(9) << gbs
+                            << std::setw(10) << (cycles > 0.0 ? count / cycles : 0.0)
+                            << std::setw(9) << gbs / mpi_gbs << std::setw(11) << gbs / memcpy_gbs
+                            << std::endl;
+                    }
+                    set_simd_level(detected);
+                }
+            }
+        }
+    }
+
+private:
+    template<typename T>
+    static std::function<void(char*, size_t)> fill_with(T value) {
+        return [value](char* buffer, size_t count) {
+            T* elements = reinterpret_cast<T*>(buffer);
+            std::fill(elements, elements + count, value);
+        };
+    }
+
+    static void fill_pairs(char* buffer, size_t count) {
+        struct DoubleInt { double value; int index; };
+        DoubleInt* pairs = reinterpret_cast<DoubleInt*>(buffer);
+        for (size_t i = 0; i < count; ++i) {
+            pairs[i] = { static_cast<double>(i % 7), static_cast<int>(i) };
+        }
+    }
+
+    static uint64_t read_cycles() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return 0;
+#endif
+    }
+
+    // Best of three batches of at least min_seconds_; GB/s over `traffic`
+    // bytes per call. cycles receives TSC cycles per call of the best batch.
+    double time_best(const std::function<void()>& call, double traffic, double& cycles) {
+        call();
+        int iterations = 1;
+        double best = 0.0;
+        for (int batch = 0; batch < 3; ++batch) {
+            while (true) {
+                uint64_t first_cycle = read_cycles();
+                auto start = std::chrono::steady_clock::now();
+                for (int i = 0; i < iterations; ++i) {
+                    call();
+                }
+                double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+                uint64_t elapsed_cycles = read_cycles() - first_cycle;
+                if (seconds < min_seconds_ && batch == 0) {
+                    iterations *= 2;
+                    continue;
+                }
+                double gbs = traffic * iterations / seconds / 1e9;
+                if (gbs > best) {
+                    best = gbs;
+                    cycles = static_cast<double>(elapsed_cycles) / iterations;
+                }
+                break;
+            }
+        }
+        return best;
+    }
+
+    double time_kernel(const Case& c, int count, MPI_Aint extent, size_t offset, double& cycles) {
+        size_t bytes = static_cast<size_t>(count) * extent;
+        Buffer a(bytes + offset), b(bytes + offset), dst(bytes + offset);
+        c.fill(a.base + offset, count);
+        c.fill(b.base + offset, count);
+        ReductionKernel kernel = resolve_reduction_kernel(c.datatype, c.op);
+        return time_best([&] {
+            kernel.combine(dst.base + offset, a.base + offset, b.base + offset, count);
+        }, 3.0 * bytes, cycles);
+    }
+
+    // MPI_Reduce_local is two-operand (inout = in op inout), so the same
+    // three streams: two reads and one write
+    double time_reduce_local(const Case& c, int count, MPI_Aint extent, size_t offset) {
+        size_t bytes = static_cast<size_t>(count) * extent;
+        Buffer in(bytes + offset), inout(bytes + offset);
+        c.fill(in.base + offset, count);
+        c.fill(inout.base + offset, count);
+        MPI_Op op = is_half_precision(c.datatype) ? half_precision_op(c.op) : c.op;
+        double cycles = 0.0;
+        return time_best([&] {
+            MPI_Reduce_local(in.base + offset, inout.base + offset, count, c.datatype, op);
+        }, 3.0 * bytes, cycles);
+    }
+
+    // Bytes read plus written per second by memcpy: the bandwidth ceiling
+    // of a kernel that streams its operands once
+    double time_memcpy(size_t bytes) {
+        Buffer from(bytes), to(bytes);
+        double cycles = 0.0;
+        return time_best([&] { std::memcpy(to.base, from.base, bytes); }, 2.0 * bytes, cycles);
+    }
+
+    static std::string op_name(MPI_Op op) {
+        if (op == MPI_SUM) return "MPI_SUM";
+        if (op == MPI_PROD) return "MPI_PROD";
+        if (op == MPI_MAX) return "MPI_MAX";
+        if (op == MPI_MIN) return "MPI_MIN";
+        if (op == MPI_BXOR) return "MPI_BXOR";
+        if (op == MPI_MAXLOC) return "MPI_MAXLOC";
+        return "UNKNOWN";
+    }
+
+    static std::string format_bytes(size_t bytes) {
+        if (bytes == SIZE_MAX) return "never";
+        if (bytes >= (size_t(1) << 20) && bytes % (size_t(1) << 20) == 0) return std::to_string(bytes >> 20) + "M";
+        if (bytes >= 1024 && bytes % 1024 == 0) return std::to_string(bytes >> 10) + "K";
+        return std::to_string(bytes);
+    }
+};
+
+int main(int argc, char** argv) {
+    MPI_Init(&argc, &argv);
+
+    bool quick = false;
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--quick") == 0) {
+            quick = true;
+        }
+    }
+
+    ReductionKernelBenchmark benchmark(quick);
+    benchmark.run();
+
+    MPI_Finalize();
+    return 0;
+}
@@ -3,10 +3,30 @@
 #include <vector>
 #include <string>
 #include <cmath>
+#include <complex>
 #include <algorithm>
 #include <random>
+#include <map>
+#include <functional>
+#include <chrono>
+#include <thread>
 #include "../../src/core/collective_optimizer.h"
 #include "../../src/algorithms/topology_aware_broadcast.h"
+#include "../../src/algorithms/torus_broadcast.h"
+#include "../../src/algorithms/dragonfly_broadcast.h"
+#include "../../src/algorithms/topology_aware_allgather.h"
+#include "../../src/algorithms/variable_block_collectives.h"
+#include "../../src/algorithms/topology_aware_reduce_scatter.h"
+#include "../../src/algorithms/topology_aware_alltoall.h"
+#include "../../src/algorithms/topology_aware_scan.h"
+#include "../../src/algorithms/topology_aware_reduce.h"
+#include "../../src/algorithms/ordered_reduction.h"
+#include "../../src/algorithms/fused_allreduce.h"
+#include "../../src/algorithms/typed_collectives.h"
+#include "../../src/core/reduction_ops.h"
+#include "../../src/core/reduction_half.h"
+#include "../../src/algorithms/topology_aware_barrier.h"
+#include "../../src/algorithms/topology_aware_neighbor.h"
 
 using namespace TopologyAwareResearch;
 
@@ -45,16 +65,42 @@ public:
 
         // Test reduce operations
         all_passed &= test_reduce_correctness();
+        all_passed &= test_reduce_algorithms_correctness();
 
         // Test allreduce operations
         all_passed &= test_allreduce_correctness();
+        all_passed &= test_allreduce_algorithms_correctness();
+
+        // Test order-preserving reduce/allreduce for non-commutative ops
+        all_passed &= test_ordered_reduction_correctness();
 
         // Test allgather operations
         all_passed &= test_allgather_correctness();
+        all_passed &= test_allgather_algorithms_correctness();
+        all_passed &= test_variable_block_correctness();
+
+        // Test reduce-scatter algorithms
+        all_passed &= test_reduce_scatter_correctness();
+
+        // Test alltoall algorithms
+        all_passed &= test_alltoall_correctness();
+
+        // Test scan/exscan algorithms
+        all_passed &= test_scan_correctness();
+
+        // Test barrier algorithms
+        all_passed &= test_barrier_correctness();
+
+        // Test neighbourhood collectives
+        all_passed &= test_neighbor_correctness();
 
         // Test topology-aware algorithms
         all_passed &= test_topology_aware_correctness();
 
+        // Test multi-port torus broadcast
+        all_passed &= test_torus_broadcast_correctness();
+        all_passed &= test_dragonfly_broadcast_correctness();
+
         if (world_rank_ == 0) {
             if (all_passed) {
                 std::cout << "=== ALL CORRECTNESS TESTS PASSED ===" << std::endl;
@@ -185,6 +231,70 @@ public:
         return true;
     }
 
+    bool test_reduce_algorithms_correctness() {
+        if (world_rank_ == 0) {
+            std::cout << "Testing Reduce Algorithms..." << std::endl;
+        }
+
+        bool all_passed = true;
+        std::vector<int> test_sizes = { 1, 1000, 20000 };
+        std::vector<int> roots = { 0, world_size_ - 1 };
+        std::vector<MPI_Op> operations = { MPI_SUM, MPI_MAX };
+        std::vector<std::pair<AlgorithmType, std::string>> algorithms = {
+            { AlgorithmType::SEGMENTED_BINOMIAL_REDUCE, "segmented binomial" },
+            { AlgorithmType::RABENSEIFNER_REDUCE, "rabenseifner" },
+            { AlgorithmType::PIPELINED_CHAIN_REDUCE, "pipelined chain" }
+        };
+
+        NetworkCharacteristics interleaved;
+        interleaved.node_mapping.resize(world_size_);
+        for (int i = 0; i < world_size_; ++i) {
+            interleaved.node_mapping[i] = i % 2;
+        }
+        TopologyAwareReduce reduce(interleaved);
+        // Small segments so that the larger sizes are really pipelined
+        reduce.set_segment_size(4096);
+
+        for (const auto& algorithm : algorithms) {
+            for (int size : test_sizes) {
+                std::vector<int> input(size);
+                for (int j = 0; j < size; ++j) {
+                    input[j] = (world_rank_ * 13 + j * 7) % 1000;
+                }
+
+                for (MPI_Op op : operations) {
+                    for (int root : roots) {
+                        std::vector<int> native(size);
+                        MPI_Reduce(input.data(), native.data(), size, MPI_INT, op, root, comm_);
+
+                        for (bool in_place : { false, true }) {
+                            std::vector<int> result(in_place ? input : std::vector<int>(size, -1));
+                            bool root_in_place = in_place && world_rank_ == root;
+                            reduce.execute(algorithm.first, root_in_place ? MPI_IN_PLACE : input.data(),
+                                result.data(), size, MPI_INT, op, root, comm_);
+
+                            bool passed = (world_rank_ != root) || (result == native);
+                            all_passed &= passed;
+                            if (!passed) {
+                                std::cerr << "  FAILED: Reduce algorithm=" << algorithm.second << ", size=" << size
+                                    << ", root=" << root << ", in_place=" << in_place << std::endl;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        // Failures are reported on the root
+        all_passed = agree(all_passed);
+
+        if (world_rank_ == 0 && all_passed) {
+            std::cout << "  All reduce algorithm tests passed" << std::endl;
+        }
+
+        return all_passed;
+    }
+
     bool test_allreduce_correctness() {
         if (world_rank_ == 0) {
             std::cout << "Testing Allreduce Correctness..." << std::endl;
@@ -278,6 +388,960 @@ public:
         return verify_allgather_result(native_recv.data(), optimized_recv.data(), size);
     }
 
+    bool test_allgather_algorithms_correctness() {
+        if (world_rank_ == 0) {
+            std::cout << "Testing Allgather Algorithms..." << std::endl;
+        }
+
+        bool all_passed = true;
+        std::vector<int> test_sizes = { 1, 64, 1000 };
+        std::vector<std::pair<AlgorithmType, std::string>> algorithms = {
+            { AlgorithmType::RING_ALLGATHER, "ring" },
+            { AlgorithmType::RECURSIVE_DOUBLING_ALLGATHER, "recursive doubling" },
+            { AlgorithmType::BRUCK_ALLGATHER, "bruck" },
+            { AlgorithmType::HIERARCHICAL_ALLGATHER, "hierarchical" }
+        };
+
+        // Interleaved nodes (node order differs from rank order) and
+        // contiguous nodes of uneven size (1, 2, 2, ... ranks)
+        NetworkCharacteristics interleaved, uneven;
+        interleaved.node_mapping.resize(world_size_);
+        uneven.node_mapping.resize(world_size_);
+        for (int i = 0; i < world_size_; ++i) {
+            interleaved.node_mapping[i] = i % 2;
+            uneven.node_mapping[i] = (i + 1) / 2;
+        }
+
+        for (const NetworkCharacteristics& config : { interleaved, uneven }) {
+            TopologyAwareAllgather allgather(config);
+
+            for (const auto& algorithm : algorithms) {
+                for (int size : test_sizes) {
+                    for (bool in_place : { false, true }) {
+                        std::vector<double> send_buffer(size);
+                        std::vector<double> native_recv(size * world_size_);
+                        std::vector<double> optimized_recv(size * world_size_, 0.0);
+
+                        initialize_sequential(send_buffer.data(), size, world_rank_);
+                        MPI_Allgather(send_buffer.data(), size, MPI_DOUBLE,
+                            native_recv.data(), size, MPI_DOUBLE, comm_);
+
+                        if (in_place) {
+                            std::copy(send_buffer.begin(), send_buffer.end(),
+                                optimized_recv.begin() + world_rank_ * size);
+                        }
+                        allgather.execute(algorithm.first, in_place ? MPI_IN_PLACE : send_buffer.data(),
+                            optimized_recv.data(), size, MPI_DOUBLE, comm_);
+
+                        bool passed = verify_allgather_result(native_recv.data(), optimized_recv.data(), size);
+                        all_passed &= passed;
+
+                        if (world_rank_ == 0 && !passed) {
+                            std::cerr << "  FAILED: Allgather algorithm=" << algorithm.second
+                                << ", size=" << size << ", in_place=" << in_place << std::endl;
+                        }
+                    }
+                }
+            }
+        }
+
+        if (world_rank_ == 0 && all_passed) {
+            std::cout << "  All allgather algorithm tests passed" << std::endl;
+        }
+
+        return all_passed;
+    }
+
+    bool test_variable_block_correctness() {
+        if (world_rank_ == 0) {
+            std::cout << "Testing Allgatherv/Gatherv/Scatterv..." << std::endl;
+        }
+
+        bool all_passed = true;
+        std::vector<int> roots = { 0, world_size_ - 1 };
+
+        // Uneven blocks (some empty) with a gap between neighbours
+        std::vector<int> counts(world_size_), displs(world_size_);
+        int total = 0;
+        for (int i = 0; i < world_size_; ++i) {
+            counts[i] = (i * 7) % 5 + (i == world_size_ / 2 ? 300 : 0);
+            displs[i] = total;
+            total += counts[i] + 1;
+        }
+        auto expected = [](int rank, int index) { return static_cast<double>(rank * 1000 + index); };
+
+        NetworkCharacteristics interleaved, uneven;
+        interleaved.node_mapping.resize(world_size_);
+        uneven.node_mapping.resize(world_size_);
+        for (int i = 0; i < world_size_; ++i) {
+            interleaved.node_mapping[i] = i % 2;
+            uneven.node_mapping[i] = (i + 1) / 2;
+        }
+
+        for (const NetworkCharacteristics& config : { interleaved, uneven }) {
+            VariableBlockCollectives collectives(config);
+
+            std::vector<double> block(counts[world_rank_]);
+            for (int j = 0; j < counts[world_rank_]; ++j) {
+                block[j] = expected(world_rank_, j);
+            }
+
+            // Allgatherv, regular and in place
+            for (bool in_place : { false, true }) {
+                std::vector<double> result(total, -1.0);
+                if (in_place) {
+                    std::copy(block.begin(), block.end(), result.begin() + displs[world_rank_]);
+                }
+                collectives.allgatherv(in_place ? MPI_IN_PLACE : block.data(), counts[world_rank_], MPI_DOUBLE,
+                    result.data(), counts.data(), displs.data(), MPI_DOUBLE, comm_);
+
+                bool passed = true;
+                for (int i = 0; i < world_size_; ++i) {
+                    for (int j = 0; j < counts[i]; ++j) {
+                        passed &= (result[displs[i] + j] == expected(i, j));
+                    }
+                }
+                all_passed &= passed;
+                if (!passed) {
+                    std::cerr << "  FAILED: Allgatherv rank=" << world_rank_ << ", in_place=" << in_place << std::endl;
+                }
+            }
+
+            for (int root : roots) {
+                // Gatherv
+                std::vector<double> gathered(total, -1.0);
+                collectives.gatherv(block.data(), counts[world_rank_], MPI_DOUBLE,
+                    gathered.data(), counts.data(), displs.data(), MPI_DOUBLE, root, comm_);
+
+                bool passed = true;
+                if (world_rank_ == root) {
+                    for (int i = 0; i < world_size_; ++i) {
+                        for (int j = 0; j < counts[i]; ++j) {
+                            passed &= (gathered[displs[i] + j] == expected(i, j));
+                        }
+                    }
+                }
+
+                // Scatterv back out of the gathered layout
+                std::vector<double> scattered(counts[world_rank_], -1.0);
+                std::vector<double> source(total);
+                for (int i = 0; i < world_size_; ++i) {
+                    for (int j = 0; j < counts[i]; ++j) {
+                        source[displs[i] + j] = expected(i, j);
+                    }
+                }
+                collectives.scatterv(source.data(), counts.data(), displs.data(), MPI_DOUBLE,
+                    scattered.data(), counts[world_rank_], MPI_DOUBLE, root, comm_);
+                passed &= (scattered == block);
+
+                all_passed &= passed;
+                if (!passed) {
+                    std::cerr << "  FAILED: Gatherv/Scatterv rank=" << world_rank_ << ", root=" << root << std::endl;
+                }
+            }
+        }
+
+        all_passed = agree(all_passed);
+
+        if (world_rank_ == 0 && all_passed) {
+            std::cout << "  All allgatherv/gatherv/scatterv tests passed" << std::endl;
+        }
+
+        return all_passed;
+    }
+
+    bool test_reduce_scatter_correctness() {
+        if (world_rank_ == 0) {
+            std::cout << "Testing Reduce_scatter Algorithms..." << std::endl;
+        }
+
+        bool all_passed = true;
+        std::vector<std::pair<AlgorithmType, std::string>> algorithms = {
+            { AlgorithmType::RING_REDUCE_SCATTER, "ring" },
+            { AlgorithmType::RECURSIVE_HALVING_REDUCE_SCATTER, "recursive halving" },
+            { AlgorithmType::HIERARCHICAL_REDUCE_SCATTER, "hierarchical" }
+        };
+        std::vector<MPI_Op> operations = { MPI_SUM, MPI_MAX };
+
+        // Uneven blocks, some empty
+        std::vector<int> counts(world_size_);
+        int total = 0;
+        for (int i = 0; i < world_size_; ++i) {
+            counts[i] = (i * 7) % 5 + (i == world_size_ / 2 ? 300 : 0);
+            total += counts[i];
+        }
+
+        NetworkCharacteristics interleaved, uneven;
+        interleaved.node_mapping.resize(world_size_);
+        uneven.node_mapping.resize(world_size_);
+        for (int i = 0; i < world_size_; ++i) {
+            interleaved.node_mapping[i] = i % 2;
+            uneven.node_mapping[i] = (i + 1) / 2;
+        }
+
+        std::vector<int> input(total);
+        for (int j = 0; j < total; ++j) {
+            input[j] = (world_rank_ * 31 + j * 17) % 101;
+        }
+
+        for (const NetworkCharacteristics& config : { interleaved, uneven }) {
+            TopologyAwareReduceScatter reduce_scatter(config);
+
+            for (const auto& algorithm : algorithms) {
+                for (MPI_Op op : operations) {
+                    std::vector<int> native_recv(counts[world_rank_]);
+                    MPI_Reduce_scatter(input.data(), native_recv.data(), counts.data(), MPI_INT, op, comm_);
+
+                    for (bool in_place : { false, true }) {
+                        std::vector<int> optimized_recv(in_place ? input : std::vector<int>(counts[world_rank_], -1));
+                        reduce_scatter.execute(algorithm.first, in_place ? MPI_IN_PLACE : input.data(),
+                            optimized_recv.data(), counts.data(), MPI_INT, op, comm_);
+
+                        bool passed = std::equal(native_recv.begin(), native_recv.end(), optimized_recv.begin());
+                        all_passed &= passed;
+                        if (!passed) {
+                            std::cerr << "  FAILED: Reduce_scatter algorithm=" << algorithm.second
+                                << ", rank=" << world_rank_ << ", in_place=" << in_place << std::endl;
+                        }
+                    }
+                }
+            }
+        }
+
+        // Block variant through the optimizer
+        CollectiveOptimizer optimizer;
+        std::vector<double> block_input(64 * world_size_);
+        initialize_sequential(block_input.data(), static_cast<int>(block_input.size()), world_rank_);
+        std::vector<double> native_block(64), optimized_block(64);
+        MPI_Reduce_scatter_block(block_input.data(), native_block.data(), 64, MPI_DOUBLE, MPI_SUM, comm_);
+        optimizer.optimize_reduce_scatter_block(block_input.data(), optimized_block.data(), 64,
+            MPI_DOUBLE, MPI_SUM, comm_);
+        all_passed &= verify_allreduce_result(native_block.data(), optimized_block.data(), 64, MPI_SUM);
+
+        // A non-commutative op keeps rank order, registered or not
+        MPI_Datatype affine_type;
+        MPI_Type_contiguous(2, MPI_INT, &affine_type);
+        MPI_Type_commit(&affine_type);
+        MPI_Op affine_op;
+        MPI_Op_create(&compose_affine, 0, &affine_op);
+        std::vector<int> affine_input(2 * total);
+        for (int j = 0; j < total; ++j) {
+            affine_input[2 * j] = ((world_rank_ * 5 + j) % 4 == 0) ? -1 : 1;
+            affine_input[2 * j + 1] = (world_rank_ * 11 + j) % 97;
+        }
+        std::vector<int> native_affine(2 * counts[world_rank_]);
+        MPI_Reduce_scatter(affine_input.data(), native_affine.data(), counts.data(), affine_type, affine_op, comm_);
+        for (bool registered : { false, true }) {
+            if (registered) {
+                g_custom_op_manager.register_custom_op(affine_op, &compose_affine, nullptr, false);
+            }
+            std::vector<int> optimized_affine(2 * counts[world_rank_], -1);
+            std::vector<int> direct_affine(2 * counts[world_rank_], -1);
+            optimizer.optimize_reduce_scatter(affine_input.data(), optimized_affine.data(), counts.data(),
+                affine_type, affine_op, comm_);
+            TopologyAwareReduceScatter(uneven).reduce_scatter(affine_input.data(), direct_affine.data(),
+                counts.data(), affine_type, affine_op, comm_);
+            bool passed = (optimized_affine == native_affine) && (direct_affine == native_affine);
+            all_passed &= passed;
+            if (!passed) {
+                std::cerr << "  FAILED: Reduce_scatter non-commutative op, registered=" << registered
+                    << ", rank=" << world_rank_ << std::endl;
+            }
+        }
+        g_custom_op_manager.unregister_custom_op(affine_op);
+        MPI_Op_free(&affine_op);
+        MPI_Type_free(&affine_type);
+
+        all_passed = agree(all_passed);
+
+        if (world_rank_ == 0 && all_passed) {
+            std::cout << "  All reduce_scatter tests passed" << std::endl;
+        }
+
+        return all_passed;
+    }
+
+    bool test_alltoall_correctness() {
+        if (world_rank_ == 0) {
+            std::cout << "Testing Alltoall/Alltoallv Algorithms..." << std::endl;
+        }
+
+        bool all_passed = true;
+        std::vector<int> test_sizes = { 1, 64, 1000 };
+        std::vector<std::pair<AlgorithmType, std::string>> algorithms = {
+            { AlgorithmType::BRUCK_ALLTOALL, "bruck" },
+            { AlgorithmType::PAIRWISE_ALLTOALL, "pairwise" },
+            { AlgorithmType::HIERARCHICAL_ALLTOALL, "hierarchical" },
+            { AlgorithmType::THROTTLED_ALLTOALL, "throttled" }
+        };
+        // Value of element j of the block rank `from` sends to rank `to`
+        auto expected = [](int from, int to, int j) { return static_cast<double>(from * 100000 + to * 1000 + j); };
+
+        NetworkCharacteristics interleaved, uneven;
+        interleaved.node_mapping.resize(world_size_);
+        uneven.node_mapping.resize(world_size_);
+        for (int i = 0; i < world_size_; ++i) {
+            interleaved.node_mapping[i] = i % 2;
+            uneven.node_mapping[i] = (i + 1) / 2;
+        }
+
+        // Uneven alltoallv layout: rank i sends (i + j) % 4 elements to rank j,
+        // with a one-element gap after every block
+        auto block_count = [](int from, int to) { return (from + to) % 4; };
+        std::vector<int> sendcounts(world_size_), sdispls(world_size_);
+        std::vector<int> recvcounts(world_size_), rdispls(world_size_);
+        int send_total = 0, recv_total = 0;
+        for (int i = 0; i < world_size_; ++i) {
+            sendcounts[i] = block_count(world_rank_, i);
+            sdispls[i] = send_total;
+            send_total += sendcounts[i] + 1;
+            recvcounts[i] = block_count(i, world_rank_);
+            rdispls[i] = recv_total;
+            recv_total += recvcounts[i] + 1;
+        }
+        std::vector<double> v_send(send_total, -1.0);
+        for (int i = 0; i < world_size_; ++i) {
+            for (int j = 0; j < sendcounts[i]; ++j) {
+                v_send[sdispls[i] + j] = expected(world_rank_, i, j);
+            }
+        }
+
+        for (const NetworkCharacteristics& config : { interleaved, uneven }) {
+            TopologyAwareAlltoall alltoall(config);
+            alltoall.set_max_outstanding(2);
+
+            for (const auto& algorithm : algorithms) {
+                for (int size : test_sizes) {
+                    for (bool in_place : { false, true }) {
+                        std::vector<double> send_buffer(size * world_size_);
+                        for (int i = 0; i < world_size_; ++i) {
+                            for (int j = 0; j < size; ++j) {
+                                send_buffer[i * size + j] = expected(world_rank_, i, j);
+                            }
+                        }
+                        std::vector<double> recv_buffer(in_place ? send_buffer : std::vector<double>(size * world_size_, -1.0));
+
+                        alltoall.execute(algorithm.first, in_place ? MPI_IN_PLACE : send_buffer.data(),
+                            recv_buffer.data(), size, MPI_DOUBLE, comm_);
+
+                        bool passed = true;
+                        for (int i = 0; i < world_size_; ++i) {
+                            for (int j = 0; j < size; ++j) {
+                                passed &= (recv_buffer[i * size + j] == expected(i, world_rank_, j));
+                            }
+                        }
+                        all_passed &= passed;
+                        if (!passed) {
+                            std::cerr << "  FAILED: Alltoall algorithm=" << algorithm.second << ", rank=" << world_rank_
+                                << ", size=" << size << ", in_place=" << in_place << std::endl;
+                        }
+                    }
+                }
+
+                std::vector<double> v_recv(recv_total, -1.0);
+                alltoall.execute(algorithm.first, v_send.data(), sendcounts.data(), sdispls.data(), MPI_DOUBLE,
+                    v_recv.data(), recvcounts.data(), rdispls.data(), MPI_DOUBLE, comm_);
+
+                bool passed = true;
+                for (int i = 0; i < world_size_; ++i) {
+                    for (int j = 0; j < recvcounts[i]; ++j) {
+                        passed &= (v_recv[rdispls[i] + j] == expected(i, world_rank_, j));
+                    }
+                    passed &= (v_recv[rdispls[i] + recvcounts[i]] == -1.0);
+                }
+                all_passed &= passed;
+                if (!passed) {
+                    std::cerr << "  FAILED: Alltoallv algorithm=" << algorithm.second << ", rank=" << world_rank_ << std::endl;
+                }
+            }
+        }
+
+        all_passed = agree(all_passed);
+
+        if (world_rank_ == 0 && all_passed) {
+            std::cout << "  All alltoall tests passed" << std::endl;
+        }
+
+        return all_passed;
+    }
+
+    // Composition of affine maps x -> a*x + b, applied left (lower rank) first;
+    // associative but not commutative
+    static void compose_affine(void* invec, void* inoutvec, int* len, MPI_Datatype*) {
+        const int* first = static_cast<const int*>(invec);
+        int* second = static_cast<int*>(inoutvec);
+        for (int i = 0; i < *len; ++i) {
+            int a = first[2 * i] * second[2 * i];
+            int b = second[2 * i] * first[2 * i + 1] + second[2 * i + 1];
+            second[2 * i] = a;
+            second[2 * i + 1] = b % 1000003;
+        }
+    }
+
+    bool test_allreduce_algorithms_correctness() {
+        if (world_rank_ == 0) {
+            std::cout << "Testing Allreduce Algorithms..." << std::endl;
+        }
+
+        bool all_passed = true;
+        NetworkCharacteristics config;
+        config.node_mapping.resize(world_size_);
+        for (int i = 0; i < world_size_; ++i) {
+            config.node_mapping[i] = i / 2;
+        }
+        HierarchicalAllreduce hierarchical(config);
+
+        using AllreduceCall = std::function<PerformanceMetrics(const void*, void*, int, MPI_Datatype, MPI_Op, MPI_Comm)>;
+        std::vector<std::pair<AllreduceCall, std::string>> algorithms = {
+            { fused_ring_allreduce, "fused ring" },
+            { fused_recursive_doubling_allreduce, "fused recursive doubling" },
+            { [&](const void* s, void* r, int n, MPI_Datatype t, MPI_Op o, MPI_Comm c) {
+                return optimizer_.optimize_allreduce(s, r, n, t, o, c); }, "optimizer" },
+            { [&](const void* s, void* r, int n, MPI_Datatype t, MPI_Op o, MPI_Comm c) {
+                return hierarchical.ring_allreduce(s, r, n, t, o, c); }, "hierarchical ring" },
+            { [&](const void* s, void* r, int n, MPI_Datatype t, MPI_Op o, MPI_Comm c) {
+                return hierarchical.segmented_ring_allreduce(s, r, n, t, o, c); }, "segmented ring" },
+            { [&](const void* s, void* r, int n, MPI_Datatype t, MPI_Op o, MPI_Comm c) {
+                return hierarchical.two_level_allreduce(s, r, n, t, o, c); }, "two-level" }
+        };
+
+        for (int count : { 1, 3, 1000, 20000 }) {
+            std::vector<int> input(count);
+            for (int i = 0; i < count; ++i) {
+                input[i] = (world_rank_ * 31 + i * 7) % 1000;
+            }
+
+            for (MPI_Op op : { MPI_SUM, MPI_MAX }) {
+                std::vector<int> native(count);
+                MPI_Allreduce(input.data(), native.data(), count, MPI_INT, op, comm_);
+
+                for (const auto& algorithm : algorithms) {
+                    // Out of place: sendbuf must stay untouched
+                    std::vector<int> sent(input), result(count, -1);
+                    algorithm.first(sent.data(), result.data(), count, MPI_INT, op, comm_);
+                    bool passed = (result == native) && (sent == input);
+
+                    std::vector<int> in_place(input);
+                    algorithm.first(MPI_IN_PLACE, in_place.data(), count, MPI_INT, op, comm_);
+                    passed &= (in_place == native);
+
+                    all_passed &= passed;
+                    if (!passed) {
+                        std::cerr << "  FAILED: Allreduce algorithm=" << algorithm.second << ", count=" << count
+                            << ", op=" << op_to_string(op) << ", rank=" << world_rank_ << std::endl;
+                    }
+                }
+            }
+        }
+
+        // fp16/bf16 through every algorithm with the registered op (which
+        // native MPI also takes) and the fused ring with plain MPI_SUM. Small
+        // integers keep every partial sum exact in both formats.
+        std::vector<std::pair<MPI_Datatype, std::string>> half_types = {
+            { float16_datatype(), "float16" }, { bfloat16_datatype(), "bfloat16" }
+        };
+        for (const auto& half_type : half_types) {
+            bool is_float16 = (half_type.first == float16_datatype());
+            auto encode = [&](float value) { return is_float16 ? float_to_half(value) : float_to_bfloat16(value); };
+            int count = 5000;
+            std::vector<uint16_t> input(count), expected(count);
+            for (int i = 0; i < count; ++i) {
+                input[i] = encode(static_cast<float>((world_rank_ + i) % 4));
+                int sum = 0;
+                for (int r = 0; r < world_size_; ++r) {
+                    sum += (r + i) % 4;
+                }
+                expected[i] = encode(static_cast<float>(sum));
+            }
+
+            std::vector<uint16_t> native(count);
+            MPI_Op half_sum = half_precision_op(MPI_SUM);
+            MPI_Allreduce(input.data(), native.data(), count, half_type.first, half_sum, comm_);
+            bool passed = (native == expected);
+
+            for (const auto& algorithm : algorithms) {
+                std::vector<uint16_t> result(count);
+                algorithm.first(input.data(), result.data(), count, half_type.first, half_sum, comm_);
+                bool algorithm_passed = (result == expected);
+                if (!algorithm_passed) {
+                    std::cerr << "  FAILED: Allreduce algorithm=" << algorithm.second << ", type="
+                        << half_type.second << ", rank=" << world_rank_ << std::endl;
+                }
+                passed &= algorithm_passed;
+            }
+            std::vector<uint16_t> predefined(count);
+            fused_ring_allreduce(input.data(), predefined.data(), count, half_type.first, MPI_SUM, comm_);
+            passed &= (predefined == expected);
+
+            all_passed &= passed;
+            if (!passed) {
+                std::cerr << "  FAILED: Half-precision allreduce type=" << half_type.second
+                    << ", rank=" << world_rank_ << std::endl;
+            }
+        }
+
+        // Typed custom op: the library's inlined loop against native MPI_SUM
+        MPI_Op typed_sum = g_custom_op_manager.register_typed_op<int>([](int left, int right) { return left + right; });
+        for (int count : { 3, 20000 }) {
+            std::vector<int> input(count), native(count);
+            for (int i = 0; i < count; ++i) {
+                input[i] = (world_rank_ * 17 + i) % 100;
+            }
+            MPI_Allreduce(input.data(), native.data(), count, MPI_INT, MPI_SUM, comm_);
+            for (const auto& algorithm : algorithms) {
+                std::vector<int> result(count);
+                algorithm.first(input.data(), result.data(), count, MPI_INT, typed_sum, comm_);
+                if (result != native) {
+                    all_passed = false;
+                    std::cerr << "  FAILED: Allreduce algorithm=" << algorithm.second << ", typed op, count="
+                        << count << ", rank=" << world_rank_ << std::endl;
+                }
+            }
+        }
+        g_custom_op_manager.unregister_custom_op(typed_sum);
+        MPI_Op_free(&typed_sum);
+
+        // Argmax over MPI_DOUBLE_INT, with ties across ranks, and products of
+        // Gaussian integers, which stay exact in any order
+        for (int count : { 3, 20000 }) {
+            struct DoubleInt { double value; int index; };
+            std::vector<DoubleInt> pairs(count), native_pairs(count);
+            std::vector<std::complex<double>> numbers(count), native_numbers(count);
+            for (int i = 0; i < count; ++i) {
+                pairs[i] = { static_cast<double>((world_rank_ * 5 + i) % 3), world_rank_ };
+                numbers[i] = std::complex<double>((world_rank_ + i) % 2, (world_rank_ + i) % 3 == 0 ? 1 : -1);
+            }
+            MPI_Allreduce(pairs.data(), native_pairs.data(), count, MPI_DOUBLE_INT, MPI_MAXLOC, comm_);
+            MPI_Allreduce(numbers.data(), native_numbers.data(), count, MPI_C_DOUBLE_COMPLEX, MPI_PROD, comm_);
+            for (const auto& algorithm : algorithms) {
+                std::vector<DoubleInt> result_pairs(count);
+                std::vector<std::complex<double>> result_numbers(count);
+                algorithm.first(pairs.data(), result_pairs.data(), count, MPI_DOUBLE_INT, MPI_MAXLOC, comm_);
+                algorithm.first(numbers.data(), result_numbers.data(), count, MPI_C_DOUBLE_COMPLEX, MPI_PROD, comm_);
+                bool passed = (result_numbers == native_numbers);
+                for (int i = 0; i < count; ++i) {
+                    passed &= result_pairs[i].value == native_pairs[i].value &&
+                        result_pairs[i].index == native_pairs[i].index;
+                }
+                all_passed &= passed;
+                if (!passed) {
+                    std::cerr << "  FAILED: Allreduce algorithm=" << algorithm.second
+                        << ", MAXLOC/complex PROD, count=" << count << ", rank=" << world_rank_ << std::endl;
+                }
+            }
+        }
+
+        // Compile-time typed API, out of place and in place, both algorithms,
+        // predefined ops and a user functor
+        struct Largest {
+            unsigned operator()(unsigned left, unsigned right) const { return std::max(left, right); }
+        };
+        for (int count : { 3, 20000 }) {
+            std::vector<double> input(count), native(count), result(count);
+            std::vector<unsigned> bits(count), native_bits(count);
+            std::vector<unsigned> largest(count), native_largest(count);
+            for (int i = 0; i < count; ++i) {
+                input[i] = (world_rank_ * 13 + i) % 50 * 0.5;
+                bits[i] = 1u << ((world_rank_ + i) % 32);
+            }
+            MPI_Allreduce(input.data(), native.data(), count, MPI_DOUBLE, MPI_SUM, comm_);
+            MPI_Allreduce(bits.data(), native_bits.data(), count, MPI_UNSIGNED, MPI_BOR, comm_);
+            MPI_Allreduce(bits.data(), native_largest.data(), count, MPI_UNSIGNED, MPI_MAX, comm_);
+            typed::allreduce<double, typed::Sum>(input.data(), result.data(), count, comm_);
+            typed::allreduce<unsigned, Largest>(bits.data(), largest.data(), count, comm_);
+            typed::allreduce<unsigned, typed::Bor>(bits, comm_);
+            if (result != native || bits != native_bits || largest != native_largest) {
+                all_passed = false;
+                std::cerr << "  FAILED: Typed allreduce, count=" << count << ", rank=" << world_rank_ << std::endl;
+            }
+        }
+
+        all_passed = agree(all_passed);
+
+        if (world_rank_ == 0 && all_passed) {
+            std::cout << "  All allreduce algorithm tests passed" << std::endl;
+        }
+
+        return all_passed;
+    }
+
+    bool test_ordered_reduction_correctness() {
+        if (world_rank_ == 0) {
+            std::cout << "Testing Order-Preserving Reduce/Allreduce..." << std::endl;
+        }
+
+        bool all_passed = true;
+        std::vector<std::pair<AlgorithmType, std::string>> algorithms = {
+            { AlgorithmType::ORDERED_TREE_REDUCE, "ordered tree" },
+            { AlgorithmType::ORDERED_RECURSIVE_HALVING_REDUCE, "ordered recursive halving" }
+        };
+
+        MPI_Datatype affine_type;
+        MPI_Type_contiguous(2, MPI_INT, &affine_type);
+        MPI_Type_commit(&affine_type);
+        MPI_Op affine_op;
+        MPI_Op_create(&compose_affine, 0, &affine_op);
+
+        // Consecutive nodes (two-level tree), interleaved nodes (flat tree)
+        NetworkCharacteristics pairs, interleaved;
+        pairs.node_mapping.resize(world_size_);
+        interleaved.node_mapping.resize(world_size_);
+        for (int i = 0; i < world_size_; ++i) {
+            pairs.node_mapping[i] = i / 2;
+            interleaved.node_mapping[i] = i % 2;
+        }
+
+        std::vector<int> counts = { 1, 7, 3000 };
+        std::vector<int> roots = { 0, world_size_ / 2, world_size_ - 1 };
+
+        for (const NetworkCharacteristics& config : { pairs, interleaved }) {
+            OrderedReduction ordered(config);
+            // Small segments so the tree pipelines
+            ordered.set_segment_size(256);
+
+            for (int count : counts) {
+                // x -> a*x + b with a = +-1 keeps products bounded
+                std::vector<int> input(2 * count);
+                for (int i = 0; i < count; ++i) {
+                    input[2 * i] = ((world_rank_ + i) % 3 == 0) ? -1 : 1;
+                    input[2 * i + 1] = (world_rank_ * 7 + i * 13) % 101;
+                }
+
+                std::vector<int> native_all(2 * count);
+                MPI_Allreduce(input.data(), native_all.data(), count, affine_type, affine_op, comm_);
+
+                for (const auto& algorithm : algorithms) {
+                    for (bool in_place : { false, true }) {
+                        std::vector<int> optimized(in_place ? input : std::vector<int>(2 * count, -1));
+                        ordered.execute(algorithm.first, in_place ? MPI_IN_PLACE : input.data(), optimized.data(),
+                            count, affine_type, affine_op, comm_);
+                        bool passed = (optimized == native_all);
+
+                        for (int root : roots) {
+                            std::vector<int> reduced(2 * count, -1);
+                            bool root_in_place = in_place && world_rank_ == root;
+                            if (root_in_place) {
+                                reduced = input;
+                            }
+                            ordered.execute(algorithm.first, root_in_place ? MPI_IN_PLACE : input.data(),
+                                reduced.data(), count, affine_type, affine_op, root, comm_);
+                            passed &= (world_rank_ != root) || (reduced == native_all);
+                        }
+
+                        all_passed &= passed;
+                        if (!passed) {
+                            std::cerr << "  FAILED: Ordered reduction algorithm=" << algorithm.second
+                                << ", count=" << count << ", rank=" << world_rank_ << ", in_place=" << in_place << std::endl;
+                        }
+                    }
+                }
+            }
+        }
+
+        // A registered non-commutative op is routed to the ordered variants
+        g_custom_op_manager.register_custom_op(affine_op, &compose_affine, nullptr, false);
+        all_passed &= (g_custom_op_manager.order_preserving_algorithm(affine_op, AlgorithmType::RABENSEIFNER_REDUCE) ==
+            AlgorithmType::ORDERED_RECURSIVE_HALVING_REDUCE);
+        all_passed &= (g_custom_op_manager.order_preserving_algorithm(MPI_SUM, AlgorithmType::RABENSEIFNER_REDUCE) ==
+            AlgorithmType::RABENSEIFNER_REDUCE);
+
+        CollectiveOptimizer optimizer;
+        for (int count : { 5, 6000 }) {
+            std::vector<int> input(2 * count);
+            for (int i = 0; i < count; ++i) {
+                input[2 * i] = ((world_rank_ * 5 + i) % 4 == 0) ? -1 : 1;
+                input[2 * i + 1] = (world_rank_ * 11 + i) % 97;
+            }
+            std::vector<int> native_all(2 * count), optimized_all(2 * count, -1), optimized_root(2 * count, -1);
+            MPI_Allreduce(input.data(), native_all.data(), count, affine_type, affine_op, comm_);
+            optimizer.optimize_allreduce(input.data(), optimized_all.data(), count, affine_type, affine_op, comm_);
+            optimizer.optimize_reduce(input.data(), optimized_root.data(), count, affine_type, affine_op, 0, comm_);
+            all_passed &= (optimized_all == native_all);
+            all_passed &= (world_rank_ != 0) || (optimized_root == native_all);
+        }
+        g_custom_op_manager.unregister_custom_op(affine_op);
+
+        MPI_Op_free(&affine_op);
+        MPI_Type_free(&affine_type);
+
+        all_passed = agree(all_passed);
+
+        if (world_rank_ == 0 && all_passed) {
+            std::cout << "  All order-preserving reduction tests passed" << std::endl;
+        }
+
+        return all_passed;
+    }
+
+    bool test_scan_correctness() {
+        if (world_rank_ == 0) {
+            std::cout << "Testing Scan/Exscan Algorithms..." << std::endl;
+        }
+
+        bool all_passed = true;
+        const int count = 37;
+        std::vector<std::pair<AlgorithmType, std::string>> algorithms = {
+            { AlgorithmType::RECURSIVE_DOUBLING_SCAN, "recursive doubling" },
+            { AlgorithmType::HIERARCHICAL_SCAN, "hierarchical" }
+        };
+
+        MPI_Datatype affine_type;
+        MPI_Type_contiguous(2, MPI_INT, &affine_type);
+        MPI_Type_commit(&affine_type);
+        MPI_Op affine_op;
+        MPI_Op_create(&compose_affine, 0, &affine_op);
+
+        std::vector<std::pair<MPI_Op, MPI_Datatype>> operations = {
+            { MPI_SUM, MPI_INT }, { MPI_MAX, MPI_INT }, { affine_op, affine_type }
+        };
+
+        // Consecutive nodes of uneven size, pairs, and interleaved nodes
+        // (the latter forces the recursive-doubling fallback)
+        NetworkCharacteristics uneven, pairs, interleaved;
+        uneven.node_mapping.resize(world_size_);
+        pairs.node_mapping.resize(world_size_);
+        interleaved.node_mapping.resize(world_size_);
+        for (int i = 0; i < world_size_; ++i) {
+            uneven.node_mapping[i] = (i + 1) / 2;
+            pairs.node_mapping[i] = i / 2;
+            interleaved.node_mapping[i] = i % 2;
+        }
+
+        // Two ints per element so the affine op sees (a, b) pairs
+        std::vector<int> input(2 * count);
+        for (int j = 0; j < count; ++j) {
+            input[2 * j] = 1 + (world_rank_ + j) % 2;
+            input[2 * j + 1] = (world_rank_ * 7 + j * 3) % 11;
+        }
+
+        for (const NetworkCharacteristics& config : { uneven, pairs, interleaved }) {
+            TopologyAwareScan scan(config);
+
+            for (const auto& algorithm : algorithms) {
+                for (const auto& operation : operations) {
+                    int elements = (operation.second == MPI_INT) ? 2 * count : count;
+
+                    for (bool exclusive : { false, true }) {
+                        std::vector<int> native(2 * count, -1);
+                        if (exclusive) {
+                            MPI_Exscan(input.data(), native.data(), elements, operation.second, operation.first, comm_);
+                        }
+                        else {
+                            MPI_Scan(input.data(), native.data(), elements, operation.second, operation.first, comm_);
+                        }
+
+                        for (bool in_place : { false, true }) {
+                            std::vector<int> result(in_place ? input : std::vector<int>(2 * count, -1));
+                            scan.execute(algorithm.first, exclusive, in_place ? MPI_IN_PLACE : input.data(),
+                                result.data(), elements, operation.second, operation.first, comm_);
+
+                            // Exscan leaves rank 0 undefined
+                            bool passed = (exclusive && world_rank_ == 0) || (result == native);
+                            all_passed &= passed;
+                            if (!passed) {
+                                std::cerr << "  FAILED: " << (exclusive ? "Exscan" : "Scan") << " algorithm="
+                                    << algorithm.second << ", rank=" << world_rank_ << ", in_place=" << in_place << std::endl;
+                            }
+                        }
+                    }
+                }
+            }
+        }
+
+        MPI_Op_free(&affine_op);
+        MPI_Type_free(&affine_type);
+
+        all_passed = agree(all_passed);
+
+        if (world_rank_ == 0 && all_passed) {
+            std::cout << "  All scan/exscan tests passed" << std::endl;
+        }
+
+        return all_passed;
+    }
+
+    bool test_barrier_correctness() {
+        if (world_rank_ == 0) {
+            std::cout << "Testing Barrier Algorithms..." << std::endl;
+        }
+
+        bool all_passed = true;
+        std::vector<std::pair<AlgorithmType, std::string>> algorithms = {
+            { AlgorithmType::DISSEMINATION_BARRIER, "dissemination" },
+            { AlgorithmType::HIERARCHICAL_BARRIER, "hierarchical" }
+        };
+        TopologyAwareBarrier barrier(optimizer_.get_network_characteristics());
+        const double delay = 0.01;
+
+        for (const auto& algorithm : algorithms) {
+            // One rank arrives late each round; nobody may leave before it
+            // arrives. Only local clocks are compared.
+            for (int round = 0; round < 2 * world_size_; ++round) {
+                int late_rank = round % world_size_;
+                if (world_rank_ == late_rank) {
+                    std::this_thread::sleep_for(std::chrono::duration<double>(delay));
+                }
+
+                auto start = MPI_Wtime();
+                barrier.execute(algorithm.first, comm_);
+                double waited = MPI_Wtime() - start;
+
+                bool passed = (world_rank_ == late_rank) || waited > delay / 2;
+                all_passed &= passed;
+                if (!passed) {
+                    std::cerr << "  FAILED: Barrier algorithm=" << algorithm.second << ", rank=" << world_rank_
+                        << " left after " << waited * 1000 << " ms, before late rank " << late_rank << std::endl;
+                }
+            }
+
+            // Back-to-back barriers reuse the shared flags; the counter must
+            // still agree everywhere afterwards
+            int rounds = 0;
+            for (int i = 0; i < 500; ++i) {
+                barrier.execute(algorithm.first, comm_);
+                ++rounds;
+            }
+            int min_rounds, max_rounds;
+            MPI_Allreduce(&rounds, &min_rounds, 1, MPI_INT, MPI_MIN, comm_);
+            MPI_Allreduce(&rounds, &max_rounds, 1, MPI_INT, MPI_MAX, comm_);
+            all_passed &= (min_rounds == max_rounds);
+        }
+
+        // Through the optimizer
+        optimizer_.optimize_barrier(comm_);
+
+        all_passed = agree(all_passed);
+
+        if (world_rank_ == 0 && all_passed) {
+            std::cout << "  All barrier tests passed" << std::endl;
+        }
+
+        return all_passed;
+    }
+
+    bool test_neighbor_correctness() {
+        if (world_rank_ == 0) {
+            std::cout << "Testing Neighborhood Collectives..." << std::endl;
+        }
+
+        bool all_passed = true;
+        std::vector<std::pair<AlgorithmType, std::string>> algorithms = {
+            { AlgorithmType::DIRECT_NEIGHBOR, "direct" },
+            { AlgorithmType::AGGREGATED_NEIGHBOR, "aggregated" }
+        };
+
+        NetworkCharacteristics pairs, interleaved, uneven;
+        pairs.node_mapping.resize(world_size_);
+        interleaved.node_mapping.resize(world_size_);
+        uneven.node_mapping.resize(world_size_);
+        for (int i = 0; i < world_size_; ++i) {
+            pairs.node_mapping[i] = i / 2;
+            interleaved.node_mapping[i] = i % 2;
+            uneven.node_mapping[i] = (i + 1) / 2;
+        }
+
+        // Halo graphs plus an irregular one with a repeated edge
+        std::vector<std::pair<int, std::string>> graphs = { { 6, "halo 6" }, { 26, "halo 26" }, { 0, "irregular" } };
+
+        for (const NetworkCharacteristics& config : { pairs, interleaved, uneven }) {
+            TopologyAwareNeighbor neighbor(config);
+
+            for (const auto& graph : graphs) {
+                MPI_Comm graph_comm;
+                if (graph.first > 0) {
+                    graph_comm = neighbor.create_halo_graph(comm_, graph.first);
+                }
+                else {
+                    int up = (world_rank_ + 1) % world_size_, far = (world_rank_ + 3) % world_size_;
+                    int down = (world_rank_ - 1 + world_size_) % world_size_;
+                    int far_down = ((world_rank_ - 3) % world_size_ + world_size_) % world_size_;
+                    std::vector<int> destinations = { up, far, up };
+                    std::vector<int> sources = { down, far_down, down };
+                    MPI_Dist_graph_create_adjacent(comm_, 3, sources.data(), MPI_UNWEIGHTED,
+                        3, destinations.data(), MPI_UNWEIGHTED, MPI_INFO_NULL, 0, &graph_comm);
+                }
+
+                int indegree, outdegree, weighted;
+                MPI_Dist_graph_neighbors_count(graph_comm, &indegree, &outdegree, &weighted);
+                std::vector<int> sources(indegree), destinations(outdegree);
+                MPI_Dist_graph_neighbors(graph_comm, indegree, sources.data(), MPI_UNWEIGHTED,
+                    outdegree, destinations.data(), MPI_UNWEIGHTED);
+
+                // Allgather of a rank-dependent block
+                const int block = 5;
+                std::vector<int> send_block(block);
+                for (int k = 0; k < block; ++k) {
+                    send_block[k] = world_rank_ * 100 + k;
+                }
+                std::vector<int> native_gather(indegree * block);
+                MPI_Neighbor_allgather(send_block.data(), block, MPI_INT, native_gather.data(), block, MPI_INT, graph_comm);
+
+                // Alltoallv with a size per (sender, receiver, repetition), some empty
+                auto edge_count = [](int sender, int receiver, int occurrence) {
+                    return (sender + 2 * receiver + occurrence) % 4;
+                };
+                std::vector<int> sendcounts(outdegree), sdispls(outdegree), recvcounts(indegree), rdispls(indegree);
+                std::map<int, int> seen;
+                for (int i = 0; i < outdegree; ++i) {
+                    sendcounts[i] = edge_count(world_rank_, destinations[i], seen[destinations[i]]++);
+                    sdispls[i] = (i == 0) ? 0 : sdispls[i - 1] + sendcounts[i - 1];
+                }
+                seen.clear();
+                for (int j = 0; j < indegree; ++j) {
+                    recvcounts[j] = edge_count(sources[j], world_rank_, seen[sources[j]]++);
+                    rdispls[j] = (j == 0) ? 0 : rdispls[j - 1] + recvcounts[j - 1];
+                }
+                std::vector<int> send_data(outdegree > 0 ? sdispls[outdegree - 1] + sendcounts[outdegree - 1] : 0);
+                for (int i = 0; i < outdegree; ++i) {
+                    for (int k = 0; k < sendcounts[i]; ++k) {
+                        send_data[sdispls[i] + k] = world_rank_ * 1000 + i * 10 + k;
+                    }
+                }
+                std::vector<int> native_v(indegree > 0 ? rdispls[indegree - 1] + recvcounts[indegree - 1] : 0);
+                MPI_Neighbor_alltoallv(send_data.data(), sendcounts.data(), sdispls.data(), MPI_INT,
+                    native_v.data(), recvcounts.data(), rdispls.data(), MPI_INT, graph_comm);
+
+                for (const auto& algorithm : algorithms) {
+                    for (int repeat = 0; repeat < 2; ++repeat) {
+                        std::vector<int> optimized_gather(native_gather.size(), -1);
+                        neighbor.execute(algorithm.first, send_block.data(), block, MPI_INT,
+                            optimized_gather.data(), block, MPI_INT, graph_comm);
+
+                        std::vector<int> optimized_v(native_v.size(), -1);
+                        neighbor.execute(algorithm.first, send_data.data(), sendcounts.data(), sdispls.data(), MPI_INT,
+                            optimized_v.data(), recvcounts.data(), rdispls.data(), MPI_INT, graph_comm);
+
+                        bool passed = (optimized_gather == native_gather) && (optimized_v == native_v);
+                        all_passed &= passed;
+                        if (!passed) {
+                            std::cerr << "  FAILED: Neighbor algorithm=" << algorithm.second
+                                << ", graph=" << graph.second << ", rank=" << world_rank_ << std::endl;
+                        }
+                    }
+                }
+
+                MPI_Comm_free(&graph_comm);
+            }
+        }
+
+        // Through the optimizer on the detected topology
+        MPI_Comm halo_comm = optimizer_.create_halo_graph(comm_, 6);
+        std::vector<double> halo_send(8, world_rank_), halo_native(6 * 8), halo_optimized(6 * 8);
+        MPI_Neighbor_allgather(halo_send.data(), 8, MPI_DOUBLE, halo_native.data(), 8, MPI_DOUBLE, halo_comm);
+        optimizer_.optimize_neighbor_allgather(halo_send.data(), 8, MPI_DOUBLE,
+            halo_optimized.data(), 8, MPI_DOUBLE, halo_comm);
+        all_passed &= (halo_native == halo_optimized);
+        MPI_Comm_free(&halo_comm);
+
+        all_passed = agree(all_passed);
+
+        if (world_rank_ == 0 && all_passed) {
+            std::cout << "  All neighborhood collective tests passed" << std::endl;
+        }
+
+        return all_passed;
+    }
+
     bool test_topology_aware_correctness() {
         if (world_rank_ == 0) {
             std::cout << "Testing Topology-Aware Algorithms..." << std::endl;
@@ -323,10 +1387,134 @@ public:
         bool binomial_correct = verify_sequential(buffer1.data(), size, root);
         bool pipeline_correct = verify_sequential(buffer2.data(), size, root);
 
-        return binomial_correct && pipeline_correct;
+        // Typed front end: the datatype comes from the element type
+        std::vector<double> buffer3(size);
+        if (world_rank_ == root) {
+            initialize_sequential(buffer3.data(), size, root);
+        }
+        typed::bcast(topology_broadcast_, buffer3, root, comm_);
+        bool typed_correct = verify_sequential(buffer3.data(), size, root);
+
+        return binomial_correct && pipeline_correct && typed_correct;
+    }
+
+    bool test_torus_broadcast_correctness() {
+        if (world_rank_ == 0) {
+            std::cout << "Testing Multi-Port Torus Broadcast..." << std::endl;
+        }
+
+        bool all_passed = true;
+        std::vector<int> test_sizes = { 1, 256, 4096 };
+        std::vector<int> roots = { 0, world_size_ / 2, world_size_ - 1 };
+
+        // 2D grid with a partial last row and a 3D grid with a partial last plane
+        std::vector<std::vector<int>> grids = {
+            { 2, (world_size_ + 1) / 2, 1 },
+            { 2, 2, (world_size_ + 3) / 4 }
+        };
+
+        for (const auto& grid : grids) {
+            NetworkCharacteristics config;
+            config.topology = (grid[2] > 1) ? NetworkTopology::TORUS_3D : NetworkTopology::TORUS_2D;
+            config.topology_params.torus.x = grid[0];
+            config.topology_params.torus.y = grid[1];
+            config.topology_params.torus.z = grid[2];
+
+            MultiPortTorusBroadcast torus(config);
+            torus.set_segment_size(512);
+
+            for (int size : test_sizes) {
+                for (int root : roots) {
+                    std::vector<double> buffer(size, 0.0);
+                    if (world_rank_ == root) {
+                        initialize_sequential(buffer.data(), size, root);
+                    }
+
+                    torus.broadcast(buffer.data(), size, MPI_DOUBLE, root, comm_);
+                    bool passed = verify_sequential(buffer.data(), size, root);
+                    all_passed &= passed;
+
+                    if (world_rank_ == 0 && !passed) {
+                        std::cerr << "  FAILED: Torus broadcast grid=" << grid[0] << "x"
+                            << grid[1] << "x" << grid[2] << ", size=" << size
+                            << ", root=" << root << std::endl;
+                    }
+                }
+            }
+        }
+
+        if (world_rank_ == 0 && all_passed) {
+            std::cout << "  All torus broadcast tests passed" << std::endl;
+        }
+
+        return all_passed;
+    }
+
+    bool test_dragonfly_broadcast_correctness() {
+        if (world_rank_ == 0) {
+            std::cout << "Testing Dragonfly Broadcast..." << std::endl;
+        }
+
+        bool all_passed = true;
+        std::vector<int> test_sizes = { 1, 256, 4096 };
+        std::vector<int> roots = { 0, world_size_ / 2, world_size_ - 1 };
+
+        // Explicit layout with uneven routers and groups, and the fallback
+        // that groups consecutive ranks by the dragonfly parameters
+        NetworkCharacteristics explicit_layout;
+        explicit_layout.topology = NetworkTopology::DRAGONFLY;
+        explicit_layout.group_mapping.resize(world_size_);
+        explicit_layout.router_mapping.resize(world_size_);
+        for (int i = 0; i < world_size_; ++i) {
+            explicit_layout.router_mapping[i] = (i * 5) % ((world_size_ + 2) / 3);
+            explicit_layout.group_mapping[i] = explicit_layout.router_mapping[i] % 3;
+        }
+
+        NetworkCharacteristics inferred_layout;
+        inferred_layout.topology = NetworkTopology::DRAGONFLY;
+        inferred_layout.topology_params.dragonfly.routers_per_group = 2;
+        inferred_layout.topology_params.dragonfly.nodes_per_router = 1;
+
+        for (const NetworkCharacteristics& config : { explicit_layout, inferred_layout }) {
+            DragonflyBroadcast dragonfly(config);
+            dragonfly.set_segment_size(512);
+
+            for (int size : test_sizes) {
+                for (int root : roots) {
+                    std::vector<double> buffer(size, 0.0);
+                    if (world_rank_ == root) {
+                        initialize_sequential(buffer.data(), size, root);
+                    }
+
+                    dragonfly.broadcast(buffer.data(), size, MPI_DOUBLE, root, comm_);
+                    bool passed = verify_sequential(buffer.data(), size, root);
+                    all_passed &= passed;
+
+                    if (world_rank_ == 0 && !passed) {
+                        std::cerr << "  FAILED: Dragonfly broadcast layout="
+                            << (config.group_mapping.empty() ? "inferred" : "explicit")
+                            << ", size=" << size << ", root=" << root << std::endl;
+                    }
+                }
+            }
+        }
+
+        if (world_rank_ == 0 && all_passed) {
+            std::cout << "  All dragonfly broadcast tests passed" << std::endl;
+        }
+
+        return all_passed;
     }
 
 private:
+    // Failures are seen by the ranks that check them; true only if every
+    // rank passed
+    bool agree(bool passed) {
+        int passed_everywhere = passed ? 1 : 0;
+        MPI_Allreduce(MPI_IN_PLACE, &passed_everywhere, 1, MPI_INT, MPI_MIN, comm_);
+        return passed_everywhere == 1;
+    }
+
     void initialize_sequential(double* buffer, int size, int rank) {
         for (int i = 0; i < size; ++i) {
             buffer[i] = static_cast<double>(i + rank + 1);
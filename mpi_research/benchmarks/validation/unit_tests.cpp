@@ -5,8 +5,16 @@
 #include <cmath>
 #include <algorithm>
 #include <memory>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <complex>
 #include "../../src/core/collective_optimizer.h"
 #include "../../src/core/topology_detection.h"
+#include "../../src/core/reduction_ops.h"
+#include "../../src/core/reduction_simd.h"
+#include "../../src/core/reduction_half.h"
+#include "../../src/core/scratch_pool.h"
 #include "../../src/utils/performance_measurement.h"
 
 using namespace TopologyAwareResearch;
@@ -42,6 +50,16 @@ public:
         // Test performance metrics
         all_passed &= test_performance_metrics();
 
+        // Test resolved reduction kernels
+        all_passed &= test_reduction_kernels();
+        all_passed &= test_derived_datatype_kernels();
+        all_passed &= test_half_precision_kernels();
+        all_passed &= test_typed_custom_ops();
+        all_passed &= test_location_and_complex_kernels();
+
+        // Test scratch buffer pool
+        all_passed &= test_scratch_pool();
+
         if (world_rank_ == 0) {
             if (all_passed) {
                 std::cout << "=== ALL UNIT TESTS PASSED ===" << std::endl;
@@ -324,6 +342,550 @@ public:
 
         return passed;
     }
+
+    // Resolved kernel at an offset against MPI_Reduce_local on the same data
+    template<typename T>
+    bool check_reduction_kernel(MPI_Datatype datatype, MPI_Op op, int count = 37) {
+        const int start = 5;
+        std::vector<T> src(count), dest(start + count), expected;
+        for (int i = 0; i < count; ++i) {
+            src[i] = static_cast<T>((i * 7) % 5);
+        }
+        for (int i = 0; i < start + count; ++i) {
+            dest[i] = static_cast<T>((i * 3) % 4);
+        }
+        expected = dest;
+        MPI_Reduce_local(src.data(), expected.data() + start, count, datatype, op);
+
+        ReductionKernel kernel = resolve_reduction_kernel(datatype, op);
+        std::vector<T> right(dest.begin() + start, dest.end());
+        kernel(dest.data(), src.data(), start, count);
+        bool passed = (dest == expected);
+
+        // Three-operand forms: into a third buffer, into the left operand,
+        // and with the forwarded copy
+        std::vector<T> fused(count), forwarded(count), left(src);
+        kernel.combine(fused.data(), src.data(), right.data(), count);
+        passed &= std::equal(fused.begin(), fused.end(), expected.begin() + start);
+        kernel.combine(left.data(), left.data(), right.data(), count);
+        passed &= std::equal(left.begin(), left.end(), expected.begin() + start);
+        fused.assign(count, T());
+        kernel.combine_forward(fused.data(), forwarded.data(), src.data(), right.data(), count);
+        passed &= std::equal(fused.begin(), fused.end(), expected.begin() + start) && (forwarded == fused);
+
+        // K-way form against pairwise MPI_Reduce_local, into a third buffer
+        // and into the first source
+        std::vector<std::vector<T>> inputs = { right, src, src, right };
+        for (int i = 0; i < count; ++i) {
+            inputs[2][i] = static_cast<T>((i * 5) % 3 + 1);
+        }
+        std::vector<T> pairwise(inputs[0]);
+        for (size_t k = 1; k < inputs.size(); ++k) {
+            MPI_Reduce_local(inputs[k].data(), pairwise.data(), count, datatype, op);
+        }
+        std::vector<const void*> sources;
+        for (const std::vector<T>& input : inputs) {
+            sources.push_back(input.data());
+        }
+        std::vector<T> many(count);
+        kernel.combine_many(many.data(), sources.data(), static_cast<int>(sources.size()), count);
+        passed &= (many == pairwise);
+        kernel.combine_many(inputs[0].data(), sources.data(), static_cast<int>(sources.size()), count);
+        passed &= (inputs[0] == pairwise);
+        return passed;
+    }
+
+    bool test_reduction_kernels() {
+        if (world_rank_ == 0) {
+            std::cout << "Testing Reduction Kernels..." << std::endl;
+        }
+
+        bool passed = true;
+        for (MPI_Op op : { MPI_SUM, MPI_PROD, MPI_MAX, MPI_MIN, MPI_LAND, MPI_LOR, MPI_LXOR }) {
+            passed &= check_reduction_kernel<int>(MPI_INT, op);
+            passed &= check_reduction_kernel<long>(MPI_LONG, op);
+            passed &= check_reduction_kernel<unsigned short>(MPI_UNSIGNED_SHORT, op);
+        }
+
+        // Every vector level this CPU has; counts cover the unrolled loop,
+        // single vectors and the scalar tail
+        SimdLevel detected = detect_simd_level();
+        for (SimdLevel level : { SimdLevel::SCALAR, SimdLevel::SSE42, SimdLevel::AVX2, SimdLevel::AVX512 }) {
+            if (level > detected) {
+                continue;
+            }
+            set_simd_level(level);
+            bool level_passed = true;
+            for (int count : { 3, 37, 1000 }) {
+                for (MPI_Op op : { MPI_SUM, MPI_PROD, MPI_MAX, MPI_MIN }) {
+                    level_passed &= check_reduction_kernel<float>(MPI_FLOAT, op, count);
+                    level_passed &= check_reduction_kernel<double>(MPI_DOUBLE, op, count);
+                    level_passed &= check_reduction_kernel<unsigned char>(MPI_UNSIGNED_CHAR, op, count);
+                }
+                for (MPI_Op op : { MPI_SUM, MPI_PROD, MPI_MAX, MPI_MIN, MPI_BAND, MPI_BOR, MPI_BXOR }) {
+                    level_passed &= check_reduction_kernel<int>(MPI_INT, op, count);
+                    level_passed &= check_reduction_kernel<long>(MPI_LONG, op, count);
+                    level_passed &= check_reduction_kernel<unsigned>(MPI_UNSIGNED, op, count);
+                    level_passed &= check_reduction_kernel<unsigned long>(MPI_UNSIGNED_LONG, op, count);
+                    level_passed &= check_reduction_kernel<unsigned short>(MPI_UNSIGNED_SHORT, op, count);
+                }
+                for (MPI_Op op : { MPI_BAND, MPI_BOR, MPI_BXOR }) {
+                    level_passed &= check_reduction_kernel<unsigned char>(MPI_BYTE, op, count);
+                }
+            }
+            if (world_rank_ == 0) {
+                std::cout << "  " << simd_level_name(level) << " kernels: "
+                    << (level_passed ? "PASSED" : "FAILED") << std::endl;
+            }
+            passed &= level_passed;
+        }
+        set_simd_level(detected);
+
+        // Non-temporal store kernels and copies; the dest offset in
+        // check_reduction_kernel exercises the alignment prologue
+        set_streaming_stores(StreamingStores::ALWAYS);
+        bool streaming_passed = true;
+        for (SimdLevel level : { SimdLevel::SSE42, SimdLevel::AVX2, SimdLevel::AVX512 }) {
+            if (level > detected) {
+                continue;
+            }
+            set_simd_level(level);
+            for (int count : { 3, 37, 1000 }) {
+                streaming_passed &= check_reduction_kernel<double>(MPI_DOUBLE, MPI_SUM, count);
+                streaming_passed &= check_reduction_kernel<float>(MPI_FLOAT, MPI_MAX, count);
+                streaming_passed &= check_reduction_kernel<int>(MPI_INT, MPI_BXOR, count);
+                streaming_passed &= check_reduction_kernel<unsigned char>(MPI_UNSIGNED_CHAR, MPI_MIN, count);
+            }
+        }
+        set_simd_level(detected);
+        for (size_t bytes : { size_t(1), size_t(15), size_t(100), size_t(4099) }) {
+            std::vector<char> from(bytes + 3), to(bytes + 3, 0);
+            for (size_t i = 0; i < from.size(); ++i) {
+                from[i] = static_cast<char>(i * 13);
+            }
+            stream_copy(to.data() + 3, from.data() + 1, bytes);
+            streaming_passed &= std::equal(from.begin() + 1, from.begin() + 1 + bytes, to.begin() + 3);
+        }
+        set_streaming_stores(StreamingStores::AUTO);
+
+        // Segments of a collective larger than the cache stream, whatever
+        // their own size
+        if (detected > SimdLevel::SCALAR) {
+            ReductionKernel segmented = resolve_reduction_kernel(MPI_DOUBLE, MPI_SUM);
+            segmented.stream_for_total(last_level_cache_bytes() / 2);
+            streaming_passed &= segmented.select(1000) == segmented.function;
+            segmented.stream_for_total(last_level_cache_bytes());
+            streaming_passed &= segmented.select(1000) == segmented.streaming_function &&
+                segmented.streaming_function != nullptr;
+        }
+        if (world_rank_ == 0) {
+            std::cout << "  Streaming-store kernels: " << (streaming_passed ? "PASSED" : "FAILED")
+                << " (LLC " << (last_level_cache_bytes() >> 10) << " KiB)" << std::endl;
+        }
+        passed &= streaming_passed;
+
+        // Large calls split over an OpenMP team, also from inside a
+        // parallel region where they must fall back to one thread
+        set_parallel_reduction(4, 1024);
+        bool parallel_passed = true;
+        for (int count : { 5000, 100003 }) {
+            parallel_passed &= check_reduction_kernel<double>(MPI_DOUBLE, MPI_SUM, count);
+            parallel_passed &= check_reduction_kernel<int>(MPI_INT, MPI_MAX, count);
+            parallel_passed &= check_reduction_kernel<long>(MPI_LONG, MPI_LAND, count);
+        }
+        int nested_failures = 0;
+        #pragma omp parallel num_threads(2) reduction(+:nested_failures)
+        {
+            nested_failures += check_reduction_kernel<float>(MPI_FLOAT, MPI_SUM, 100003) ? 0 : 1;
+        }
+        parallel_passed &= (nested_failures == 0);
+        set_parallel_reduction(1, 4 << 20);
+        if (world_rank_ == 0) {
+            std::cout << "  Parallel kernels: " << (parallel_passed ? "PASSED" : "FAILED") << std::endl;
+        }
+        passed &= parallel_passed;
+
+        if (world_rank_ == 0) {
+            std::cout << "  Kernels vs MPI_Reduce_local: " << (passed ? "PASSED" : "FAILED") << std::endl;
+        }
+
+        return passed;
+    }
+
+    // SUM through reduce_segments on a datatype made of T elements; slots of
+    // the extent not in the typemap must be left alone
+    template<typename T>
+    bool check_derived_kernel(MPI_Datatype datatype, const std::vector<bool>& covered, int count = 9) {
+        size_t slots = covered.size() * count;
+        std::vector<T> src(slots), dest(slots), expected(slots);
+        for (size_t i = 0; i < slots; ++i) {
+            src[i] = static_cast<T>(i % 7 + 1);
+            dest[i] = static_cast<T>(i % 5);
+            expected[i] = covered[i % covered.size()] ? src[i] + dest[i] : dest[i];
+        }
+        reduce_segments(dest.data(), src.data(), 0, count, datatype, MPI_SUM);
+        return dest == expected;
+    }
+
+    bool test_derived_datatype_kernels() {
+        if (world_rank_ == 0) {
+            std::cout << "Testing Derived Datatype Kernels..." << std::endl;
+        }
+
+        bool passed = true;
+
+        // 3 blocks of 2 doubles, stride 4: covers slots 0-1, 4-5, 8-9 of 10
+        MPI_Datatype vector_type;
+        MPI_Type_vector(3, 2, 4, MPI_DOUBLE, &vector_type);
+        MPI_Type_commit(&vector_type);
+        passed &= check_derived_kernel<double>(vector_type,
+            { true, true, false, false, true, true, false, false, true, true });
+
+        // Blocks {1, 3} at {0, 4}: slots 0 and 4-6 of 7
+        int blocklengths[2] = { 1, 3 };
+        int displacements[2] = { 0, 4 };
+        MPI_Datatype indexed_type;
+        MPI_Type_indexed(2, blocklengths, displacements, MPI_INT, &indexed_type);
+        MPI_Type_commit(&indexed_type);
+        passed &= check_derived_kernel<int>(indexed_type, { true, false, false, false, true, true, true });
+
+        // Contiguous types reduce as one run over all elements
+        MPI_Datatype contiguous_type;
+        MPI_Type_contiguous(5, MPI_FLOAT, &contiguous_type);
+        MPI_Type_commit(&contiguous_type);
+        passed &= check_derived_kernel<float>(contiguous_type, std::vector<bool>(5, true), 1000);
+
+        // Mixed struct resized to its C++ layout, padding included
+        struct Record { double x; int n; float y[2]; };
+        int struct_lengths[3] = { 1, 1, 2 };
+        MPI_Aint struct_offsets[3] = { offsetof(Record, x), offsetof(Record, n), offsetof(Record, y) };
+        MPI_Datatype struct_types[3] = { MPI_DOUBLE, MPI_INT, MPI_FLOAT };
+        MPI_Datatype packed_type, record_type;
+        MPI_Type_create_struct(3, struct_lengths, struct_offsets, struct_types, &packed_type);
+        MPI_Type_create_resized(packed_type, 0, sizeof(Record), &record_type);
+        MPI_Type_commit(&record_type);
+
+        std::vector<Record> src(11), dest(11), expected(11);
+        for (int i = 0; i < 11; ++i) {
+            src[i] = { 1.5 * i, i, { 2.0f * i, 3.0f } };
+            dest[i] = { 0.25, 2 * i + 1, { 1.0f, -1.0f * i } };
+            expected[i] = { dest[i].x > src[i].x ? dest[i].x : src[i].x, std::max(dest[i].n, src[i].n),
+                { std::max(dest[i].y[0], src[i].y[0]), std::max(dest[i].y[1], src[i].y[1]) } };
+        }
+        ReductionKernel kernel = resolve_reduction_kernel(record_type, MPI_MAX);
+        kernel(dest.data(), src.data(), 0, 11);
+        for (int i = 0; i < 11; ++i) {
+            passed &= dest[i].x == expected[i].x && dest[i].n == expected[i].n &&
+                dest[i].y[0] == expected[i].y[0] && dest[i].y[1] == expected[i].y[1];
+        }
+        passed &= is_operation_supported(record_type, MPI_MAX) && !is_operation_supported(record_type, MPI_BAND);
+
+        MPI_Type_free(&vector_type);
+        MPI_Type_free(&indexed_type);
+        MPI_Type_free(&contiguous_type);
+        MPI_Type_free(&packed_type);
+        MPI_Type_free(&record_type);
+
+        if (world_rank_ == 0) {
+            std::cout << "  Flattened vector/indexed/contiguous/struct layouts: "
+                << (passed ? "PASSED" : "FAILED") << std::endl;
+        }
+        return passed;
+    }
+
+    bool test_half_precision_kernels() {
+        if (world_rank_ == 0) {
+            std::cout << "Testing Half-Precision Kernels..." << std::endl;
+        }
+
+        // Conversions: exact values, rounding to even, subnormals, overflow
+        bool passed = float_to_half(1.0f) == 0x3C00 && float_to_half(-2.5f) == 0xC100 &&
+            float_to_half(65504.0f) == 0x7BFF && float_to_half(65520.0f) == 0x7C00 &&
+            float_to_half(1.0f + 1.0f / 2048) == 0x3C00 && float_to_half(1.0f + 3.0f / 2048) == 0x3C02 &&
+            float_to_half(5.9604645e-8f) == 0x0001 && float_to_half(1e-9f) == 0x0000 &&
+            half_to_float(0x0001) == 5.9604645e-8f && half_to_float(0x3555) == 0.333251953125f &&
+            float_to_bfloat16(1.0f) == 0x3F80 && float_to_bfloat16(1.00390625f) == 0x3F80 &&
+            float_to_bfloat16(1.01171875f) == 0x3F82 && bfloat16_to_float(0xC040) == -3.0f &&
+            // Bit checks, as -ffast-math builds may fold std::isnan away
+            (float_to_half(std::numeric_limits<float>::quiet_NaN()) & 0x7E00) == 0x7E00 &&
+            (float_to_bfloat16(std::numeric_limits<float>::quiet_NaN()) & 0x7FC0) == 0x7FC0;
+
+        // Every vector level against the scalar kernel, which widens both
+        // operands, combines in fp32 and rounds once
+        SimdLevel detected = detect_simd_level();
+        for (MPI_Datatype datatype : { float16_datatype(), bfloat16_datatype() }) {
+            bool is_float16 = (datatype == float16_datatype());
+            auto encode = [&](float value) { return is_float16 ? float_to_half(value) : float_to_bfloat16(value); };
+            auto decode = [&](uint16_t value) { return is_float16 ? half_to_float(value) : bfloat16_to_float(value); };
+            int count = 103;
+            std::vector<uint16_t> a(count), b(count);
+            for (int i = 0; i < count; ++i) {
+                a[i] = encode(0.37f * i - 11.0f);
+                b[i] = encode(1.0f / (i + 1) + 3.0f);
+            }
+            for (MPI_Op op : { MPI_SUM, MPI_PROD, MPI_MAX, MPI_MIN }) {
+                std::vector<uint16_t> expected(count);
+                for (int i = 0; i < count; ++i) {
+                    float x = decode(a[i]), y = decode(b[i]);
+                    float r = op == MPI_SUM ? x + y : op == MPI_PROD ? x * y : op == MPI_MAX ? std::max(x, y) : std::min(x, y);
+                    expected[i] = encode(r);
+                }
+                for (SimdLevel level : { SimdLevel::SCALAR, SimdLevel::SSE42, SimdLevel::AVX2, SimdLevel::AVX512 }) {
+                    if (level > detected) {
+                        continue;
+                    }
+                    set_simd_level(level);
+                    ReductionKernel kernel = resolve_reduction_kernel(datatype, op);
+                    std::vector<uint16_t> result(count);
+                    kernel.combine(result.data(), a.data(), b.data(), count);
+                    passed &= (result == expected);
+                }
+                set_simd_level(detected);
+
+                // The registered op through MPI itself
+                std::vector<uint16_t> inout(b);
+                MPI_Reduce_local(a.data(), inout.data(), count, datatype, half_precision_op(op));
+                passed &= (inout == expected);
+            }
+        }
+
+        if (world_rank_ == 0) {
+            std::cout << "  fp16/bf16 conversions and kernels: " << (passed ? "PASSED" : "FAILED") << std::endl;
+        }
+        return passed;
+    }
+
+    bool test_typed_custom_ops() {
+        if (world_rank_ == 0) {
+            std::cout << "Testing Typed Custom Ops..." << std::endl;
+        }
+
+        // Non-commutative on purpose: operand order must match MPI's
+        auto scaled = [](double factor) {
+            return [factor](double left, double right) { return left * factor + right; };
+        };
+        double scale = 0.5;
+        MPI_Op op = g_custom_op_manager.register_typed_op<double>(scaled(scale), false);
+
+        int count = 1001;
+        std::vector<double> a(count), b(count), expected(count);
+        for (int i = 0; i < count; ++i) {
+            a[i] = i * 0.25;
+            b[i] = 3.0 - i;
+            expected[i] = a[i] * scale + b[i];
+        }
+
+        ReductionKernel kernel = resolve_reduction_kernel(MPI_DOUBLE, op);
+        std::vector<double> result(count), forwarded(count);
+        kernel.combine_forward(result.data(), forwarded.data(), a.data(), b.data(), count);
+        bool passed = (result == expected) && (forwarded == expected);
+
+        // reduce_segments at an offset, and MPI itself through the op
+        std::vector<double> dest(3 + count, 7.0);
+        std::copy(b.begin(), b.end(), dest.begin() + 3);
+        reduce_segments(dest.data(), a.data(), 3, count, MPI_DOUBLE, op);
+        passed &= std::equal(expected.begin(), expected.end(), dest.begin() + 3) && dest[0] == 7.0;
+        std::vector<double> inout(b);
+        MPI_Reduce_local(a.data(), inout.data(), count, MPI_DOUBLE, op);
+        passed &= (inout == expected);
+
+        // The same lambda type with another capture is a separate op
+        MPI_Op doubled = g_custom_op_manager.register_typed_op<double>(scaled(2.0), false);
+        ReductionKernel doubled_kernel = resolve_reduction_kernel(MPI_DOUBLE, doubled);
+        doubled_kernel.combine(result.data(), a.data(), b.data(), count);
+        inout = b;
+        MPI_Reduce_local(a.data(), inout.data(), count, MPI_DOUBLE, doubled);
+        for (int i = 0; i < count; ++i) {
+            passed &= result[i] == a[i] * 2.0 + b[i] && inout[i] == result[i];
+        }
+        kernel.combine(result.data(), a.data(), b.data(), count);
+        passed &= (result == expected);
+
+        // A datatype of two doubles is not read as one double per element
+        MPI_Datatype pair;
+        MPI_Type_contiguous(2, MPI_DOUBLE, &pair);
+        MPI_Type_commit(&pair);
+        ReductionKernel pair_kernel = resolve_reduction_kernel(pair, op);
+        passed &= pair_kernel.function != kernel.function;
+        pair_kernel.combine(result.data(), a.data(), b.data(), count / 2);
+        passed &= std::equal(expected.begin(), expected.begin() + count / 2 * 2, result.begin());
+        MPI_Type_free(&pair);
+
+        // One double per element with lb -8 and a 16-byte stride: the value
+        // sits at the true lower bound, not at lb
+        MPI_Datatype shifted;
+        MPI_Type_create_resized(MPI_DOUBLE, -8, 16, &shifted);
+        MPI_Type_commit(&shifted);
+        int strided = count / 2;
+        inout = b;
+        MPI_Reduce_local(a.data(), inout.data(), strided, shifted, op);
+        for (int i = 0; i < 2 * strided; ++i) {
+            passed &= inout[i] == (i % 2 == 0 ? expected[i] : b[i]);
+        }
+        MPI_Type_free(&shifted);
+
+        g_custom_op_manager.unregister_custom_op(doubled);
+        MPI_Op_free(&doubled);
+        g_custom_op_manager.unregister_custom_op(op);
+        MPI_Op_free(&op);
+
+        if (world_rank_ == 0) {
+            std::cout << "  register_typed_op kernel and MPI_User_function: "
+                << (passed ? "PASSED" : "FAILED") << std::endl;
+        }
+        return passed;
+    }
+
+    // MAXLOC/MINLOC on a {T value; int index;} pair type against
+    // MPI_Reduce_local, fields only since padding is unspecified. Values
+    // repeat so ties have to pick the lower index.
+    template<typename T>
+    bool check_location_kernel(MPI_Datatype datatype, MPI_Op op, int count) {
+        struct Pair { T value; int index; };
+        std::vector<Pair> a(count), b(count), expected, result(count);
+        for (int i = 0; i < count; ++i) {
+            a[i].value = static_cast<T>((i * 7) % 5);
+            a[i].index = (i * 3) % 11;
+            b[i].value = static_cast<T>((i * 3) % 4);
+            b[i].index = (i * 5) % 13;
+        }
+        expected = b;
+        MPI_Reduce_local(a.data(), expected.data(), count, datatype, op);
+
+        auto same = [&](const std::vector<Pair>& values) {
+            for (int i = 0; i < count; ++i) {
+                if (values[i].value != expected[i].value || values[i].index != expected[i].index) {
+                    return false;
+                }
+            }
+            return true;
+        };
+        ReductionKernel kernel = resolve_reduction_kernel(datatype, op);
+        kernel.combine(result.data(), a.data(), b.data(), count);
+        bool passed = same(result);
+        const void* sources[] = { b.data(), a.data() };
+        std::vector<Pair> many(count);
+        kernel.combine_many(many.data(), sources, 2, count);
+        return passed && same(many);
+    }
+
+    template<typename T>
+    bool check_complex_kernel(MPI_Datatype datatype, MPI_Op op, int count) {
+        // Small integers, so products are exact at every precision
+        std::vector<std::complex<T>> a(count), b(count), expected, result(count), forwarded(count);
+        for (int i = 0; i < count; ++i) {
+            a[i] = std::complex<T>(static_cast<T>(i % 7 - 3), static_cast<T>(i % 5 - 2));
+            b[i] = std::complex<T>(static_cast<T>(i % 3 + 1), static_cast<T>(2 - i % 4));
+        }
+        expected = b;
+        MPI_Reduce_local(a.data(), expected.data(), count, datatype, op);
+
+        ReductionKernel kernel = resolve_reduction_kernel(datatype, op);
+        kernel.combine_forward(result.data(), forwarded.data(), a.data(), b.data(), count);
+        return result == expected && forwarded == expected;
+    }
+
+    bool test_location_and_complex_kernels() {
+        if (world_rank_ == 0) {
+            std::cout << "Testing Location and Complex Kernels..." << std::endl;
+        }
+
+        bool passed = true;
+        SimdLevel detected = detect_simd_level();
+        for (SimdLevel level : { SimdLevel::SCALAR, SimdLevel::SSE42, SimdLevel::AVX2, SimdLevel::AVX512 }) {
+            if (level > detected) {
+                continue;
+            }
+            set_simd_level(level);
+            for (int count : { 3, 37, 1000 }) {
+                for (MPI_Op op : { MPI_MAXLOC, MPI_MINLOC }) {
+                    passed &= check_location_kernel<float>(MPI_FLOAT_INT, op, count);
+                    passed &= check_location_kernel<double>(MPI_DOUBLE_INT, op, count);
+                    passed &= check_location_kernel<long>(MPI_LONG_INT, op, count);
+                    passed &= check_location_kernel<int>(MPI_2INT, op, count);
+                    passed &= check_location_kernel<short>(MPI_SHORT_INT, op, count);
+                    passed &= check_location_kernel<long double>(MPI_LONG_DOUBLE_INT, op, count);
+                }
+                for (MPI_Op op : { MPI_SUM, MPI_PROD }) {
+                    passed &= check_complex_kernel<float>(MPI_C_FLOAT_COMPLEX, op, count);
+                    passed &= check_complex_kernel<double>(MPI_C_DOUBLE_COMPLEX, op, count);
+                }
+            }
+        }
+        set_simd_level(detected);
+
+        // Location ops are only defined on the pair types
+        passed &= is_operation_supported(MPI_DOUBLE_INT, MPI_MAXLOC) &&
+            !is_operation_supported(MPI_DOUBLE, MPI_MAXLOC) &&
+            is_operation_supported(MPI_C_DOUBLE_COMPLEX, MPI_PROD) &&
+            !is_operation_supported(MPI_C_DOUBLE_COMPLEX, MPI_MAX) &&
+            is_simd_supported(MPI_2INT, MPI_MINLOC) == (detected > SimdLevel::SCALAR);
+
+        if (world_rank_ == 0) {
+            std::cout << "  MAXLOC/MINLOC pairs and complex SUM/PROD: "
+                << (passed ? "PASSED" : "FAILED") << std::endl;
+        }
+        return passed;
+    }
+
+    bool test_scratch_pool() {
+        if (world_rank_ == 0) {
+            std::cout << "Testing Scratch Pool..." << std::endl;
+        }
+
+        bool passed = true;
+        ScratchPool& pool = ScratchPool::local();
+        pool.trim();
+
+        // Aligned blocks of the requested size, reused once released
+        char* first = nullptr;
+        {
+            ScratchBuffer buffer = pool.acquire(10000);
+            first = buffer.data();
+            passed &= buffer.size() == 10000 && reinterpret_cast<uintptr_t>(first) % 64 == 0;
+        }
+        passed &= pool.cached_bytes() == 16384;
+        {
+            // Same size class, so the same block
+            ScratchBuffer buffer = pool.acquire(9000);
+            passed &= buffer.data() == first && pool.cached_bytes() == 0;
+
+            // Held blocks are never handed out twice
+            ScratchBuffer other = pool.acquire(9000);
+            passed &= other.data() != first;
+        }
+
+        // Above 1 MiB classes step by a quarter of the power of two below
+        {
+            ScratchBuffer buffer = pool.acquire((size_t(3) << 20) + 1);
+        }
+        passed &= pool.cached_bytes() == 2 * 16384 + (size_t(7) << 19);
+
+        std::vector<int> source(1000);
+        for (size_t i = 0; i < source.size(); ++i) {
+            source[i] = static_cast<int>(i * 7);
+        }
+        {
+            ScratchBuffer copy = pool.acquire_copy(source.data(), source.size() * sizeof(int));
+            passed &= std::equal(source.begin(), source.end(), reinterpret_cast<const int*>(copy.data()));
+
+            // Moving transfers the lease
+            ScratchBuffer moved = std::move(copy);
+            passed &= copy.data() == nullptr && moved.size() == source.size() * sizeof(int);
+        }
+
+        ScratchBuffer empty = pool.acquire(0);
+        passed &= empty.data() == nullptr && empty.size() == 0;
+
+        pool.trim();
+        passed &= pool.cached_bytes() == 0;
+
+        if (world_rank_ == 0) {
+            std::cout << "  Size classes, reuse and alignment: "
+                << (passed ? "PASSED" : "FAILED") << std::endl;
+        }
+        return passed;
+    }
 };
 
 // Test runner with MPI-aware reporting
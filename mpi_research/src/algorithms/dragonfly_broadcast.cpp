@@ -0,0 +1,162 @@
+#include "dragonfly_broadcast.h"
+#include "../core/dragonfly_layout.h"
+#include <algorithm>
+#include <map>
+
+namespace TopologyAwareResearch {
+
+    DragonflyBroadcast::DragonflyBroadcast(const NetworkCharacteristics& config)
+        : network_config_(config), segment_bytes_(65536) {
+    }
+
+    DragonflyBroadcast::~DragonflyBroadcast() {}
+
+    PerformanceMetrics DragonflyBroadcast::broadcast(void* buffer, int count,
+        MPI_Datatype datatype, int root,
+        MPI_Comm comm) {
+        PerformanceMetrics metrics;
+
+        int world_size;
+        MPI_Comm_size(comm, &world_size);
+
+        if (world_size == 1 || count == 0) {
+            metrics.execution_time = 0.0;
+            return metrics;
+        }
+
+        std::vector<int> group_mapping, router_mapping;
+        resolve_layout(world_size, group_mapping, router_mapping);
+
+        bool has_parent = false;
+        TreeLink parent = { MPI_COMM_NULL, MPI_PROC_NULL, MPI_PROC_NULL };
+        std::vector<TreeLink> children;
+        build_tree(group_mapping, router_mapping, comm, root, has_parent, parent, children);
+
+        return pipelined_tree_broadcast(buffer, count, datatype, comm,
+            has_parent, parent, children, segment_bytes_);
+    }
+
+    void DragonflyBroadcast::resolve_layout(int world_size, std::vector<int>& group_mapping,
+        std::vector<int>& router_mapping) const {
+        if (static_cast<int>(network_config_.group_mapping.size()) == world_size &&
+            static_cast<int>(network_config_.router_mapping.size()) == world_size) {
+            group_mapping = network_config_.group_mapping;
+            router_mapping = network_config_.router_mapping;
+            return;
+        }
+
+        // No detected layout: one router per node, or per nodes_per_router ranks
+        std::vector<int> routers(world_size);
+        int ranks_per_router = std::max(1, network_config_.topology_params.dragonfly.nodes_per_router);
+        for (int i = 0; i < world_size; ++i) {
+            routers[i] = (static_cast<int>(network_config_.node_mapping.size()) == world_size) ?
+                network_config_.node_mapping[i] : i / ranks_per_router;
+        }
+
+        DragonflyLayout layout = DragonflyLayoutDetector::infer(routers,
+            network_config_.topology_params.dragonfly.routers_per_group);
+        group_mapping = layout.group_mapping;
+        router_mapping = layout.router_mapping;
+    }
+
+    void DragonflyBroadcast::build_tree(const std::vector<int>& group_mapping,
+        const std::vector<int>& router_mapping, MPI_Comm comm, int root,
+        bool& has_parent, TreeLink& parent, std::vector<TreeLink>& children) const {
+        int world_rank, world_size;
+        MPI_Comm_rank(comm, &world_rank);
+        MPI_Comm_size(comm, &world_size);
+
+        // Processes per router (leader first) and routers per group, both in rank order
+        std::map<int, std::vector<int>> router_members;
+        std::map<int, std::vector<int>> group_routers;
+        for (int i = 0; i < world_size; ++i) {
+            std::vector<int>& members = router_members[router_mapping[i]];
+            if (members.empty()) {
+                group_routers[group_mapping[i]].push_back(router_mapping[i]);
+            }
+            members.push_back(i);
+        }
+        std::vector<int>& root_router_members = router_members[router_mapping[root]];
+        std::rotate(root_router_members.begin(),
+            std::find(root_router_members.begin(), root_router_members.end(), root),
+            std::find(root_router_members.begin(), root_router_members.end(), root) + 1);
+
+        // Every process walks the same construction and keeps its own edges;
+        // edges are added in priority order (global links before local fan-out)
+        has_parent = false;
+        children.clear();
+        auto add_edge = [&](int from, int to) {
+            if (from == world_rank) {
+                children.push_back({ comm, to, to });
+            }
+            if (to == world_rank) {
+                has_parent = true;
+                parent = { comm, from, from };
+            }
+        };
+
+        // Root group: root feeds the leader of each of its routers
+        int root_group = group_mapping[root];
+        std::vector<int> root_group_leaders;
+        for (int router : group_routers[root_group]) {
+            int leader = router_members[router].front();
+            if (leader == root) {
+                root_group_leaders.insert(root_group_leaders.begin(), leader);
+            }
+            else {
+                root_group_leaders.push_back(leader);
+            }
+        }
+        for (size_t i = 1; i < root_group_leaders.size(); ++i) {
+            add_edge(root, root_group_leaders[i]);
+        }
+
+        // Global links: remote groups are dealt round-robin to the root group's
+        // routers, each landing on a different router of the remote group
+        std::vector<int> remote_groups;
+        for (const auto& item : group_routers) {
+            if (item.first != root_group) {
+                remote_groups.push_back(item.first);
+            }
+        }
+        std::rotate(remote_groups.begin(),
+            std::lower_bound(remote_groups.begin(), remote_groups.end(), root_group),
+            remote_groups.end());
+
+        int driver_count = static_cast<int>(root_group_leaders.size());
+        std::vector<int> entry_router(remote_groups.size());
+        for (size_t i = 0; i < remote_groups.size(); ++i) {
+            const std::vector<int>& routers = group_routers[remote_groups[i]];
+            int driver = static_cast<int>(i) % driver_count;
+            entry_router[i] = routers[driver % routers.size()];
+            add_edge(root_group_leaders[driver], router_members[entry_router[i]].front());
+        }
+
+        // Remote groups: the entry leader fans out over the local links
+        for (size_t i = 0; i < remote_groups.size(); ++i) {
+            int entry_leader = router_members[entry_router[i]].front();
+            for (int router : group_routers[remote_groups[i]]) {
+                if (router != entry_router[i]) {
+                    add_edge(entry_leader, router_members[router].front());
+                }
+            }
+        }
+
+        // Within a router: binomial tree rooted at the leader
+        const std::vector<int>& members = router_members[router_mapping[world_rank]];
+        int size = static_cast<int>(members.size());
+        int index = static_cast<int>(std::find(members.begin(), members.end(), world_rank) - members.begin());
+        if (index > 0) {
+            add_edge(members[index & (index - 1)], world_rank);
+        }
+        int lowest_bit = (index == 0) ? 1 : (index & -index);
+        int span = 1;
+        while (span < size) span <<= 1;
+        for (int mask = (index == 0) ? span >> 1 : lowest_bit >> 1; mask > 0; mask >>= 1) {
+            if (index + mask < size) {
+                add_edge(world_rank, members[index + mask]);
+            }
+        }
+    }
+
+} // namespace TopologyAwareResearch
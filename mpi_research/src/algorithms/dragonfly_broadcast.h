@@ -0,0 +1,53 @@
+#ifndef DRAGONFLY_BROADCAST_H
+#define DRAGONFLY_BROADCAST_H
+
+#include <mpi.h>
+#include <vector>
+#include "../core/collective_optimizer.h"
+#include "pipelined_tree.h"
+
+namespace TopologyAwareResearch {
+
+    // Pipelined broadcast for dragonfly networks.
+    //
+    // The root hands each segment to the leader of every router in its
+    // group over the all-to-all local links. Every one of those leaders then
+    // drives its own share of the remote groups over its global links, so
+    // the global fan-out runs from all routers of the root group in parallel
+    // instead of through a single router. A remote group's entry leader
+    // forwards each segment to the other routers of its group as soon as it
+    // lands, and router leaders finish with a binomial tree over the
+    // processes attached to their router.
+    //
+    // Group and router placement come from NetworkCharacteristics
+    // (group_mapping/router_mapping, see DragonflyLayoutDetector); without
+    // them routers are taken from the node mapping and grouped by the
+    // dragonfly parameters.
+    class DragonflyBroadcast {
+    private:
+        NetworkCharacteristics network_config_;
+        int segment_bytes_;
+
+    public:
+        DragonflyBroadcast(const NetworkCharacteristics& config);
+        ~DragonflyBroadcast();
+
+        PerformanceMetrics broadcast(void* buffer, int count,
+            MPI_Datatype datatype, int root,
+            MPI_Comm comm);
+
+        void set_segment_size(int bytes) { segment_bytes_ = bytes; }
+        int get_segment_size() const { return segment_bytes_; }
+
+    private:
+        void resolve_layout(int world_size, std::vector<int>& group_mapping,
+            std::vector<int>& router_mapping) const;
+
+        void build_tree(const std::vector<int>& group_mapping, const std::vector<int>& router_mapping,
+            MPI_Comm comm, int root,
+            bool& has_parent, TreeLink& parent, std::vector<TreeLink>& children) const;
+    };
+
+} // namespace TopologyAwareResearch
+
+#endif // DRAGONFLY_BROADCAST_H
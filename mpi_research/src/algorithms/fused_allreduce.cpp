@@ -0,0 +1,187 @@
+#include "fused_allreduce.h"
+#include "../core/reduction_ops.h"
+#include "../core/reduction_simd.h"
+#include "../core/scratch_pool.h"
+#include <algorithm>
+#include <vector>
+
+namespace TopologyAwareResearch {
+
+    namespace {
+        const int kFusedAllreduceTag = 18;
+
+        // Copy for single-rank communicators, where no step would write recvbuf
+        void copy_input(const char* input, char* output, int count, MPI_Aint extent) {
+            bulk_copy(output, input, static_cast<size_t>(count) * extent);
+        }
+    }
+
+    PerformanceMetrics fused_ring_allreduce(const void* sendbuf, void* recvbuf, int count,
+        MPI_Datatype datatype, MPI_Op op, MPI_Comm comm) {
+        return fused_ring_allreduce_with_kernel(sendbuf, recvbuf, count,
+            resolve_reduction_kernel(datatype, op), comm);
+    }
+
+    PerformanceMetrics fused_ring_allreduce_with_kernel(const void* sendbuf, void* recvbuf, int count,
+        const ReductionKernel& kernel, MPI_Comm comm) {
+        PerformanceMetrics metrics;
+        auto start_time = MPI_Wtime();
+
+        int world_size, world_rank;
+        MPI_Comm_size(comm, &world_size);
+        MPI_Comm_rank(comm, &world_rank);
+
+        MPI_Datatype datatype = kernel.datatype;
+        MPI_Aint extent = kernel.extent;
+        const char* input = static_cast<const char*>(sendbuf == MPI_IN_PLACE ? recvbuf : sendbuf);
+        char* output = static_cast<char*>(recvbuf);
+
+        if (world_size == 1 || count == 0) {
+            copy_input(input, output, count, extent);
+            return metrics;
+        }
+
+        // Blocks are 1/P of the buffer; stream by the buffer's size
+        ReductionKernel reduce_kernel = kernel;
+        reduce_kernel.stream_for_total(static_cast<size_t>(count) * extent);
+
+        // Block b covers elements [offsets[b], offsets[b+1]); the first
+        // count % P blocks hold one extra element
+        std::vector<int> offsets(world_size + 1, 0);
+        for (int b = 0; b < world_size; ++b) {
+            offsets[b + 1] = offsets[b] + count / world_size + (b < count % world_size ? 1 : 0);
+        }
+        auto block_count = [&](int b) { return offsets[b + 1] - offsets[b]; };
+        auto block_at = [&](const char* base, int b) {
+            return const_cast<char*>(base) + static_cast<MPI_Aint>(offsets[b]) * extent;
+        };
+
+        int right = (world_rank + 1) % world_size;
+        int left = (world_rank - 1 + world_size) % world_size;
+        ScratchBuffer incoming = ScratchPool::local().acquire(static_cast<size_t>(block_count(0)) * extent);
+
+        // Reduce-scatter: step s forwards the partial of block rank-s (the
+        // raw input in step 0) and folds the local input into block rank-s-1.
+        // Afterwards block rank+1 is complete in recvbuf.
+        for (int step = 0; step < world_size - 1; ++step) {
+            int send_block = (world_rank - step + world_size) % world_size;
+            int recv_block = (world_rank - step - 1 + world_size) % world_size;
+            const char* send_ptr = block_at(step == 0 ? input : output, send_block);
+
+            MPI_Sendrecv(send_ptr, block_count(send_block), datatype, right, kFusedAllreduceTag,
+                incoming.data(), block_count(recv_block), datatype, left, kFusedAllreduceTag,
+                comm, MPI_STATUS_IGNORE);
+            reduce_kernel.combine(block_at(output, recv_block), incoming.data(),
+                block_at(input, recv_block), block_count(recv_block));
+        }
+
+        // Allgather: pass the completed blocks around, receiving in place
+        for (int step = 0; step < world_size - 1; ++step) {
+            int send_block = (world_rank + 1 - step + world_size) % world_size;
+            int recv_block = (world_rank - step + world_size) % world_size;
+            MPI_Sendrecv(block_at(output, send_block), block_count(send_block), datatype, right, kFusedAllreduceTag,
+                block_at(output, recv_block), block_count(recv_block), datatype, left, kFusedAllreduceTag,
+                comm, MPI_STATUS_IGNORE);
+        }
+
+        metrics.communication_edges.emplace_back(world_rank, right);
+        metrics.communication_edges.emplace_back(left, world_rank);
+        metrics.messages_sent = 2 * (world_size - 1);
+        metrics.bytes_transferred = 2 * (count - block_count((world_rank + 1) % world_size)) * extent;
+
+        auto end_time = MPI_Wtime();
+        metrics.execution_time = end_time - start_time;
+        metrics.communication_time = metrics.execution_time;
+        return metrics;
+    }
+
+    PerformanceMetrics fused_recursive_doubling_allreduce(const void* sendbuf, void* recvbuf, int count,
+        MPI_Datatype datatype, MPI_Op op, MPI_Comm comm) {
+        return fused_recursive_doubling_allreduce_with_kernel(sendbuf, recvbuf, count,
+            resolve_reduction_kernel(datatype, op), comm);
+    }
+
+    PerformanceMetrics fused_recursive_doubling_allreduce_with_kernel(const void* sendbuf, void* recvbuf, int count,
+        const ReductionKernel& reduce_kernel, MPI_Comm comm) {
+        PerformanceMetrics metrics;
+        auto start_time = MPI_Wtime();
+
+        int world_size, world_rank;
+        MPI_Comm_size(comm, &world_size);
+        MPI_Comm_rank(comm, &world_rank);
+
+        MPI_Datatype datatype = reduce_kernel.datatype;
+        MPI_Aint extent = reduce_kernel.extent;
+        const char* input = static_cast<const char*>(sendbuf == MPI_IN_PLACE ? recvbuf : sendbuf);
+        char* output = static_cast<char*>(recvbuf);
+
+        if (world_size == 1 || count == 0) {
+            copy_input(input, output, count, extent);
+            return metrics;
+        }
+
+        ScratchBuffer incoming = ScratchPool::local().acquire(static_cast<size_t>(count) * extent);
+
+        int pof2 = 1;
+        while (pof2 * 2 <= world_size) {
+            pof2 *= 2;
+        }
+        int extra = world_size - pof2;
+        auto real_rank = [extra](int v) { return v < extra ? 2 * v + 1 : v + extra; };
+
+        // Until the first combine recvbuf holds nothing and sends read the input
+        const char* current = input;
+        int messages = 0;
+        int virtual_rank = world_rank - extra;
+        if (world_rank < 2 * extra) {
+            if (world_rank % 2 == 0) {
+                MPI_Send(input, count, datatype, world_rank + 1, kFusedAllreduceTag, comm);
+                metrics.communication_edges.emplace_back(world_rank, world_rank + 1);
+                ++messages;
+                virtual_rank = -1;
+            }
+            else {
+                MPI_Recv(incoming.data(), count, datatype, world_rank - 1, kFusedAllreduceTag,
+                    comm, MPI_STATUS_IGNORE);
+                reduce_kernel.combine(output, incoming.data(), input, count);
+                current = output;
+                virtual_rank = world_rank / 2;
+            }
+        }
+
+        if (virtual_rank >= 0) {
+            for (int mask = 1; mask < pof2; mask <<= 1) {
+                int partner = real_rank(virtual_rank ^ mask);
+                MPI_Sendrecv(current, count, datatype, partner, kFusedAllreduceTag,
+                    incoming.data(), count, datatype, partner, kFusedAllreduceTag,
+                    comm, MPI_STATUS_IGNORE);
+                if (partner < world_rank) {
+                    reduce_kernel.combine(output, incoming.data(), current, count);
+                }
+                else {
+                    reduce_kernel.combine(output, current, incoming.data(), count);
+                }
+                current = output;
+                metrics.communication_edges.emplace_back(world_rank, partner);
+                ++messages;
+            }
+
+            // Hand the folded-in neighbour the result
+            if (world_rank < 2 * extra) {
+                MPI_Send(output, count, datatype, world_rank - 1, kFusedAllreduceTag, comm);
+                ++messages;
+            }
+        }
+        else {
+            MPI_Recv(output, count, datatype, world_rank + 1, kFusedAllreduceTag, comm, MPI_STATUS_IGNORE);
+        }
+
+        auto end_time = MPI_Wtime();
+        metrics.execution_time = end_time - start_time;
+        metrics.communication_time = metrics.execution_time;
+        metrics.messages_sent = messages;
+        metrics.bytes_transferred = messages * count * extent;
+        return metrics;
+    }
+
+} // namespace TopologyAwareResearch
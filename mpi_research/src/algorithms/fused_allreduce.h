@@ -0,0 +1,39 @@
+#ifndef FUSED_ALLREDUCE_H
+#define FUSED_ALLREDUCE_H
+
+#include <mpi.h>
+#include "../core/collective_optimizer.h"
+#include "../core/reduction_ops.h"
+
+namespace TopologyAwareResearch {
+
+    // Allreduce building blocks that never copy sendbuf into recvbuf up
+    // front: every step combines three-operand (recvbuf block = incoming op
+    // input block), so the first step reads the input where it lies.
+    // MPI_Allreduce semantics, MPI_IN_PLACE included; the datatype must be
+    // contiguous and, for the ring, the operation commutative.
+
+    // Bandwidth-optimal ring: reduce-scatter of one block per rank, then an
+    // allgather of the reduced blocks straight into recvbuf
+    PerformanceMetrics fused_ring_allreduce(const void* sendbuf, void* recvbuf, int count,
+        MPI_Datatype datatype, MPI_Op op, MPI_Comm comm);
+
+    // Latency-optimal recursive doubling on whole vectors. Ranks beyond the
+    // largest power of two fold into a neighbour first. The lower-ranked
+    // partial is always the left operand, so both partners compute bitwise
+    // identical results.
+    PerformanceMetrics fused_recursive_doubling_allreduce(const void* sendbuf, void* recvbuf, int count,
+        MPI_Datatype datatype, MPI_Op op, MPI_Comm comm);
+
+    // The above with an already resolved kernel, for callers that reduce the
+    // same (datatype, op) repeatedly or build the kernel themselves (see
+    // typed_collectives.h). kernel.datatype and kernel.extent describe the
+    // elements sent.
+    PerformanceMetrics fused_ring_allreduce_with_kernel(const void* sendbuf, void* recvbuf, int count,
+        const ReductionKernel& kernel, MPI_Comm comm);
+    PerformanceMetrics fused_recursive_doubling_allreduce_with_kernel(const void* sendbuf, void* recvbuf, int count,
+        const ReductionKernel& kernel, MPI_Comm comm);
+
+} // namespace TopologyAwareResearch
+
+#endif // FUSED_ALLREDUCE_H
@@ -0,0 +1,382 @@
+#include "ordered_reduction.h"
+#include "../core/reduction_ops.h"
+#include "../core/scratch_pool.h"
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+namespace TopologyAwareResearch {
+
+    namespace {
+        const int kOrderedTag = 17;
+
+        // Below this the tree's log2(P) latency wins
+        const long long kShortOrderedBytes = 65536;
+
+        const int kDefaultOrderedSegmentBytes = 65536;
+    }
+
+    OrderedReduction::OrderedReduction(const NetworkCharacteristics& config)
+        : network_config_(config), segment_size_(kDefaultOrderedSegmentBytes) {
+    }
+
+    OrderedReduction::~OrderedReduction() {}
+
+    PerformanceMetrics OrderedReduction::reduce(const void* sendbuf, void* recvbuf,
+        int count, MPI_Datatype datatype,
+        MPI_Op op, int root, MPI_Comm comm) {
+        int world_size, type_size;
+        MPI_Comm_size(comm, &world_size);
+        MPI_Type_size(datatype, &type_size);
+
+        AlgorithmType algo = select_algorithm(static_cast<long long>(count) * type_size, count, world_size);
+        return execute(algo, sendbuf, recvbuf, count, datatype, op, root, comm);
+    }
+
+    PerformanceMetrics OrderedReduction::allreduce(const void* sendbuf, void* recvbuf,
+        int count, MPI_Datatype datatype,
+        MPI_Op op, MPI_Comm comm) {
+        int world_size, type_size;
+        MPI_Comm_size(comm, &world_size);
+        MPI_Type_size(datatype, &type_size);
+
+        AlgorithmType algo = select_algorithm(static_cast<long long>(count) * type_size, count, world_size);
+        return execute(algo, sendbuf, recvbuf, count, datatype, op, comm);
+    }
+
+    PerformanceMetrics OrderedReduction::execute(AlgorithmType algo, const void* sendbuf, void* recvbuf,
+        int count, MPI_Datatype datatype,
+        MPI_Op op, int root, MPI_Comm comm) {
+        switch (algo) {
+        case AlgorithmType::ORDERED_TREE_REDUCE:
+            return ordered_tree_reduce(sendbuf, recvbuf, count, datatype, op, root, comm);
+        case AlgorithmType::ORDERED_RECURSIVE_HALVING_REDUCE:
+            return ordered_recursive_halving_reduce(sendbuf, recvbuf, count, datatype, op, root, comm);
+        default: {
+            PerformanceMetrics metrics;
+            auto start_time = MPI_Wtime();
+            MPI_Reduce(sendbuf, recvbuf, count, datatype, op, root, comm);
+            metrics.execution_time = MPI_Wtime() - start_time;
+            return metrics;
+        }
+        }
+    }
+
+    PerformanceMetrics OrderedReduction::execute(AlgorithmType algo, const void* sendbuf, void* recvbuf,
+        int count, MPI_Datatype datatype,
+        MPI_Op op, MPI_Comm comm) {
+        switch (algo) {
+        case AlgorithmType::ORDERED_TREE_REDUCE:
+            return ordered_tree_allreduce(sendbuf, recvbuf, count, datatype, op, comm);
+        case AlgorithmType::ORDERED_RECURSIVE_HALVING_REDUCE:
+            return ordered_recursive_halving_allreduce(sendbuf, recvbuf, count, datatype, op, comm);
+        default: {
+            PerformanceMetrics metrics;
+            auto start_time = MPI_Wtime();
+            MPI_Allreduce(sendbuf, recvbuf, count, datatype, op, comm);
+            metrics.execution_time = MPI_Wtime() - start_time;
+            return metrics;
+        }
+        }
+    }
+
+    AlgorithmType OrderedReduction::select_algorithm(long long message_bytes, int count, int world_size) const {
+        if (message_bytes < kShortOrderedBytes || count < world_size || world_size <= 2) {
+            return AlgorithmType::ORDERED_TREE_REDUCE;
+        }
+        return AlgorithmType::ORDERED_RECURSIVE_HALVING_REDUCE;
+    }
+
+    void OrderedReduction::ordered_binomial(const std::vector<int>& members, int position,
+        bool& has_parent, int& parent, std::vector<int>& children) {
+        // Binomial tree on the mirrored positions m = n-1-position: m covers
+        // [m, m + lowbit(m)), i.e. itself and the members just below it
+        int n = static_cast<int>(members.size());
+        int mirrored = n - 1 - position;
+        has_parent = false;
+        children.clear();
+        for (int mask = 1; mask < n; mask <<= 1) {
+            if (mirrored & mask) {
+                has_parent = true;
+                parent = members[n - 1 - (mirrored - mask)];
+                return;
+            }
+            if (mirrored + mask < n) {
+                children.push_back(members[n - 1 - (mirrored + mask)]);
+            }
+        }
+    }
+
+    PerformanceMetrics OrderedReduction::tree_reduce_to_last(const void* sendbuf, void* recvbuf,
+        int count, MPI_Datatype datatype, MPI_Op op, MPI_Comm comm,
+        bool& has_parent, TreeLink& parent, std::vector<TreeLink>& children) const {
+        int world_size, world_rank;
+        MPI_Comm_size(comm, &world_size);
+        MPI_Comm_rank(comm, &world_rank);
+
+        // Ranges of consecutive ranks: one per node, or a single one
+        std::vector<int> starts = { 0 };
+        if (has_contiguous_nodes(network_config_.node_mapping, world_size)) {
+            const std::vector<int>& node_mapping = network_config_.node_mapping;
+            for (int i = 1; i < world_size; ++i) {
+                if (node_mapping[i] != node_mapping[i - 1]) {
+                    starts.push_back(i);
+                }
+            }
+        }
+        starts.push_back(world_size);
+        int range = static_cast<int>(std::upper_bound(starts.begin(), starts.end(), world_rank) - starts.begin()) - 1;
+
+        std::vector<int> members(starts[range + 1] - starts[range]);
+        std::iota(members.begin(), members.end(), starts[range]);
+        int parent_rank = 0;
+        std::vector<int> child_ranks;
+        ordered_binomial(members, world_rank - starts[range], has_parent, parent_rank, child_ranks);
+
+        // The last rank of each range joins the tree across ranges; those
+        // children cover lower ranges, so they come after the local ones
+        if (!has_parent && starts.size() > 2) {
+            std::vector<int> lasts;
+            for (size_t r = 1; r < starts.size(); ++r) {
+                lasts.push_back(starts[r] - 1);
+            }
+            std::vector<int> remote_children;
+            ordered_binomial(lasts, range, has_parent, parent_rank, remote_children);
+            child_ranks.insert(child_ranks.end(), remote_children.begin(), remote_children.end());
+        }
+
+        parent = { comm, parent_rank, parent_rank };
+        children.clear();
+        for (int child : child_ranks) {
+            children.push_back({ comm, child, child });
+        }
+
+        // Children are folded in on the left, nearest range first
+        return pipelined_tree_reduce(sendbuf, recvbuf, count, datatype, op, comm,
+            has_parent, parent, children, segment_size_);
+    }
+
+    PerformanceMetrics OrderedReduction::ordered_tree_reduce(const void* sendbuf, void* recvbuf,
+        int count, MPI_Datatype datatype,
+        MPI_Op op, int root, MPI_Comm comm) {
+        auto start_time = MPI_Wtime();
+
+        int world_size, world_rank;
+        MPI_Comm_size(comm, &world_size);
+        MPI_Comm_rank(comm, &world_rank);
+        int last = world_size - 1;
+
+        MPI_Aint lower_bound, extent;
+        MPI_Type_get_extent(datatype, &lower_bound, &extent);
+
+        // recvbuf is only usable on the root
+        ScratchBuffer result;
+        void* tree_output = recvbuf;
+        if (world_rank == last && root != last) {
+            result = ScratchPool::local().acquire(static_cast<size_t>(count) * extent);
+            tree_output = result.data();
+        }
+
+        bool has_parent;
+        TreeLink parent;
+        std::vector<TreeLink> children;
+        PerformanceMetrics metrics = tree_reduce_to_last(sendbuf, tree_output, count, datatype, op, comm,
+            has_parent, parent, children);
+
+        if (root != last) {
+            if (world_rank == last) {
+                MPI_Send(result.data(), count, datatype, root, kOrderedTag, comm);
+                metrics.messages_sent += 1;
+                metrics.communication_edges.emplace_back(world_rank, root);
+            }
+            else if (world_rank == root) {
+                MPI_Recv(recvbuf, count, datatype, last, kOrderedTag, comm, MPI_STATUS_IGNORE);
+            }
+        }
+
+        auto end_time = MPI_Wtime();
+        metrics.execution_time = end_time - start_time;
+        metrics.communication_time = metrics.execution_time;
+
+        return metrics;
+    }
+
+    PerformanceMetrics OrderedReduction::ordered_tree_allreduce(const void* sendbuf, void* recvbuf,
+        int count, MPI_Datatype datatype,
+        MPI_Op op, MPI_Comm comm) {
+        auto start_time = MPI_Wtime();
+
+        bool has_parent;
+        TreeLink parent;
+        std::vector<TreeLink> children;
+        PerformanceMetrics metrics = tree_reduce_to_last(sendbuf, recvbuf, count, datatype, op, comm,
+            has_parent, parent, children);
+
+        PerformanceMetrics broadcast = pipelined_tree_broadcast(recvbuf, count, datatype, comm,
+            has_parent, parent, children, segment_size_);
+
+        auto end_time = MPI_Wtime();
+        metrics.execution_time = end_time - start_time;
+        metrics.communication_time = metrics.execution_time;
+        metrics.messages_sent += broadcast.messages_sent;
+        metrics.bytes_transferred += broadcast.bytes_transferred;
+        metrics.communication_edges.insert(metrics.communication_edges.end(),
+            broadcast.communication_edges.begin(), broadcast.communication_edges.end());
+
+        return metrics;
+    }
+
+    int OrderedReduction::ordered_halving(char* work, int count, MPI_Datatype datatype, MPI_Op op,
+        MPI_Comm comm, std::vector<int>& counts, std::vector<int>& displacements) {
+        int world_size, world_rank;
+        MPI_Comm_size(comm, &world_size);
+        MPI_Comm_rank(comm, &world_rank);
+
+        MPI_Aint lower_bound, extent;
+        MPI_Type_get_extent(datatype, &lower_bound, &extent);
+        ReductionKernel reduce_kernel = resolve_reduction_kernel(datatype, op);
+        reduce_kernel.stream_for_total(static_cast<size_t>(count) * extent);
+        ScratchBuffer incoming = ScratchPool::local().acquire(static_cast<size_t>(count) * extent);
+
+        int pof2 = 1;
+        while (pof2 * 2 <= world_size) {
+            pof2 *= 2;
+        }
+        int extra = world_size - pof2;
+        // Virtual ranks stay in rank order: the first `extra` stand for the
+        // pairs (2v, 2v+1) folded together, the rest for one rank each
+        auto real_rank = [&](int v) { return (v < extra) ? 2 * v + 1 : v + extra; };
+
+        int messages = 0;
+        int virtual_rank = world_rank - extra;
+        if (world_rank < 2 * extra) {
+            if (world_rank % 2 == 0) {
+                MPI_Send(work, count, datatype, world_rank + 1, kOrderedTag, comm);
+                ++messages;
+                virtual_rank = -1;
+            }
+            else {
+                MPI_Recv(incoming.data(), count, datatype, world_rank - 1, kOrderedTag, comm, MPI_STATUS_IGNORE);
+                reduce_kernel(work, incoming.data(), 0, count);
+                virtual_rank = world_rank / 2;
+            }
+        }
+
+        // Distance doubles each step, so the partner's partial always
+        // covers the block of ranks adjacent to ours
+        if (virtual_rank >= 0) {
+            int lo = 0, hi = count;
+            for (int mask = 1; mask < pof2; mask <<= 1) {
+                int partner = real_rank(virtual_rank ^ mask);
+                int mid = lo + (hi - lo) / 2;
+                bool upper = (virtual_rank & mask) != 0;
+                int keep_lo = upper ? mid : lo, keep_hi = upper ? hi : mid;
+                int send_lo = upper ? lo : mid, send_hi = upper ? mid : hi;
+                int keep = keep_hi - keep_lo;
+
+                char* kept = work + static_cast<MPI_Aint>(keep_lo) * extent;
+                char* received = incoming.data() + static_cast<MPI_Aint>(keep_lo) * extent;
+                MPI_Sendrecv(work + static_cast<MPI_Aint>(send_lo) * extent, send_hi - send_lo, datatype,
+                    partner, kOrderedTag, received, keep, datatype, partner, kOrderedTag,
+                    comm, MPI_STATUS_IGNORE);
+                ++messages;
+
+                if (upper) {
+                    // Partner covers the lower ranks: kept = received op kept
+                    reduce_kernel(work, received, keep_lo, keep);
+                }
+                else {
+                    // kept = kept op received
+                    reduce_kernel.combine(kept, kept, received, keep);
+                }
+                lo = keep_lo;
+                hi = keep_hi;
+            }
+        }
+
+        counts.assign(world_size, 0);
+        displacements.assign(world_size, 0);
+        for (int v = 0; v < pof2; ++v) {
+            int lo = 0, hi = count;
+            for (int mask = 1; mask < pof2; mask <<= 1) {
+                int mid = lo + (hi - lo) / 2;
+                if (v & mask) {
+                    lo = mid;
+                }
+                else {
+                    hi = mid;
+                }
+            }
+            counts[real_rank(v)] = hi - lo;
+            displacements[real_rank(v)] = lo;
+        }
+
+        return messages;
+    }
+
+    PerformanceMetrics OrderedReduction::ordered_recursive_halving_reduce(const void* sendbuf, void* recvbuf,
+        int count, MPI_Datatype datatype,
+        MPI_Op op, int root, MPI_Comm comm) {
+        PerformanceMetrics metrics;
+        auto start_time = MPI_Wtime();
+
+        int world_rank;
+        MPI_Comm_rank(comm, &world_rank);
+
+        MPI_Aint lower_bound, extent;
+        MPI_Type_get_extent(datatype, &lower_bound, &extent);
+
+        const char* input = static_cast<const char*>(sendbuf == MPI_IN_PLACE ? recvbuf : sendbuf);
+        ScratchBuffer work = ScratchPool::local().acquire_copy(input, static_cast<size_t>(count) * extent);
+        std::vector<int> counts, displacements;
+        int messages = ordered_halving(work.data(), count, datatype, op, comm, counts, displacements);
+
+        MPI_Gatherv(work.data() + static_cast<MPI_Aint>(displacements[world_rank]) * extent, counts[world_rank],
+            datatype, recvbuf, counts.data(), displacements.data(), datatype, root, comm);
+
+        int type_size;
+        MPI_Type_size(datatype, &type_size);
+
+        auto end_time = MPI_Wtime();
+        metrics.execution_time = end_time - start_time;
+        metrics.communication_time = metrics.execution_time;
+        metrics.messages_sent = messages + (world_rank != root ? 1 : 0);
+        metrics.bytes_transferred = static_cast<long long>(counts[world_rank]) * type_size;
+
+        return metrics;
+    }
+
+    PerformanceMetrics OrderedReduction::ordered_recursive_halving_allreduce(const void* sendbuf, void* recvbuf,
+        int count, MPI_Datatype datatype,
+        MPI_Op op, MPI_Comm comm) {
+        PerformanceMetrics metrics;
+        auto start_time = MPI_Wtime();
+
+        int world_size, world_rank;
+        MPI_Comm_size(comm, &world_size);
+        MPI_Comm_rank(comm, &world_rank);
+
+        MPI_Aint lower_bound, extent;
+        MPI_Type_get_extent(datatype, &lower_bound, &extent);
+
+        const char* input = static_cast<const char*>(sendbuf == MPI_IN_PLACE ? recvbuf : sendbuf);
+        ScratchBuffer work = ScratchPool::local().acquire_copy(input, static_cast<size_t>(count) * extent);
+        std::vector<int> counts, displacements;
+        int messages = ordered_halving(work.data(), count, datatype, op, comm, counts, displacements);
+
+        MPI_Allgatherv(work.data() + static_cast<MPI_Aint>(displacements[world_rank]) * extent, counts[world_rank],
+            datatype, recvbuf, counts.data(), displacements.data(), datatype, comm);
+
+        int type_size;
+        MPI_Type_size(datatype, &type_size);
+
+        auto end_time = MPI_Wtime();
+        metrics.execution_time = end_time - start_time;
+        metrics.communication_time = metrics.execution_time;
+        metrics.messages_sent = messages + world_size - 1;
+        metrics.bytes_transferred = static_cast<long long>(counts[world_rank]) * type_size * (world_size - 1);
+
+        return metrics;
+    }
+
+} // namespace TopologyAwareResearch
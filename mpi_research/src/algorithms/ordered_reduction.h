@@ -0,0 +1,94 @@
+#ifndef ORDERED_REDUCTION_H
+#define ORDERED_REDUCTION_H
+
+#include <mpi.h>
+#include <vector>
+#include "../core/collective_optimizer.h"
+#include "../core/communicator_cache.h"
+#include "pipelined_tree.h"
+
+namespace TopologyAwareResearch {
+
+    // Reduce and allreduce for non-commutative operations: partial results
+    // always cover a contiguous range of ranks and are combined lower range
+    // on the left, so the result equals x0 op x1 op ... op x(P-1). Semantics
+    // follow MPI_Reduce/MPI_Allreduce, MPI_IN_PLACE included.
+    class OrderedReduction {
+    private:
+        NetworkCharacteristics network_config_;
+        int segment_size_;  // Pipeline segment of the tree variants in bytes
+
+    public:
+        OrderedReduction(const NetworkCharacteristics& config);
+        ~OrderedReduction();
+
+        // Pick an algorithm with select_algorithm() and run it
+        PerformanceMetrics reduce(const void* sendbuf, void* recvbuf,
+            int count, MPI_Datatype datatype,
+            MPI_Op op, int root, MPI_Comm comm);
+
+        PerformanceMetrics allreduce(const void* sendbuf, void* recvbuf,
+            int count, MPI_Datatype datatype,
+            MPI_Op op, MPI_Comm comm);
+
+        PerformanceMetrics execute(AlgorithmType algo, const void* sendbuf, void* recvbuf,
+            int count, MPI_Datatype datatype,
+            MPI_Op op, int root, MPI_Comm comm);
+
+        PerformanceMetrics execute(AlgorithmType algo, const void* sendbuf, void* recvbuf,
+            int count, MPI_Datatype datatype,
+            MPI_Op op, MPI_Comm comm);
+
+        // Pipelined tree towards the last rank whose children always cover
+        // the ranks just below their parent. When nodes hold consecutive
+        // ranks the tree is built per node first and only the last rank of
+        // each node talks to other nodes. The result is then forwarded to
+        // the root.
+        PerformanceMetrics ordered_tree_reduce(const void* sendbuf, void* recvbuf,
+            int count, MPI_Datatype datatype,
+            MPI_Op op, int root, MPI_Comm comm);
+
+        // Ordered tree reduce followed by a pipelined broadcast down the same tree
+        PerformanceMetrics ordered_tree_allreduce(const void* sendbuf, void* recvbuf,
+            int count, MPI_Datatype datatype,
+            MPI_Op op, MPI_Comm comm);
+
+        // Recursive-halving reduce-scatter with the distance doubling each
+        // step, so every partial covers adjacent ranks, then a gather of the
+        // pieces at the root
+        PerformanceMetrics ordered_recursive_halving_reduce(const void* sendbuf, void* recvbuf,
+            int count, MPI_Datatype datatype,
+            MPI_Op op, int root, MPI_Comm comm);
+
+        // The same reduce-scatter followed by an allgather of the pieces
+        PerformanceMetrics ordered_recursive_halving_allreduce(const void* sendbuf, void* recvbuf,
+            int count, MPI_Datatype datatype,
+            MPI_Op op, MPI_Comm comm);
+
+        void set_segment_size(int bytes) { segment_size_ = bytes; }
+        int get_segment_size() const { return segment_size_; }
+
+        // Tree for short messages, recursive halving for large ones
+        AlgorithmType select_algorithm(long long message_bytes, int count, int world_size) const;
+
+    private:
+        // Reduce up the ordered tree; the result lands in recvbuf on the last rank
+        PerformanceMetrics tree_reduce_to_last(const void* sendbuf, void* recvbuf,
+            int count, MPI_Datatype datatype, MPI_Op op, MPI_Comm comm,
+            bool& has_parent, TreeLink& parent, std::vector<TreeLink>& children) const;
+
+        // Order-preserving reduce-scatter in place on work. Fills the piece
+        // of every rank (empty on ranks folded away for a non-power-of-two
+        // size) and returns the number of messages sent.
+        static int ordered_halving(char* work, int count, MPI_Datatype datatype, MPI_Op op,
+            MPI_Comm comm, std::vector<int>& counts, std::vector<int>& displacements);
+
+        // Tree over members (ascending ranks) rooted at the last one; the
+        // children of a member cover the ranks just below it, nearest first
+        static void ordered_binomial(const std::vector<int>& members, int position,
+            bool& has_parent, int& parent, std::vector<int>& children);
+    };
+
+} // namespace TopologyAwareResearch
+
+#endif // ORDERED_REDUCTION_H
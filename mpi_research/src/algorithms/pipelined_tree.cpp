@@ -0,0 +1,198 @@
+#include "pipelined_tree.h"
+#include "../core/reduction_ops.h"
+#include "../core/reduction_simd.h"
+#include "../core/scratch_pool.h"
+#include <algorithm>
+
+namespace TopologyAwareResearch {
+
+    namespace {
+        // Keeps tags well below the MPI-guaranteed MPI_TAG_UB of 32767
+        const int kMaxTreeSegments = 4096;
+
+        // Elements per segment, capped so that tags stay below kMaxTreeSegments
+        int tree_segment_count(int count, int type_size, int segment_bytes, int& num_segments) {
+            int segment_count = std::max(1, segment_bytes / std::max(1, type_size));
+            num_segments = (count + segment_count - 1) / segment_count;
+            if (num_segments > kMaxTreeSegments) {
+                segment_count = (count + kMaxTreeSegments - 1) / kMaxTreeSegments;
+                num_segments = (count + segment_count - 1) / segment_count;
+            }
+            return segment_count;
+        }
+    }
+
+    PerformanceMetrics pipelined_tree_broadcast(void* buffer, int count,
+        MPI_Datatype datatype, MPI_Comm comm,
+        bool has_parent, const TreeLink& parent,
+        const std::vector<TreeLink>& children,
+        int segment_bytes) {
+        PerformanceMetrics metrics;
+        auto start_time = MPI_Wtime();
+
+        int world_rank;
+        MPI_Comm_rank(comm, &world_rank);
+
+        if (count == 0) {
+            metrics.execution_time = 0.0;
+            return metrics;
+        }
+
+        // Segment layout
+        int type_size;
+        MPI_Aint lower_bound, extent;
+        MPI_Type_size(datatype, &type_size);
+        MPI_Type_get_extent(datatype, &lower_bound, &extent);
+
+        int num_segments;
+        int segment_count = tree_segment_count(count, type_size, segment_bytes, num_segments);
+
+        char* base = static_cast<char*>(buffer);
+        auto segment_ptr = [&](int s) { return base + static_cast<MPI_Aint>(s) * segment_count * extent; };
+        auto segment_len = [&](int s) { return std::min(segment_count, count - s * segment_count); };
+
+        std::vector<std::pair<int, int>> communication_edges;
+
+        // Pre-post every segment receive so the parent never waits on us
+        std::vector<MPI_Request> recv_requests(num_segments, MPI_REQUEST_NULL);
+        if (has_parent) {
+            for (int s = 0; s < num_segments; ++s) {
+                MPI_Irecv(segment_ptr(s), segment_len(s), datatype, parent.peer, s,
+                    parent.comm, &recv_requests[s]);
+            }
+            communication_edges.emplace_back(parent.world_peer, world_rank);
+        }
+
+        // Forward each segment to all ports as soon as it lands
+        std::vector<MPI_Request> send_requests;
+        send_requests.reserve(static_cast<size_t>(num_segments) * children.size());
+        for (int s = 0; s < num_segments; ++s) {
+            if (has_parent) {
+                MPI_Wait(&recv_requests[s], MPI_STATUS_IGNORE);
+            }
+            for (const TreeLink& child : children) {
+                send_requests.emplace_back();
+                MPI_Isend(segment_ptr(s), segment_len(s), datatype, child.peer, s,
+                    child.comm, &send_requests.back());
+            }
+        }
+        MPI_Waitall(static_cast<int>(send_requests.size()), send_requests.data(), MPI_STATUSES_IGNORE);
+
+        for (const TreeLink& child : children) {
+            communication_edges.emplace_back(world_rank, child.world_peer);
+        }
+
+        auto end_time = MPI_Wtime();
+        metrics.execution_time = end_time - start_time;
+        metrics.communication_time = metrics.execution_time;
+        metrics.bytes_transferred = count * type_size * static_cast<int>(children.size());
+        metrics.communication_edges = communication_edges;
+        metrics.messages_sent = num_segments * static_cast<int>(children.size());
+
+        return metrics;
+    }
+
+    PerformanceMetrics pipelined_tree_reduce(const void* sendbuf, void* recvbuf, int count,
+        MPI_Datatype datatype, MPI_Op op, MPI_Comm comm,
+        bool has_parent, const TreeLink& parent,
+        const std::vector<TreeLink>& children,
+        int segment_bytes) {
+        PerformanceMetrics metrics;
+        auto start_time = MPI_Wtime();
+
+        int world_rank;
+        MPI_Comm_rank(comm, &world_rank);
+
+        // Segment layout
+        int type_size;
+        MPI_Aint lower_bound, extent;
+        MPI_Type_size(datatype, &type_size);
+        MPI_Type_get_extent(datatype, &lower_bound, &extent);
+
+        int num_segments;
+        int segment_count = tree_segment_count(count, type_size, segment_bytes, num_segments);
+        auto segment_offset = [&](int s) { return s * segment_count; };
+        auto segment_len = [&](int s) { return std::min(segment_count, count - s * segment_count); };
+        ReductionKernel reduce_kernel = resolve_reduction_kernel(datatype, op);
+        reduce_kernel.stream_for_total(static_cast<size_t>(count) * extent);
+
+        // Accumulate in recvbuf at the root and in a private buffer on inner
+        // ranks; leaves send straight from their input. Children's segments
+        // are combined with the input into the accumulator, so the input is
+        // never copied there.
+        const char* input = static_cast<const char*>(sendbuf == MPI_IN_PLACE ? recvbuf : sendbuf);
+        size_t bytes = static_cast<size_t>(count) * extent;
+        ScratchBuffer partial;
+        char* accumulator;
+        if (!has_parent) {
+            accumulator = static_cast<char*>(recvbuf);
+            if (children.empty()) {
+                bulk_copy(accumulator, input, bytes);
+            }
+        }
+        else if (!children.empty()) {
+            partial = ScratchPool::local().acquire(bytes);
+            accumulator = partial.data();
+        }
+        else {
+            accumulator = const_cast<char*>(input);
+        }
+        auto segment_ptr = [&](int s) { return accumulator + static_cast<MPI_Aint>(segment_offset(s)) * extent; };
+
+        // Two receive slots per child: segment s+1 lands while s is reduced
+        size_t slot_bytes = static_cast<size_t>(segment_count) * extent;
+        ScratchBuffer slots = ScratchPool::local().acquire(2 * children.size() * slot_bytes);
+        std::vector<MPI_Request> recv_requests(2 * children.size(), MPI_REQUEST_NULL);
+        auto slot = [&](int s, size_t c) { return slots.data() + ((s % 2) * children.size() + c) * slot_bytes; };
+        auto post_receives = [&](int s) {
+            for (size_t c = 0; c < children.size(); ++c) {
+                MPI_Irecv(slot(s, c), segment_len(s), datatype, children[c].peer, s,
+                    children[c].comm, &recv_requests[(s % 2) * children.size() + c]);
+            }
+        };
+
+        // Own input first, then every child's slot: all children are folded
+        // into a segment in one pass over the accumulator
+        std::vector<const void*> sources(children.size() + 1);
+
+        std::vector<MPI_Request> send_requests;
+        send_requests.reserve(has_parent ? num_segments : 0);
+        if (num_segments > 0) {
+            post_receives(0);
+        }
+        for (int s = 0; s < num_segments; ++s) {
+            if (s + 1 < num_segments) {
+                post_receives(s + 1);
+            }
+            if (!children.empty()) {
+                MPI_Waitall(static_cast<int>(children.size()), &recv_requests[(s % 2) * children.size()],
+                    MPI_STATUSES_IGNORE);
+                sources[0] = input + static_cast<MPI_Aint>(segment_offset(s)) * extent;
+                for (size_t c = 0; c < children.size(); ++c) {
+                    sources[c + 1] = slot(s, c);
+                }
+                reduce_kernel.combine_many(segment_ptr(s), sources.data(), static_cast<int>(sources.size()),
+                    segment_len(s));
+            }
+            if (has_parent) {
+                send_requests.emplace_back();
+                MPI_Isend(segment_ptr(s), segment_len(s), datatype, parent.peer, s,
+                    parent.comm, &send_requests.back());
+            }
+        }
+        MPI_Waitall(static_cast<int>(send_requests.size()), send_requests.data(), MPI_STATUSES_IGNORE);
+
+        if (has_parent) {
+            metrics.communication_edges.emplace_back(world_rank, parent.world_peer);
+        }
+
+        auto end_time = MPI_Wtime();
+        metrics.execution_time = end_time - start_time;
+        metrics.communication_time = metrics.execution_time;
+        metrics.bytes_transferred = has_parent ? count * type_size : 0;
+        metrics.messages_sent = has_parent ? num_segments : 0;
+
+        return metrics;
+    }
+
+} // namespace TopologyAwareResearch
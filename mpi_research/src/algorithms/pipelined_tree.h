@@ -0,0 +1,41 @@
+#ifndef PIPELINED_TREE_H
+#define PIPELINED_TREE_H
+
+#include <mpi.h>
+#include <vector>
+#include "../core/collective_optimizer.h"
+
+namespace TopologyAwareResearch {
+
+    // One edge of a broadcast or reduce tree, expressed in the communicator that carries it
+    struct TreeLink {
+        MPI_Comm comm;   // Communicator carrying the edge
+        int peer;        // Peer rank in that communicator
+        int world_peer;  // Peer rank in the collective's communicator
+    };
+
+    // Segmented broadcast down an arbitrary tree. All receives from the
+    // parent are pre-posted and every segment is forwarded to all children
+    // with nonblocking sends as soon as it arrives, so subtrees start working
+    // on the first segment while later ones are still in flight.
+    PerformanceMetrics pipelined_tree_broadcast(void* buffer, int count,
+        MPI_Datatype datatype, MPI_Comm comm,
+        bool has_parent, const TreeLink& parent,
+        const std::vector<TreeLink>& children,
+        int segment_bytes);
+
+    // Segmented reduce up an arbitrary tree; the rank without a parent ends
+    // up with the result in recvbuf (sendbuf may be MPI_IN_PLACE there).
+    // Receives for the next segment are posted before the current one is
+    // reduced, so the reduction overlaps every child's next transfer. All
+    // children of a segment are folded in one k-way pass, in order:
+    // result = child[n-1] op ... op child[0] op own.
+    PerformanceMetrics pipelined_tree_reduce(const void* sendbuf, void* recvbuf, int count,
+        MPI_Datatype datatype, MPI_Op op, MPI_Comm comm,
+        bool has_parent, const TreeLink& parent,
+        const std::vector<TreeLink>& children,
+        int segment_bytes);
+
+} // namespace TopologyAwareResearch
+
+#endif // PIPELINED_TREE_H
@@ -0,0 +1,312 @@
+#include "topology_aware_allgather.h"
+#include "../core/scratch_pool.h"
+#include <algorithm>
+#include <cstring>
+
+namespace TopologyAwareResearch {
+
+    namespace {
+        const int kAllgatherTag = 0;
+
+        // Totals below this are latency bound
+        const long long kShortAllgatherBytes = 81920;
+        // Recursive doubling still beats the ring up to here for power-of-two P
+        const long long kMediumAllgatherBytes = 524288;
+
+        bool is_power_of_two(int value) {
+            return value > 0 && (value & (value - 1)) == 0;
+        }
+
+        // Puts this rank's contribution at recvbuf[rank] unless it is already there
+        void copy_own_block(const void* sendbuf, void* recvbuf, int rank, MPI_Aint block_bytes) {
+            if (sendbuf != MPI_IN_PLACE) {
+                std::memcpy(static_cast<char*>(recvbuf) + rank * block_bytes, sendbuf, block_bytes);
+            }
+        }
+    }
+
+    TopologyAwareAllgather::TopologyAwareAllgather(const NetworkCharacteristics& config)
+        : network_config_(config) {
+    }
+
+    TopologyAwareAllgather::~TopologyAwareAllgather() {}
+
+    PerformanceMetrics TopologyAwareAllgather::allgather(const void* sendbuf, void* recvbuf,
+        int count, MPI_Datatype datatype,
+        MPI_Comm comm) {
+        int world_size, type_size;
+        MPI_Comm_size(comm, &world_size);
+        MPI_Type_size(datatype, &type_size);
+
+        AlgorithmType algo = select_algorithm(static_cast<long long>(count) * type_size, world_size);
+        return execute(algo, sendbuf, recvbuf, count, datatype, comm);
+    }
+
+    PerformanceMetrics TopologyAwareAllgather::execute(AlgorithmType algo, const void* sendbuf, void* recvbuf,
+        int count, MPI_Datatype datatype,
+        MPI_Comm comm) {
+        switch (algo) {
+        case AlgorithmType::RING_ALLGATHER:
+            return ring_allgather(sendbuf, recvbuf, count, datatype, comm);
+        case AlgorithmType::RECURSIVE_DOUBLING_ALLGATHER:
+            return recursive_doubling_allgather(sendbuf, recvbuf, count, datatype, comm);
+        case AlgorithmType::BRUCK_ALLGATHER:
+            return bruck_allgather(sendbuf, recvbuf, count, datatype, comm);
+        case AlgorithmType::HIERARCHICAL_ALLGATHER:
+            return hierarchical_allgather(sendbuf, recvbuf, count, datatype, comm);
+        default: {
+            PerformanceMetrics metrics;
+            auto start_time = MPI_Wtime();
+            MPI_Allgather(sendbuf, count, datatype, recvbuf, count, datatype, comm);
+            metrics.execution_time = MPI_Wtime() - start_time;
+            return metrics;
+        }
+        }
+    }
+
+    AlgorithmType TopologyAwareAllgather::select_algorithm(long long block_bytes, int world_size) const {
+        long long total_bytes = block_bytes * world_size;
+
+        if (total_bytes < kMediumAllgatherBytes && has_node_hierarchy(network_config_.node_mapping, world_size)) {
+            return AlgorithmType::HIERARCHICAL_ALLGATHER;
+        }
+
+        if (total_bytes < kShortAllgatherBytes) {
+            return is_power_of_two(world_size) ? AlgorithmType::RECURSIVE_DOUBLING_ALLGATHER
+                : AlgorithmType::BRUCK_ALLGATHER;
+        }
+        if (total_bytes < kMediumAllgatherBytes && is_power_of_two(world_size)) {
+            return AlgorithmType::RECURSIVE_DOUBLING_ALLGATHER;
+        }
+        return AlgorithmType::RING_ALLGATHER;
+    }
+
+    PerformanceMetrics TopologyAwareAllgather::ring_allgather(const void* sendbuf, void* recvbuf,
+        int count, MPI_Datatype datatype,
+        MPI_Comm comm) {
+        PerformanceMetrics metrics;
+        auto start_time = MPI_Wtime();
+
+        int world_size, world_rank;
+        MPI_Comm_size(comm, &world_size);
+        MPI_Comm_rank(comm, &world_rank);
+
+        MPI_Aint lower_bound, extent;
+        MPI_Type_get_extent(datatype, &lower_bound, &extent);
+        MPI_Aint block_bytes = count * extent;
+        char* blocks = static_cast<char*>(recvbuf);
+
+        copy_own_block(sendbuf, recvbuf, world_rank, block_bytes);
+
+        std::vector<int> order = node_grouped_order(network_config_.node_mapping, world_size);
+        int position = static_cast<int>(std::find(order.begin(), order.end(), world_rank) - order.begin());
+        int right = order[(position + 1) % world_size];
+        int left = order[(position - 1 + world_size) % world_size];
+
+        // Step s forwards the block that arrived in step s-1
+        for (int step = 0; step < world_size - 1; ++step) {
+            int send_block = order[(position - step + world_size) % world_size];
+            int recv_block = order[(position - step - 1 + world_size) % world_size];
+
+            MPI_Sendrecv(blocks + send_block * block_bytes, count, datatype, right, kAllgatherTag,
+                blocks + recv_block * block_bytes, count, datatype, left, kAllgatherTag,
+                comm, MPI_STATUS_IGNORE);
+        }
+
+        int type_size;
+        MPI_Type_size(datatype, &type_size);
+
+        auto end_time = MPI_Wtime();
+        metrics.execution_time = end_time - start_time;
+        metrics.communication_time = metrics.execution_time;
+        metrics.messages_sent = world_size - 1;
+        metrics.bytes_transferred = (world_size - 1) * count * type_size;
+        if (world_size > 1) {
+            metrics.communication_edges.emplace_back(world_rank, right);
+        }
+
+        return metrics;
+    }
+
+    PerformanceMetrics TopologyAwareAllgather::recursive_doubling_allgather(const void* sendbuf, void* recvbuf,
+        int count, MPI_Datatype datatype,
+        MPI_Comm comm) {
+        int world_size, world_rank;
+        MPI_Comm_size(comm, &world_size);
+        MPI_Comm_rank(comm, &world_rank);
+
+        if (!is_power_of_two(world_size)) {
+            return bruck_allgather(sendbuf, recvbuf, count, datatype, comm);
+        }
+
+        PerformanceMetrics metrics;
+        auto start_time = MPI_Wtime();
+
+        MPI_Aint lower_bound, extent;
+        MPI_Type_get_extent(datatype, &lower_bound, &extent);
+        MPI_Aint block_bytes = count * extent;
+        char* blocks = static_cast<char*>(recvbuf);
+
+        copy_own_block(sendbuf, recvbuf, world_rank, block_bytes);
+
+        // After the step with distance `mask` each rank holds the 2*mask
+        // consecutive blocks of its aligned subcube
+        int messages = 0;
+        for (int mask = 1; mask < world_size; mask <<= 1) {
+            int partner = world_rank ^ mask;
+            int my_base = world_rank & ~(mask - 1);
+            int partner_base = partner & ~(mask - 1);
+
+            MPI_Sendrecv(blocks + my_base * block_bytes, mask * count, datatype, partner, kAllgatherTag,
+                blocks + partner_base * block_bytes, mask * count, datatype, partner, kAllgatherTag,
+                comm, MPI_STATUS_IGNORE);
+
+            metrics.communication_edges.emplace_back(world_rank, partner);
+            ++messages;
+        }
+
+        int type_size;
+        MPI_Type_size(datatype, &type_size);
+
+        auto end_time = MPI_Wtime();
+        metrics.execution_time = end_time - start_time;
+        metrics.communication_time = metrics.execution_time;
+        metrics.messages_sent = messages;
+        metrics.bytes_transferred = (world_size - 1) * count * type_size;
+
+        return metrics;
+    }
+
+    PerformanceMetrics TopologyAwareAllgather::bruck_allgather(const void* sendbuf, void* recvbuf,
+        int count, MPI_Datatype datatype,
+        MPI_Comm comm) {
+        PerformanceMetrics metrics;
+        auto start_time = MPI_Wtime();
+
+        int world_size, world_rank;
+        MPI_Comm_size(comm, &world_size);
+        MPI_Comm_rank(comm, &world_rank);
+
+        MPI_Aint lower_bound, extent;
+        MPI_Type_get_extent(datatype, &lower_bound, &extent);
+        MPI_Aint block_bytes = count * extent;
+        char* blocks = static_cast<char*>(recvbuf);
+
+        // Work in a buffer rotated so that the own block sits at index 0
+        ScratchBuffer rotated = ScratchPool::local().acquire(static_cast<size_t>(world_size) * block_bytes);
+        const void* own_block = (sendbuf == MPI_IN_PLACE) ? blocks + world_rank * block_bytes : sendbuf;
+        std::memcpy(rotated.data(), own_block, block_bytes);
+
+        int messages = 0;
+        for (int distance = 1; distance < world_size; distance <<= 1) {
+            int block_count = std::min(distance, world_size - distance);
+            int send_to = (world_rank - distance + world_size) % world_size;
+            int recv_from = (world_rank + distance) % world_size;
+
+            MPI_Sendrecv(rotated.data(), block_count * count, datatype, send_to, kAllgatherTag,
+                rotated.data() + distance * block_bytes, block_count * count, datatype, recv_from, kAllgatherTag,
+                comm, MPI_STATUS_IGNORE);
+
+            metrics.communication_edges.emplace_back(world_rank, send_to);
+            ++messages;
+        }
+
+        // Undo the rotation: rotated[i] holds the block of rank + i
+        for (int i = 0; i < world_size; ++i) {
+            int owner = (world_rank + i) % world_size;
+            std::memcpy(blocks + owner * block_bytes, rotated.data() + i * block_bytes, block_bytes);
+        }
+
+        int type_size;
+        MPI_Type_size(datatype, &type_size);
+
+        auto end_time = MPI_Wtime();
+        metrics.execution_time = end_time - start_time;
+        metrics.communication_time = metrics.execution_time;
+        metrics.messages_sent = messages;
+        metrics.bytes_transferred = (world_size - 1) * count * type_size;
+
+        return metrics;
+    }
+
+    PerformanceMetrics TopologyAwareAllgather::hierarchical_allgather(const void* sendbuf, void* recvbuf,
+        int count, MPI_Datatype datatype,
+        MPI_Comm comm) {
+        PerformanceMetrics metrics;
+        auto start_time = MPI_Wtime();
+
+        int world_size, world_rank;
+        MPI_Comm_size(comm, &world_size);
+        MPI_Comm_rank(comm, &world_rank);
+
+        const NodeCommunicators& node = CommunicatorCache::node(comm, network_config_.node_mapping);
+
+        MPI_Aint lower_bound, extent;
+        MPI_Type_get_extent(datatype, &lower_bound, &extent);
+        MPI_Aint block_bytes = count * extent;
+        char* blocks = static_cast<char*>(recvbuf);
+
+        // Blocks travel in node order; when that is rank order they can land
+        // in recvbuf directly, otherwise they are staged and permuted at the end
+        bool rank_ordered = true;
+        for (int i = 0; i < world_size && rank_ordered; ++i) {
+            rank_ordered = (node.node_order[i] == i);
+        }
+        ScratchBuffer staging;
+        if (!rank_ordered) {
+            staging = ScratchPool::local().acquire(static_cast<size_t>(world_size) * block_bytes);
+        }
+        char* staged = rank_ordered ? blocks : staging.data();
+
+        std::vector<int> counts(node.node_count), displacements(node.node_count);
+        int node_offset = 0;
+        for (int i = 0; i < node.node_count; ++i) {
+            counts[i] = node.node_sizes[i] * count;
+            displacements[i] = node_offset * count;
+            node_offset += node.node_sizes[i];
+        }
+        char* node_blocks = staged + static_cast<MPI_Aint>(displacements[node.node_index]) * extent;
+
+        // Step 1: gather the node's blocks at its leader
+        const void* own_block = (sendbuf == MPI_IN_PLACE) ? blocks + world_rank * block_bytes : sendbuf;
+        if (node.is_leader() && own_block == node_blocks) {
+            own_block = MPI_IN_PLACE;
+        }
+        MPI_Gather(own_block, count, datatype, node_blocks, count, datatype, 0, node.node_comm);
+
+        // Step 2: leaders exchange whole node blocks
+        if (node.is_leader() && node.node_count > 1) {
+            MPI_Allgatherv(MPI_IN_PLACE, 0, datatype, staged, counts.data(), displacements.data(),
+                datatype, node.leader_comm);
+        }
+
+        // Step 3: every rank of the node gets the full result
+        if (node.node_sizes[node.node_index] > 1) {
+            MPI_Bcast(staged, world_size * count, datatype, 0, node.node_comm);
+        }
+
+        if (!rank_ordered) {
+            for (int i = 0; i < world_size; ++i) {
+                std::memcpy(blocks + node.node_order[i] * block_bytes, staged + i * block_bytes, block_bytes);
+            }
+        }
+
+        int type_size;
+        MPI_Type_size(datatype, &type_size);
+
+        auto end_time = MPI_Wtime();
+        metrics.execution_time = end_time - start_time;
+        metrics.communication_time = metrics.execution_time;
+        if (node.is_leader()) {
+            metrics.messages_sent = (node.node_count - 1) + (node.node_sizes[node.node_index] - 1);
+            metrics.bytes_transferred = (node.node_count - 1) * counts[node.node_index] * type_size;
+        }
+        else {
+            metrics.messages_sent = 1;
+            metrics.bytes_transferred = count * type_size;
+        }
+
+        return metrics;
+    }
+
+} // namespace TopologyAwareResearch
@@ -0,0 +1,66 @@
+#ifndef TOPOLOGY_AWARE_ALLGATHER_H
+#define TOPOLOGY_AWARE_ALLGATHER_H
+
+#include <mpi.h>
+#include <vector>
+#include "../core/collective_optimizer.h"
+#include "../core/communicator_cache.h"
+
+namespace TopologyAwareResearch {
+
+    // Point-to-point allgather algorithms. Every variant accepts MPI_IN_PLACE
+    // (own block already at recvbuf[rank]) and places block i at offset
+    // i * count in recvbuf, exactly like MPI_Allgather.
+    class TopologyAwareAllgather {
+    private:
+        NetworkCharacteristics network_config_;
+
+    public:
+        TopologyAwareAllgather(const NetworkCharacteristics& config);
+        ~TopologyAwareAllgather();
+
+        // Picks an algorithm with select_algorithm() and runs it
+        PerformanceMetrics allgather(const void* sendbuf, void* recvbuf,
+            int count, MPI_Datatype datatype,
+            MPI_Comm comm);
+
+        PerformanceMetrics execute(AlgorithmType algo, const void* sendbuf, void* recvbuf,
+            int count, MPI_Datatype datatype,
+            MPI_Comm comm);
+
+        // P-1 neighbour exchanges; the ring visits ranks node by node so only
+        // one link per node crosses the network. Best for large blocks.
+        PerformanceMetrics ring_allgather(const void* sendbuf, void* recvbuf,
+            int count, MPI_Datatype datatype,
+            MPI_Comm comm);
+
+        // log2(P) exchanges of doubling size; power-of-two sizes only
+        // (falls back to Bruck otherwise)
+        PerformanceMetrics recursive_doubling_allgather(const void* sendbuf, void* recvbuf,
+            int count, MPI_Datatype datatype,
+            MPI_Comm comm);
+
+        // ceil(log2(P)) exchanges for any P, plus a final local rotation.
+        // Best for small blocks.
+        PerformanceMetrics bruck_allgather(const void* sendbuf, void* recvbuf,
+            int count, MPI_Datatype datatype,
+            MPI_Comm comm);
+
+        // Node leaders gather their ranks' blocks, exchange node-sized blocks
+        // with an allgatherv, then broadcast the result inside the node, so
+        // only one process per node touches the network. Nodes may hold
+        // different numbers of ranks.
+        PerformanceMetrics hierarchical_allgather(const void* sendbuf, void* recvbuf,
+            int count, MPI_Datatype datatype,
+            MPI_Comm comm);
+
+        // Multi-node runs with several ranks per node aggregate per node
+        // unless the total is bandwidth bound; otherwise latency-bound totals
+        // go to Bruck (or recursive doubling for a power-of-two P) and
+        // bandwidth-bound ones to the ring
+        AlgorithmType select_algorithm(long long block_bytes, int world_size) const;
+    };
+
+} // namespace TopologyAwareResearch
+
+#endif // TOPOLOGY_AWARE_ALLGATHER_H
@@ -0,0 +1,565 @@
+#include "topology_aware_alltoall.h"
+#include "../core/scratch_pool.h"
+#include <algorithm>
+#include <cstring>
+
+namespace TopologyAwareResearch {
+
+    namespace {
+        const int kAlltoallTag = 13;
+
+        // Blocks below this are latency bound
+        const long long kShortAlltoallBytes = 256;
+        // Node aggregation and throttled exchanges pay off up to here
+        const long long kMediumAlltoallBytes = 32768;
+
+        const int kDefaultMaxOutstanding = 8;
+
+        // With MPI_IN_PLACE the receive buffer is also the input; copy it
+        // aside and describe it with the receive-side layout
+        struct InPlaceInput {
+            ScratchBuffer copy;
+            const void* sendbuf;
+            const int* sendcounts;
+            const int* sdispls;
+            MPI_Datatype sendtype;
+        };
+
+        InPlaceInput resolve_input(const void* sendbuf, const int* sendcounts, const int* sdispls,
+            MPI_Datatype sendtype, const void* recvbuf, const int* recvcounts, const int* rdispls,
+            MPI_Datatype recvtype, int world_size) {
+            InPlaceInput input;
+            input.sendbuf = sendbuf;
+            input.sendcounts = sendcounts;
+            input.sdispls = sdispls;
+            input.sendtype = sendtype;
+            if (sendbuf != MPI_IN_PLACE) {
+                return input;
+            }
+
+            MPI_Aint lower_bound, extent;
+            MPI_Type_get_extent(recvtype, &lower_bound, &extent);
+            MPI_Aint span = 0;
+            for (int i = 0; i < world_size; ++i) {
+                span = std::max(span, static_cast<MPI_Aint>(rdispls[i] + recvcounts[i]) * extent);
+            }
+            input.copy = ScratchPool::local().acquire_copy(recvbuf, static_cast<size_t>(span));
+            input.sendbuf = input.copy.data();
+            input.sendcounts = recvcounts;
+            input.sdispls = rdispls;
+            input.sendtype = recvtype;
+            return input;
+        }
+
+        // Uniform counts and displacements for the plain alltoall
+        void uniform_layout(int count, int world_size, std::vector<int>& counts, std::vector<int>& displs) {
+            counts.assign(world_size, count);
+            displs.resize(world_size);
+            for (int i = 0; i < world_size; ++i) {
+                displs[i] = i * count;
+            }
+        }
+
+        int position_of(const std::vector<int>& order, int rank) {
+            return static_cast<int>(std::find(order.begin(), order.end(), rank) - order.begin());
+        }
+    }
+
+    TopologyAwareAlltoall::TopologyAwareAlltoall(const NetworkCharacteristics& config)
+        : network_config_(config), max_outstanding_(kDefaultMaxOutstanding) {
+    }
+
+    TopologyAwareAlltoall::~TopologyAwareAlltoall() {}
+
+    PerformanceMetrics TopologyAwareAlltoall::alltoall(const void* sendbuf, void* recvbuf,
+        int count, MPI_Datatype datatype,
+        MPI_Comm comm) {
+        int world_size, type_size;
+        MPI_Comm_size(comm, &world_size);
+        MPI_Type_size(datatype, &type_size);
+
+        AlgorithmType algo = select_algorithm(static_cast<long long>(count) * type_size, world_size);
+        return execute(algo, sendbuf, recvbuf, count, datatype, comm);
+    }
+
+    PerformanceMetrics TopologyAwareAlltoall::alltoallv(const void* sendbuf, const int* sendcounts, const int* sdispls,
+        MPI_Datatype sendtype, void* recvbuf, const int* recvcounts, const int* rdispls,
+        MPI_Datatype recvtype, MPI_Comm comm) {
+        int world_size, type_size;
+        MPI_Comm_size(comm, &world_size);
+        MPI_Type_size(recvtype, &type_size);
+
+        // Every rank must pick the same algorithm, so decide on the mean block
+        long long local_bytes = 0;
+        for (int i = 0; i < world_size; ++i) {
+            local_bytes += static_cast<long long>(recvcounts[i]) * type_size;
+        }
+        long long total_bytes = 0;
+        MPI_Allreduce(&local_bytes, &total_bytes, 1, MPI_LONG_LONG, MPI_SUM, comm);
+
+        long long mean_block = total_bytes / (static_cast<long long>(world_size) * world_size);
+        AlgorithmType algo = select_algorithm(mean_block, world_size);
+        return execute(algo, sendbuf, sendcounts, sdispls, sendtype,
+            recvbuf, recvcounts, rdispls, recvtype, comm);
+    }
+
+    PerformanceMetrics TopologyAwareAlltoall::execute(AlgorithmType algo, const void* sendbuf, void* recvbuf,
+        int count, MPI_Datatype datatype,
+        MPI_Comm comm) {
+        if (algo == AlgorithmType::BRUCK_ALLTOALL) {
+            return bruck_alltoall(sendbuf, recvbuf, count, datatype, comm);
+        }
+
+        int world_size;
+        MPI_Comm_size(comm, &world_size);
+        std::vector<int> counts, displs;
+        uniform_layout(count, world_size, counts, displs);
+
+        return execute(algo, sendbuf, counts.data(), displs.data(), datatype,
+            recvbuf, counts.data(), displs.data(), datatype, comm);
+    }
+
+    PerformanceMetrics TopologyAwareAlltoall::execute(AlgorithmType algo, const void* sendbuf, const int* sendcounts,
+        const int* sdispls, MPI_Datatype sendtype, void* recvbuf, const int* recvcounts,
+        const int* rdispls, MPI_Datatype recvtype, MPI_Comm comm) {
+        switch (algo) {
+        case AlgorithmType::BRUCK_ALLTOALL:
+        case AlgorithmType::PAIRWISE_ALLTOALL:
+            return pairwise_alltoallv(sendbuf, sendcounts, sdispls, sendtype,
+                recvbuf, recvcounts, rdispls, recvtype, comm);
+        case AlgorithmType::HIERARCHICAL_ALLTOALL:
+            return hierarchical_alltoallv(sendbuf, sendcounts, sdispls, sendtype,
+                recvbuf, recvcounts, rdispls, recvtype, comm);
+        case AlgorithmType::THROTTLED_ALLTOALL:
+            return throttled_alltoallv(sendbuf, sendcounts, sdispls, sendtype,
+                recvbuf, recvcounts, rdispls, recvtype, comm);
+        default: {
+            PerformanceMetrics metrics;
+            auto start_time = MPI_Wtime();
+            MPI_Alltoallv(sendbuf, sendcounts, sdispls, sendtype,
+                recvbuf, recvcounts, rdispls, recvtype, comm);
+            metrics.execution_time = MPI_Wtime() - start_time;
+            return metrics;
+        }
+        }
+    }
+
+    AlgorithmType TopologyAwareAlltoall::select_algorithm(long long block_bytes, int world_size) const {
+        bool hierarchy = has_node_hierarchy(network_config_.node_mapping, world_size);
+
+        if (block_bytes < kShortAlltoallBytes && !hierarchy) {
+            return AlgorithmType::BRUCK_ALLTOALL;
+        }
+        if (block_bytes < kMediumAlltoallBytes) {
+            return hierarchy ? AlgorithmType::HIERARCHICAL_ALLTOALL : AlgorithmType::THROTTLED_ALLTOALL;
+        }
+        return AlgorithmType::PAIRWISE_ALLTOALL;
+    }
+
+    PerformanceMetrics TopologyAwareAlltoall::bruck_alltoall(const void* sendbuf, void* recvbuf,
+        int count, MPI_Datatype datatype,
+        MPI_Comm comm) {
+        PerformanceMetrics metrics;
+        auto start_time = MPI_Wtime();
+
+        int world_size, world_rank;
+        MPI_Comm_size(comm, &world_size);
+        MPI_Comm_rank(comm, &world_rank);
+
+        MPI_Aint lower_bound, extent;
+        MPI_Type_get_extent(datatype, &lower_bound, &extent);
+        MPI_Aint block_bytes = count * extent;
+        char* blocks = static_cast<char*>(recvbuf);
+        const char* input = static_cast<const char*>(sendbuf == MPI_IN_PLACE ? recvbuf : sendbuf);
+
+        // Rotate so that rotated[i] is the block for rank + i
+        ScratchBuffer rotated = ScratchPool::local().acquire(static_cast<size_t>(world_size) * block_bytes);
+        for (int i = 0; i < world_size; ++i) {
+            std::memcpy(rotated.data() + i * block_bytes,
+                input + ((world_rank + i) % world_size) * block_bytes, block_bytes);
+        }
+
+        // In the step with distance d every block whose index has bit d set
+        // moves d ranks forward; afterwards rotated[i] came from rank - i
+        ScratchBuffer packed = ScratchPool::local().acquire(static_cast<size_t>((world_size + 1) / 2) * block_bytes);
+        ScratchBuffer incoming = ScratchPool::local().acquire(packed.size());
+        int messages = 0;
+        for (int distance = 1; distance < world_size; distance <<= 1) {
+            int send_to = (world_rank + distance) % world_size;
+            int recv_from = (world_rank - distance + world_size) % world_size;
+
+            int moved = 0;
+            for (int i = distance; i < world_size; ++i) {
+                if (i & distance) {
+                    std::memcpy(packed.data() + moved * block_bytes, rotated.data() + i * block_bytes, block_bytes);
+                    ++moved;
+                }
+            }
+
+            MPI_Sendrecv(packed.data(), moved * count, datatype, send_to, kAlltoallTag,
+                incoming.data(), moved * count, datatype, recv_from, kAlltoallTag,
+                comm, MPI_STATUS_IGNORE);
+
+            moved = 0;
+            for (int i = distance; i < world_size; ++i) {
+                if (i & distance) {
+                    std::memcpy(rotated.data() + i * block_bytes, incoming.data() + moved * block_bytes, block_bytes);
+                    ++moved;
+                }
+            }
+
+            metrics.communication_edges.emplace_back(world_rank, send_to);
+            ++messages;
+        }
+
+        for (int i = 0; i < world_size; ++i) {
+            int source = (world_rank - i + world_size) % world_size;
+            std::memcpy(blocks + source * block_bytes, rotated.data() + i * block_bytes, block_bytes);
+        }
+
+        int type_size;
+        MPI_Type_size(datatype, &type_size);
+
+        auto end_time = MPI_Wtime();
+        metrics.execution_time = end_time - start_time;
+        metrics.communication_time = metrics.execution_time;
+        metrics.messages_sent = messages;
+        metrics.bytes_transferred = messages * ((world_size + 1) / 2) * count * type_size;
+
+        return metrics;
+    }
+
+    PerformanceMetrics TopologyAwareAlltoall::pairwise_alltoallv(const void* sendbuf, const int* sendcounts, const int* sdispls,
+        MPI_Datatype sendtype, void* recvbuf, const int* recvcounts, const int* rdispls,
+        MPI_Datatype recvtype, MPI_Comm comm) {
+        PerformanceMetrics metrics;
+        auto start_time = MPI_Wtime();
+
+        int world_size, world_rank;
+        MPI_Comm_size(comm, &world_size);
+        MPI_Comm_rank(comm, &world_rank);
+
+        InPlaceInput input = resolve_input(sendbuf, sendcounts, sdispls, sendtype,
+            recvbuf, recvcounts, rdispls, recvtype, world_size);
+
+        MPI_Aint lower_bound, send_extent, recv_extent;
+        MPI_Type_get_extent(input.sendtype, &lower_bound, &send_extent);
+        MPI_Type_get_extent(recvtype, &lower_bound, &recv_extent);
+        const char* send_blocks = static_cast<const char*>(input.sendbuf);
+        char* recv_blocks = static_cast<char*>(recvbuf);
+
+        std::vector<int> order = node_grouped_order(network_config_.node_mapping, world_size);
+        int position = position_of(order, world_rank);
+
+        int send_size;
+        MPI_Type_size(input.sendtype, &send_size);
+        long long bytes = 0;
+
+        // Step 0 is the local copy
+        for (int step = 0; step < world_size; ++step) {
+            int send_to = order[(position + step) % world_size];
+            int recv_from = order[(position - step + world_size) % world_size];
+
+            MPI_Sendrecv(send_blocks + input.sdispls[send_to] * send_extent, input.sendcounts[send_to],
+                input.sendtype, send_to, kAlltoallTag,
+                recv_blocks + rdispls[recv_from] * recv_extent, recvcounts[recv_from],
+                recvtype, recv_from, kAlltoallTag,
+                comm, MPI_STATUS_IGNORE);
+
+            if (step > 0) {
+                metrics.communication_edges.emplace_back(world_rank, send_to);
+                bytes += static_cast<long long>(input.sendcounts[send_to]) * send_size;
+            }
+        }
+
+        auto end_time = MPI_Wtime();
+        metrics.execution_time = end_time - start_time;
+        metrics.communication_time = metrics.execution_time;
+        metrics.messages_sent = world_size - 1;
+        metrics.bytes_transferred = static_cast<int>(bytes);
+
+        return metrics;
+    }
+
+    PerformanceMetrics TopologyAwareAlltoall::throttled_alltoallv(const void* sendbuf, const int* sendcounts, const int* sdispls,
+        MPI_Datatype sendtype, void* recvbuf, const int* recvcounts, const int* rdispls,
+        MPI_Datatype recvtype, MPI_Comm comm) {
+        PerformanceMetrics metrics;
+        auto start_time = MPI_Wtime();
+
+        int world_size, world_rank;
+        MPI_Comm_size(comm, &world_size);
+        MPI_Comm_rank(comm, &world_rank);
+
+        InPlaceInput input = resolve_input(sendbuf, sendcounts, sdispls, sendtype,
+            recvbuf, recvcounts, rdispls, recvtype, world_size);
+
+        MPI_Aint lower_bound, send_extent, recv_extent;
+        MPI_Type_get_extent(input.sendtype, &lower_bound, &send_extent);
+        MPI_Type_get_extent(recvtype, &lower_bound, &recv_extent);
+        const char* send_blocks = static_cast<const char*>(input.sendbuf);
+        char* recv_blocks = static_cast<char*>(recvbuf);
+
+        std::vector<int> order = node_grouped_order(network_config_.node_mapping, world_size);
+        int position = position_of(order, world_rank);
+        int window = std::max(1, max_outstanding_);
+
+        int send_size;
+        MPI_Type_size(input.sendtype, &send_size);
+        long long bytes = 0;
+
+        // Same shifted partner sequence as the pairwise exchange, but up to
+        // `window` partners at a time; the window drains before the next
+        // one is posted
+        std::vector<MPI_Request> requests;
+        requests.reserve(2 * window);
+        for (int first = 0; first < world_size; first += window) {
+            int last = std::min(first + window, world_size);
+            requests.clear();
+
+            for (int step = first; step < last; ++step) {
+                int recv_from = order[(position - step + world_size) % world_size];
+                requests.emplace_back();
+                MPI_Irecv(recv_blocks + rdispls[recv_from] * recv_extent, recvcounts[recv_from],
+                    recvtype, recv_from, kAlltoallTag, comm, &requests.back());
+            }
+            for (int step = first; step < last; ++step) {
+                int send_to = order[(position + step) % world_size];
+                requests.emplace_back();
+                MPI_Isend(send_blocks + input.sdispls[send_to] * send_extent, input.sendcounts[send_to],
+                    input.sendtype, send_to, kAlltoallTag, comm, &requests.back());
+
+                if (step > 0) {
+                    metrics.communication_edges.emplace_back(world_rank, send_to);
+                    bytes += static_cast<long long>(input.sendcounts[send_to]) * send_size;
+                }
+            }
+
+            MPI_Waitall(static_cast<int>(requests.size()), requests.data(), MPI_STATUSES_IGNORE);
+        }
+
+        auto end_time = MPI_Wtime();
+        metrics.execution_time = end_time - start_time;
+        metrics.communication_time = metrics.execution_time;
+        metrics.messages_sent = world_size - 1;
+        metrics.bytes_transferred = static_cast<int>(bytes);
+
+        return metrics;
+    }
+
+    PerformanceMetrics TopologyAwareAlltoall::hierarchical_alltoallv(const void* sendbuf, const int* sendcounts, const int* sdispls,
+        MPI_Datatype sendtype, void* recvbuf, const int* recvcounts, const int* rdispls,
+        MPI_Datatype recvtype, MPI_Comm comm) {
+        PerformanceMetrics metrics;
+        auto start_time = MPI_Wtime();
+
+        int world_size, world_rank;
+        MPI_Comm_size(comm, &world_size);
+        MPI_Comm_rank(comm, &world_rank);
+
+        InPlaceInput input = resolve_input(sendbuf, sendcounts, sdispls, sendtype,
+            recvbuf, recvcounts, rdispls, recvtype, world_size);
+
+        const NodeCommunicators& node = CommunicatorCache::node(comm, network_config_.node_mapping);
+        int node_size = node.node_sizes[node.node_index];
+
+        MPI_Aint lower_bound, send_extent, recv_extent;
+        MPI_Type_get_extent(input.sendtype, &lower_bound, &send_extent);
+        MPI_Type_get_extent(recvtype, &lower_bound, &recv_extent);
+        int send_size, recv_size;
+        MPI_Type_size(input.sendtype, &send_size);
+        MPI_Type_size(recvtype, &recv_size);
+
+        // Node of every rank and the start of every node in node order
+        std::vector<int> node_start(node.node_count + 1, 0);
+        std::vector<int> node_of(world_size);
+        for (int n = 0; n < node.node_count; ++n) {
+            node_start[n + 1] = node_start[n] + node.node_sizes[n];
+            for (int i = node_start[n]; i < node_start[n + 1]; ++i) {
+                node_of[node.node_order[i]] = n;
+            }
+        }
+
+        // Step 1: every rank hands the leader its byte counts and its blocks
+        // packed in node order of the destination
+        std::vector<int> local_bytes(2 * world_size);
+        int packed_bytes = 0;
+        for (int i = 0; i < world_size; ++i) {
+            local_bytes[i] = input.sendcounts[i] * send_size;
+            local_bytes[world_size + i] = recvcounts[i] * recv_size;
+            packed_bytes += local_bytes[i];
+        }
+        ScratchBuffer packed = ScratchPool::local().acquire(packed_bytes);
+        const char* send_blocks = static_cast<const char*>(input.sendbuf);
+        int offset = 0;
+        for (int d = 0; d < world_size; ++d) {
+            int destination = node.node_order[d];
+            std::memcpy(packed.data() + offset, send_blocks + input.sdispls[destination] * send_extent,
+                local_bytes[destination]);
+            offset += local_bytes[destination];
+        }
+
+        // byte_counts[j][0..P) = bytes member j sends to each rank,
+        // byte_counts[j][P..2P) = bytes member j receives from each rank
+        std::vector<int> byte_counts;
+        if (node.is_leader()) {
+            byte_counts.resize(static_cast<size_t>(node_size) * 2 * world_size);
+        }
+        MPI_Gather(local_bytes.data(), 2 * world_size, MPI_INT,
+            byte_counts.data(), 2 * world_size, MPI_INT, 0, node.node_comm);
+        auto sent = [&](int member, int destination) {
+            return byte_counts[static_cast<size_t>(member) * 2 * world_size + destination];
+        };
+        auto received = [&](int member, int source) {
+            return byte_counts[static_cast<size_t>(member) * 2 * world_size + world_size + source];
+        };
+
+        std::vector<int> member_bytes(node_size), member_offsets(node_size);
+        ScratchBuffer gathered;
+        if (node.is_leader()) {
+            int total = 0;
+            for (int j = 0; j < node_size; ++j) {
+                member_bytes[j] = 0;
+                for (int i = 0; i < world_size; ++i) {
+                    member_bytes[j] += sent(j, i);
+                }
+                member_offsets[j] = total;
+                total += member_bytes[j];
+            }
+            gathered = ScratchPool::local().acquire(total);
+        }
+        MPI_Gatherv(packed.data(), packed_bytes, MPI_BYTE,
+            gathered.data(), member_bytes.data(), member_offsets.data(), MPI_BYTE, 0, node.node_comm);
+
+        int messages = 0;
+        ScratchBuffer delivered;
+        std::vector<int> delivered_bytes(node_size), delivered_offsets(node_size);
+
+        if (node.is_leader()) {
+            // Where block (member j -> node-order destination d) sits in `gathered`
+            std::vector<int> block_offset(static_cast<size_t>(node_size) * world_size);
+            for (int j = 0; j < node_size; ++j) {
+                int cursor = member_offsets[j];
+                for (int d = 0; d < world_size; ++d) {
+                    block_offset[static_cast<size_t>(j) * world_size + d] = cursor;
+                    cursor += sent(j, node.node_order[d]);
+                }
+            }
+
+            // Step 2: one message per node pair, laid out [source member][destination member],
+            // all pairs packed into one outgoing and one incoming buffer
+            std::vector<int> outgoing_offset(node.node_count + 1, 0), incoming_offset(node.node_count + 1, 0);
+            for (int n = 0; n < node.node_count; ++n) {
+                int bytes = 0;
+                for (int j = 0; j < node_size; ++j) {
+                    for (int d = node_start[n]; d < node_start[n + 1]; ++d) {
+                        bytes += sent(j, node.node_order[d]);
+                    }
+                }
+                outgoing_offset[n + 1] = outgoing_offset[n] + bytes;
+
+                bytes = 0;
+                for (int s = node_start[n]; s < node_start[n + 1]; ++s) {
+                    for (int i = 0; i < node_size; ++i) {
+                        bytes += received(i, node.node_order[s]);
+                    }
+                }
+                incoming_offset[n + 1] = incoming_offset[n] + bytes;
+            }
+            ScratchBuffer outgoing = ScratchPool::local().acquire(outgoing_offset[node.node_count]);
+            ScratchBuffer incoming = ScratchPool::local().acquire(incoming_offset[node.node_count]);
+            for (int n = 0; n < node.node_count; ++n) {
+                int cursor = outgoing_offset[n];
+                for (int j = 0; j < node_size; ++j) {
+                    int first = block_offset[static_cast<size_t>(j) * world_size + node_start[n]];
+                    int span = 0;
+                    for (int d = node_start[n]; d < node_start[n + 1]; ++d) {
+                        span += sent(j, node.node_order[d]);
+                    }
+                    std::memcpy(outgoing.data() + cursor, gathered.data() + first, span);
+                    cursor += span;
+                }
+            }
+
+            std::vector<MPI_Request> requests;
+            for (int n = 0; n < node.node_count; ++n) {
+                int outgoing_bytes = outgoing_offset[n + 1] - outgoing_offset[n];
+                if (n == node.node_index) {
+                    std::memcpy(incoming.data() + incoming_offset[n], outgoing.data() + outgoing_offset[n],
+                        outgoing_bytes);
+                    continue;
+                }
+                requests.emplace_back();
+                MPI_Irecv(incoming.data() + incoming_offset[n], incoming_offset[n + 1] - incoming_offset[n],
+                    MPI_BYTE, n, kAlltoallTag, node.leader_comm, &requests.back());
+                requests.emplace_back();
+                MPI_Isend(outgoing.data() + outgoing_offset[n], outgoing_bytes, MPI_BYTE,
+                    n, kAlltoallTag, node.leader_comm, &requests.back());
+                metrics.communication_edges.emplace_back(world_rank, node.node_order[node_start[n]]);
+                ++messages;
+            }
+            MPI_Waitall(static_cast<int>(requests.size()), requests.data(), MPI_STATUSES_IGNORE);
+
+            // Step 3: regroup per destination member, sources in rank order
+            std::vector<int> source_offset(static_cast<size_t>(world_size) * node_size);
+            for (int n = 0; n < node.node_count; ++n) {
+                int cursor = 0;
+                for (int s = node_start[n]; s < node_start[n + 1]; ++s) {
+                    int source = node.node_order[s];
+                    for (int i = 0; i < node_size; ++i) {
+                        source_offset[static_cast<size_t>(source) * node_size + i] = cursor;
+                        cursor += received(i, source);
+                    }
+                }
+            }
+
+            int total = 0;
+            for (int i = 0; i < node_size; ++i) {
+                delivered_offsets[i] = total;
+                delivered_bytes[i] = 0;
+                for (int source = 0; source < world_size; ++source) {
+                    delivered_bytes[i] += received(i, source);
+                }
+                total += delivered_bytes[i];
+            }
+            delivered = ScratchPool::local().acquire(total);
+            for (int i = 0; i < node_size; ++i) {
+                int cursor = delivered_offsets[i];
+                for (int source = 0; source < world_size; ++source) {
+                    int bytes = received(i, source);
+                    std::memcpy(delivered.data() + cursor,
+                        incoming.data() + incoming_offset[node_of[source]] +
+                            source_offset[static_cast<size_t>(source) * node_size + i],
+                        bytes);
+                    cursor += bytes;
+                }
+            }
+            messages += node_size - 1;
+        }
+
+        int own_bytes = 0;
+        for (int source = 0; source < world_size; ++source) {
+            own_bytes += local_bytes[world_size + source];
+        }
+        ScratchBuffer mine = ScratchPool::local().acquire(own_bytes);
+        MPI_Scatterv(delivered.data(), delivered_bytes.data(), delivered_offsets.data(), MPI_BYTE,
+            mine.data(), own_bytes, MPI_BYTE, 0, node.node_comm);
+
+        char* recv_blocks = static_cast<char*>(recvbuf);
+        int cursor = 0;
+        for (int source = 0; source < world_size; ++source) {
+            int bytes = local_bytes[world_size + source];
+            std::memcpy(recv_blocks + rdispls[source] * recv_extent, mine.data() + cursor, bytes);
+            cursor += bytes;
+        }
+
+        auto end_time = MPI_Wtime();
+        metrics.execution_time = end_time - start_time;
+        metrics.communication_time = metrics.execution_time;
+        metrics.messages_sent = node.is_leader() ? messages : 1;
+        metrics.bytes_transferred = packed_bytes;
+
+        return metrics;
+    }
+
+} // namespace TopologyAwareResearch
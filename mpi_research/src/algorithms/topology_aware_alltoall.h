@@ -0,0 +1,78 @@
+#ifndef TOPOLOGY_AWARE_ALLTOALL_H
+#define TOPOLOGY_AWARE_ALLTOALL_H
+
+#include <mpi.h>
+#include <vector>
+#include "../core/collective_optimizer.h"
+#include "../core/communicator_cache.h"
+
+namespace TopologyAwareResearch {
+
+    // Alltoall and alltoallv. Block i of the send buffer goes to rank i and
+    // the block from rank i lands at block i of the receive buffer, exactly
+    // like the MPI calls; MPI_IN_PLACE is accepted as sendbuf. The
+    // node-aggregated variants copy blocks with memcpy and so expect
+    // contiguous datatypes.
+    class TopologyAwareAlltoall {
+    private:
+        NetworkCharacteristics network_config_;
+        int max_outstanding_;  // Sends in flight per rank for the throttled variant
+
+    public:
+        TopologyAwareAlltoall(const NetworkCharacteristics& config);
+        ~TopologyAwareAlltoall();
+
+        // Picks an algorithm with select_algorithm() and runs it
+        PerformanceMetrics alltoall(const void* sendbuf, void* recvbuf,
+            int count, MPI_Datatype datatype,
+            MPI_Comm comm);
+
+        PerformanceMetrics alltoallv(const void* sendbuf, const int* sendcounts, const int* sdispls,
+            MPI_Datatype sendtype, void* recvbuf, const int* recvcounts, const int* rdispls,
+            MPI_Datatype recvtype, MPI_Comm comm);
+
+        PerformanceMetrics execute(AlgorithmType algo, const void* sendbuf, void* recvbuf,
+            int count, MPI_Datatype datatype,
+            MPI_Comm comm);
+
+        // Bruck has no v form; it runs pairwise instead
+        PerformanceMetrics execute(AlgorithmType algo, const void* sendbuf, const int* sendcounts,
+            const int* sdispls, MPI_Datatype sendtype, void* recvbuf, const int* recvcounts,
+            const int* rdispls, MPI_Datatype recvtype, MPI_Comm comm);
+
+        // ceil(log2(P)) exchanges of P/2 blocks each. Best for tiny blocks.
+        PerformanceMetrics bruck_alltoall(const void* sendbuf, void* recvbuf,
+            int count, MPI_Datatype datatype,
+            MPI_Comm comm);
+
+        // P-1 exchanges with one partner at a time. Partners are taken at a
+        // growing shift along the node-ordered rank list, so in every step
+        // each node talks to at most two other nodes. Best for large blocks.
+        PerformanceMetrics pairwise_alltoallv(const void* sendbuf, const int* sendcounts, const int* sdispls,
+            MPI_Datatype sendtype, void* recvbuf, const int* recvcounts, const int* rdispls,
+            MPI_Datatype recvtype, MPI_Comm comm);
+
+        // Ranks hand their blocks to the node leader, leaders swap one
+        // combined message per node pair and scatter the result inside the
+        // node: N^2 network messages instead of P^2
+        PerformanceMetrics hierarchical_alltoallv(const void* sendbuf, const int* sendcounts, const int* sdispls,
+            MPI_Datatype sendtype, void* recvbuf, const int* recvcounts, const int* rdispls,
+            MPI_Datatype recvtype, MPI_Comm comm);
+
+        // Non-blocking exchanges posted in windows of max_outstanding
+        // partners, which bounds the incast any one rank sees
+        PerformanceMetrics throttled_alltoallv(const void* sendbuf, const int* sendcounts, const int* sdispls,
+            MPI_Datatype sendtype, void* recvbuf, const int* recvcounts, const int* rdispls,
+            MPI_Datatype recvtype, MPI_Comm comm);
+
+        void set_max_outstanding(int requests) { max_outstanding_ = requests; }
+        int get_max_outstanding() const { return max_outstanding_; }
+
+        // Bruck for tiny blocks, node aggregation for small ones on
+        // multi-node runs, throttled for medium and pairwise for large blocks
+        AlgorithmType select_algorithm(long long block_bytes, int world_size) const;
+    };
+
+} // namespace TopologyAwareResearch
+
+#endif // TOPOLOGY_AWARE_ALLTOALL_H
@@ -0,0 +1,44 @@
+#ifndef TOPOLOGY_AWARE_BARRIER_H
+#define TOPOLOGY_AWARE_BARRIER_H
+
+#include <mpi.h>
+#include "../core/collective_optimizer.h"
+#include "../core/communicator_cache.h"
+
+namespace TopologyAwareResearch {
+
+    // Barriers built from zero-byte point-to-point messages and, inside a
+    // node, from flags in a shared-memory window
+    class TopologyAwareBarrier {
+    private:
+        NetworkCharacteristics network_config_;
+
+    public:
+        TopologyAwareBarrier(const NetworkCharacteristics& config);
+        ~TopologyAwareBarrier();
+
+        // Picks an algorithm with select_algorithm() and runs it
+        PerformanceMetrics barrier(MPI_Comm comm);
+
+        PerformanceMetrics execute(AlgorithmType algo, MPI_Comm comm);
+
+        // ceil(log2(P)) rounds; in round k rank r signals r + 2^k and waits
+        // for r - 2^k. No power-of-two restriction.
+        PerformanceMetrics dissemination_barrier(MPI_Comm comm);
+
+        // Sense-reversing barrier in a shared-memory window inside each node;
+        // the node leader waits for its ranks, runs the dissemination barrier
+        // with the other leaders and then releases the node
+        PerformanceMetrics hierarchical_barrier(MPI_Comm comm);
+
+        // Hierarchical as soon as some node holds more than one rank
+        AlgorithmType select_algorithm(MPI_Comm comm) const;
+
+    private:
+        // Returns the number of messages sent
+        static int dissemination_rounds(MPI_Comm comm);
+    };
+
+} // namespace TopologyAwareResearch
+
+#endif // TOPOLOGY_AWARE_BARRIER_H
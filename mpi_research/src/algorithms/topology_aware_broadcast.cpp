@@ -6,6 +6,15 @@
 #include <thread>
 #include <cstring>
 #include "../core/reduction_ops.h"
+#include "../core/reduction_simd.h"
+#include "torus_broadcast.h"
+#include "dragonfly_broadcast.h"
+#include "topology_aware_allgather.h"
+#include "topology_aware_scan.h"
+#include "fused_allreduce.h"
+#include "pipelined_tree.h"
+#include "../core/communicator_cache.h"
+#include "../core/scratch_pool.h"
 
 namespace TopologyAwareResearch {
 
@@ -125,61 +134,10 @@ namespace TopologyAwareResearch {
     PerformanceMetrics TopologyAwareBroadcast::torus_broadcast(void* buffer, int count,
         MPI_Datatype datatype, int root,
         MPI_Comm comm) {
-        PerformanceMetrics metrics;
-        auto start_time = MPI_Wtime();
-
-        int world_size, world_rank;
-        MPI_Comm_size(comm, &world_size);
-        MPI_Comm_rank(comm, &world_rank);
-
-        // Assuming 2D torus for simplicity
-        int dim_x = network_config_.topology_params.torus.x;
-        int dim_y = network_config_.topology_params.torus.y;
-
-        int root_x = root % dim_x;
-        int root_y = root / dim_x;
-        int current_x = world_rank % dim_x;
-        int current_y = world_rank / dim_x;
-
-        std::vector<std::pair<int, int>> communication_edges;
-
-        // Phase 1: Broadcast along X dimension (row)
-        if (current_y == root_y) {
-            // Participate in row broadcast
-            MPI_Comm row_comm;
-            MPI_Comm_split(comm, current_y, world_rank, &row_comm);
-
-            int row_root = root_x;
-            PerformanceMetrics row_metrics = binomial_tree_broadcast(buffer, count, datatype,
-                row_root, row_comm);
-
-            communication_edges.insert(communication_edges.end(),
-                row_metrics.communication_edges.begin(),
-                row_metrics.communication_edges.end());
-
-            MPI_Comm_free(&row_comm);
-        }
-
-        // Phase 2: Broadcast along Y dimension (column)
-        MPI_Comm col_comm;
-        MPI_Comm_split(comm, current_x, world_rank, &col_comm);
-
-        int col_root = root_y;
-        PerformanceMetrics col_metrics = binomial_tree_broadcast(buffer, count, datatype,
-            col_root, col_comm);
-
-        communication_edges.insert(communication_edges.end(),
-            col_metrics.communication_edges.begin(),
-            col_metrics.communication_edges.end());
-
-        MPI_Comm_free(&col_comm);
-
-        auto end_time = MPI_Wtime();
-        metrics.execution_time = end_time - start_time;
-        metrics.communication_edges = communication_edges;
-        metrics.messages_sent = communication_edges.size();
-
-        return metrics;
+        // Row/column/plane communicators are cached on comm by the torus
+        // broadcast, so repeated calls no longer split the communicator
+        MultiPortTorusBroadcast torus(network_config_);
+        return torus.broadcast(buffer, count, datatype, root, comm);
     }
 
     PerformanceMetrics TopologyAwareBroadcast::binomial_tree_broadcast(void* buffer, int count,
@@ -352,100 +310,8 @@ namespace TopologyAwareResearch {
     PerformanceMetrics TopologyAwareBroadcast::dragonfly_broadcast(void* buffer, int count,
         MPI_Datatype datatype, int root,
         MPI_Comm comm) {
-        PerformanceMetrics metrics;
-        auto start_time = MPI_Wtime();
-
-        int world_size, world_rank;
-        MPI_Comm_size(comm, &world_size);
-        MPI_Comm_rank(comm, &world_rank);
-
-        // Dragonfly parameters
-        int groups = network_config_.topology_params.dragonfly.groups;
-        int routers_per_group = network_config_.topology_params.dragonfly.routers_per_group;
-        int nodes_per_router = network_config_.topology_params.dragonfly.nodes_per_router;
-
-        // Calculate group and router for each process
-        int group_size = routers_per_group * nodes_per_router;
-        int root_group = root / group_size;
-        int root_router = (root % group_size) / nodes_per_router;
-        int my_group = world_rank / group_size;
-        int my_router = (world_rank % group_size) / nodes_per_router;
-
-        std::vector<std::pair<int, int>> communication_edges;
-
-        // Phase 1: Intra-group broadcast (within root's group)
-        if (my_group == root_group) {
-            // Use hierarchical broadcast within group
-            MPI_Comm group_comm;
-            MPI_Comm_split(comm, my_group, world_rank, &group_comm);
-
-            // Find router leader (lowest rank in router)
-            int router_leader = my_group * group_size + my_router * nodes_per_router;
-
-            if (world_rank == root) {
-                // Send to all routers in group
-                for (int r = 0; r < routers_per_group; r++) {
-                    if (r != root_router) {
-                        int dest_router_leader = my_group * group_size + r * nodes_per_router;
-                        MPI_Send(buffer, count, datatype, dest_router_leader, 0, comm);
-                        communication_edges.emplace_back(world_rank, dest_router_leader);
-                    }
-                }
-            }
-
-            if (world_rank == router_leader && my_router != root_router) {
-                MPI_Recv(buffer, count, datatype, root, 0, comm, MPI_STATUS_IGNORE);
-                communication_edges.emplace_back(root, world_rank);
-            }
-
-            // Broadcast within router
-            MPI_Bcast(buffer, count, datatype, router_leader - my_group * group_size, group_comm);
-            MPI_Comm_free(&group_comm);
-        }
-
-        // Phase 2: Inter-group broadcast
-        if (my_group != root_group) {
-            // Each group receives from one source group
-            int source_group = (my_group > root_group) ? my_group - 1 : my_group + 1;
-            int source_router = 0; // Simplified - use first router for global connection
-
-            if (world_rank == my_group * group_size + my_router * nodes_per_router) {
-                MPI_Recv(buffer, count, datatype,
-                        source_group * group_size + source_router * nodes_per_router,
-                        1, comm, MPI_STATUS_IGNORE);
-                communication_edges.emplace_back(source_group * group_size + source_router * nodes_per_router, world_rank);
-            }
-        }
-
-        if (my_group == root_group) {
-            // Send to neighboring groups
-            for (int g = 0; g < groups; g++) {
-                if (g != root_group) {
-                    int dest_router = 0; // Simplified - use first router for global connection
-                    int dest = g * group_size + dest_router * nodes_per_router;
-                    MPI_Send(buffer, count, datatype, dest, 1, comm);
-                    communication_edges.emplace_back(world_rank, dest);
-                }
-            }
-        }
-
-        // Phase 3: Final intra-group broadcast in receiving groups
-        if (my_group != root_group) {
-            MPI_Comm group_comm;
-            MPI_Comm_split(comm, my_group, world_rank, &group_comm);
-
-            int router_leader = my_group * group_size + my_router * nodes_per_router;
-            MPI_Bcast(buffer, count, datatype,
-                     (world_rank == router_leader) ? 0 : MPI_PROC_NULL, group_comm);
-            MPI_Comm_free(&group_comm);
-        }
-
-        auto end_time = MPI_Wtime();
-        metrics.execution_time = end_time - start_time;
-        metrics.communication_edges = communication_edges;
-        metrics.messages_sent = communication_edges.size();
-
-        return metrics;
+        DragonflyBroadcast dragonfly(network_config_);
+        return dragonfly.broadcast(buffer, count, datatype, root, comm);
     }
 
     PerformanceMetrics TopologyAwareBroadcast::multi_core_broadcast(void* buffer, int count,
@@ -783,58 +649,108 @@ namespace TopologyAwareResearch {
         PerformanceMetrics metrics;
         auto start_time = MPI_Wtime();
 
-        int world_rank, world_size;
+        int world_rank;
         MPI_Comm_rank(comm, &world_rank);
-        MPI_Comm_size(comm, &world_size);
-
-        std::vector<std::pair<int, int>> communication_edges;
-
-        // Phase 1: Create node communicators and perform local reduction
-        MPI_Comm node_comm = create_node_communicator(comm);
-
-        int node_rank, node_size;
-        MPI_Comm_rank(node_comm, &node_rank);
-        MPI_Comm_size(node_comm, &node_size);
-
-        // Local reduction within node
-        void* local_result = (world_rank == 0) ? const_cast<void*>(sendbuf) : recvbuf;
-        PerformanceMetrics local_metrics = ring_allreduce(sendbuf, local_result, count,
-            datatype, op, node_comm);
 
-        communication_edges.insert(communication_edges.end(),
-            local_metrics.communication_edges.begin(),
-            local_metrics.communication_edges.end());
-
-        // Phase 2: Global reduction across nodes
-        if (node_rank == 0) {
-            MPI_Comm inter_node_comm = create_inter_node_communicator(comm);
-
-            if (inter_node_comm != MPI_COMM_NULL) {
-                int inter_rank, inter_size;
-                MPI_Comm_rank(inter_node_comm, &inter_rank);
-                MPI_Comm_size(inter_node_comm, &inter_size);
+        const NodeCommunicators& node = CommunicatorCache::node(comm, network_config_.node_mapping);
+        int node_size = node.node_sizes[node.node_index];
+        std::vector<int> leader_world_ranks(node.node_count);
+        int node_begin = 0;
+        for (int n = 0, position = 0; n < node.node_count; position += node.node_sizes[n++]) {
+            leader_world_ranks[n] = node.node_order[position];
+            if (n == node.node_index) {
+                node_begin = position;
+            }
+        }
+        int leader_world_rank = leader_world_ranks[node.node_index];
 
-                // Perform global reduction among node leaders
-                PerformanceMetrics global_metrics = ring_allreduce(local_result, recvbuf, count,
-                    datatype, op, inter_node_comm);
+        MPI_Aint lower_bound, extent;
+        MPI_Type_get_extent(datatype, &lower_bound, &extent);
+        const char* input = static_cast<const char*>(sendbuf == MPI_IN_PLACE ? recvbuf : sendbuf);
+        size_t bytes = static_cast<size_t>(count) * extent;
 
-                communication_edges.insert(communication_edges.end(),
-                    global_metrics.communication_edges.begin(),
-                    global_metrics.communication_edges.end());
+        std::vector<std::pair<int, int>> communication_edges;
+        if (!node.is_leader()) {
+            communication_edges.emplace_back(world_rank, leader_world_rank);
+        }
 
-                MPI_Comm_free(&inter_node_comm);
+        auto leader_allreduce = [&](void* buffer) {
+            if (node.is_leader() && node.node_count > 1) {
+                PerformanceMetrics global_metrics = fused_ring_allreduce(MPI_IN_PLACE, buffer, count,
+                    datatype, op, node.leader_comm);
+                metrics.messages_sent += global_metrics.messages_sent;
+                metrics.bytes_transferred += global_metrics.bytes_transferred;
+                for (const auto& edge : global_metrics.communication_edges) {
+                    communication_edges.emplace_back(leader_world_ranks[edge.first], leader_world_ranks[edge.second]);
+                }
+            }
+        };
+
+        if (CommunicatorCache::node_shares_memory(comm, network_config_.node_mapping)) {
+            // Phase 1: every rank publishes its input, then reduces one slice
+            // of all node inputs into the leader's segment in a single k-way
+            // pass, so the node's reduction is spread over all its cores and
+            // each slice of the result is written once
+            const NodeSharedSegments& shared = CommunicatorCache::node_segments(comm,
+                network_config_.node_mapping, std::max<MPI_Aint>(1, bytes));
+            bulk_copy(shared.segments[node.node_rank], input, bytes);
+            MPI_Win_sync(shared.window);
+            MPI_Barrier(node.node_comm);
+            MPI_Win_sync(shared.window);
+
+            int slice = (count + node_size - 1) / node_size;
+            int first = std::min(count, node.node_rank * slice);
+            int length = std::min(slice, count - first);
+            if (length > 0) {
+                MPI_Aint offset = static_cast<MPI_Aint>(first) * extent;
+                std::vector<const void*> sources(node_size);
+                for (int i = 0; i < node_size; ++i) {
+                    sources[i] = shared.segments[i] + offset;
+                }
+                ReductionKernel reduce_kernel = resolve_reduction_kernel(datatype, op);
+                reduce_kernel.stream_for_total(bytes);
+                reduce_kernel.combine_many(shared.segments[0] + offset, sources.data(), node_size, length);
             }
+            MPI_Win_sync(shared.window);
+            MPI_Barrier(node.node_comm);
+            MPI_Win_sync(shared.window);
+
+            // Phase 2: leaders combine the node results in place
+            leader_allreduce(shared.segments[0]);
+            MPI_Win_sync(shared.window);
+            MPI_Barrier(node.node_comm);
+            MPI_Win_sync(shared.window);
+
+            // Phase 3: everyone copies the result out; the leader's segment
+            // must not be refilled by the next call before that is done
+            bulk_copy(recvbuf, shared.segments[0], bytes);
+            MPI_Barrier(node.node_comm);
         }
+        else {
+            // Phase 1: flat pipelined tree into the leader, which folds all
+            // members' segments in one k-way pass
+            TreeLink parent = { node.node_comm, 0, leader_world_rank };
+            std::vector<TreeLink> children;
+            if (node.is_leader()) {
+                for (int i = 1; i < node_size; ++i) {
+                    children.push_back({ node.node_comm, i, node.node_order[node_begin + i] });
+                }
+            }
+            PerformanceMetrics local_metrics = pipelined_tree_reduce(sendbuf, recvbuf, count, datatype, op,
+                node.node_comm, !node.is_leader(), parent, children, segment_size_);
+            metrics.messages_sent += local_metrics.messages_sent;
+            metrics.bytes_transferred += local_metrics.bytes_transferred;
 
-        // Phase 3: Broadcast result within nodes
-        MPI_Bcast(recvbuf, count, datatype, 0, node_comm);
+            // Phase 2: global reduction among node leaders
+            leader_allreduce(recvbuf);
 
-        MPI_Comm_free(&node_comm);
+            // Phase 3: broadcast result within nodes
+            MPI_Bcast(recvbuf, count, datatype, 0, node.node_comm);
+        }
 
         auto end_time = MPI_Wtime();
         metrics.execution_time = end_time - start_time;
         metrics.communication_edges = communication_edges;
-        metrics.messages_sent = communication_edges.size();
 
         return metrics;
     }
@@ -842,54 +758,8 @@ namespace TopologyAwareResearch {
     PerformanceMetrics HierarchicalAllreduce::ring_allreduce(const void* sendbuf, void* recvbuf,
         int count, MPI_Datatype datatype,
         MPI_Op op, MPI_Comm comm) {
-        PerformanceMetrics metrics;
-        auto start_time = MPI_Wtime();
-
-        int world_rank, world_size;
-        MPI_Comm_rank(comm, &world_rank);
-        MPI_Comm_size(comm, &world_size);
-
-        if (world_size == 1) {
-            if (sendbuf != MPI_IN_PLACE) {
-                memcpy(recvbuf, sendbuf, count * sizeof(double)); // Assuming double
-            }
-            metrics.execution_time = 0.0;
-            return metrics;
-        }
-
-        int type_size;
-        MPI_Type_size(datatype, &type_size);
-        int total_bytes = count * type_size;
-
-        // Use segmented approach for large messages
-        int segments = std::max(1, total_bytes / segment_size_);
-        int segment_elements = count / segments;
-        int remaining = count % segments;
-
-        std::vector<std::pair<int, int>> communication_edges;
-
-        // Ring allreduce implementation
-        // Phase 1: Reduce-scatter
-        // Phase 2: Allgather
-
-        // Simplified implementation - in practice this would be more sophisticated
-        for (int step = 0; step < world_size - 1; ++step) {
-            int send_to = (world_rank + 1) % world_size;
-            int recv_from = (world_rank - 1 + world_size) % world_size;
-
-            MPI_Send(recvbuf, count, datatype, send_to, 0, comm);
-            MPI_Recv(recvbuf, count, datatype, recv_from, 0, comm, MPI_STATUS_IGNORE);
-
-            communication_edges.emplace_back(world_rank, send_to);
-            communication_edges.emplace_back(recv_from, world_rank);
-        }
-
-        auto end_time = MPI_Wtime();
-        metrics.execution_time = end_time - start_time;
-        metrics.communication_edges = communication_edges;
-        metrics.messages_sent = communication_edges.size();
-
-        return metrics;
+        // Reduce-scatter + allgather ring combining straight from sendbuf
+        return fused_ring_allreduce(sendbuf, recvbuf, count, datatype, op, comm);
     }
 
     PerformanceMetrics HierarchicalAllreduce::three_level_allreduce(const void* sendbuf, void* recvbuf,
@@ -911,8 +781,12 @@ namespace TopologyAwareResearch {
         MPI_Comm_rank(node_comm, &node_rank);
         MPI_Comm_size(node_comm, &node_size);
 
-        void* node_result = (node_rank == 0) ? malloc(count * get_mpi_type_size(datatype)) : nullptr;
-        MPI_Reduce(sendbuf, node_result, count, datatype, op, 0, node_comm);
+        size_t bytes = static_cast<size_t>(count) * get_mpi_type_size(datatype);
+        ScratchBuffer node_result;
+        if (node_rank == 0) {
+            node_result = ScratchPool::local().acquire(bytes);
+        }
+        MPI_Reduce(sendbuf, node_result.data(), count, datatype, op, 0, node_comm);
 
         // Step 2: Rack-level reduction (if applicable)
         MPI_Comm rack_comm = create_rack_communicator(comm);
@@ -921,11 +795,14 @@ namespace TopologyAwareResearch {
             MPI_Comm_rank(rack_comm, &rack_rank);
             MPI_Comm_size(rack_comm, &rack_size);
 
-            void* rack_result = (rack_rank == 0) ? malloc(count * get_mpi_type_size(datatype)) : nullptr;
+            ScratchBuffer rack_result;
+            if (rack_rank == 0) {
+                rack_result = ScratchPool::local().acquire(bytes);
+            }
             if (node_rank == 0) {
-                MPI_Reduce(node_result, rack_result, count, datatype, op, 0, rack_comm);
+                MPI_Reduce(node_result.data(), rack_result.data(), count, datatype, op, 0, rack_comm);
             } else {
-                MPI_Reduce(nullptr, rack_result, count, datatype, op, 0, rack_comm);
+                MPI_Reduce(nullptr, rack_result.data(), count, datatype, op, 0, rack_comm);
             }
 
             // Step 3: Global reduction among rack leaders
@@ -936,35 +813,29 @@ namespace TopologyAwareResearch {
                 MPI_Comm_rank(global_comm, &global_rank);
                 MPI_Comm_size(global_comm, &global_size);
 
-                void* global_result = (global_rank == 0) ? malloc(count * get_mpi_type_size(datatype)) : nullptr;
+                ScratchBuffer global_result;
+                if (global_rank == 0) {
+                    global_result = ScratchPool::local().acquire(bytes);
+                }
                 if (rack_rank == 0) {
-                    MPI_Reduce(rack_result, global_result, count, datatype, op, 0, global_comm);
+                    MPI_Reduce(rack_result.data(), global_result.data(), count, datatype, op, 0, global_comm);
                 } else {
-                    MPI_Reduce(nullptr, global_result, count, datatype, op, 0, global_comm);
+                    MPI_Reduce(nullptr, global_result.data(), count, datatype, op, 0, global_comm);
                 }
 
                 // Broadcast back through the hierarchy
                 if (global_rank == 0) {
-                    memcpy(recvbuf, global_result, count * get_mpi_type_size(datatype));
+                    memcpy(recvbuf, global_result.data(), bytes);
                 }
 
                 MPI_Bcast(recvbuf, count, datatype, 0, global_comm);
 
-                if (global_rank == 0) {
-                    free(global_result);
-                }
                 MPI_Comm_free(&global_comm);
             }
 
-            if (rack_rank == 0) {
-                free(rack_result);
-            }
             MPI_Comm_free(&rack_comm);
         }
 
-        if (node_rank == 0) {
-            free(node_result);
-        }
         MPI_Comm_free(&node_comm);
 
         auto end_time = MPI_Wtime();
@@ -983,59 +854,31 @@ namespace TopologyAwareResearch {
         MPI_Comm_size(comm, &size);
 
         // Determine optimal segment size based on network characteristics
-        int segment_size = calculate_optimal_segment_size(count, size, network_config_);
+        int segment_size = std::max(1, calculate_optimal_segment_size(count, size, network_config_));
         int segments = (count + segment_size - 1) / segment_size;
 
-        // Temporary buffer for segments
-        std::vector<char> temp_buffer(count * get_mpi_type_size(datatype));
-        char* temp_ptr = temp_buffer.data();
-
-        // Copy sendbuf to recvbuf for reduction
-        if (sendbuf != MPI_IN_PLACE) {
-            memcpy(recvbuf, sendbuf, count * get_mpi_type_size(datatype));
-        }
+        MPI_Aint lower_bound, extent;
+        MPI_Type_get_extent(datatype, &lower_bound, &extent);
+        const char* input = static_cast<const char*>(sendbuf);
+        char* output = static_cast<char*>(recvbuf);
 
         std::vector<std::pair<int, int>> communication_edges;
 
-        // Segmented ring allreduce
+        // One ring allreduce per segment; each reads its slice of sendbuf
+        // directly, so nothing is copied to recvbuf beforehand
         for (int seg = 0; seg < segments; seg++) {
             int seg_start = seg * segment_size;
             int seg_count = std::min(segment_size, count - seg_start);
+            MPI_Aint offset = static_cast<MPI_Aint>(seg_start) * extent;
 
-            // Reduction phase
-            for (int step = 0; step < size - 1; step++) {
-                int send_to = (rank + 1) % size;
-                int recv_from = (rank - 1 + size) % size;
-
-                // Send segment to next process
-                MPI_Send(reinterpret_cast<char*>(recvbuf) + seg_start * get_mpi_type_size(datatype),
-                        seg_count, datatype, send_to, seg * 1000 + step, comm);
+            PerformanceMetrics segment_metrics = fused_ring_allreduce(
+                sendbuf == MPI_IN_PLACE ? MPI_IN_PLACE : input + offset, output + offset,
+                seg_count, datatype, op, comm);
 
-                // Receive segment from previous process
-                MPI_Recv(temp_ptr, seg_count, datatype, recv_from, seg * 1000 + step, comm,
-                        MPI_STATUS_IGNORE);
-
-                // Reduce received segment using the comprehensive reduction function
-                reduce_segments(recvbuf, temp_ptr, seg_start, seg_count, datatype, op);
-
-                communication_edges.emplace_back(rank, send_to);
-                communication_edges.emplace_back(recv_from, rank);
-            }
-
-            // Distribution phase (similar but in reverse)
-            for (int step = 0; step < size - 1; step++) {
-                int send_to = (rank - 1 + size) % size;
-                int recv_from = (rank + 1) % size;
-
-                MPI_Send(reinterpret_cast<char*>(recvbuf) + seg_start * get_mpi_type_size(datatype),
-                        seg_count, datatype, send_to, seg * 2000 + step, comm);
-
-                MPI_Recv(reinterpret_cast<char*>(recvbuf) + seg_start * get_mpi_type_size(datatype),
-                        seg_count, datatype, recv_from, seg * 2000 + step, comm,
-                        MPI_STATUS_IGNORE);
-
-                communication_edges.emplace_back(rank, send_to);
-                communication_edges.emplace_back(recv_from, rank);
+            metrics.messages_sent += segment_metrics.messages_sent;
+            metrics.bytes_transferred += segment_metrics.bytes_transferred;
+            if (communication_edges.empty()) {
+                communication_edges = segment_metrics.communication_edges;
             }
         }
 
@@ -1043,9 +886,7 @@ namespace TopologyAwareResearch {
         metrics.execution_time = end_time - start_time;
         metrics.communication_time = metrics.execution_time * 0.8;
         metrics.computation_time = metrics.execution_time * 0.2;
-        metrics.bytes_transferred = 2 * (size - 1) * count * get_mpi_type_size(datatype);
         metrics.communication_edges = communication_edges;
-        metrics.messages_sent = communication_edges.size();
 
         return metrics;
     }
@@ -1177,12 +1018,44 @@ namespace TopologyAwareResearch {
         PerformanceMetrics metrics;
         auto start_time = MPI_Wtime();
 
-        // Use native MPI for now - could be extended with topology-aware versions
-        MPI_Allgather(sendbuf, count, datatype, recvbuf, count, datatype, comm);
+        int type_size;
+        MPI_Type_size(datatype, &type_size);
+
+        // Allgather selection works on block bytes rather than element count
+        AlgorithmType algo = select_algorithm(2, count * type_size, comm); // 2 for allgather
+
+        TopologyAwareAllgather allgather(network_config_);
+        metrics = allgather.execute(algo, sendbuf, recvbuf, count, datatype, comm);
 
         auto end_time = MPI_Wtime();
         metrics.execution_time = end_time - start_time;
 
+        // Update performance model
+        update_performance_model(algo, metrics);
+
+        return metrics;
+    }
+
+    PerformanceMetrics AdaptiveCollective::adaptive_scan(const void* sendbuf, void* recvbuf,
+        int count, MPI_Datatype datatype,
+        MPI_Op op, MPI_Comm comm, bool exclusive) {
+        PerformanceMetrics metrics;
+        auto start_time = MPI_Wtime();
+
+        int type_size;
+        MPI_Type_size(datatype, &type_size);
+
+        AlgorithmType algo = select_algorithm(3, count * type_size, comm); // 3 for scan/exscan
+
+        TopologyAwareScan scan(network_config_);
+        metrics = scan.execute(algo, exclusive, sendbuf, recvbuf, count, datatype, op, comm);
+
+        auto end_time = MPI_Wtime();
+        metrics.execution_time = end_time - start_time;
+
+        // Update performance model
+        update_performance_model(algo, metrics);
+
         return metrics;
     }
 
@@ -1201,12 +1074,16 @@ namespace TopologyAwareResearch {
             } else {
                 return AlgorithmType::PIPELINE_RING;
             }
-        } else { // Allreduce
+        } else if (operation_type == 1) { // Allreduce
             if (message_size < 8192 || world_size <= 8) {
                 return AlgorithmType::RING_ALLREDUCE;
             } else {
                 return AlgorithmType::ADAPTIVE_ALLREDUCE;
             }
+        } else if (operation_type == 2) { // Allgather, message_size is the per-rank block in bytes
+            return TopologyAwareAllgather(network_config_).select_algorithm(message_size, world_size);
+        } else { // Scan/exscan
+            return TopologyAwareScan(network_config_).select_algorithm(world_size);
         }
     }
 
@@ -1238,6 +1115,23 @@ namespace TopologyAwareResearch {
             return world_size * std::log2(world_size) * message_size * 0.0001;
         case AlgorithmType::PIPELINE_RING:
             return (world_size - 1) * message_size * 0.0001;
+        case AlgorithmType::RING_ALLGATHER:
+            return (world_size - 1) * (0.001 + message_size * 0.0001);
+        case AlgorithmType::RECURSIVE_DOUBLING_ALLGATHER:
+        case AlgorithmType::BRUCK_ALLGATHER:
+            return std::ceil(std::log2(world_size)) * 0.001 + (world_size - 1) * message_size * 0.0001;
+        case AlgorithmType::HIERARCHICAL_ALLGATHER: {
+            int nodes = std::max(1, network_config_.total_nodes);
+            return (std::ceil(std::log2(nodes)) + 2) * 0.001 + (world_size - 1) * message_size * 0.0001;
+        }
+        case AlgorithmType::RECURSIVE_DOUBLING_SCAN:
+            return std::ceil(std::log2(world_size)) * (0.001 + message_size * 0.0001);
+        case AlgorithmType::HIERARCHICAL_SCAN: {
+            int nodes = std::max(1, network_config_.total_nodes);
+            int per_node = std::max(1, world_size / nodes);
+            return (2 * std::ceil(std::log2(per_node)) + std::ceil(std::log2(nodes)) + 1) *
+                (0.001 + message_size * 0.0001);
+        }
         default:
             return message_size * 0.0001;
         }
@@ -1288,11 +1182,23 @@ namespace TopologyAwareResearch {
                 AlgorithmType::PIPELINE_RING,
                 AlgorithmType::TOPOLOGY_AWARE_BROADCAST
             };
-        } else { // Allreduce
+        } else if (operation_type == 1) { // Allreduce
             candidates = {
                 AlgorithmType::RING_ALLREDUCE,
                 AlgorithmType::ADAPTIVE_ALLREDUCE
             };
+        } else if (operation_type == 2) { // Allgather
+            candidates = {
+                AlgorithmType::RING_ALLGATHER,
+                AlgorithmType::RECURSIVE_DOUBLING_ALLGATHER,
+                AlgorithmType::BRUCK_ALLGATHER,
+                AlgorithmType::HIERARCHICAL_ALLGATHER
+            };
+        } else { // Scan/exscan
+            candidates = {
+                AlgorithmType::RECURSIVE_DOUBLING_SCAN,
+                AlgorithmType::HIERARCHICAL_SCAN
+            };
         }
 
         return candidates;
@@ -157,6 +157,10 @@ namespace TopologyAwareResearch {
             int count, MPI_Datatype datatype,
             MPI_Comm comm);
 
+        PerformanceMetrics adaptive_scan(const void* sendbuf, void* recvbuf,
+            int count, MPI_Datatype datatype,
+            MPI_Op op, MPI_Comm comm, bool exclusive = false);
+
         // Adaptation logic
         AlgorithmType select_algorithm(int operation_type, int message_size,
             MPI_Comm comm);
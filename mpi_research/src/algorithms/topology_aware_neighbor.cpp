@@ -0,0 +1,429 @@
+#include "topology_aware_neighbor.h"
+#include "../core/scratch_pool.h"
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <map>
+#include <numeric>
+
+namespace TopologyAwareResearch {
+
+    namespace {
+        const int kNeighborTag = 16;
+
+        // Table entry at the start of a rank's shared segment, describing one
+        // block it hands over to a rank of the same node
+        struct OutboxEntry {
+            int receiver;
+            int sender;      // Original sender (differs from the owner for forwarded blocks)
+            int occurrence;  // Which of the sender's edges to the receiver
+            int bytes;
+            MPI_Aint offset; // From the start of the segment
+        };
+    }
+
+    TopologyAwareNeighbor::TopologyAwareNeighbor(const NetworkCharacteristics& config)
+        : network_config_(config) {
+    }
+
+    TopologyAwareNeighbor::~TopologyAwareNeighbor() {}
+
+    MPI_Comm TopologyAwareNeighbor::create_halo_graph(MPI_Comm comm, int stencil_points) const {
+        int world_size, world_rank;
+        MPI_Comm_size(comm, &world_size);
+        MPI_Comm_rank(comm, &world_rank);
+
+        std::vector<int> neighbors = halo_neighbors(world_rank, world_size, stencil_points);
+        int degree = static_cast<int>(neighbors.size());
+
+        MPI_Comm graph_comm;
+        MPI_Dist_graph_create_adjacent(comm, degree, neighbors.data(), MPI_UNWEIGHTED,
+            degree, neighbors.data(), MPI_UNWEIGHTED, MPI_INFO_NULL, 0, &graph_comm);
+        return graph_comm;
+    }
+
+    std::vector<int> TopologyAwareNeighbor::halo_neighbors(int rank, int world_size, int stencil_points) const {
+        int dims[3];
+        std::vector<int> rank_of_cell = halo_layout(world_size, dims);
+        int cell = static_cast<int>(std::find(rank_of_cell.begin(), rank_of_cell.end(), rank) - rank_of_cell.begin());
+        int coords[3] = { cell % dims[0], (cell / dims[0]) % dims[1], cell / (dims[0] * dims[1]) };
+
+        // Offsets further than this many axes away are not part of the stencil
+        int max_axes = (stencil_points <= 6) ? 1 : (stencil_points <= 18) ? 2 : 3;
+
+        std::vector<int> neighbors;
+        for (int dz = -1; dz <= 1; ++dz) {
+            for (int dy = -1; dy <= 1; ++dy) {
+                for (int dx = -1; dx <= 1; ++dx) {
+                    int axes = std::abs(dx) + std::abs(dy) + std::abs(dz);
+                    if (axes == 0 || axes > max_axes) {
+                        continue;
+                    }
+                    int x = (coords[0] + dx + dims[0]) % dims[0];
+                    int y = (coords[1] + dy + dims[1]) % dims[1];
+                    int z = (coords[2] + dz + dims[2]) % dims[2];
+                    neighbors.push_back(rank_of_cell[x + dims[0] * (y + dims[1] * z)]);
+                }
+            }
+        }
+        return neighbors;
+    }
+
+    std::vector<int> TopologyAwareNeighbor::halo_layout(int world_size, int dims[3]) const {
+        std::vector<int> rank_of_cell(world_size);
+
+        const std::vector<int>& node_mapping = network_config_.node_mapping;
+        if (static_cast<int>(node_mapping.size()) == world_size) {
+            std::map<int, std::vector<int>> members;
+            for (int i = 0; i < world_size; ++i) {
+                members[node_mapping[i]].push_back(i);
+            }
+            int nodes = static_cast<int>(members.size());
+            int ranks_per_node = world_size / nodes;
+            bool uniform = std::all_of(members.begin(), members.end(), [&](const auto& item) {
+                return static_cast<int>(item.second.size()) == ranks_per_node;
+            });
+
+            if (uniform && nodes > 1 && ranks_per_node > 1) {
+                // Nodes on the detected torus when it matches, otherwise a
+                // balanced grid; each node's ranks fill one block of cells
+                int node_dims[3] = { 0, 0, 0 };
+                const auto& torus = network_config_.topology_params.torus;
+                bool is_torus = network_config_.topology == NetworkTopology::TORUS_2D ||
+                    network_config_.topology == NetworkTopology::TORUS_3D;
+                int torus_z = std::max(torus.z, 1);
+                if (is_torus && torus.x > 0 && torus.y > 0 && torus.x * torus.y * torus_z == nodes) {
+                    node_dims[0] = torus.x;
+                    node_dims[1] = torus.y;
+                    node_dims[2] = torus_z;
+                }
+                else {
+                    MPI_Dims_create(nodes, 3, node_dims);
+                }
+                int local_dims[3] = { 0, 0, 0 };
+                MPI_Dims_create(ranks_per_node, 3, local_dims);
+                for (int a = 0; a < 3; ++a) {
+                    dims[a] = node_dims[a] * local_dims[a];
+                }
+
+                int node_index = 0;
+                for (const auto& item : members) {
+                    int node_coords[3] = { node_index % node_dims[0], (node_index / node_dims[0]) % node_dims[1],
+                        node_index / (node_dims[0] * node_dims[1]) };
+                    for (int local = 0; local < ranks_per_node; ++local) {
+                        int local_coords[3] = { local % local_dims[0], (local / local_dims[0]) % local_dims[1],
+                            local / (local_dims[0] * local_dims[1]) };
+                        int x = node_coords[0] * local_dims[0] + local_coords[0];
+                        int y = node_coords[1] * local_dims[1] + local_coords[1];
+                        int z = node_coords[2] * local_dims[2] + local_coords[2];
+                        rank_of_cell[x + dims[0] * (y + dims[1] * z)] = item.second[local];
+                    }
+                    ++node_index;
+                }
+                return rank_of_cell;
+            }
+        }
+
+        dims[0] = dims[1] = dims[2] = 0;
+        MPI_Dims_create(world_size, 3, dims);
+        std::iota(rank_of_cell.begin(), rank_of_cell.end(), 0);
+        return rank_of_cell;
+    }
+
+    PerformanceMetrics TopologyAwareNeighbor::neighbor_allgather(const void* sendbuf, int sendcount,
+        MPI_Datatype sendtype, void* recvbuf, int recvcount, MPI_Datatype recvtype, MPI_Comm comm) {
+        return execute(select_algorithm(comm), sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype, comm);
+    }
+
+    PerformanceMetrics TopologyAwareNeighbor::neighbor_alltoallv(const void* sendbuf, const int* sendcounts,
+        const int* sdispls, MPI_Datatype sendtype, void* recvbuf, const int* recvcounts, const int* rdispls,
+        MPI_Datatype recvtype, MPI_Comm comm) {
+        return execute(select_algorithm(comm), sendbuf, sendcounts, sdispls, sendtype,
+            recvbuf, recvcounts, rdispls, recvtype, comm);
+    }
+
+    PerformanceMetrics TopologyAwareNeighbor::execute(AlgorithmType algo, const void* sendbuf, int sendcount,
+        MPI_Datatype sendtype, void* recvbuf, int recvcount, MPI_Datatype recvtype, MPI_Comm comm) {
+        if (algo != AlgorithmType::DIRECT_NEIGHBOR && algo != AlgorithmType::AGGREGATED_NEIGHBOR) {
+            PerformanceMetrics metrics;
+            auto start_time = MPI_Wtime();
+            MPI_Neighbor_allgather(sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype, comm);
+            metrics.execution_time = MPI_Wtime() - start_time;
+            return metrics;
+        }
+
+        int indegree, outdegree, weighted;
+        MPI_Dist_graph_neighbors_count(comm, &indegree, &outdegree, &weighted);
+
+        MPI_Aint lower_bound, send_extent, recv_extent;
+        MPI_Type_get_extent(sendtype, &lower_bound, &send_extent);
+        MPI_Type_get_extent(recvtype, &lower_bound, &recv_extent);
+
+        // The same block goes to every destination
+        NeighborBlocks blocks;
+        blocks.send.assign(outdegree, static_cast<const char*>(sendbuf));
+        blocks.send_bytes.assign(outdegree, static_cast<int>(sendcount * send_extent));
+        blocks.recv_bytes.assign(indegree, static_cast<int>(recvcount * recv_extent));
+        for (int j = 0; j < indegree; ++j) {
+            blocks.recv.push_back(static_cast<char*>(recvbuf) + j * recvcount * recv_extent);
+        }
+
+        return run(algo, blocks, comm);
+    }
+
+    PerformanceMetrics TopologyAwareNeighbor::execute(AlgorithmType algo, const void* sendbuf,
+        const int* sendcounts, const int* sdispls, MPI_Datatype sendtype,
+        void* recvbuf, const int* recvcounts, const int* rdispls,
+        MPI_Datatype recvtype, MPI_Comm comm) {
+        if (algo != AlgorithmType::DIRECT_NEIGHBOR && algo != AlgorithmType::AGGREGATED_NEIGHBOR) {
+            PerformanceMetrics metrics;
+            auto start_time = MPI_Wtime();
+            MPI_Neighbor_alltoallv(sendbuf, sendcounts, sdispls, sendtype,
+                recvbuf, recvcounts, rdispls, recvtype, comm);
+            metrics.execution_time = MPI_Wtime() - start_time;
+            return metrics;
+        }
+
+        int indegree, outdegree, weighted;
+        MPI_Dist_graph_neighbors_count(comm, &indegree, &outdegree, &weighted);
+
+        MPI_Aint lower_bound, send_extent, recv_extent;
+        MPI_Type_get_extent(sendtype, &lower_bound, &send_extent);
+        MPI_Type_get_extent(recvtype, &lower_bound, &recv_extent);
+
+        NeighborBlocks blocks;
+        for (int i = 0; i < outdegree; ++i) {
+            blocks.send.push_back(static_cast<const char*>(sendbuf) + sdispls[i] * send_extent);
+            blocks.send_bytes.push_back(static_cast<int>(sendcounts[i] * send_extent));
+        }
+        for (int j = 0; j < indegree; ++j) {
+            blocks.recv.push_back(static_cast<char*>(recvbuf) + rdispls[j] * recv_extent);
+            blocks.recv_bytes.push_back(static_cast<int>(recvcounts[j] * recv_extent));
+        }
+
+        return run(algo, blocks, comm);
+    }
+
+    AlgorithmType TopologyAwareNeighbor::select_algorithm(MPI_Comm comm) const {
+        const NodeCommunicators& node = CommunicatorCache::node(comm, network_config_.node_mapping);
+        bool shared_node = std::any_of(node.node_sizes.begin(), node.node_sizes.end(),
+            [](int ranks) { return ranks > 1; });
+        if (shared_node && CommunicatorCache::node_shares_memory(comm, network_config_.node_mapping)) {
+            return AlgorithmType::AGGREGATED_NEIGHBOR;
+        }
+        return AlgorithmType::DIRECT_NEIGHBOR;
+    }
+
+    PerformanceMetrics TopologyAwareNeighbor::run(AlgorithmType algo, const NeighborBlocks& blocks, MPI_Comm comm) {
+        PerformanceMetrics metrics;
+        auto start_time = MPI_Wtime();
+
+        int messages = (algo == AlgorithmType::AGGREGATED_NEIGHBOR) ? aggregated_exchange(blocks, comm)
+            : direct_exchange(blocks, comm);
+
+        auto end_time = MPI_Wtime();
+        metrics.execution_time = end_time - start_time;
+        metrics.communication_time = metrics.execution_time;
+        metrics.messages_sent = messages;
+        metrics.bytes_transferred = std::accumulate(blocks.send_bytes.begin(), blocks.send_bytes.end(), 0LL);
+
+        int world_rank;
+        MPI_Comm_rank(comm, &world_rank);
+        for (int destination : CommunicatorCache::graph_destinations(comm)[world_rank]) {
+            metrics.communication_edges.emplace_back(world_rank, destination);
+        }
+
+        return metrics;
+    }
+
+    int TopologyAwareNeighbor::direct_exchange(const NeighborBlocks& blocks, MPI_Comm comm) {
+        int indegree = static_cast<int>(blocks.recv.size());
+        int outdegree = static_cast<int>(blocks.send.size());
+        std::vector<int> sources(indegree), destinations(outdegree);
+        MPI_Dist_graph_neighbors(comm, indegree, sources.data(), MPI_UNWEIGHTED,
+            outdegree, destinations.data(), MPI_UNWEIGHTED);
+
+        // Posting in list order keeps repeated edges matched in order
+        std::vector<MPI_Request> requests(indegree + outdegree);
+        for (int j = 0; j < indegree; ++j) {
+            MPI_Irecv(blocks.recv[j], blocks.recv_bytes[j], MPI_BYTE, sources[j], kNeighborTag,
+                comm, &requests[j]);
+        }
+        for (int i = 0; i < outdegree; ++i) {
+            MPI_Isend(blocks.send[i], blocks.send_bytes[i], MPI_BYTE, destinations[i], kNeighborTag,
+                comm, &requests[indegree + i]);
+        }
+        MPI_Waitall(static_cast<int>(requests.size()), requests.data(), MPI_STATUSES_IGNORE);
+
+        return outdegree;
+    }
+
+    int TopologyAwareNeighbor::aggregated_exchange(const NeighborBlocks& blocks, MPI_Comm comm) const {
+        const std::vector<int>& node_mapping = network_config_.node_mapping;
+        if (!CommunicatorCache::node_shares_memory(comm, node_mapping)) {
+            return direct_exchange(blocks, comm);
+        }
+
+        int world_size, world_rank;
+        MPI_Comm_size(comm, &world_size);
+        MPI_Comm_rank(comm, &world_rank);
+
+        const NodeCommunicators& node = CommunicatorCache::node(comm, node_mapping);
+        const std::vector<std::vector<int>>& graph = CommunicatorCache::graph_destinations(comm);
+
+        int indegree = static_cast<int>(blocks.recv.size());
+        int outdegree = static_cast<int>(blocks.send.size());
+        std::vector<int> sources(indegree), destinations(outdegree);
+        MPI_Dist_graph_neighbors(comm, indegree, sources.data(), MPI_UNWEIGHTED,
+            outdegree, destinations.data(), MPI_UNWEIGHTED);
+
+        // Node and node_comm rank of every rank
+        std::vector<int> node_of(world_size), node_rank_of(world_size);
+        int position = 0;
+        for (int n = 0; n < node.node_count; ++n) {
+            for (int i = 0; i < node.node_sizes[n]; ++i, ++position) {
+                node_of[node.node_order[position]] = n;
+                node_rank_of[node.node_order[position]] = i;
+            }
+        }
+
+        // Every rank can work out any sender's proxy from the cached graph
+        auto proxy_of = [&](int sender, int target_node) {
+            int proxy = world_size;
+            for (int destination : graph[sender]) {
+                if (node_of[destination] == target_node) {
+                    proxy = std::min(proxy, destination);
+                }
+            }
+            return proxy;
+        };
+
+        std::vector<OutboxEntry> entries;
+        std::vector<const char*> entry_data;
+
+        // Step 1: blocks for this node go to the outbox; the rest is packed
+        // per destination node as block sizes followed by the blocks
+        std::map<int, std::vector<int>> remote_blocks;
+        std::map<int, int> occurrences;
+        for (int i = 0; i < outdegree; ++i) {
+            int destination = destinations[i];
+            int occurrence = occurrences[destination]++;
+            if (node_of[destination] == node.node_index) {
+                entries.push_back({ destination, world_rank, occurrence, blocks.send_bytes[i], 0 });
+                entry_data.push_back(blocks.send[i]);
+            }
+            else {
+                remote_blocks[node_of[destination]].push_back(i);
+            }
+        }
+
+        std::vector<ScratchBuffer> packed;
+        std::vector<MPI_Request> requests;
+        for (const auto& item : remote_blocks) {
+            const std::vector<int>& indices = item.second;
+            size_t total = indices.size() * sizeof(int);
+            for (int i : indices) {
+                total += blocks.send_bytes[i];
+            }
+
+            packed.push_back(ScratchPool::local().acquire(total));
+            char* out = packed.back().data();
+            for (int i : indices) {
+                std::memcpy(out, &blocks.send_bytes[i], sizeof(int));
+                out += sizeof(int);
+            }
+            for (int i : indices) {
+                std::memcpy(out, blocks.send[i], blocks.send_bytes[i]);
+                out += blocks.send_bytes[i];
+            }
+
+            requests.emplace_back();
+            MPI_Isend(packed.back().data(), static_cast<int>(total), MPI_BYTE, proxy_of(world_rank, item.first),
+                kNeighborTag, comm, &requests.back());
+        }
+
+        // Step 2: as a proxy, unpack what other nodes sent for this node
+        std::vector<ScratchBuffer> forwarded;
+        for (int sender = 0; sender < world_size; ++sender) {
+            if (node_of[sender] == node.node_index || proxy_of(sender, node.node_index) != world_rank) {
+                continue;
+            }
+
+            MPI_Status status;
+            int bytes;
+            MPI_Probe(sender, kNeighborTag, comm, &status);
+            MPI_Get_count(&status, MPI_BYTE, &bytes);
+            forwarded.push_back(ScratchPool::local().acquire(bytes));
+            MPI_Recv(forwarded.back().data(), bytes, MPI_BYTE, sender, kNeighborTag, comm, MPI_STATUS_IGNORE);
+
+            // Blocks follow the sender's destination order
+            std::vector<std::pair<int, int>> pieces;
+            std::map<int, int> sender_occurrences;
+            for (int destination : graph[sender]) {
+                int occurrence = sender_occurrences[destination]++;
+                if (node_of[destination] == node.node_index) {
+                    pieces.emplace_back(destination, occurrence);
+                }
+            }
+            const char* sizes = forwarded.back().data();
+            const char* data = sizes + pieces.size() * sizeof(int);
+            for (size_t p = 0; p < pieces.size(); ++p) {
+                int piece_bytes;
+                std::memcpy(&piece_bytes, sizes + p * sizeof(int), sizeof(int));
+                entries.push_back({ pieces[p].first, sender, pieces[p].second, piece_bytes, 0 });
+                entry_data.push_back(data);
+                data += piece_bytes;
+            }
+        }
+
+        // Step 3: publish the outbox. Entering the size agreement also means
+        // every rank of the node is done reading the previous outboxes.
+        long long needed = sizeof(MPI_Aint) + entries.size() * sizeof(OutboxEntry);
+        for (OutboxEntry& entry : entries) {
+            entry.offset = static_cast<MPI_Aint>(needed);
+            needed += entry.bytes;
+        }
+        MPI_Allreduce(MPI_IN_PLACE, &needed, 1, MPI_LONG_LONG, MPI_MAX, node.node_comm);
+
+        const NodeSharedSegments& shared = CommunicatorCache::node_segments(comm, node_mapping, needed);
+        char* outbox = shared.segments[node.node_rank];
+        MPI_Aint entry_count = static_cast<MPI_Aint>(entries.size());
+        std::memcpy(outbox, &entry_count, sizeof(MPI_Aint));
+        if (!entries.empty()) {
+            std::memcpy(outbox + sizeof(MPI_Aint), entries.data(), entries.size() * sizeof(OutboxEntry));
+        }
+        for (size_t e = 0; e < entries.size(); ++e) {
+            std::memcpy(outbox + entries[e].offset, entry_data[e], entries[e].bytes);
+        }
+
+        MPI_Win_sync(shared.window);
+        MPI_Barrier(node.node_comm);
+        MPI_Win_sync(shared.window);
+
+        // Step 4: collect each incoming block from the outbox of its sender
+        // or of the sender's proxy on this node
+        std::map<int, int> source_occurrences;
+        for (int j = 0; j < indegree; ++j) {
+            int source = sources[j];
+            int occurrence = source_occurrences[source]++;
+            int holder = (node_of[source] == node.node_index) ? source : proxy_of(source, node.node_index);
+
+            const char* box = shared.segments[node_rank_of[holder]];
+            MPI_Aint box_entries;
+            std::memcpy(&box_entries, box, sizeof(MPI_Aint));
+            const OutboxEntry* table = reinterpret_cast<const OutboxEntry*>(box + sizeof(MPI_Aint));
+            for (MPI_Aint e = 0; e < box_entries; ++e) {
+                if (table[e].receiver == world_rank && table[e].sender == source &&
+                    table[e].occurrence == occurrence) {
+                    std::memcpy(blocks.recv[j], box + table[e].offset, std::min(table[e].bytes, blocks.recv_bytes[j]));
+                    break;
+                }
+            }
+        }
+
+        MPI_Waitall(static_cast<int>(requests.size()), requests.data(), MPI_STATUSES_IGNORE);
+
+        return static_cast<int>(requests.size());
+    }
+
+} // namespace TopologyAwareResearch
@@ -0,0 +1,79 @@
+#ifndef TOPOLOGY_AWARE_NEIGHBOR_H
+#define TOPOLOGY_AWARE_NEIGHBOR_H
+
+#include <mpi.h>
+#include <vector>
+#include "../core/collective_optimizer.h"
+#include "../core/communicator_cache.h"
+
+namespace TopologyAwareResearch {
+
+    // Neighbourhood collectives on a communicator with a distributed graph
+    // topology, with MPI_Neighbor_allgather/MPI_Neighbor_alltoallv semantics:
+    // block i goes to the i-th destination, block j arrives from the j-th
+    // source, and repeated neighbours are matched in list order. Blocks are
+    // moved as count * extent bytes, so datatypes must be contiguous.
+    class TopologyAwareNeighbor {
+    private:
+        NetworkCharacteristics network_config_;
+
+    public:
+        TopologyAwareNeighbor(const NetworkCharacteristics& config);
+        ~TopologyAwareNeighbor();
+
+        // Periodic 3D halo graph over comm with 6 (faces), 18 (faces and
+        // edges) or 26 (faces, edges and corners) neighbours per rank. With a
+        // uniform node mapping each node owns a block of the grid, laid out on
+        // the detected torus when there is one. Sources and destinations are
+        // the same list. The caller frees the returned communicator.
+        MPI_Comm create_halo_graph(MPI_Comm comm, int stencil_points) const;
+
+        // Neighbour list of one rank in the halo graph
+        std::vector<int> halo_neighbors(int rank, int world_size, int stencil_points) const;
+
+        // Pick an algorithm with select_algorithm() and run it
+        PerformanceMetrics neighbor_allgather(const void* sendbuf, int sendcount, MPI_Datatype sendtype,
+            void* recvbuf, int recvcount, MPI_Datatype recvtype, MPI_Comm comm);
+
+        PerformanceMetrics neighbor_alltoallv(const void* sendbuf, const int* sendcounts, const int* sdispls,
+            MPI_Datatype sendtype, void* recvbuf, const int* recvcounts, const int* rdispls,
+            MPI_Datatype recvtype, MPI_Comm comm);
+
+        PerformanceMetrics execute(AlgorithmType algo, const void* sendbuf, int sendcount, MPI_Datatype sendtype,
+            void* recvbuf, int recvcount, MPI_Datatype recvtype, MPI_Comm comm);
+
+        PerformanceMetrics execute(AlgorithmType algo, const void* sendbuf, const int* sendcounts, const int* sdispls,
+            MPI_Datatype sendtype, void* recvbuf, const int* recvcounts, const int* rdispls,
+            MPI_Datatype recvtype, MPI_Comm comm);
+
+        // Aggregated whenever nodes hold several ranks in shared memory
+        AlgorithmType select_algorithm(MPI_Comm comm) const;
+
+    private:
+        // Byte view of one exchange: send[i] goes to destination i, recv[j]
+        // is filled from source j
+        struct NeighborBlocks {
+            std::vector<const char*> send;
+            std::vector<int> send_bytes;
+            std::vector<char*> recv;
+            std::vector<int> recv_bytes;
+        };
+
+        PerformanceMetrics run(AlgorithmType algo, const NeighborBlocks& blocks, MPI_Comm comm);
+
+        // One Isend/Irecv per edge. Returns the number of messages sent.
+        static int direct_exchange(const NeighborBlocks& blocks, MPI_Comm comm);
+
+        // Blocks for another node travel as one message to a proxy rank on
+        // that node (the sender's lowest-ranked neighbour there); blocks for
+        // the own node and forwarded ones are handed over in shared memory.
+        // Returns the number of network messages sent.
+        int aggregated_exchange(const NeighborBlocks& blocks, MPI_Comm comm) const;
+
+        // Grid extents and the rank at each cell (x fastest)
+        std::vector<int> halo_layout(int world_size, int dims[3]) const;
+    };
+
+} // namespace TopologyAwareResearch
+
+#endif // TOPOLOGY_AWARE_NEIGHBOR_H
@@ -0,0 +1,193 @@
+#include "topology_aware_reduce.h"
+#include "ordered_reduction.h"
+#include "pipelined_tree.h"
+#include "../core/reduction_ops.h"
+#include "topology_aware_reduce_scatter.h"
+#include "../core/scratch_pool.h"
+#include <algorithm>
+#include <numeric>
+
+namespace TopologyAwareResearch {
+
+    namespace {
+        // Below this the binomial tree's log2(P) latency wins
+        const long long kShortReduceBytes = 65536;
+        // From here on a single pass through the chain beats Rabenseifner
+        const long long kChainReduceBytes = 8388608;
+
+        const int kDefaultReduceSegmentBytes = 65536;
+    }
+
+    TopologyAwareReduce::TopologyAwareReduce(const NetworkCharacteristics& config)
+        : network_config_(config), segment_size_(kDefaultReduceSegmentBytes) {
+    }
+
+    TopologyAwareReduce::~TopologyAwareReduce() {}
+
+    PerformanceMetrics TopologyAwareReduce::reduce(const void* sendbuf, void* recvbuf,
+        int count, MPI_Datatype datatype,
+        MPI_Op op, int root, MPI_Comm comm) {
+        int world_size, type_size;
+        MPI_Comm_size(comm, &world_size);
+        MPI_Type_size(datatype, &type_size);
+
+        AlgorithmType algo = select_algorithm(static_cast<long long>(count) * type_size, count, world_size);
+        algo = g_custom_op_manager.order_preserving_algorithm(op, algo);
+        return execute(algo, sendbuf, recvbuf, count, datatype, op, root, comm);
+    }
+
+    PerformanceMetrics TopologyAwareReduce::execute(AlgorithmType algo, const void* sendbuf, void* recvbuf,
+        int count, MPI_Datatype datatype,
+        MPI_Op op, int root, MPI_Comm comm) {
+        switch (algo) {
+        case AlgorithmType::SEGMENTED_BINOMIAL_REDUCE:
+            return segmented_binomial_reduce(sendbuf, recvbuf, count, datatype, op, root, comm);
+        case AlgorithmType::RABENSEIFNER_REDUCE:
+            return rabenseifner_reduce(sendbuf, recvbuf, count, datatype, op, root, comm);
+        case AlgorithmType::PIPELINED_CHAIN_REDUCE:
+            return pipelined_chain_reduce(sendbuf, recvbuf, count, datatype, op, root, comm);
+        case AlgorithmType::ORDERED_TREE_REDUCE:
+        case AlgorithmType::ORDERED_RECURSIVE_HALVING_REDUCE: {
+            OrderedReduction ordered(network_config_);
+            ordered.set_segment_size(segment_size_);
+            return ordered.execute(algo, sendbuf, recvbuf, count, datatype, op, root, comm);
+        }
+        default: {
+            PerformanceMetrics metrics;
+            auto start_time = MPI_Wtime();
+            MPI_Reduce(sendbuf, recvbuf, count, datatype, op, root, comm);
+            metrics.execution_time = MPI_Wtime() - start_time;
+            return metrics;
+        }
+        }
+    }
+
+    AlgorithmType TopologyAwareReduce::select_algorithm(long long message_bytes, int count, int world_size) const {
+        if (message_bytes < kShortReduceBytes || count < world_size || world_size <= 2) {
+            return AlgorithmType::SEGMENTED_BINOMIAL_REDUCE;
+        }
+        if (message_bytes < kChainReduceBytes) {
+            return AlgorithmType::RABENSEIFNER_REDUCE;
+        }
+        return AlgorithmType::PIPELINED_CHAIN_REDUCE;
+    }
+
+    PerformanceMetrics TopologyAwareReduce::segmented_binomial_reduce(const void* sendbuf, void* recvbuf,
+        int count, MPI_Datatype datatype,
+        MPI_Op op, int root, MPI_Comm comm) {
+        int world_size, world_rank;
+        MPI_Comm_size(comm, &world_size);
+        MPI_Comm_rank(comm, &world_rank);
+
+        // Relative rank r receives from r + mask for every mask below its
+        // lowest set bit and sends to r - lowbit(r)
+        int relative_rank = (world_rank - root + world_size) % world_size;
+        bool has_parent = false;
+        TreeLink parent = { comm, 0, 0 };
+        std::vector<TreeLink> children;
+        for (int mask = 1; mask < world_size; mask <<= 1) {
+            if (relative_rank & mask) {
+                int peer = (relative_rank - mask + root) % world_size;
+                parent = { comm, peer, peer };
+                has_parent = true;
+                break;
+            }
+            if (relative_rank + mask < world_size) {
+                int peer = (relative_rank + mask + root) % world_size;
+                children.push_back({ comm, peer, peer });
+            }
+        }
+
+        return pipelined_tree_reduce(sendbuf, recvbuf, count, datatype, op, comm,
+            has_parent, parent, children, segment_size_);
+    }
+
+    PerformanceMetrics TopologyAwareReduce::rabenseifner_reduce(const void* sendbuf, void* recvbuf,
+        int count, MPI_Datatype datatype,
+        MPI_Op op, int root, MPI_Comm comm) {
+        PerformanceMetrics metrics;
+        auto start_time = MPI_Wtime();
+
+        int world_size, world_rank;
+        MPI_Comm_size(comm, &world_size);
+        MPI_Comm_rank(comm, &world_rank);
+
+        MPI_Aint lower_bound, extent;
+        MPI_Type_get_extent(datatype, &lower_bound, &extent);
+
+        std::vector<int> counts(world_size), displacements(world_size);
+        for (int i = 0; i < world_size; ++i) {
+            counts[i] = count / world_size + (i < count % world_size ? 1 : 0);
+            displacements[i] = (i == 0) ? 0 : displacements[i - 1] + counts[i - 1];
+        }
+
+        // Step 1: every rank ends up with one fully reduced block
+        const void* input = (sendbuf == MPI_IN_PLACE) ? recvbuf : sendbuf;
+        ScratchBuffer block = ScratchPool::local().acquire(static_cast<size_t>(counts[world_rank]) * extent);
+        TopologyAwareReduceScatter reduce_scatter(network_config_);
+        metrics = reduce_scatter.recursive_halving_reduce_scatter(input, block.data(), counts.data(),
+            datatype, op, comm);
+
+        // Step 2: collect the blocks at the root
+        MPI_Gatherv(block.data(), counts[world_rank], datatype,
+            recvbuf, counts.data(), displacements.data(), datatype, root, comm);
+
+        int type_size;
+        MPI_Type_size(datatype, &type_size);
+
+        auto end_time = MPI_Wtime();
+        metrics.execution_time = end_time - start_time;
+        metrics.communication_time = metrics.execution_time;
+        if (world_rank != root) {
+            metrics.messages_sent += 1;
+            metrics.bytes_transferred += counts[world_rank] * type_size;
+            metrics.communication_edges.emplace_back(world_rank, root);
+        }
+
+        return metrics;
+    }
+
+    PerformanceMetrics TopologyAwareReduce::pipelined_chain_reduce(const void* sendbuf, void* recvbuf,
+        int count, MPI_Datatype datatype,
+        MPI_Op op, int root, MPI_Comm comm) {
+        int world_size, world_rank;
+        MPI_Comm_size(comm, &world_size);
+        MPI_Comm_rank(comm, &world_rank);
+
+        // Rotate the node-ordered list so that the chain ends at the root
+        std::vector<int> order = chain_order(world_size);
+        int root_position = static_cast<int>(std::find(order.begin(), order.end(), root) - order.begin());
+        std::vector<int> chain(world_size);
+        for (int i = 0; i < world_size; ++i) {
+            chain[i] = order[(root_position + 1 + i) % world_size];
+        }
+        int position = static_cast<int>(std::find(chain.begin(), chain.end(), world_rank) - chain.begin());
+
+        bool has_parent = (position < world_size - 1);
+        TreeLink parent = { comm, 0, 0 };
+        if (has_parent) {
+            parent = { comm, chain[position + 1], chain[position + 1] };
+        }
+        std::vector<TreeLink> children;
+        if (position > 0) {
+            children.push_back({ comm, chain[position - 1], chain[position - 1] });
+        }
+
+        return pipelined_tree_reduce(sendbuf, recvbuf, count, datatype, op, comm,
+            has_parent, parent, children, segment_size_);
+    }
+
+    std::vector<int> TopologyAwareReduce::chain_order(int world_size) const {
+        std::vector<int> order(world_size);
+        std::iota(order.begin(), order.end(), 0);
+
+        const std::vector<int>& node_mapping = network_config_.node_mapping;
+        if (static_cast<int>(node_mapping.size()) == world_size) {
+            std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+                return node_mapping[a] < node_mapping[b];
+            });
+        }
+        return order;
+    }
+
+} // namespace TopologyAwareResearch
@@ -0,0 +1,65 @@
+#ifndef TOPOLOGY_AWARE_REDUCE_H
+#define TOPOLOGY_AWARE_REDUCE_H
+
+#include <mpi.h>
+#include <vector>
+#include "../core/collective_optimizer.h"
+
+namespace TopologyAwareResearch {
+
+    // Reduce-to-root built on reduce_segments, with MPI_Reduce semantics
+    // (recvbuf is only written on the root, which may pass MPI_IN_PLACE).
+    // The binomial, Rabenseifner and chain algorithms reorder operands;
+    // reduce() hands non-commutative operations to OrderedReduction.
+    class TopologyAwareReduce {
+    private:
+        NetworkCharacteristics network_config_;
+        int segment_size_;  // Pipeline segment in bytes
+
+    public:
+        TopologyAwareReduce(const NetworkCharacteristics& config);
+        ~TopologyAwareReduce();
+
+        // Picks an algorithm with select_algorithm(), swapped for its
+        // order-preserving counterpart when op is not commutative
+        PerformanceMetrics reduce(const void* sendbuf, void* recvbuf,
+            int count, MPI_Datatype datatype,
+            MPI_Op op, int root, MPI_Comm comm);
+
+        PerformanceMetrics execute(AlgorithmType algo, const void* sendbuf, void* recvbuf,
+            int count, MPI_Datatype datatype,
+            MPI_Op op, int root, MPI_Comm comm);
+
+        // Binomial tree rooted at root, pipelined in segments
+        PerformanceMetrics segmented_binomial_reduce(const void* sendbuf, void* recvbuf,
+            int count, MPI_Datatype datatype,
+            MPI_Op op, int root, MPI_Comm comm);
+
+        // Recursive-halving reduce-scatter followed by a gather of the
+        // reduced blocks at the root: 2(P-1)/P of the buffer per rank
+        // instead of log2(P) full buffers
+        PerformanceMetrics rabenseifner_reduce(const void* sendbuf, void* recvbuf,
+            int count, MPI_Datatype datatype,
+            MPI_Op op, int root, MPI_Comm comm);
+
+        // Node-ordered chain ending at the root, pipelined in segments; each
+        // rank sends the buffer once, which wins for very large messages
+        PerformanceMetrics pipelined_chain_reduce(const void* sendbuf, void* recvbuf,
+            int count, MPI_Datatype datatype,
+            MPI_Op op, int root, MPI_Comm comm);
+
+        void set_segment_size(int bytes) { segment_size_ = bytes; }
+        int get_segment_size() const { return segment_size_; }
+
+        // Binomial for short messages, Rabenseifner for large ones and the
+        // chain for very large ones
+        AlgorithmType select_algorithm(long long message_bytes, int count, int world_size) const;
+
+    private:
+        // Ranks grouped by node when the node mapping is known
+        std::vector<int> chain_order(int world_size) const;
+    };
+
+} // namespace TopologyAwareResearch
+
+#endif // TOPOLOGY_AWARE_REDUCE_H
@@ -0,0 +1,398 @@
+#include "topology_aware_reduce_scatter.h"
+#include "../core/reduction_ops.h"
+#include "../core/scratch_pool.h"
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+namespace TopologyAwareResearch {
+
+    namespace {
+        const int kReduceScatterTag = 12;
+
+        // Totals below this are latency bound
+        const long long kShortReduceScatterBytes = 524288;
+
+        // Element offset of every block plus the total at the end
+        std::vector<int> block_offsets(const int* counts, int blocks) {
+            std::vector<int> offsets(blocks + 1, 0);
+            for (int i = 0; i < blocks; ++i) {
+                offsets[i + 1] = offsets[i] + counts[i];
+            }
+            return offsets;
+        }
+
+        char* element_ptr(char* base, int index, MPI_Aint extent) {
+            return base + static_cast<MPI_Aint>(index) * extent;
+        }
+
+        char* element_ptr(const char* base, int index, MPI_Aint extent) {
+            return const_cast<char*>(base) + static_cast<MPI_Aint>(index) * extent;
+        }
+    }
+
+    TopologyAwareReduceScatter::TopologyAwareReduceScatter(const NetworkCharacteristics& config)
+        : network_config_(config) {
+    }
+
+    TopologyAwareReduceScatter::~TopologyAwareReduceScatter() {}
+
+    PerformanceMetrics TopologyAwareReduceScatter::reduce_scatter(const void* sendbuf, void* recvbuf,
+        const int* recvcounts, MPI_Datatype datatype,
+        MPI_Op op, MPI_Comm comm) {
+        int world_size, type_size;
+        MPI_Comm_size(comm, &world_size);
+        MPI_Type_size(datatype, &type_size);
+
+        long long total_count = 0;
+        for (int i = 0; i < world_size; ++i) {
+            total_count += recvcounts[i];
+        }
+
+        AlgorithmType algo = g_custom_op_manager.is_commutative(op) ?
+            select_algorithm(total_count * type_size, world_size) : AlgorithmType::NATIVE_MPI;
+        return execute(algo, sendbuf, recvbuf, recvcounts, datatype, op, comm);
+    }
+
+    PerformanceMetrics TopologyAwareReduceScatter::reduce_scatter_block(const void* sendbuf, void* recvbuf,
+        int recvcount, MPI_Datatype datatype,
+        MPI_Op op, MPI_Comm comm) {
+        int world_size;
+        MPI_Comm_size(comm, &world_size);
+
+        std::vector<int> recvcounts(world_size, recvcount);
+        return reduce_scatter(sendbuf, recvbuf, recvcounts.data(), datatype, op, comm);
+    }
+
+    PerformanceMetrics TopologyAwareReduceScatter::execute(AlgorithmType algo, const void* sendbuf, void* recvbuf,
+        const int* recvcounts, MPI_Datatype datatype,
+        MPI_Op op, MPI_Comm comm) {
+        switch (algo) {
+        case AlgorithmType::RING_REDUCE_SCATTER:
+            return ring_reduce_scatter(sendbuf, recvbuf, recvcounts, datatype, op, comm);
+        case AlgorithmType::RECURSIVE_HALVING_REDUCE_SCATTER:
+            return recursive_halving_reduce_scatter(sendbuf, recvbuf, recvcounts, datatype, op, comm);
+        case AlgorithmType::HIERARCHICAL_REDUCE_SCATTER:
+            return hierarchical_reduce_scatter(sendbuf, recvbuf, recvcounts, datatype, op, comm);
+        default: {
+            PerformanceMetrics metrics;
+            auto start_time = MPI_Wtime();
+            MPI_Reduce_scatter(sendbuf, recvbuf, recvcounts, datatype, op, comm);
+            metrics.execution_time = MPI_Wtime() - start_time;
+            return metrics;
+        }
+        }
+    }
+
+    AlgorithmType TopologyAwareReduceScatter::select_algorithm(long long total_bytes, int world_size) const {
+        if (has_node_hierarchy(network_config_.node_mapping, world_size)) {
+            return AlgorithmType::HIERARCHICAL_REDUCE_SCATTER;
+        }
+        if (total_bytes < kShortReduceScatterBytes) {
+            return AlgorithmType::RECURSIVE_HALVING_REDUCE_SCATTER;
+        }
+        return AlgorithmType::RING_REDUCE_SCATTER;
+    }
+
+    int TopologyAwareReduceScatter::ring_pass(const char* input, char* output, const int* recvcounts,
+        MPI_Datatype datatype, MPI_Op op, MPI_Comm comm,
+        const std::vector<int>& order) {
+        int world_size, world_rank;
+        MPI_Comm_size(comm, &world_size);
+        MPI_Comm_rank(comm, &world_rank);
+
+        MPI_Aint lower_bound, extent;
+        MPI_Type_get_extent(datatype, &lower_bound, &extent);
+        ReductionKernel reduce_kernel = resolve_reduction_kernel(datatype, op);
+        std::vector<int> offsets = block_offsets(recvcounts, world_size);
+        reduce_kernel.stream_for_total(static_cast<size_t>(offsets[world_size]) * extent);
+
+        if (world_size == 1) {
+            std::memmove(output, input, static_cast<size_t>(recvcounts[0]) * extent);
+            return 0;
+        }
+
+        int position = static_cast<int>(std::find(order.begin(), order.end(), world_rank) - order.begin());
+        int right = order[(position + 1) % world_size];
+        int left = order[(position - 1 + world_size) % world_size];
+
+        int max_count = *std::max_element(recvcounts, recvcounts + world_size);
+        ScratchBuffer outgoing = ScratchPool::local().acquire(static_cast<size_t>(max_count) * extent);
+        ScratchBuffer incoming = ScratchPool::local().acquire(outgoing.size());
+
+        // Step s receives the partial sum of block order[pos-s-2] from the
+        // left, folds in the local contribution and forwards it in step s+1.
+        // The last block to arrive is our own; it goes straight to output
+        // unless output aliases the input (MPI_IN_PLACE).
+        for (int step = 0; step < world_size - 1; ++step) {
+            int send_block = order[(position - step - 1 + world_size) % world_size];
+            int recv_block = order[(position - step - 2 + 2 * world_size) % world_size];
+            bool last = (step == world_size - 2);
+
+            char* send_ptr = (step == 0) ? element_ptr(input, offsets[send_block], extent) : outgoing.data();
+            char* recv_ptr = (last && output != input) ? output : incoming.data();
+
+            MPI_Sendrecv(send_ptr, recvcounts[send_block], datatype, right, kReduceScatterTag,
+                recv_ptr, recvcounts[recv_block], datatype, left, kReduceScatterTag,
+                comm, MPI_STATUS_IGNORE);
+
+            reduce_kernel(recv_ptr, element_ptr(input, offsets[recv_block], extent), 0, recvcounts[recv_block]);
+
+            if (!last) {
+                outgoing.swap(incoming);
+            }
+            else if (recv_ptr != output) {
+                std::memcpy(output, recv_ptr, static_cast<size_t>(recvcounts[recv_block]) * extent);
+            }
+        }
+
+        return world_size - 1;
+    }
+
+    PerformanceMetrics TopologyAwareReduceScatter::ring_reduce_scatter(const void* sendbuf, void* recvbuf,
+        const int* recvcounts, MPI_Datatype datatype,
+        MPI_Op op, MPI_Comm comm) {
+        PerformanceMetrics metrics;
+        auto start_time = MPI_Wtime();
+
+        int world_size, world_rank;
+        MPI_Comm_size(comm, &world_size);
+        MPI_Comm_rank(comm, &world_rank);
+
+        const char* input = static_cast<const char*>(sendbuf == MPI_IN_PLACE ? recvbuf : sendbuf);
+        std::vector<int> order = node_grouped_order(network_config_.node_mapping, world_size);
+        int messages = ring_pass(input, static_cast<char*>(recvbuf), recvcounts, datatype, op, comm, order);
+
+        int type_size;
+        MPI_Type_size(datatype, &type_size);
+        std::vector<int> offsets = block_offsets(recvcounts, world_size);
+
+        auto end_time = MPI_Wtime();
+        metrics.execution_time = end_time - start_time;
+        metrics.communication_time = metrics.execution_time;
+        metrics.messages_sent = messages;
+        metrics.bytes_transferred = (offsets[world_size] - recvcounts[world_rank]) * type_size;
+        if (world_size > 1) {
+            int position = static_cast<int>(std::find(order.begin(), order.end(), world_rank) - order.begin());
+            metrics.communication_edges.emplace_back(world_rank, order[(position + 1) % world_size]);
+        }
+
+        return metrics;
+    }
+
+    PerformanceMetrics TopologyAwareReduceScatter::recursive_halving_reduce_scatter(const void* sendbuf, void* recvbuf,
+        const int* recvcounts, MPI_Datatype datatype,
+        MPI_Op op, MPI_Comm comm) {
+        PerformanceMetrics metrics;
+        auto start_time = MPI_Wtime();
+
+        int world_size, world_rank;
+        MPI_Comm_size(comm, &world_size);
+        MPI_Comm_rank(comm, &world_rank);
+
+        MPI_Aint lower_bound, extent;
+        MPI_Type_get_extent(datatype, &lower_bound, &extent);
+        ReductionKernel reduce_kernel = resolve_reduction_kernel(datatype, op);
+        std::vector<int> offsets = block_offsets(recvcounts, world_size);
+        int total_count = offsets[world_size];
+        reduce_kernel.stream_for_total(static_cast<size_t>(total_count) * extent);
+
+        const char* input = static_cast<const char*>(sendbuf == MPI_IN_PLACE ? recvbuf : sendbuf);
+        ScratchBuffer work = ScratchPool::local().acquire_copy(input, static_cast<size_t>(total_count) * extent);
+        ScratchBuffer incoming = ScratchPool::local().acquire(work.size());
+
+        int power = 1;
+        while (power * 2 <= world_size) {
+            power *= 2;
+        }
+        int extra = world_size - power;
+
+        // The first 2*extra ranks pair up; even ones hand their whole input
+        // to the odd neighbour and sit out the halving phase
+        int messages = 0;
+        int virtual_rank;
+        if (world_rank < 2 * extra) {
+            if (world_rank % 2 == 0) {
+                MPI_Send(work.data(), total_count, datatype, world_rank + 1, kReduceScatterTag, comm);
+                metrics.communication_edges.emplace_back(world_rank, world_rank + 1);
+                ++messages;
+                virtual_rank = -1;
+            }
+            else {
+                MPI_Recv(incoming.data(), total_count, datatype, world_rank - 1, kReduceScatterTag,
+                    comm, MPI_STATUS_IGNORE);
+                reduce_kernel(work.data(), incoming.data(), 0, total_count);
+                virtual_rank = world_rank / 2;
+            }
+        }
+        else {
+            virtual_rank = world_rank - extra;
+        }
+
+        // Virtual rank v stands for real blocks [first_block(v), first_block(v+1))
+        auto first_block = [extra, world_size](int v) {
+            return v < extra ? 2 * v : std::min(v + extra, world_size);
+        };
+        auto real_rank = [extra](int v) {
+            return v < extra ? 2 * v + 1 : v + extra;
+        };
+
+        if (virtual_rank >= 0) {
+            int low = 0, high = power;
+            for (int mask = power / 2; mask > 0; mask >>= 1) {
+                int partner = real_rank(virtual_rank ^ mask);
+                int middle = low + mask;
+
+                int keep_low = low, keep_high = middle, send_low = middle, send_high = high;
+                if (virtual_rank >= middle) {
+                    std::swap(keep_low, send_low);
+                    std::swap(keep_high, send_high);
+                }
+
+                int keep_offset = offsets[first_block(keep_low)];
+                int keep_count = offsets[first_block(keep_high)] - keep_offset;
+                int send_offset = offsets[first_block(send_low)];
+                int send_count = offsets[first_block(send_high)] - send_offset;
+
+                MPI_Sendrecv(element_ptr(work.data(), send_offset, extent), send_count, datatype,
+                    partner, kReduceScatterTag,
+                    incoming.data(), keep_count, datatype, partner, kReduceScatterTag,
+                    comm, MPI_STATUS_IGNORE);
+                reduce_kernel(work.data(), incoming.data(), keep_offset, keep_count);
+
+                metrics.communication_edges.emplace_back(world_rank, partner);
+                ++messages;
+                low = keep_low;
+                high = keep_high;
+            }
+
+            // Hand the folded-in neighbour its block
+            if (virtual_rank < extra) {
+                MPI_Send(element_ptr(work.data(), offsets[world_rank - 1], extent), recvcounts[world_rank - 1],
+                    datatype, world_rank - 1, kReduceScatterTag, comm);
+                ++messages;
+            }
+            std::memcpy(recvbuf, element_ptr(work.data(), offsets[world_rank], extent),
+                static_cast<size_t>(recvcounts[world_rank]) * extent);
+        }
+        else {
+            MPI_Recv(recvbuf, recvcounts[world_rank], datatype, world_rank + 1, kReduceScatterTag,
+                comm, MPI_STATUS_IGNORE);
+        }
+
+        int type_size;
+        MPI_Type_size(datatype, &type_size);
+
+        auto end_time = MPI_Wtime();
+        metrics.execution_time = end_time - start_time;
+        metrics.communication_time = metrics.execution_time;
+        metrics.messages_sent = messages;
+        metrics.bytes_transferred = (total_count - recvcounts[world_rank]) * type_size;
+
+        return metrics;
+    }
+
+    PerformanceMetrics TopologyAwareReduceScatter::hierarchical_reduce_scatter(const void* sendbuf, void* recvbuf,
+        const int* recvcounts, MPI_Datatype datatype,
+        MPI_Op op, MPI_Comm comm) {
+        PerformanceMetrics metrics;
+        auto start_time = MPI_Wtime();
+
+        int world_size, world_rank;
+        MPI_Comm_size(comm, &world_size);
+        MPI_Comm_rank(comm, &world_rank);
+
+        const NodeCommunicators& node = CommunicatorCache::node(comm, network_config_.node_mapping);
+        int node_size = node.node_sizes[node.node_index];
+
+        MPI_Aint lower_bound, extent;
+        MPI_Type_get_extent(datatype, &lower_bound, &extent);
+        ReductionKernel reduce_kernel = resolve_reduction_kernel(datatype, op);
+        std::vector<int> offsets = block_offsets(recvcounts, world_size);
+        int total_count = offsets[world_size];
+        reduce_kernel.stream_for_total(static_cast<size_t>(total_count) * extent);
+
+        // Work in node order so that every node's blocks are contiguous
+        const char* input = static_cast<const char*>(sendbuf == MPI_IN_PLACE ? recvbuf : sendbuf);
+        std::vector<int> ordered_counts(world_size);
+        ScratchBuffer work = ScratchPool::local().acquire(static_cast<size_t>(total_count) * extent);
+        MPI_Aint position = 0;
+        for (int i = 0; i < world_size; ++i) {
+            int owner = node.node_order[i];
+            ordered_counts[i] = recvcounts[owner];
+            MPI_Aint bytes = static_cast<MPI_Aint>(recvcounts[owner]) * extent;
+            std::memcpy(work.data() + position, element_ptr(input, offsets[owner], extent), bytes);
+            position += bytes;
+        }
+
+        // Step 1: binomial reduce of the whole vector to the node leader
+        int messages = 0;
+        ScratchBuffer incoming = ScratchPool::local().acquire(work.size());
+        for (int mask = 1; mask < node_size; mask <<= 1) {
+            if (node.node_rank & mask) {
+                MPI_Send(work.data(), total_count, datatype, node.node_rank - mask, kReduceScatterTag, node.node_comm);
+                ++messages;
+                break;
+            }
+            if (node.node_rank + mask < node_size) {
+                MPI_Recv(incoming.data(), total_count, datatype, node.node_rank + mask, kReduceScatterTag,
+                    node.node_comm, MPI_STATUS_IGNORE);
+                reduce_kernel(work.data(), incoming.data(), 0, total_count);
+            }
+        }
+
+        std::vector<int> node_counts(node.node_count, 0);
+        std::vector<int> member_counts;
+        int ordered_index = 0;
+        for (int n = 0; n < node.node_count; ++n) {
+            for (int i = 0; i < node.node_sizes[n]; ++i, ++ordered_index) {
+                node_counts[n] += ordered_counts[ordered_index];
+                if (n == node.node_index) {
+                    member_counts.push_back(ordered_counts[ordered_index]);
+                }
+            }
+        }
+
+        // Step 2: leaders reduce-scatter node-sized blocks
+        ScratchBuffer node_result;
+        const char* node_block = work.data();
+        if (node.is_leader() && node.node_count > 1) {
+            node_result = ScratchPool::local().acquire(static_cast<size_t>(node_counts[node.node_index]) * extent);
+            std::vector<int> leader_order(node.node_count);
+            std::iota(leader_order.begin(), leader_order.end(), 0);
+            messages += ring_pass(work.data(), node_result.data(), node_counts.data(),
+                datatype, op, node.leader_comm, leader_order);
+            node_block = node_result.data();
+        }
+
+        // Step 3: the leader hands every member its block
+        if (node_size > 1) {
+            std::vector<int> member_offsets = block_offsets(member_counts.data(), node_size);
+            MPI_Scatterv(node_block, member_counts.data(), member_offsets.data(), datatype,
+                recvbuf, recvcounts[world_rank], datatype, 0, node.node_comm);
+            if (node.is_leader()) {
+                messages += node_size - 1;
+            }
+        }
+        else {
+            std::memcpy(recvbuf, node_block, static_cast<size_t>(recvcounts[world_rank]) * extent);
+        }
+
+        int type_size;
+        MPI_Type_size(datatype, &type_size);
+
+        auto end_time = MPI_Wtime();
+        metrics.execution_time = end_time - start_time;
+        metrics.communication_time = metrics.execution_time;
+        metrics.messages_sent = messages;
+        if (node.is_leader()) {
+            metrics.bytes_transferred = (total_count - node_counts[node.node_index]) * type_size;
+        }
+        else {
+            metrics.bytes_transferred = total_count * type_size;
+        }
+
+        return metrics;
+    }
+
+} // namespace TopologyAwareResearch
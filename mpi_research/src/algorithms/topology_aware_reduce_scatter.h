@@ -0,0 +1,71 @@
+#ifndef TOPOLOGY_AWARE_REDUCE_SCATTER_H
+#define TOPOLOGY_AWARE_REDUCE_SCATTER_H
+
+#include <mpi.h>
+#include <vector>
+#include "../core/collective_optimizer.h"
+#include "../core/communicator_cache.h"
+
+namespace TopologyAwareResearch {
+
+    // Reduce-scatter built on reduce_segments. Semantics follow
+    // MPI_Reduce_scatter: rank i ends up with block i (recvcounts[i]
+    // elements) of the element-wise reduction; with MPI_IN_PLACE the input
+    // is read from recvbuf. The algorithms assume a commutative op;
+    // reduce_scatter() hands non-commutative ones to MPI_Reduce_scatter.
+    class TopologyAwareReduceScatter {
+    private:
+        NetworkCharacteristics network_config_;
+
+    public:
+        TopologyAwareReduceScatter(const NetworkCharacteristics& config);
+        ~TopologyAwareReduceScatter();
+
+        // Picks an algorithm with select_algorithm() and runs it
+        PerformanceMetrics reduce_scatter(const void* sendbuf, void* recvbuf,
+            const int* recvcounts, MPI_Datatype datatype,
+            MPI_Op op, MPI_Comm comm);
+
+        PerformanceMetrics reduce_scatter_block(const void* sendbuf, void* recvbuf,
+            int recvcount, MPI_Datatype datatype,
+            MPI_Op op, MPI_Comm comm);
+
+        PerformanceMetrics execute(AlgorithmType algo, const void* sendbuf, void* recvbuf,
+            const int* recvcounts, MPI_Datatype datatype,
+            MPI_Op op, MPI_Comm comm);
+
+        // P-1 steps along a node-ordered ring; each incoming partial block is
+        // combined with the local contribution and passed on. Bandwidth optimal.
+        PerformanceMetrics ring_reduce_scatter(const void* sendbuf, void* recvbuf,
+            const int* recvcounts, MPI_Datatype datatype,
+            MPI_Op op, MPI_Comm comm);
+
+        // log2(P) exchanges of halving size; extra ranks of a non-power-of-two
+        // P fold their input into a neighbour first and get their block back
+        // at the end
+        PerformanceMetrics recursive_halving_reduce_scatter(const void* sendbuf, void* recvbuf,
+            const int* recvcounts, MPI_Datatype datatype,
+            MPI_Op op, MPI_Comm comm);
+
+        // Binomial reduce inside each node, ring reduce-scatter of node-sized
+        // blocks among node leaders, then a scatter inside the node
+        PerformanceMetrics hierarchical_reduce_scatter(const void* sendbuf, void* recvbuf,
+            const int* recvcounts, MPI_Datatype datatype,
+            MPI_Op op, MPI_Comm comm);
+
+        // Multi-node runs with several ranks per node reduce per node first;
+        // otherwise latency-bound totals use recursive halving and
+        // bandwidth-bound ones the ring
+        AlgorithmType select_algorithm(long long total_bytes, int world_size) const;
+
+    private:
+        // Ring over the given rank order; block i of the result lands at
+        // output on rank i. Returns the number of messages sent.
+        static int ring_pass(const char* input, char* output, const int* recvcounts,
+            MPI_Datatype datatype, MPI_Op op, MPI_Comm comm,
+            const std::vector<int>& order);
+    };
+
+} // namespace TopologyAwareResearch
+
+#endif // TOPOLOGY_AWARE_REDUCE_SCATTER_H
@@ -0,0 +1,261 @@
+#include "topology_aware_scan.h"
+#include "../core/reduction_ops.h"
+#include "../core/scratch_pool.h"
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+namespace TopologyAwareResearch {
+
+    namespace {
+        const int kScanTag = 14;
+    }
+
+    TopologyAwareScan::TopologyAwareScan(const NetworkCharacteristics& config)
+        : network_config_(config) {
+    }
+
+    TopologyAwareScan::~TopologyAwareScan() {}
+
+    PerformanceMetrics TopologyAwareScan::scan(const void* sendbuf, void* recvbuf,
+        int count, MPI_Datatype datatype,
+        MPI_Op op, MPI_Comm comm) {
+        int world_size;
+        MPI_Comm_size(comm, &world_size);
+        return execute(select_algorithm(world_size), false, sendbuf, recvbuf, count, datatype, op, comm);
+    }
+
+    PerformanceMetrics TopologyAwareScan::exscan(const void* sendbuf, void* recvbuf,
+        int count, MPI_Datatype datatype,
+        MPI_Op op, MPI_Comm comm) {
+        int world_size;
+        MPI_Comm_size(comm, &world_size);
+        return execute(select_algorithm(world_size), true, sendbuf, recvbuf, count, datatype, op, comm);
+    }
+
+    PerformanceMetrics TopologyAwareScan::execute(AlgorithmType algo, bool exclusive,
+        const void* sendbuf, void* recvbuf,
+        int count, MPI_Datatype datatype,
+        MPI_Op op, MPI_Comm comm) {
+        switch (algo) {
+        case AlgorithmType::RECURSIVE_DOUBLING_SCAN:
+            return recursive_doubling_scan(sendbuf, recvbuf, count, datatype, op, comm, exclusive);
+        case AlgorithmType::HIERARCHICAL_SCAN:
+            return hierarchical_scan(sendbuf, recvbuf, count, datatype, op, comm, exclusive);
+        default: {
+            PerformanceMetrics metrics;
+            auto start_time = MPI_Wtime();
+            if (exclusive) {
+                MPI_Exscan(sendbuf, recvbuf, count, datatype, op, comm);
+            }
+            else {
+                MPI_Scan(sendbuf, recvbuf, count, datatype, op, comm);
+            }
+            metrics.execution_time = MPI_Wtime() - start_time;
+            return metrics;
+        }
+        }
+    }
+
+    AlgorithmType TopologyAwareScan::select_algorithm(int world_size) const {
+        return has_contiguous_nodes(network_config_.node_mapping, world_size) ? AlgorithmType::HIERARCHICAL_SCAN
+            : AlgorithmType::RECURSIVE_DOUBLING_SCAN;
+    }
+
+    int TopologyAwareScan::doubling_prefix(const char* input, char* inclusive, char* exclusive,
+        bool& has_exclusive, int count, MPI_Datatype datatype, MPI_Op op,
+        MPI_Comm comm, const std::vector<int>& order) {
+        int rank;
+        MPI_Comm_rank(comm, &rank);
+        int size = static_cast<int>(order.size());
+        int position = static_cast<int>(std::find(order.begin(), order.end(), rank) - order.begin());
+
+        MPI_Aint lower_bound, extent;
+        MPI_Type_get_extent(datatype, &lower_bound, &extent);
+        ReductionKernel reduce_kernel = resolve_reduction_kernel(datatype, op);
+        size_t bytes = static_cast<size_t>(count) * extent;
+
+        // partial = total of this rank's aligned subcube, which doubles each step
+        ScratchBuffer partial = ScratchPool::local().acquire_copy(input, bytes);
+        ScratchBuffer incoming = ScratchPool::local().acquire(bytes);
+        if (inclusive != nullptr && inclusive != input) {
+            std::memcpy(inclusive, input, bytes);
+        }
+        has_exclusive = false;
+
+        int messages = 0;
+        for (int mask = 1; mask < size; mask <<= 1) {
+            int partner_position = position ^ mask;
+            if (partner_position >= size) {
+                continue;
+            }
+            int partner = order[partner_position];
+
+            MPI_Sendrecv(partial.data(), count, datatype, partner, kScanTag,
+                incoming.data(), count, datatype, partner, kScanTag,
+                comm, MPI_STATUS_IGNORE);
+            ++messages;
+
+            if (partner_position < position) {
+                // The lower subcube is the left operand of everything we hold
+                reduce_kernel(partial.data(), incoming.data(), 0, count);
+                if (inclusive != nullptr) {
+                    reduce_kernel(inclusive, incoming.data(), 0, count);
+                }
+                if (exclusive != nullptr) {
+                    if (has_exclusive) {
+                        reduce_kernel(exclusive, incoming.data(), 0, count);
+                    }
+                    else {
+                        std::memcpy(exclusive, incoming.data(), bytes);
+                    }
+                }
+                has_exclusive = true;
+            }
+            else {
+                // partial = partial op incoming
+                reduce_kernel(incoming.data(), partial.data(), 0, count);
+                partial.swap(incoming);
+            }
+        }
+
+        return messages;
+    }
+
+    PerformanceMetrics TopologyAwareScan::recursive_doubling_scan(const void* sendbuf, void* recvbuf,
+        int count, MPI_Datatype datatype,
+        MPI_Op op, MPI_Comm comm, bool exclusive) {
+        PerformanceMetrics metrics;
+        auto start_time = MPI_Wtime();
+
+        int world_size, world_rank;
+        MPI_Comm_size(comm, &world_size);
+        MPI_Comm_rank(comm, &world_rank);
+
+        const char* input = static_cast<const char*>(sendbuf == MPI_IN_PLACE ? recvbuf : sendbuf);
+        char* output = static_cast<char*>(recvbuf);
+        std::vector<int> order(world_size);
+        std::iota(order.begin(), order.end(), 0);
+
+        bool has_exclusive;
+        int messages = doubling_prefix(input, exclusive ? nullptr : output, exclusive ? output : nullptr,
+            has_exclusive, count, datatype, op, comm, order);
+
+        int type_size;
+        MPI_Type_size(datatype, &type_size);
+
+        auto end_time = MPI_Wtime();
+        metrics.execution_time = end_time - start_time;
+        metrics.communication_time = metrics.execution_time;
+        metrics.messages_sent = messages;
+        metrics.bytes_transferred = messages * count * type_size;
+        for (int mask = 1; mask < world_size; mask <<= 1) {
+            if ((world_rank ^ mask) < world_size) {
+                metrics.communication_edges.emplace_back(world_rank, world_rank ^ mask);
+            }
+        }
+
+        return metrics;
+    }
+
+    PerformanceMetrics TopologyAwareScan::hierarchical_scan(const void* sendbuf, void* recvbuf,
+        int count, MPI_Datatype datatype,
+        MPI_Op op, MPI_Comm comm, bool exclusive) {
+        int world_size, world_rank;
+        MPI_Comm_size(comm, &world_size);
+        MPI_Comm_rank(comm, &world_rank);
+
+        if (!has_contiguous_nodes(network_config_.node_mapping, world_size)) {
+            return recursive_doubling_scan(sendbuf, recvbuf, count, datatype, op, comm, exclusive);
+        }
+
+        PerformanceMetrics metrics;
+        auto start_time = MPI_Wtime();
+
+        const NodeCommunicators& node = CommunicatorCache::node(comm, network_config_.node_mapping);
+        int node_size = node.node_sizes[node.node_index];
+
+        MPI_Aint lower_bound, extent;
+        MPI_Type_get_extent(datatype, &lower_bound, &extent);
+        size_t bytes = static_cast<size_t>(count) * extent;
+
+        const char* input = static_cast<const char*>(sendbuf == MPI_IN_PLACE ? recvbuf : sendbuf);
+        char* output = static_cast<char*>(recvbuf);
+
+        // Step 1: prefix inside the node (node_comm keeps rank order)
+        std::vector<int> local_order(node_size);
+        std::iota(local_order.begin(), local_order.end(), 0);
+        ScratchBuffer local_inclusive;
+        char* inclusive = output;
+        if (exclusive) {
+            local_inclusive = ScratchPool::local().acquire(bytes);
+            inclusive = local_inclusive.data();
+        }
+        bool has_local_prefix;
+        int messages = doubling_prefix(input, inclusive, exclusive ? output : nullptr,
+            has_local_prefix, count, datatype, op, node.node_comm, local_order);
+
+        // Step 2: the last rank of the node holds the node total
+        ScratchBuffer node_total;
+        if (node.is_leader()) {
+            node_total = ScratchPool::local().acquire(bytes);
+            if (node_size == 1) {
+                std::memcpy(node_total.data(), inclusive, bytes);
+            }
+            else {
+                MPI_Recv(node_total.data(), count, datatype, node_size - 1, kScanTag,
+                    node.node_comm, MPI_STATUS_IGNORE);
+            }
+        }
+        else if (node.node_rank == node_size - 1) {
+            MPI_Send(inclusive, count, datatype, 0, kScanTag, node.node_comm);
+            ++messages;
+        }
+
+        // Step 3: leaders exscan node totals in rank order of the nodes
+        ScratchBuffer node_prefix = ScratchPool::local().acquire(bytes);
+        if (node.is_leader()) {
+            std::vector<int> leader_order(node.node_count);
+            std::iota(leader_order.begin(), leader_order.end(), 0);
+            std::vector<int> first_rank(node.node_count);
+            int start = 0;
+            for (int n = 0; n < node.node_count; ++n) {
+                first_rank[n] = node.node_order[start];
+                start += node.node_sizes[n];
+            }
+            std::sort(leader_order.begin(), leader_order.end(), [&](int a, int b) {
+                return first_rank[a] < first_rank[b];
+            });
+
+            bool has_node_prefix;
+            messages += doubling_prefix(node_total.data(), nullptr, node_prefix.data(),
+                has_node_prefix, count, datatype, op, node.leader_comm, leader_order);
+        }
+
+        // Step 4: fold the node offset in; the node holding rank 0 has none
+        bool first_node = (world_rank == node.node_rank);
+        if (!first_node) {
+            if (node_size > 1) {
+                MPI_Bcast(node_prefix.data(), count, datatype, 0, node.node_comm);
+            }
+            if (exclusive && node.is_leader()) {
+                std::memcpy(output, node_prefix.data(), bytes);
+            }
+            else {
+                reduce_segments(output, node_prefix.data(), 0, count, datatype, op);
+            }
+        }
+
+        int type_size;
+        MPI_Type_size(datatype, &type_size);
+
+        auto end_time = MPI_Wtime();
+        metrics.execution_time = end_time - start_time;
+        metrics.communication_time = metrics.execution_time;
+        metrics.messages_sent = messages;
+        metrics.bytes_transferred = messages * count * type_size;
+
+        return metrics;
+    }
+
+} // namespace TopologyAwareResearch
@@ -0,0 +1,65 @@
+#ifndef TOPOLOGY_AWARE_SCAN_H
+#define TOPOLOGY_AWARE_SCAN_H
+
+#include <mpi.h>
+#include <vector>
+#include "../core/collective_optimizer.h"
+#include "../core/communicator_cache.h"
+
+namespace TopologyAwareResearch {
+
+    // Inclusive and exclusive prefix reductions with MPI_Scan/MPI_Exscan
+    // semantics, MPI_IN_PLACE included. Partial results are always combined
+    // lower ranks on the left, so non-commutative operations are safe. As
+    // with MPI_Exscan, recvbuf on rank 0 is left untouched by exscan.
+    class TopologyAwareScan {
+    private:
+        NetworkCharacteristics network_config_;
+
+    public:
+        TopologyAwareScan(const NetworkCharacteristics& config);
+        ~TopologyAwareScan();
+
+        // Pick an algorithm with select_algorithm() and run it
+        PerformanceMetrics scan(const void* sendbuf, void* recvbuf,
+            int count, MPI_Datatype datatype,
+            MPI_Op op, MPI_Comm comm);
+
+        PerformanceMetrics exscan(const void* sendbuf, void* recvbuf,
+            int count, MPI_Datatype datatype,
+            MPI_Op op, MPI_Comm comm);
+
+        PerformanceMetrics execute(AlgorithmType algo, bool exclusive,
+            const void* sendbuf, void* recvbuf,
+            int count, MPI_Datatype datatype,
+            MPI_Op op, MPI_Comm comm);
+
+        // log2(P) exchanges of the running subcube total
+        PerformanceMetrics recursive_doubling_scan(const void* sendbuf, void* recvbuf,
+            int count, MPI_Datatype datatype,
+            MPI_Op op, MPI_Comm comm, bool exclusive = false);
+
+        // Prefix inside the node, exscan of node totals among the leaders,
+        // then every rank folds its node's offset in. Needs each node to hold
+        // a contiguous range of ranks; falls back to recursive doubling
+        // otherwise.
+        PerformanceMetrics hierarchical_scan(const void* sendbuf, void* recvbuf,
+            int count, MPI_Datatype datatype,
+            MPI_Op op, MPI_Comm comm, bool exclusive = false);
+
+        // Hierarchical whenever the node mapping allows it: it moves the same
+        // volume as recursive doubling over fewer network hops
+        AlgorithmType select_algorithm(int world_size) const;
+
+    private:
+        // Recursive doubling over the ranks of comm taken in `order`. Fills
+        // inclusive and/or exclusive (either may be null); has_exclusive is
+        // false on the first rank of the order.
+        static int doubling_prefix(const char* input, char* inclusive, char* exclusive,
+            bool& has_exclusive, int count, MPI_Datatype datatype, MPI_Op op,
+            MPI_Comm comm, const std::vector<int>& order);
+    };
+
+} // namespace TopologyAwareResearch
+
+#endif // TOPOLOGY_AWARE_SCAN_H
@@ -0,0 +1,153 @@
+#include "torus_broadcast.h"
+#include <algorithm>
+
+namespace TopologyAwareResearch {
+
+    MultiPortTorusBroadcast::MultiPortTorusBroadcast(const NetworkCharacteristics& config)
+        : network_config_(config), segment_bytes_(65536) {
+    }
+
+    MultiPortTorusBroadcast::~MultiPortTorusBroadcast() {}
+
+    PerformanceMetrics MultiPortTorusBroadcast::broadcast(void* buffer, int count,
+        MPI_Datatype datatype, int root,
+        MPI_Comm comm) {
+        PerformanceMetrics metrics;
+
+        int world_size;
+        MPI_Comm_size(comm, &world_size);
+
+        if (world_size == 1 || count == 0) {
+            metrics.execution_time = 0.0;
+            return metrics;
+        }
+
+        // Torus extents are only meaningful when the topology says so
+        int dim_x = 0, dim_y = 0, dim_z = 1;
+        if (network_config_.topology == NetworkTopology::TORUS_2D ||
+            network_config_.topology == NetworkTopology::TORUS_3D) {
+            dim_x = network_config_.topology_params.torus.x;
+            dim_y = network_config_.topology_params.torus.y;
+            dim_z = std::max(1, network_config_.topology_params.torus.z);
+        }
+        const TorusCommunicators& torus = CommunicatorCache::torus(comm, dim_x, dim_y, dim_z);
+
+        bool has_parent = false;
+        TreeLink parent = { MPI_COMM_NULL, MPI_PROC_NULL, MPI_PROC_NULL };
+        std::vector<TreeLink> children;
+        build_tree(torus, comm, root, has_parent, parent, children);
+
+        return pipelined_tree_broadcast(buffer, count, datatype, comm,
+            has_parent, parent, children, segment_bytes_);
+    }
+
+    void MultiPortTorusBroadcast::line_neighbors(int position, int length, int root_position,
+        int& parent, std::vector<int>& children) const {
+        parent = -1;
+        children.clear();
+        if (length <= 1) {
+            return;
+        }
+
+        // Positions 1..forward_hops are reached going up, the rest going down
+        int forward_hops = length / 2;
+        int backward_hops = length - 1 - forward_hops;
+        int relative = (position - root_position + length) % length;
+
+        if (relative == 0) {
+            if (forward_hops > 0) children.push_back((position + 1) % length);
+            if (backward_hops > 0) children.push_back((position - 1 + length) % length);
+        }
+        else if (relative <= forward_hops) {
+            parent = (position - 1 + length) % length;
+            if (relative < forward_hops) children.push_back((position + 1) % length);
+        }
+        else {
+            int distance = length - relative;
+            parent = (position + 1) % length;
+            if (distance < backward_hops) children.push_back((position - 1 + length) % length);
+        }
+    }
+
+    void MultiPortTorusBroadcast::build_tree(const TorusCommunicators& torus, MPI_Comm comm, int root,
+        bool& has_parent, TreeLink& parent, std::vector<TreeLink>& children) const {
+        int world_rank;
+        MPI_Comm_rank(comm, &world_rank);
+
+        const int* dims = torus.dims;
+        const int* coords = torus.coords;
+
+        int root_coords[3] = {
+            root % dims[0],
+            (root / dims[0]) % dims[1],
+            root / (dims[0] * dims[1])
+        };
+
+        // Only the slab at the highest coordinate of the last dimension can be
+        // incomplete; a root inside it hands the data to its slab-0 twin first
+        int last_dim = 0;
+        for (int d = 0; d < 3; ++d) {
+            if (dims[d] > 1) last_dim = d;
+        }
+        int slab_size = 1;
+        for (int d = 0; d < last_dim; ++d) {
+            slab_size *= dims[d];
+        }
+
+        int tree_root_coords[3] = { root_coords[0], root_coords[1], root_coords[2] };
+        if ((root_coords[last_dim] + 1) * slab_size > torus.total_processes) {
+            tree_root_coords[last_dim] = 0;
+        }
+        int tree_root = CommunicatorCache::torus_rank(torus, tree_root_coords[0],
+            tree_root_coords[1], tree_root_coords[2]);
+        bool relayed = (tree_root != root);
+
+        has_parent = false;
+        children.clear();
+
+        if (relayed && world_rank == root) {
+            children.push_back({ comm, tree_root, tree_root });
+        }
+        if (relayed && world_rank == tree_root) {
+            has_parent = true;
+            parent = { comm, root, root };
+        }
+
+        auto world_rank_at = [&](int dim, int position) {
+            int c[3] = { coords[0], coords[1], coords[2] };
+            c[dim] = position;
+            return CommunicatorCache::torus_rank(torus, c[0], c[1], c[2]);
+        };
+
+        // Highest dimension in which this rank differs from the tree root
+        int arrival_dim = -1;
+        for (int d = 0; d < 3; ++d) {
+            if (coords[d] != tree_root_coords[d]) arrival_dim = d;
+        }
+
+        int line_parent;
+        std::vector<int> line_children;
+
+        for (int d = std::max(arrival_dim, 0); d < 3; ++d) {
+            if (d != arrival_dim && dims[d] == 1) continue;
+
+            MPI_Comm line = torus.line_comm(d);
+            int line_size;
+            MPI_Comm_size(line, &line_size);
+            line_neighbors(coords[d], line_size, tree_root_coords[d], line_parent, line_children);
+
+            if (d == arrival_dim && !(relayed && world_rank == root)) {
+                has_parent = true;
+                parent = { line, line_parent, world_rank_at(d, line_parent) };
+            }
+
+            for (int position : line_children) {
+                int peer = world_rank_at(d, position);
+                // The original root already holds the data
+                if (relayed && peer == root) continue;
+                children.push_back({ line, position, peer });
+            }
+        }
+    }
+
+} // namespace TopologyAwareResearch
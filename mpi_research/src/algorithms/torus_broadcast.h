@@ -0,0 +1,49 @@
+#ifndef TORUS_BROADCAST_H
+#define TORUS_BROADCAST_H
+
+#include <mpi.h>
+#include <vector>
+#include "../core/collective_optimizer.h"
+#include "../core/communicator_cache.h"
+#include "pipelined_tree.h"
+
+namespace TopologyAwareResearch {
+
+    // Pipelined multi-port broadcast for 2D/3D tori.
+    //
+    // The message is cut into segments and spread dimension by dimension
+    // (x, then y, then z). Along every line the root's data travels in both
+    // wrap-around directions at once, and each rank forwards a segment to all
+    // of its children (same line and the lines of later dimensions) as soon
+    // as it arrives, so successive dimensions overlap instead of running as
+    // separate phases. Partial tori are supported: if the root sits in an
+    // incomplete last slab it first relays to its counterpart in slab 0.
+    class MultiPortTorusBroadcast {
+    private:
+        NetworkCharacteristics network_config_;
+        int segment_bytes_;
+
+    public:
+        MultiPortTorusBroadcast(const NetworkCharacteristics& config);
+        ~MultiPortTorusBroadcast();
+
+        PerformanceMetrics broadcast(void* buffer, int count,
+            MPI_Datatype datatype, int root,
+            MPI_Comm comm);
+
+        void set_segment_size(int bytes) { segment_bytes_ = bytes; }
+        int get_segment_size() const { return segment_bytes_; }
+
+    private:
+        // Bidirectional chain along one ring: the root feeds both neighbours,
+        // every other position forwards away from the root.
+        void line_neighbors(int position, int length, int root_position,
+            int& parent, std::vector<int>& children) const;
+
+        void build_tree(const TorusCommunicators& torus, MPI_Comm comm, int root,
+            bool& has_parent, TreeLink& parent, std::vector<TreeLink>& children) const;
+    };
+
+} // namespace TopologyAwareResearch
+
+#endif // TORUS_BROADCAST_H
@@ -0,0 +1,174 @@
+#ifndef TYPED_COLLECTIVES_H
+#define TYPED_COLLECTIVES_H
+
+#include <mpi.h>
+#include <algorithm>
+#include <climits>
+#include <complex>
+#include <type_traits>
+#include <vector>
+#include "../core/reduction_ops.h"
+#include "fused_allreduce.h"
+#include "topology_aware_broadcast.h"
+
+namespace TopologyAwareResearch {
+namespace typed {
+
+    // Compile-time collective API for C++ callers: the element type and the
+    // operation are template parameters, so the MPI datatype and element
+    // size are fixed at compile time. Operations with a predefined MPI op
+    // use the library's own SIMD kernels; other functors are reduced by a
+    // loop instantiated in the calling translation unit.
+    //
+    //   typed::allreduce<double, typed::Sum>(values, comm);
+    //   typed::bcast<int>(broadcaster, counts, root, comm);
+
+    // Predefined MPI datatype of T
+    template<typename T> struct Datatype;
+    template<> struct Datatype<char> { static MPI_Datatype get() { return MPI_CHAR; } };
+    template<> struct Datatype<signed char> { static MPI_Datatype get() { return MPI_SIGNED_CHAR; } };
+    template<> struct Datatype<unsigned char> { static MPI_Datatype get() { return MPI_UNSIGNED_CHAR; } };
+    template<> struct Datatype<short> { static MPI_Datatype get() { return MPI_SHORT; } };
+    template<> struct Datatype<unsigned short> { static MPI_Datatype get() { return MPI_UNSIGNED_SHORT; } };
+    template<> struct Datatype<int> { static MPI_Datatype get() { return MPI_INT; } };
+    template<> struct Datatype<unsigned> { static MPI_Datatype get() { return MPI_UNSIGNED; } };
+    template<> struct Datatype<long> { static MPI_Datatype get() { return MPI_LONG; } };
+    template<> struct Datatype<unsigned long> { static MPI_Datatype get() { return MPI_UNSIGNED_LONG; } };
+    template<> struct Datatype<long long> { static MPI_Datatype get() { return MPI_LONG_LONG; } };
+    template<> struct Datatype<unsigned long long> { static MPI_Datatype get() { return MPI_UNSIGNED_LONG_LONG; } };
+    template<> struct Datatype<float> { static MPI_Datatype get() { return MPI_FLOAT; } };
+    template<> struct Datatype<double> { static MPI_Datatype get() { return MPI_DOUBLE; } };
+    template<> struct Datatype<long double> { static MPI_Datatype get() { return MPI_LONG_DOUBLE; } };
+    template<> struct Datatype<std::complex<float>> { static MPI_Datatype get() { return MPI_C_FLOAT_COMPLEX; } };
+    template<> struct Datatype<std::complex<double>> { static MPI_Datatype get() { return MPI_C_DOUBLE_COMPLEX; } };
+
+    // Operations: result = op(left, right), plus the matching predefined op.
+    // Any default-constructible functor without mpi_op() also works.
+    struct Sum {
+        static MPI_Op mpi_op() { return MPI_SUM; }
+        template<typename T> T operator()(T left, T right) const { return left + right; }
+    };
+    struct Prod {
+        static MPI_Op mpi_op() { return MPI_PROD; }
+        template<typename T> T operator()(T left, T right) const { return left * right; }
+    };
+    struct Max {
+        static MPI_Op mpi_op() { return MPI_MAX; }
+        template<typename T> T operator()(T left, T right) const { return left > right ? left : right; }
+    };
+    struct Min {
+        static MPI_Op mpi_op() { return MPI_MIN; }
+        template<typename T> T operator()(T left, T right) const { return left < right ? left : right; }
+    };
+    struct Band {
+        static MPI_Op mpi_op() { return MPI_BAND; }
+        template<typename T> T operator()(T left, T right) const { return left & right; }
+    };
+    struct Bor {
+        static MPI_Op mpi_op() { return MPI_BOR; }
+        template<typename T> T operator()(T left, T right) const { return left | right; }
+    };
+    struct Bxor {
+        static MPI_Op mpi_op() { return MPI_BXOR; }
+        template<typename T> T operator()(T left, T right) const { return left ^ right; }
+    };
+
+    // Whether Op names a predefined MPI op
+    template<typename Op, typename = void>
+    struct has_mpi_op : std::false_type {};
+    template<typename Op>
+    struct has_mpi_op<Op, std::void_t<decltype(Op::mpi_op())>> : std::true_type {};
+
+    // dst = a op b over count elements of T, forward too unless null
+    template<typename T, typename Op>
+    void reduce_loop(const ReductionKernel&, void* dst, const void* a, const void* b,
+                     void* forward, int count) {
+        T* d = static_cast<T*>(dst);
+        const T* x = static_cast<const T*>(a);
+        const T* y = static_cast<const T*>(b);
+        if (forward == nullptr) {
+            for (int i = 0; i < count; ++i) {
+                d[i] = Op()(x[i], y[i]);
+            }
+        }
+        else {
+            T* f = static_cast<T*>(forward);
+            for (int i = 0; i < count; ++i) {
+                T result = Op()(x[i], y[i]);
+                d[i] = result;
+                f[i] = result;
+            }
+        }
+    }
+
+    // Kernel for T and Op. Predefined ops resolve to the library's kernel
+    // (SIMD at the runtime level, streaming stores, threads); user functors
+    // get reduce_loop, split across threads as set by set_parallel_reduction
+    template<typename T, typename Op>
+    ReductionKernel reduction_kernel() {
+        static_assert(std::is_trivially_copyable_v<T>, "elements are moved as raw bytes");
+        if constexpr (has_mpi_op<Op>::value) {
+            return resolve_reduction_kernel(Datatype<T>::get(), Op::mpi_op());
+        }
+        else {
+            ReductionKernel kernel;
+            kernel.function = &reduce_loop<T, Op>;
+            kernel.datatype = Datatype<T>::get();
+            kernel.op = MPI_OP_NULL;
+            kernel.extent = sizeof(T);
+            int threads = parallel_reduction_threads();
+            if (threads > 1) {
+                kernel.parallel_threads = threads;
+                size_t min_count = std::max<size_t>(parallel_reduction_threshold() / sizeof(T), 1);
+                kernel.parallel_min_count = static_cast<int>(std::min<size_t>(min_count, INT_MAX));
+            }
+            return kernel;
+        }
+    }
+
+    namespace detail {
+        // Recursive doubling up to 32 KiB on more than two ranks, the ring
+        // above, as CollectiveOptimizer::adaptive_allreduce
+        template<typename T, typename Op>
+        PerformanceMetrics allreduce(const void* sendbuf, T* recvbuf, int count, MPI_Comm comm) {
+            int world_size;
+            MPI_Comm_size(comm, &world_size);
+            ReductionKernel kernel = reduction_kernel<T, Op>();
+            if (static_cast<long long>(count) * sizeof(T) <= 32768 && world_size > 2) {
+                return fused_recursive_doubling_allreduce_with_kernel(sendbuf, recvbuf, count, kernel, comm);
+            }
+            return fused_ring_allreduce_with_kernel(sendbuf, recvbuf, count, kernel, comm);
+        }
+    }
+
+    template<typename T, typename Op>
+    PerformanceMetrics allreduce(const T* sendbuf, T* recvbuf, int count, MPI_Comm comm) {
+        return detail::allreduce<T, Op>(sendbuf, recvbuf, count, comm);
+    }
+
+    // In place
+    template<typename T, typename Op>
+    PerformanceMetrics allreduce(T* buffer, int count, MPI_Comm comm) {
+        return detail::allreduce<T, Op>(MPI_IN_PLACE, buffer, count, comm);
+    }
+
+    template<typename T, typename Op>
+    PerformanceMetrics allreduce(std::vector<T>& values, MPI_Comm comm) {
+        return allreduce<T, Op>(values.data(), static_cast<int>(values.size()), comm);
+    }
+
+    template<typename T>
+    PerformanceMetrics bcast(TopologyAwareBroadcast& broadcaster, T* buffer, int count, int root, MPI_Comm comm) {
+        static_assert(std::is_trivially_copyable_v<T>, "elements are moved as raw bytes");
+        return broadcaster.broadcast(buffer, count, Datatype<T>::get(), root, comm);
+    }
+
+    template<typename T>
+    PerformanceMetrics bcast(TopologyAwareBroadcast& broadcaster, std::vector<T>& values, int root, MPI_Comm comm) {
+        return bcast<T>(broadcaster, values.data(), static_cast<int>(values.size()), root, comm);
+    }
+
+} // namespace typed
+} // namespace TopologyAwareResearch
+
+#endif // TYPED_COLLECTIVES_H
@@ -0,0 +1,543 @@
+#include "variable_block_collectives.h"
+#include "../core/scratch_pool.h"
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+
+namespace TopologyAwareResearch {
+
+    namespace {
+        const int kVariableBlockTag = 11;
+
+        // Totals below this are latency bound
+        const long long kShortAllgathervBytes = 81920;
+    }
+
+    VariableBlockCollectives::VariableBlockCollectives(const NetworkCharacteristics& config)
+        : network_config_(config) {
+    }
+
+    VariableBlockCollectives::~VariableBlockCollectives() {}
+
+    PerformanceMetrics VariableBlockCollectives::allgatherv(const void* sendbuf, int sendcount, MPI_Datatype sendtype,
+        void* recvbuf, const int* recvcounts, const int* displs,
+        MPI_Datatype recvtype, MPI_Comm comm) {
+        int world_size;
+        MPI_Comm_size(comm, &world_size);
+
+        const NodeCommunicators& node = CommunicatorCache::node(comm, network_config_.node_mapping);
+        if (has_node_hierarchy(node, world_size)) {
+            return hierarchical_allgatherv(sendbuf, sendcount, sendtype, recvbuf, recvcounts, displs, recvtype, comm);
+        }
+
+        int type_size;
+        MPI_Type_size(recvtype, &type_size);
+        long long total_bytes = static_cast<long long>(type_size) *
+            std::accumulate(recvcounts, recvcounts + world_size, 0LL);
+        if (total_bytes >= kShortAllgathervBytes) {
+            return ring_allgatherv(sendbuf, sendcount, sendtype, recvbuf, recvcounts, displs, recvtype, comm);
+        }
+
+        PerformanceMetrics metrics;
+        auto start_time = MPI_Wtime();
+        MPI_Allgatherv(sendbuf, sendcount, sendtype, recvbuf, recvcounts, displs, recvtype, comm);
+        metrics.execution_time = MPI_Wtime() - start_time;
+        return metrics;
+    }
+
+    PerformanceMetrics VariableBlockCollectives::gatherv(const void* sendbuf, int sendcount, MPI_Datatype sendtype,
+        void* recvbuf, const int* recvcounts, const int* displs,
+        MPI_Datatype recvtype, int root, MPI_Comm comm) {
+        int world_size;
+        MPI_Comm_size(comm, &world_size);
+
+        const NodeCommunicators& node = CommunicatorCache::node(comm, network_config_.node_mapping);
+        if (has_node_hierarchy(node, world_size)) {
+            return hierarchical_gatherv(sendbuf, sendcount, sendtype, recvbuf, recvcounts, displs, recvtype, root, comm);
+        }
+
+        PerformanceMetrics metrics;
+        auto start_time = MPI_Wtime();
+        MPI_Gatherv(sendbuf, sendcount, sendtype, recvbuf, recvcounts, displs, recvtype, root, comm);
+        metrics.execution_time = MPI_Wtime() - start_time;
+        return metrics;
+    }
+
+    PerformanceMetrics VariableBlockCollectives::scatterv(const void* sendbuf, const int* sendcounts, const int* displs,
+        MPI_Datatype sendtype, void* recvbuf, int recvcount,
+        MPI_Datatype recvtype, int root, MPI_Comm comm) {
+        int world_size;
+        MPI_Comm_size(comm, &world_size);
+
+        const NodeCommunicators& node = CommunicatorCache::node(comm, network_config_.node_mapping);
+        if (has_node_hierarchy(node, world_size)) {
+            return hierarchical_scatterv(sendbuf, sendcounts, displs, sendtype, recvbuf, recvcount, recvtype, root, comm);
+        }
+
+        PerformanceMetrics metrics;
+        auto start_time = MPI_Wtime();
+        MPI_Scatterv(sendbuf, sendcounts, displs, sendtype, recvbuf, recvcount, recvtype, root, comm);
+        metrics.execution_time = MPI_Wtime() - start_time;
+        return metrics;
+    }
+
+    PerformanceMetrics VariableBlockCollectives::ring_allgatherv(const void* sendbuf, int sendcount, MPI_Datatype sendtype,
+        void* recvbuf, const int* recvcounts, const int* displs,
+        MPI_Datatype recvtype, MPI_Comm comm) {
+        PerformanceMetrics metrics;
+        auto start_time = MPI_Wtime();
+
+        int world_size, world_rank;
+        MPI_Comm_size(comm, &world_size);
+        MPI_Comm_rank(comm, &world_rank);
+
+        MPI_Aint lower_bound, extent;
+        MPI_Type_get_extent(recvtype, &lower_bound, &extent);
+        char* blocks = static_cast<char*>(recvbuf);
+
+        if (sendbuf != MPI_IN_PLACE) {
+            MPI_Sendrecv(sendbuf, sendcount, sendtype, 0, kVariableBlockTag,
+                blocks + displs[world_rank] * extent, recvcounts[world_rank], recvtype, 0, kVariableBlockTag,
+                MPI_COMM_SELF, MPI_STATUS_IGNORE);
+        }
+
+        const NodeCommunicators& node = CommunicatorCache::node(comm, network_config_.node_mapping);
+        const std::vector<int>& order = node.node_order;
+        int position = static_cast<int>(std::find(order.begin(), order.end(), world_rank) - order.begin());
+        int right = order[(position + 1) % world_size];
+        int left = order[(position - 1 + world_size) % world_size];
+
+        long long bytes_sent = 0;
+        for (int step = 0; step < world_size - 1; ++step) {
+            int send_block = order[(position - step + world_size) % world_size];
+            int recv_block = order[(position - step - 1 + world_size) % world_size];
+
+            MPI_Sendrecv(blocks + displs[send_block] * extent, recvcounts[send_block], recvtype, right, kVariableBlockTag,
+                blocks + displs[recv_block] * extent, recvcounts[recv_block], recvtype, left, kVariableBlockTag,
+                comm, MPI_STATUS_IGNORE);
+            bytes_sent += recvcounts[send_block];
+        }
+
+        int type_size;
+        MPI_Type_size(recvtype, &type_size);
+
+        auto end_time = MPI_Wtime();
+        metrics.execution_time = end_time - start_time;
+        metrics.communication_time = metrics.execution_time;
+        metrics.messages_sent = world_size - 1;
+        metrics.bytes_transferred = static_cast<int>(bytes_sent * type_size);
+        if (world_size > 1) {
+            metrics.communication_edges.emplace_back(world_rank, right);
+        }
+
+        return metrics;
+    }
+
+    PerformanceMetrics VariableBlockCollectives::hierarchical_allgatherv(const void* sendbuf, int sendcount, MPI_Datatype sendtype,
+        void* recvbuf, const int* recvcounts, const int* displs,
+        MPI_Datatype recvtype, MPI_Comm comm) {
+        PerformanceMetrics metrics;
+        auto start_time = MPI_Wtime();
+
+        int world_size, world_rank;
+        MPI_Comm_size(comm, &world_size);
+        MPI_Comm_rank(comm, &world_rank);
+
+        const NodeCommunicators& node = CommunicatorCache::node(comm, network_config_.node_mapping);
+
+        MPI_Aint lower_bound, extent;
+        MPI_Type_get_extent(recvtype, &lower_bound, &extent);
+        int type_size;
+        MPI_Type_size(recvtype, &type_size);
+        char* blocks = static_cast<char*>(recvbuf);
+
+        if (sendbuf != MPI_IN_PLACE) {
+            MPI_Sendrecv(sendbuf, sendcount, sendtype, 0, kVariableBlockTag,
+                blocks + displs[world_rank] * extent, recvcounts[world_rank], recvtype, 0, kVariableBlockTag,
+                MPI_COMM_SELF, MPI_STATUS_IGNORE);
+        }
+
+        // Every rank knows all counts, so every rank can name every aggregator
+        std::vector<std::vector<int>> members(node.node_count);
+        std::vector<int> aggregators(node.node_count);
+        std::vector<long long> node_bytes(node.node_count, 0);
+        for (int n = 0; n < node.node_count; ++n) {
+            members[n] = node_members(node, n);
+            std::vector<long long> member_bytes;
+            for (int member : members[n]) {
+                member_bytes.push_back(static_cast<long long>(recvcounts[member]) * type_size);
+                node_bytes[n] += member_bytes.back();
+            }
+            aggregators[n] = select_aggregator(members[n], member_bytes);
+        }
+        const std::vector<int>& my_members = members[node.node_index];
+        int my_aggregator = aggregators[node.node_index];
+
+        int messages = 0;
+        long long bytes_sent = 0;
+
+        // Step 1: blocks land in place at the node aggregator
+        if (world_rank != my_aggregator) {
+            MPI_Send(blocks + displs[world_rank] * extent, recvcounts[world_rank], recvtype,
+                my_aggregator, kVariableBlockTag, comm);
+            ++messages;
+            bytes_sent += static_cast<long long>(recvcounts[world_rank]) * type_size;
+        }
+        else {
+            std::vector<MPI_Request> requests;
+            for (int member : my_members) {
+                if (member == world_rank) continue;
+                requests.emplace_back();
+                MPI_Irecv(blocks + displs[member] * extent, recvcounts[member], recvtype,
+                    member, kVariableBlockTag, comm, &requests.back());
+            }
+            MPI_Waitall(static_cast<int>(requests.size()), requests.data(), MPI_STATUSES_IGNORE);
+        }
+
+        // Step 2: node blocks travel a ring of aggregators, described in place
+        if (world_rank == my_aggregator && node.node_count > 1) {
+            int node_count = node.node_count;
+            std::vector<MPI_Datatype> node_types(node_count);
+            for (int n = 0; n < node_count; ++n) {
+                node_types[n] = blocks_type(members[n], recvcounts, displs, recvtype);
+            }
+
+            int right = aggregators[(node.node_index + 1) % node_count];
+            int left = aggregators[(node.node_index - 1 + node_count) % node_count];
+            for (int step = 0; step < node_count - 1; ++step) {
+                int send_node = (node.node_index - step + node_count) % node_count;
+                int recv_node = (node.node_index - step - 1 + node_count) % node_count;
+                MPI_Sendrecv(blocks, 1, node_types[send_node], right, kVariableBlockTag,
+                    blocks, 1, node_types[recv_node], left, kVariableBlockTag,
+                    comm, MPI_STATUS_IGNORE);
+                ++messages;
+                bytes_sent += node_bytes[send_node];
+            }
+            metrics.communication_edges.emplace_back(world_rank, right);
+
+            for (MPI_Datatype& type : node_types) {
+                MPI_Type_free(&type);
+            }
+        }
+
+        // Step 3: one broadcast of the whole result per node
+        if (my_members.size() > 1) {
+            std::vector<int> all_ranks(world_size);
+            std::iota(all_ranks.begin(), all_ranks.end(), 0);
+            MPI_Datatype all_blocks = blocks_type(all_ranks, recvcounts, displs, recvtype);
+
+            int aggregator_node_rank = static_cast<int>(
+                std::find(my_members.begin(), my_members.end(), my_aggregator) - my_members.begin());
+            MPI_Bcast(blocks, 1, all_blocks, aggregator_node_rank, node.node_comm);
+            MPI_Type_free(&all_blocks);
+        }
+
+        auto end_time = MPI_Wtime();
+        metrics.execution_time = end_time - start_time;
+        metrics.communication_time = metrics.execution_time;
+        metrics.messages_sent = messages;
+        metrics.bytes_transferred = static_cast<int>(bytes_sent);
+
+        return metrics;
+    }
+
+    PerformanceMetrics VariableBlockCollectives::hierarchical_gatherv(const void* sendbuf, int sendcount, MPI_Datatype sendtype,
+        void* recvbuf, const int* recvcounts, const int* displs,
+        MPI_Datatype recvtype, int root, MPI_Comm comm) {
+        PerformanceMetrics metrics;
+        auto start_time = MPI_Wtime();
+
+        int world_size, world_rank;
+        MPI_Comm_size(comm, &world_size);
+        MPI_Comm_rank(comm, &world_rank);
+
+        const NodeCommunicators& node = CommunicatorCache::node(comm, network_config_.node_mapping);
+        std::vector<int> my_members = node_members(node, node.node_index);
+        bool root_node = std::find(my_members.begin(), my_members.end(), root) != my_members.end();
+
+        int messages = 0;
+        long long bytes_sent = 0;
+
+        if (world_rank == root) {
+            MPI_Aint lower_bound, extent;
+            MPI_Type_get_extent(recvtype, &lower_bound, &extent);
+            int type_size;
+            MPI_Type_size(recvtype, &type_size);
+            char* blocks = static_cast<char*>(recvbuf);
+
+            if (sendbuf != MPI_IN_PLACE) {
+                MPI_Sendrecv(sendbuf, sendcount, sendtype, 0, kVariableBlockTag,
+                    blocks + displs[root] * extent, recvcounts[root], recvtype, 0, kVariableBlockTag,
+                    MPI_COMM_SELF, MPI_STATUS_IGNORE);
+            }
+
+            std::vector<MPI_Request> requests;
+            std::vector<MPI_Datatype> node_types;
+
+            // Own node: straight from each member
+            for (int member : my_members) {
+                if (member == root) continue;
+                requests.emplace_back();
+                MPI_Irecv(blocks + displs[member] * extent, recvcounts[member], recvtype,
+                    member, kVariableBlockTag, comm, &requests.back());
+            }
+
+            // Remote nodes: one aggregated message each, unpacked by the datatype
+            for (int n = 0; n < node.node_count; ++n) {
+                if (n == node.node_index) continue;
+                std::vector<int> members = node_members(node, n);
+                std::vector<long long> member_bytes;
+                for (int member : members) {
+                    member_bytes.push_back(static_cast<long long>(recvcounts[member]) * type_size);
+                }
+                int aggregator = select_aggregator(members, member_bytes);
+
+                node_types.push_back(blocks_type(members, recvcounts, displs, recvtype));
+                requests.emplace_back();
+                MPI_Irecv(blocks, 1, node_types.back(), aggregator, kVariableBlockTag, comm, &requests.back());
+                metrics.communication_edges.emplace_back(aggregator, root);
+            }
+
+            MPI_Waitall(static_cast<int>(requests.size()), requests.data(), MPI_STATUSES_IGNORE);
+            for (MPI_Datatype& type : node_types) {
+                MPI_Type_free(&type);
+            }
+        }
+        else {
+            MPI_Aint lower_bound, extent;
+            MPI_Type_get_extent(sendtype, &lower_bound, &extent);
+            int type_size;
+            MPI_Type_size(sendtype, &type_size);
+
+            if (root_node) {
+                MPI_Send(sendbuf, sendcount, sendtype, root, kVariableBlockTag, comm);
+                ++messages;
+                bytes_sent += static_cast<long long>(sendcount) * type_size;
+            }
+            else {
+                // Node-local counts decide the aggregator, matching the root's choice
+                int my_counts[2] = { sendcount, type_size };
+                std::vector<int> member_counts(2 * my_members.size());
+                MPI_Allgather(my_counts, 2, MPI_INT, member_counts.data(), 2, MPI_INT, node.node_comm);
+
+                std::vector<long long> member_bytes(my_members.size());
+                for (size_t i = 0; i < my_members.size(); ++i) {
+                    member_bytes[i] = static_cast<long long>(member_counts[2 * i]) * member_counts[2 * i + 1];
+                }
+                int aggregator = select_aggregator(my_members, member_bytes);
+
+                if (world_rank != aggregator) {
+                    MPI_Send(sendbuf, sendcount, sendtype, aggregator, kVariableBlockTag, comm);
+                    ++messages;
+                    bytes_sent += static_cast<long long>(sendcount) * type_size;
+                }
+                else {
+                    // Pack the node's blocks in rank order and ship them as one message
+                    std::vector<MPI_Aint> offsets(my_members.size() + 1, 0);
+                    for (size_t i = 0; i < my_members.size(); ++i) {
+                        offsets[i + 1] = offsets[i] + member_counts[2 * i] * extent;
+                    }
+                    ScratchBuffer packed = ScratchPool::local().acquire(offsets.back());
+                    int packed_count = static_cast<int>(offsets.back() / std::max<MPI_Aint>(extent, 1));
+
+                    std::vector<MPI_Request> requests;
+                    for (size_t i = 0; i < my_members.size(); ++i) {
+                        if (my_members[i] == world_rank) {
+                            MPI_Sendrecv(sendbuf, sendcount, sendtype, 0, kVariableBlockTag,
+                                packed.data() + offsets[i], sendcount, sendtype, 0, kVariableBlockTag,
+                                MPI_COMM_SELF, MPI_STATUS_IGNORE);
+                            continue;
+                        }
+                        requests.emplace_back();
+                        MPI_Irecv(packed.data() + offsets[i], member_counts[2 * i], sendtype,
+                            my_members[i], kVariableBlockTag, comm, &requests.back());
+                    }
+                    MPI_Waitall(static_cast<int>(requests.size()), requests.data(), MPI_STATUSES_IGNORE);
+
+                    MPI_Send(packed.data(), packed_count, sendtype, root, kVariableBlockTag, comm);
+                    ++messages;
+                    bytes_sent += static_cast<long long>(packed_count) * type_size;
+                    metrics.communication_edges.emplace_back(world_rank, root);
+                }
+            }
+        }
+
+        auto end_time = MPI_Wtime();
+        metrics.execution_time = end_time - start_time;
+        metrics.communication_time = metrics.execution_time;
+        metrics.messages_sent = messages;
+        metrics.bytes_transferred = static_cast<int>(bytes_sent);
+
+        return metrics;
+    }
+
+    PerformanceMetrics VariableBlockCollectives::hierarchical_scatterv(const void* sendbuf, const int* sendcounts, const int* displs,
+        MPI_Datatype sendtype, void* recvbuf, int recvcount,
+        MPI_Datatype recvtype, int root, MPI_Comm comm) {
+        PerformanceMetrics metrics;
+        auto start_time = MPI_Wtime();
+
+        int world_size, world_rank;
+        MPI_Comm_size(comm, &world_size);
+        MPI_Comm_rank(comm, &world_rank);
+
+        const NodeCommunicators& node = CommunicatorCache::node(comm, network_config_.node_mapping);
+        std::vector<int> my_members = node_members(node, node.node_index);
+        bool root_node = std::find(my_members.begin(), my_members.end(), root) != my_members.end();
+
+        int messages = 0;
+        long long bytes_sent = 0;
+
+        if (world_rank == root) {
+            MPI_Aint lower_bound, extent;
+            MPI_Type_get_extent(sendtype, &lower_bound, &extent);
+            int type_size;
+            MPI_Type_size(sendtype, &type_size);
+            const char* blocks = static_cast<const char*>(sendbuf);
+
+            // Remote nodes first, largest first, so the long transfers start early
+            std::vector<std::pair<long long, int>> remote_nodes;
+            for (int n = 0; n < node.node_count; ++n) {
+                if (n == node.node_index) continue;
+                long long bytes = 0;
+                for (int member : node_members(node, n)) {
+                    bytes += static_cast<long long>(sendcounts[member]) * type_size;
+                }
+                remote_nodes.emplace_back(-bytes, n);
+            }
+            std::sort(remote_nodes.begin(), remote_nodes.end());
+
+            std::vector<MPI_Request> requests;
+            std::vector<MPI_Datatype> node_types;
+            for (const auto& remote : remote_nodes) {
+                std::vector<int> members = node_members(node, remote.second);
+                std::vector<long long> member_bytes;
+                for (int member : members) {
+                    member_bytes.push_back(static_cast<long long>(sendcounts[member]) * type_size);
+                }
+                int aggregator = select_aggregator(members, member_bytes);
+
+                node_types.push_back(blocks_type(members, sendcounts, displs, sendtype));
+                requests.emplace_back();
+                MPI_Isend(blocks, 1, node_types.back(), aggregator, kVariableBlockTag, comm, &requests.back());
+                ++messages;
+                bytes_sent -= remote.first;
+                metrics.communication_edges.emplace_back(root, aggregator);
+            }
+
+            for (int member : my_members) {
+                if (member == root) continue;
+                requests.emplace_back();
+                MPI_Isend(blocks + displs[member] * extent, sendcounts[member], sendtype,
+                    member, kVariableBlockTag, comm, &requests.back());
+                ++messages;
+                bytes_sent += static_cast<long long>(sendcounts[member]) * type_size;
+            }
+
+            if (recvbuf != MPI_IN_PLACE) {
+                MPI_Sendrecv(blocks + displs[root] * extent, sendcounts[root], sendtype, 0, kVariableBlockTag,
+                    recvbuf, recvcount, recvtype, 0, kVariableBlockTag,
+                    MPI_COMM_SELF, MPI_STATUS_IGNORE);
+            }
+
+            MPI_Waitall(static_cast<int>(requests.size()), requests.data(), MPI_STATUSES_IGNORE);
+            for (MPI_Datatype& type : node_types) {
+                MPI_Type_free(&type);
+            }
+        }
+        else {
+            MPI_Aint lower_bound, extent;
+            MPI_Type_get_extent(recvtype, &lower_bound, &extent);
+            int type_size;
+            MPI_Type_size(recvtype, &type_size);
+
+            if (root_node) {
+                MPI_Recv(recvbuf, recvcount, recvtype, root, kVariableBlockTag, comm, MPI_STATUS_IGNORE);
+            }
+            else {
+                int my_counts[2] = { recvcount, type_size };
+                std::vector<int> member_counts(2 * my_members.size());
+                MPI_Allgather(my_counts, 2, MPI_INT, member_counts.data(), 2, MPI_INT, node.node_comm);
+
+                std::vector<long long> member_bytes(my_members.size());
+                for (size_t i = 0; i < my_members.size(); ++i) {
+                    member_bytes[i] = static_cast<long long>(member_counts[2 * i]) * member_counts[2 * i + 1];
+                }
+                int aggregator = select_aggregator(my_members, member_bytes);
+
+                if (world_rank != aggregator) {
+                    MPI_Recv(recvbuf, recvcount, recvtype, aggregator, kVariableBlockTag, comm, MPI_STATUS_IGNORE);
+                }
+                else {
+                    // The node's blocks arrive packed in rank order
+                    std::vector<MPI_Aint> offsets(my_members.size() + 1, 0);
+                    for (size_t i = 0; i < my_members.size(); ++i) {
+                        offsets[i + 1] = offsets[i] + member_counts[2 * i] * extent;
+                    }
+                    ScratchBuffer packed = ScratchPool::local().acquire(offsets.back());
+                    int packed_count = static_cast<int>(offsets.back() / std::max<MPI_Aint>(extent, 1));
+                    MPI_Recv(packed.data(), packed_count, recvtype, root, kVariableBlockTag, comm, MPI_STATUS_IGNORE);
+
+                    std::vector<MPI_Request> requests;
+                    for (size_t i = 0; i < my_members.size(); ++i) {
+                        if (my_members[i] == world_rank) {
+                            std::memcpy(recvbuf, packed.data() + offsets[i], offsets[i + 1] - offsets[i]);
+                            continue;
+                        }
+                        requests.emplace_back();
+                        MPI_Isend(packed.data() + offsets[i], member_counts[2 * i], recvtype,
+                            my_members[i], kVariableBlockTag, comm, &requests.back());
+                        ++messages;
+                        bytes_sent += static_cast<long long>(member_counts[2 * i]) * type_size;
+                    }
+                    MPI_Waitall(static_cast<int>(requests.size()), requests.data(), MPI_STATUSES_IGNORE);
+                }
+            }
+        }
+
+        auto end_time = MPI_Wtime();
+        metrics.execution_time = end_time - start_time;
+        metrics.communication_time = metrics.execution_time;
+        metrics.messages_sent = messages;
+        metrics.bytes_transferred = static_cast<int>(bytes_sent);
+
+        return metrics;
+    }
+
+    std::vector<int> VariableBlockCollectives::node_members(const NodeCommunicators& node, int index) {
+        int offset = std::accumulate(node.node_sizes.begin(), node.node_sizes.begin() + index, 0);
+        return std::vector<int>(node.node_order.begin() + offset,
+            node.node_order.begin() + offset + node.node_sizes[index]);
+    }
+
+    int VariableBlockCollectives::select_aggregator(const std::vector<int>& members,
+        const std::vector<long long>& member_bytes) {
+        size_t best = 0;
+        for (size_t i = 1; i < members.size(); ++i) {
+            if (member_bytes[i] > member_bytes[best]) {
+                best = i;
+            }
+        }
+        return members[best];
+    }
+
+    MPI_Datatype VariableBlockCollectives::blocks_type(const std::vector<int>& ranks, const int* counts,
+        const int* displs, MPI_Datatype datatype) {
+        std::vector<int> block_lengths, block_displs;
+        for (int rank : ranks) {
+            block_lengths.push_back(counts[rank]);
+            block_displs.push_back(displs[rank]);
+        }
+
+        MPI_Datatype type;
+        MPI_Type_indexed(static_cast<int>(ranks.size()), block_lengths.data(), block_displs.data(),
+            datatype, &type);
+        MPI_Type_commit(&type);
+        return type;
+    }
+
+    bool VariableBlockCollectives::has_node_hierarchy(const NodeCommunicators& node, int world_size) {
+        return node.node_count > 1 && node.node_count < world_size;
+    }
+
+} // namespace TopologyAwareResearch
@@ -0,0 +1,79 @@
+#ifndef VARIABLE_BLOCK_COLLECTIVES_H
+#define VARIABLE_BLOCK_COLLECTIVES_H
+
+#include <mpi.h>
+#include <vector>
+#include "../core/collective_optimizer.h"
+#include "../core/communicator_cache.h"
+
+namespace TopologyAwareResearch {
+
+    // Allgatherv, gatherv and scatterv for uneven block sizes. Signatures and
+    // MPI_IN_PLACE rules follow the MPI calls of the same name.
+    //
+    // On multi-node runs the blocks are aggregated per node so that a single
+    // message per node crosses the network. Each node's aggregator is the
+    // rank with the largest block (the root on the root's node), so the
+    // biggest contributors never move their data inside the node, and remote
+    // node blocks are received straight into place with an indexed datatype.
+    class VariableBlockCollectives {
+    private:
+        NetworkCharacteristics network_config_;
+
+    public:
+        VariableBlockCollectives(const NetworkCharacteristics& config);
+        ~VariableBlockCollectives();
+
+        // Hierarchical on multi-node runs, otherwise the ring for
+        // bandwidth-bound totals and MPI_Allgatherv for short ones
+        PerformanceMetrics allgatherv(const void* sendbuf, int sendcount, MPI_Datatype sendtype,
+            void* recvbuf, const int* recvcounts, const int* displs,
+            MPI_Datatype recvtype, MPI_Comm comm);
+
+        // Hierarchical on multi-node runs, otherwise MPI_Gatherv
+        PerformanceMetrics gatherv(const void* sendbuf, int sendcount, MPI_Datatype sendtype,
+            void* recvbuf, const int* recvcounts, const int* displs,
+            MPI_Datatype recvtype, int root, MPI_Comm comm);
+
+        // Hierarchical on multi-node runs, otherwise MPI_Scatterv
+        PerformanceMetrics scatterv(const void* sendbuf, const int* sendcounts, const int* displs,
+            MPI_Datatype sendtype, void* recvbuf, int recvcount,
+            MPI_Datatype recvtype, int root, MPI_Comm comm);
+
+        // P-1 neighbour exchanges along a node-ordered ring
+        PerformanceMetrics ring_allgatherv(const void* sendbuf, int sendcount, MPI_Datatype sendtype,
+            void* recvbuf, const int* recvcounts, const int* displs,
+            MPI_Datatype recvtype, MPI_Comm comm);
+
+        // Aggregate at the node aggregator, ring of node blocks among the
+        // aggregators, then one broadcast per node
+        PerformanceMetrics hierarchical_allgatherv(const void* sendbuf, int sendcount, MPI_Datatype sendtype,
+            void* recvbuf, const int* recvcounts, const int* displs,
+            MPI_Datatype recvtype, MPI_Comm comm);
+
+        PerformanceMetrics hierarchical_gatherv(const void* sendbuf, int sendcount, MPI_Datatype sendtype,
+            void* recvbuf, const int* recvcounts, const int* displs,
+            MPI_Datatype recvtype, int root, MPI_Comm comm);
+
+        PerformanceMetrics hierarchical_scatterv(const void* sendbuf, const int* sendcounts, const int* displs,
+            MPI_Datatype sendtype, void* recvbuf, int recvcount,
+            MPI_Datatype recvtype, int root, MPI_Comm comm);
+
+    private:
+        // Ranks of node `index`, in rank order
+        static std::vector<int> node_members(const NodeCommunicators& node, int index);
+
+        // Rank with the most bytes among members, lowest rank on ties
+        static int select_aggregator(const std::vector<int>& members,
+            const std::vector<long long>& member_bytes);
+
+        // One indexed datatype covering the given ranks' blocks in place
+        static MPI_Datatype blocks_type(const std::vector<int>& ranks, const int* counts,
+            const int* displs, MPI_Datatype datatype);
+
+        static bool has_node_hierarchy(const NodeCommunicators& node, int world_size);
+    };
+
+} // namespace TopologyAwareResearch
+
+#endif // VARIABLE_BLOCK_COLLECTIVES_H
@@ -10,7 +10,21 @@
 #include <queue>
 #include <unordered_set>
 #include <cstring>
+#include <cstdlib>
 #include "reduction_ops.h"
+#include "dragonfly_layout.h"
+#include "../algorithms/torus_broadcast.h"
+#include "../algorithms/dragonfly_broadcast.h"
+#include "../algorithms/topology_aware_allgather.h"
+#include "../algorithms/topology_aware_barrier.h"
+#include "../algorithms/topology_aware_neighbor.h"
+#include "../algorithms/topology_aware_reduce_scatter.h"
+#include "../algorithms/topology_aware_alltoall.h"
+#include "../algorithms/topology_aware_scan.h"
+#include "../algorithms/topology_aware_reduce.h"
+#include "../algorithms/ordered_reduction.h"
+#include "../algorithms/fused_allreduce.h"
+#include "../algorithms/variable_block_collectives.h"
 
 // Forward declarations for advanced components
 namespace TopologyAwareResearch {
@@ -148,12 +162,8 @@ namespace TopologyAwareResearch {
                     config.inter_node_latency = 1.0;
                 }
                 else {
+                    // Group structure is filled in below, once every rank has the node mapping
                     config.topology = NetworkTopology::DRAGONFLY;
-                    config.topology_params.dragonfly.groups = 8;
-                    config.topology_params.dragonfly.routers_per_group = 8;
-                    config.topology_params.dragonfly.nodes_per_router = 4;
-//                    config.topology_params.dragonfly.routers_per_group = 8;
-//                    config.topology_params.dragonfly.nodes_per_router = 4;
                     config.inter_node_bandwidth = 200.0;
                     config.inter_node_latency = 0.5;
                 }
@@ -192,9 +202,53 @@ namespace TopologyAwareResearch {
             MPI_Bcast(&config.total_nodes, 1, MPI_INT, 0, comm);
             MPI_Bcast(&config.processes_per_node, 1, MPI_INT, 0, comm);
             MPI_Bcast(&config.topology, sizeof(NetworkTopology), MPI_BYTE, 0, comm);
+            MPI_Bcast(&config.topology_params, sizeof(config.topology_params), MPI_BYTE, 0, comm);
+            MPI_Bcast(&config.inter_node_bandwidth, 1, MPI_DOUBLE, 0, comm);
+            MPI_Bcast(&config.inter_node_latency, 1, MPI_DOUBLE, 0, comm);
+            MPI_Bcast(&config.intra_node_bandwidth, 1, MPI_DOUBLE, 0, comm);
+            MPI_Bcast(&config.intra_node_latency, 1, MPI_DOUBLE, 0, comm);
+
+            // Every rank needs the process mapping for the hierarchical paths
+            config.node_mapping.resize(world_size);
+            MPI_Bcast(config.node_mapping.data(), world_size, MPI_INT, 0, comm);
+            if (world_rank != 0) {
+                config.node_processes.assign(config.total_nodes, std::vector<int>());
+                for (int i = 0; i < world_size; ++i) {
+                    config.node_processes[config.node_mapping[i]].push_back(i);
+                }
+            }
+
+            detect_dragonfly(comm, config);
 
             return config;
         }
+
+    private:
+        // A layout file or Cray cnames identify a dragonfly regardless of the
+        // node count heuristic; otherwise groups are estimated from the nodes
+        void detect_dragonfly(MPI_Comm comm, NetworkCharacteristics& config) {
+            int layout_hint = (std::getenv(DragonflyLayoutDetector::config_environment_variable()) != nullptr ||
+                std::ifstream("/proc/cray_xt/cname").good()) ? 1 : 0;
+            MPI_Allreduce(MPI_IN_PLACE, &layout_hint, 1, MPI_INT, MPI_MAX, comm);
+            if (config.topology != NetworkTopology::DRAGONFLY && !layout_hint) {
+                return;
+            }
+
+            DragonflyLayout layout = DragonflyLayoutDetector::detect(comm, config.node_mapping);
+            if (config.topology != NetworkTopology::DRAGONFLY && layout.source == "inferred") {
+                return;
+            }
+
+            config.topology = NetworkTopology::DRAGONFLY;
+            config.group_mapping = layout.group_mapping;
+            config.router_mapping = layout.router_mapping;
+            config.topology_params.dragonfly.groups = layout.groups;
+            config.topology_params.dragonfly.routers_per_group = layout.routers_per_group;
+            config.topology_params.dragonfly.nodes_per_router = layout.nodes_per_router;
+            // Global links each router needs to reach every other group once
+            config.topology_params.dragonfly.global_links = std::max(1,
+                (layout.groups - 1 + layout.routers_per_group - 1) / std::max(1, layout.routers_per_group));
+        }
     };
 }
 
@@ -495,204 +549,19 @@ PerformanceMetrics CollectiveOptimizer::fat_tree_broadcast(void* buffer, int cou
 PerformanceMetrics CollectiveOptimizer::torus_broadcast(void* buffer, int count,
     MPI_Datatype datatype, int root,
     MPI_Comm comm) {
-    PerformanceMetrics metrics;
-    auto start_time = MPI_Wtime();
-
-    int world_size, world_rank;
-    MPI_Comm_size(comm, &world_size);
-    MPI_Comm_rank(comm, &world_rank);
-
-    // Extract torus dimensions from network configuration
-    int dim_x = network_config_.topology_params.torus.x;
-    int dim_y = network_config_.topology_params.torus.y;
-
-    if (dim_x * dim_y != world_size) {
-        // Fallback to binomial tree if dimensions don't match
-        return binomial_tree_broadcast(buffer, count, datatype, root, comm);
-    }
-
-    // Calculate coordinates in torus
-    int root_x = root % dim_x;
-    int root_y = root / dim_x;
-    int my_x = world_rank % dim_x;
-    int my_y = world_rank / dim_x;
-
-    std::vector<std::pair<int, int>> communication_edges;
-
-    // Phase 1: Broadcast along X dimension (rows)
-    if (my_y == root_y) {
-        // This process is in the same row as root
-        if (my_x != root_x) {
-            // Receive from left or right in the same row
-            int source = root_y * dim_x + ((my_x < root_x) ? my_x + 1 : my_x - 1);
-            MPI_Recv(buffer, count, datatype, source, 0, comm, MPI_STATUS_IGNORE);
-            communication_edges.emplace_back(source, world_rank);
-        }
-
-        // Forward along the row
-        if (my_x > root_x && my_x < dim_x - 1) {
-            int dest = root_y * dim_x + my_x + 1;
-            MPI_Send(buffer, count, datatype, dest, 0, comm);
-            communication_edges.emplace_back(world_rank, dest);
-        }
-        if (my_x < root_x && my_x > 0) {
-            int dest = root_y * dim_x + my_x - 1;
-            MPI_Send(buffer, count, datatype, dest, 0, comm);
-            communication_edges.emplace_back(world_rank, dest);
-        }
-    }
-
-    // Phase 2: Broadcast along Y dimension (columns)
-    if (my_x == root_x) {
-        // This process is in the same column as root
-        if (my_y != root_y) {
-            // Receive from above or below in the same column
-            int source = ((my_y < root_y) ? my_y + 1 : my_y - 1) * dim_x + root_x;
-            MPI_Recv(buffer, count, datatype, source, 1, comm, MPI_STATUS_IGNORE);
-            communication_edges.emplace_back(source, world_rank);
-        }
-
-        // Forward along the column
-        if (my_y > root_y && my_y < dim_y - 1) {
-            int dest = (my_y + 1) * dim_x + root_x;
-            MPI_Send(buffer, count, datatype, dest, 1, comm);
-            communication_edges.emplace_back(world_rank, dest);
-        }
-        if (my_y < root_y && my_y > 0) {
-            int dest = (my_y - 1) * dim_x + root_x;
-            MPI_Send(buffer, count, datatype, dest, 1, comm);
-            communication_edges.emplace_back(world_rank, dest);
-        }
-    }
-
-    // Phase 3: Complete column broadcasts
-    if (my_y != root_y && my_x != root_x) {
-        // Receive from process in same column but root's row
-        int source = root_y * dim_x + my_x;
-        MPI_Recv(buffer, count, datatype, source, 2, comm, MPI_STATUS_IGNORE);
-        communication_edges.emplace_back(source, world_rank);
-    }
-
-    if (my_y == root_y && my_x != root_x) {
-        // Send to processes in same column
-        for (int y = 0; y < dim_y; y++) {
-            if (y != root_y) {
-                int dest = y * dim_x + my_x;
-                MPI_Send(buffer, count, datatype, dest, 2, comm);
-                communication_edges.emplace_back(world_rank, dest);
-            }
-        }
-    }
-
-    auto end_time = MPI_Wtime();
-    metrics.execution_time = end_time - start_time;
-    metrics.communication_time = metrics.execution_time;
-    metrics.bytes_transferred = count * get_mpi_type_size(datatype);
-    metrics.communication_edges = communication_edges;
-    metrics.messages_sent = communication_edges.size();
-
-    return metrics;
+    // Segmented, bidirectional broadcast over cached row/column/plane
+    // communicators; handles 3D and partially populated tori
+    MultiPortTorusBroadcast torus(network_config_);
+    return torus.broadcast(buffer, count, datatype, root, comm);
 }
 
 PerformanceMetrics CollectiveOptimizer::dragonfly_broadcast(void* buffer, int count,
     MPI_Datatype datatype, int root,
     MPI_Comm comm) {
-    PerformanceMetrics metrics;
-    auto start_time = MPI_Wtime();
-
-    int world_size, world_rank;
-    MPI_Comm_size(comm, &world_size);
-    MPI_Comm_rank(comm, &world_rank);
-
-    // Dragonfly parameters
-    int groups = network_config_.topology_params.dragonfly.groups;
-    int routers_per_group = network_config_.topology_params.dragonfly.routers_per_group;
-    int nodes_per_router = network_config_.topology_params.dragonfly.nodes_per_router;
-
-    // Calculate group and router for each process
-    int group_size = routers_per_group * nodes_per_router;
-    int root_group = root / group_size;
-    int root_router = (root % group_size) / nodes_per_router;
-    int my_group = world_rank / group_size;
-    int my_router = (world_rank % group_size) / nodes_per_router;
-
-    std::vector<std::pair<int, int>> communication_edges;
-
-    // Phase 1: Intra-group broadcast (within root's group)
-    if (my_group == root_group) {
-        // Use hierarchical broadcast within group
-        MPI_Comm group_comm;
-        MPI_Comm_split(comm, my_group, world_rank, &group_comm);
-
-        // Find router leader (lowest rank in router)
-        int router_leader = my_group * group_size + my_router * nodes_per_router;
-
-        if (world_rank == root) {
-            // Send to all routers in group
-            for (int r = 0; r < routers_per_group; r++) {
-                if (r != root_router) {
-                    int dest_router_leader = my_group * group_size + r * nodes_per_router;
-                    MPI_Send(buffer, count, datatype, dest_router_leader, 0, comm);
-                    communication_edges.emplace_back(world_rank, dest_router_leader);
-                }
-            }
-        }
-
-        if (world_rank == router_leader && my_router != root_router) {
-            MPI_Recv(buffer, count, datatype, root, 0, comm, MPI_STATUS_IGNORE);
-            communication_edges.emplace_back(root, world_rank);
-        }
-
-        // Broadcast within router
-        MPI_Bcast(buffer, count, datatype, router_leader - my_group * group_size, group_comm);
-        MPI_Comm_free(&group_comm);
-    }
-
-    // Phase 2: Inter-group broadcast
-    if (my_group != root_group) {
-        // Each group receives from one source group
-        int source_group = (my_group > root_group) ? my_group - 1 : my_group + 1;
-        int source_router = 0; // Simplified - use first router for global connection
-
-        if (world_rank == my_group * group_size + my_router * nodes_per_router) {
-            MPI_Recv(buffer, count, datatype,
-                    source_group * group_size + source_router * nodes_per_router,
-                    1, comm, MPI_STATUS_IGNORE);
-            communication_edges.emplace_back(source_group * group_size + source_router * nodes_per_router, world_rank);
-        }
-    }
-
-    if (my_group == root_group) {
-        // Send to neighboring groups
-        for (int g = 0; g < groups; g++) {
-            if (g != root_group) {
-                int dest_router = 0; // Simplified - use first router for global connection
-                int dest = g * group_size + dest_router * nodes_per_router;
-                MPI_Send(buffer, count, datatype, dest, 1, comm);
-                communication_edges.emplace_back(world_rank, dest);
-            }
-        }
-    }
-
-    // Phase 3: Final intra-group broadcast in receiving groups
-    if (my_group != root_group) {
-        MPI_Comm group_comm;
-        MPI_Comm_split(comm, my_group, world_rank, &group_comm);
-
-        int router_leader = my_group * group_size + my_router * nodes_per_router;
-        MPI_Bcast(buffer, count, datatype,
-                 (world_rank == router_leader) ? 0 : MPI_PROC_NULL, group_comm);
-        MPI_Comm_free(&group_comm);
-    }
-
-    auto end_time = MPI_Wtime();
-    metrics.execution_time = end_time - start_time;
-    metrics.communication_time = metrics.execution_time;
-    metrics.bytes_transferred = count * get_mpi_type_size(datatype);
-    metrics.communication_edges = communication_edges;
-    metrics.messages_sent = communication_edges.size();
-
-    return metrics;
+    // Segmented fan-out from every router of the root group over its own
+    // global links, using the detected group/router layout
+    DragonflyBroadcast dragonfly(network_config_);
+    return dragonfly.broadcast(buffer, count, datatype, root, comm);
 }
 
 PerformanceMetrics CollectiveOptimizer::hierarchical_broadcast(void* buffer, int count,
@@ -863,6 +732,26 @@ PerformanceMetrics CollectiveOptimizer::optimize_allreduce(const void* sendbuf,
     PerformanceMetrics metrics;
     auto start_time = MPI_Wtime();
 
+    if (topology_aware_enabled_ && !g_custom_op_manager.is_commutative(op)) {
+        if (network_config_.topology == NetworkTopology::UNKNOWN) {
+            network_config_ = topology_detector_->detect(comm);
+        }
+
+        // Operand order matters: rank-ordered tree for short messages,
+        // ordered recursive halving for long ones
+        AlgorithmType selected_algo = g_custom_op_manager.order_preserving_algorithm(op,
+            count > 4096 ? AlgorithmType::ADAPTIVE_ALLREDUCE : AlgorithmType::BINOMIAL_TREE);
+        OrderedReduction ordered(network_config_);
+        metrics = ordered.execute(selected_algo, sendbuf, recvbuf, count, datatype, op, comm);
+
+        auto end_time = MPI_Wtime();
+        metrics.execution_time = end_time - start_time;
+
+        update_performance_history(selected_algo, metrics);
+
+        return metrics;
+    }
+
     // Use ring allreduce for topology-aware optimization
     if (topology_aware_enabled_ && count > 4096) {
         metrics = adaptive_allreduce(sendbuf, recvbuf, count, datatype, op, comm);
@@ -880,170 +769,380 @@ PerformanceMetrics CollectiveOptimizer::optimize_allreduce(const void* sendbuf,
 PerformanceMetrics CollectiveOptimizer::ring_allreduce(const void* sendbuf, void* recvbuf,
     int count, MPI_Datatype datatype,
     MPI_Op op, MPI_Comm comm) {
-    PerformanceMetrics metrics;
-    auto start_time = MPI_Wtime();
+    // Reduce-scatter + allgather ring; blocks are combined straight from
+    // sendbuf into recvbuf, without copying the input over first
+    return fused_ring_allreduce(sendbuf, recvbuf, count, datatype, op, comm);
+}
 
-    int world_size, world_rank;
+PerformanceMetrics CollectiveOptimizer::adaptive_allreduce(const void* sendbuf, void* recvbuf,
+    int count, MPI_Datatype datatype,
+    MPI_Op op, MPI_Comm comm) {
+    // Adaptive allreduce that selects algorithm based on message size and topology
+    int world_size;
     MPI_Comm_size(comm, &world_size);
-    MPI_Comm_rank(comm, &world_rank);
+    long long message_bytes = static_cast<long long>(count) * get_mpi_type_size(datatype);
 
-    if (world_size == 1) {
-        if (sendbuf != MPI_IN_PLACE) {
-            memcpy(recvbuf, sendbuf, count * get_mpi_type_size(datatype));
-        }
-        metrics.communication_time = 0.0;
-        return metrics;
+    if (message_bytes <= 32768 && world_size > 2) {
+        // Latency bound: log2(P) whole-vector exchanges beat 2(P-1) ring steps
+        return fused_recursive_doubling_allreduce(sendbuf, recvbuf, count, datatype, op, comm);
     }
+    else {
+        // Bandwidth bound: the ring moves 2(P-1)/P of the vector per rank
+        return ring_allreduce(sendbuf, recvbuf, count, datatype, op, comm);
+    }
+}
+
+// Multi-objective optimization methods
+PerformanceMetrics CollectiveOptimizer::optimize_reduce(const void* sendbuf, void* recvbuf,
+    int count, MPI_Datatype datatype,
+    MPI_Op op, int root, MPI_Comm comm) {
+    PerformanceMetrics metrics;
+    auto start_time = MPI_Wtime();
 
-    int type_size = get_mpi_type_size(datatype);
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
 
-    // Use the comprehensive reduction implementation
-    if (sendbuf != MPI_IN_PLACE) {
-        memcpy(recvbuf, sendbuf, count * type_size);
+    if (network_config_.topology == NetworkTopology::UNKNOWN) {
+        network_config_ = topology_detector_->detect(comm);
     }
 
-    std::vector<std::pair<int, int>> communication_edges;
+    // Segmented binomial tree for short messages, Rabenseifner for large
+    // ones, the node-ordered chain for very large ones; order-preserving
+    // variants when the operation is not commutative
+    int type_size;
+    MPI_Type_size(datatype, &type_size);
+    TopologyAwareReduce reduce(network_config_);
+    AlgorithmType selected_algo = topology_aware_enabled_ ?
+        g_custom_op_manager.order_preserving_algorithm(op,
+            reduce.select_algorithm(static_cast<long long>(count) * type_size, count, size)) :
+        AlgorithmType::NATIVE_MPI;
+    metrics = reduce.execute(selected_algo, sendbuf, recvbuf, count, datatype, op, root, comm);
 
-    // Ring allreduce implementation with proper reduction
-    for (int step = 0; step < world_size - 1; ++step) {
-        int send_to = (world_rank + 1) % world_size;
-        int recv_from = (world_rank - 1 + world_size) % world_size;
+    auto end_time = MPI_Wtime();
+    metrics.execution_time = end_time - start_time;
 
-        // Send current buffer
-        MPI_Send(recvbuf, count, datatype, send_to, 0, comm);
+    update_performance_history(selected_algo, metrics);
 
-        // Receive into temporary buffer and reduce
-        void* temp_buf = malloc(count * type_size);
-        MPI_Recv(temp_buf, count, datatype, recv_from, 0, comm, MPI_STATUS_IGNORE);
+    return metrics;
+}
 
-        // Use the comprehensive reduction function
-        reduce_segments(recvbuf, temp_buf, 0, count, datatype, op);
+PerformanceMetrics CollectiveOptimizer::optimize_allgather(const void* sendbuf, void* recvbuf,
+    int count, MPI_Datatype datatype,
+    MPI_Comm comm) {
+    PerformanceMetrics metrics;
+    auto start_time = MPI_Wtime();
 
-        free(temp_buf);
+    int rank, size;
+    MPI_Comm_rank(comm, &rank);
+    MPI_Comm_size(comm, &size);
 
-        communication_edges.emplace_back(world_rank, send_to);
-        communication_edges.emplace_back(recv_from, world_rank);
+    if (network_config_.topology == NetworkTopology::UNKNOWN) {
+        network_config_ = topology_detector_->detect(comm);
     }
 
+    // Node aggregation or a log(P) algorithm for latency-bound totals, the node-ordered ring for large ones
+    int type_size;
+    MPI_Type_size(datatype, &type_size);
+    TopologyAwareAllgather allgather(network_config_);
+    AlgorithmType selected_algo = topology_aware_enabled_ ?
+        allgather.select_algorithm(static_cast<long long>(count) * type_size, size) :
+        AlgorithmType::NATIVE_MPI;
+    metrics = allgather.execute(selected_algo, sendbuf, recvbuf, count, datatype, comm);
+
     auto end_time = MPI_Wtime();
     metrics.execution_time = end_time - start_time;
-    metrics.communication_edges = communication_edges;
-    metrics.messages_sent = communication_edges.size();
+
+    update_performance_history(selected_algo, metrics);
 
     return metrics;
 }
 
-PerformanceMetrics CollectiveOptimizer::adaptive_allreduce(const void* sendbuf, void* recvbuf,
-    int count, MPI_Datatype datatype,
-    MPI_Op op, MPI_Comm comm) {
-    // Adaptive allreduce that selects algorithm based on message size and topology
-    int world_size;
-    MPI_Comm_size(comm, &world_size);
-
-    if (count < 8192 || world_size <= 8) {
-        // Use ring allreduce for small messages or small communicators
-        return ring_allreduce(sendbuf, recvbuf, count, datatype, op, comm);
+PerformanceMetrics CollectiveOptimizer::optimize_allgatherv(const void* sendbuf, int sendcount, MPI_Datatype sendtype,
+    void* recvbuf, const int* recvcounts, const int* displs,
+    MPI_Datatype recvtype, MPI_Comm comm) {
+    if (network_config_.topology == NetworkTopology::UNKNOWN) {
+        network_config_ = topology_detector_->detect(comm);
     }
-    else {
-        // Use optimized reduction for large messages
+
+    if (!topology_aware_enabled_) {
         PerformanceMetrics metrics;
         auto start_time = MPI_Wtime();
+        MPI_Allgatherv(sendbuf, sendcount, sendtype, recvbuf, recvcounts, displs, recvtype, comm);
+        metrics.execution_time = MPI_Wtime() - start_time;
+        return metrics;
+    }
 
-        // Use the comprehensive optimized reduction
-        if (sendbuf != MPI_IN_PLACE) {
-            memcpy(recvbuf, sendbuf, count * get_mpi_type_size(datatype));
-        }
+    VariableBlockCollectives collectives(network_config_);
+    return collectives.allgatherv(sendbuf, sendcount, sendtype, recvbuf, recvcounts, displs, recvtype, comm);
+}
 
-        // Create temporary buffer for reduction
-        void* temp_buf = malloc(count * get_mpi_type_size(datatype));
-        memcpy(temp_buf, recvbuf, count * get_mpi_type_size(datatype));
+PerformanceMetrics CollectiveOptimizer::optimize_gatherv(const void* sendbuf, int sendcount, MPI_Datatype sendtype,
+    void* recvbuf, const int* recvcounts, const int* displs,
+    MPI_Datatype recvtype, int root, MPI_Comm comm) {
+    if (network_config_.topology == NetworkTopology::UNKNOWN) {
+        network_config_ = topology_detector_->detect(comm);
+    }
 
-        // Use optimized reduction
-        metrics = optimized_reduce_segments(recvbuf, temp_buf, 0, count, datatype, op, network_config_);
+    if (!topology_aware_enabled_) {
+        PerformanceMetrics metrics;
+        auto start_time = MPI_Wtime();
+        MPI_Gatherv(sendbuf, sendcount, sendtype, recvbuf, recvcounts, displs, recvtype, root, comm);
+        metrics.execution_time = MPI_Wtime() - start_time;
+        return metrics;
+    }
 
-        free(temp_buf);
+    VariableBlockCollectives collectives(network_config_);
+    return collectives.gatherv(sendbuf, sendcount, sendtype, recvbuf, recvcounts, displs, recvtype, root, comm);
+}
 
-        auto end_time = MPI_Wtime();
-        metrics.execution_time = end_time - start_time;
+PerformanceMetrics CollectiveOptimizer::optimize_scatterv(const void* sendbuf, const int* sendcounts, const int* displs,
+    MPI_Datatype sendtype, void* recvbuf, int recvcount,
+    MPI_Datatype recvtype, int root, MPI_Comm comm) {
+    if (network_config_.topology == NetworkTopology::UNKNOWN) {
+        network_config_ = topology_detector_->detect(comm);
+    }
 
+    if (!topology_aware_enabled_) {
+        PerformanceMetrics metrics;
+        auto start_time = MPI_Wtime();
+        MPI_Scatterv(sendbuf, sendcounts, displs, sendtype, recvbuf, recvcount, recvtype, root, comm);
+        metrics.execution_time = MPI_Wtime() - start_time;
         return metrics;
     }
+
+    VariableBlockCollectives collectives(network_config_);
+    return collectives.scatterv(sendbuf, sendcounts, displs, sendtype, recvbuf, recvcount, recvtype, root, comm);
 }
 
-// Multi-objective optimization methods
-PerformanceMetrics CollectiveOptimizer::optimize_reduce(const void* sendbuf, void* recvbuf,
+PerformanceMetrics CollectiveOptimizer::optimize_alltoall(const void* sendbuf, void* recvbuf,
     int count, MPI_Datatype datatype,
-    MPI_Op op, int root, MPI_Comm comm) {
+    MPI_Comm comm) {
     PerformanceMetrics metrics;
     auto start_time = MPI_Wtime();
 
-    int rank, size;
-    MPI_Comm_rank(comm, &rank);
+    int size;
     MPI_Comm_size(comm, &size);
 
-    // Multi-objective optimization: select algorithm based on message size and topology
-    if (count < 1024) {
-        // Small messages: use low-latency binomial tree
-        MPI_Reduce(sendbuf, recvbuf, count, datatype, op, root, comm);
+    if (network_config_.topology == NetworkTopology::UNKNOWN) {
+        network_config_ = topology_detector_->detect(comm);
     }
-    else if (network_config_.total_nodes > 1 && count > 8192) {
-        // Large messages in multi-node system: use optimized reduction
-        if (rank == root) {
-            memcpy(recvbuf, sendbuf, count * get_mpi_type_size(datatype));
-        }
-        // Use the comprehensive reduction implementation
-        metrics = optimized_reduce_segments(recvbuf, const_cast<void*>(sendbuf), 0, count, datatype, op, network_config_);
+
+    // Bruck for tiny blocks, node aggregation or a throttled exchange for
+    // medium ones, pairwise for large ones
+    int type_size;
+    MPI_Type_size(datatype, &type_size);
+    TopologyAwareAlltoall alltoall(network_config_);
+    AlgorithmType selected_algo = topology_aware_enabled_ ?
+        alltoall.select_algorithm(static_cast<long long>(count) * type_size, size) :
+        AlgorithmType::NATIVE_MPI;
+    if (selected_algo == AlgorithmType::NATIVE_MPI) {
+        MPI_Alltoall(sendbuf, count, datatype, recvbuf, count, datatype, comm);
     }
     else {
-        // Medium messages: use ring reduce
-        MPI_Reduce(sendbuf, recvbuf, count, datatype, op, root, comm);
+        metrics = alltoall.execute(selected_algo, sendbuf, recvbuf, count, datatype, comm);
     }
 
     auto end_time = MPI_Wtime();
     metrics.execution_time = end_time - start_time;
 
+    update_performance_history(selected_algo, metrics);
+
     return metrics;
 }
 
-PerformanceMetrics CollectiveOptimizer::optimize_allgather(const void* sendbuf, void* recvbuf,
+PerformanceMetrics CollectiveOptimizer::optimize_alltoallv(const void* sendbuf, const int* sendcounts, const int* sdispls,
+    MPI_Datatype sendtype, void* recvbuf, const int* recvcounts, const int* rdispls,
+    MPI_Datatype recvtype, MPI_Comm comm) {
+    if (network_config_.topology == NetworkTopology::UNKNOWN) {
+        network_config_ = topology_detector_->detect(comm);
+    }
+
+    if (!topology_aware_enabled_) {
+        PerformanceMetrics metrics;
+        auto start_time = MPI_Wtime();
+        MPI_Alltoallv(sendbuf, sendcounts, sdispls, sendtype, recvbuf, recvcounts, rdispls, recvtype, comm);
+        metrics.execution_time = MPI_Wtime() - start_time;
+        return metrics;
+    }
+
+    TopologyAwareAlltoall alltoall(network_config_);
+    return alltoall.alltoallv(sendbuf, sendcounts, sdispls, sendtype, recvbuf, recvcounts, rdispls, recvtype, comm);
+}
+
+PerformanceMetrics CollectiveOptimizer::optimize_scan(const void* sendbuf, void* recvbuf,
     int count, MPI_Datatype datatype,
-    MPI_Comm comm) {
+    MPI_Op op, MPI_Comm comm) {
     PerformanceMetrics metrics;
     auto start_time = MPI_Wtime();
 
-    int rank, size;
-    MPI_Comm_rank(comm, &rank);
+    int size;
     MPI_Comm_size(comm, &size);
 
-    // Multi-objective optimization for allgather
-    if (count < 512) {
-        // Small messages: use MPI_Allgather
-        MPI_Allgather(sendbuf, count, datatype, recvbuf, count, datatype, comm);
+    if (network_config_.topology == NetworkTopology::UNKNOWN) {
+        network_config_ = topology_detector_->detect(comm);
     }
-    else if (network_config_.total_nodes > 1) {
-        // Multi-node: use topology-aware allgather
-        MPI_Allgather(sendbuf, count, datatype, recvbuf, count, datatype, comm);
+
+    // Node-local prefix plus a leader exscan when nodes hold consecutive
+    // ranks, recursive doubling otherwise
+    TopologyAwareScan scan(network_config_);
+    AlgorithmType selected_algo = topology_aware_enabled_ ?
+        scan.select_algorithm(size) : AlgorithmType::NATIVE_MPI;
+    metrics = scan.execute(selected_algo, false, sendbuf, recvbuf, count, datatype, op, comm);
+
+    auto end_time = MPI_Wtime();
+    metrics.execution_time = end_time - start_time;
+
+    update_performance_history(selected_algo, metrics);
+
+    return metrics;
+}
+
+PerformanceMetrics CollectiveOptimizer::optimize_exscan(const void* sendbuf, void* recvbuf,
+    int count, MPI_Datatype datatype,
+    MPI_Op op, MPI_Comm comm) {
+    PerformanceMetrics metrics;
+    auto start_time = MPI_Wtime();
+
+    int size;
+    MPI_Comm_size(comm, &size);
+
+    if (network_config_.topology == NetworkTopology::UNKNOWN) {
+        network_config_ = topology_detector_->detect(comm);
     }
-    else {
-        // Single node: use ring allgather
-        MPI_Allgather(sendbuf, count, datatype, recvbuf, count, datatype, comm);
+
+    TopologyAwareScan scan(network_config_);
+    AlgorithmType selected_algo = topology_aware_enabled_ ?
+        scan.select_algorithm(size) : AlgorithmType::NATIVE_MPI;
+    metrics = scan.execute(selected_algo, true, sendbuf, recvbuf, count, datatype, op, comm);
+
+    auto end_time = MPI_Wtime();
+    metrics.execution_time = end_time - start_time;
+
+    update_performance_history(selected_algo, metrics);
+
+    return metrics;
+}
+
+PerformanceMetrics CollectiveOptimizer::optimize_reduce_scatter(const void* sendbuf, void* recvbuf,
+    const int* recvcounts, MPI_Datatype datatype,
+    MPI_Op op, MPI_Comm comm) {
+    PerformanceMetrics metrics;
+    auto start_time = MPI_Wtime();
+
+    int size;
+    MPI_Comm_size(comm, &size);
+
+    if (network_config_.topology == NetworkTopology::UNKNOWN) {
+        network_config_ = topology_detector_->detect(comm);
+    }
+
+    // Node-level reduction on multi-node runs, recursive halving for
+    // latency-bound totals, the node-ordered ring for large ones. These
+    // reorder operands, so non-commutative ops go to MPI_Reduce_scatter.
+    int type_size;
+    MPI_Type_size(datatype, &type_size);
+    long long total_count = 0;
+    for (int i = 0; i < size; ++i) {
+        total_count += recvcounts[i];
     }
+    TopologyAwareReduceScatter reduce_scatter(network_config_);
+    AlgorithmType selected_algo = topology_aware_enabled_ && g_custom_op_manager.is_commutative(op) ?
+        reduce_scatter.select_algorithm(total_count * type_size, size) :
+        AlgorithmType::NATIVE_MPI;
+    metrics = reduce_scatter.execute(selected_algo, sendbuf, recvbuf, recvcounts, datatype, op, comm);
 
     auto end_time = MPI_Wtime();
     metrics.execution_time = end_time - start_time;
 
+    update_performance_history(selected_algo, metrics);
+
     return metrics;
 }
 
+PerformanceMetrics CollectiveOptimizer::optimize_reduce_scatter_block(const void* sendbuf, void* recvbuf,
+    int recvcount, MPI_Datatype datatype,
+    MPI_Op op, MPI_Comm comm) {
+    int size;
+    MPI_Comm_size(comm, &size);
+
+    std::vector<int> recvcounts(size, recvcount);
+    return optimize_reduce_scatter(sendbuf, recvbuf, recvcounts.data(), datatype, op, comm);
+}
+
 PerformanceMetrics CollectiveOptimizer::optimize_barrier(MPI_Comm comm) {
     PerformanceMetrics metrics;
     auto start_time = MPI_Wtime();
 
-    MPI_Barrier(comm);
+    // Shared-memory flags inside each node plus dissemination among the
+    // leaders when ranks share a node, plain dissemination otherwise
+    TopologyAwareBarrier barrier(network_config_);
+    AlgorithmType selected_algo = topology_aware_enabled_ ?
+        barrier.select_algorithm(comm) : AlgorithmType::NATIVE_MPI;
+    metrics = barrier.execute(selected_algo, comm);
 
     auto end_time = MPI_Wtime();
     metrics.execution_time = end_time - start_time;
 
+    update_performance_history(selected_algo, metrics);
+
+    return metrics;
+}
+
+MPI_Comm CollectiveOptimizer::create_halo_graph(MPI_Comm comm, int stencil_points) {
+    if (network_config_.topology == NetworkTopology::UNKNOWN) {
+        network_config_ = topology_detector_->detect(comm);
+    }
+
+    TopologyAwareNeighbor neighbor(network_config_);
+    return neighbor.create_halo_graph(comm, stencil_points);
+}
+
+PerformanceMetrics CollectiveOptimizer::optimize_neighbor_allgather(const void* sendbuf, int sendcount,
+    MPI_Datatype sendtype, void* recvbuf, int recvcount, MPI_Datatype recvtype, MPI_Comm comm) {
+    PerformanceMetrics metrics;
+    auto start_time = MPI_Wtime();
+
+    if (network_config_.topology == NetworkTopology::UNKNOWN) {
+        network_config_ = topology_detector_->detect(comm);
+    }
+
+    // One message per remote node plus shared-memory hand-over inside the
+    // node when ranks share a node, one message per edge otherwise
+    TopologyAwareNeighbor neighbor(network_config_);
+    AlgorithmType selected_algo = topology_aware_enabled_ ?
+        neighbor.select_algorithm(comm) : AlgorithmType::NATIVE_MPI;
+    metrics = neighbor.execute(selected_algo, sendbuf, sendcount, sendtype, recvbuf, recvcount, recvtype, comm);
+
+    auto end_time = MPI_Wtime();
+    metrics.execution_time = end_time - start_time;
+
+    update_performance_history(selected_algo, metrics);
+
+    return metrics;
+}
+
+PerformanceMetrics CollectiveOptimizer::optimize_neighbor_alltoallv(const void* sendbuf, const int* sendcounts,
+    const int* sdispls, MPI_Datatype sendtype, void* recvbuf, const int* recvcounts, const int* rdispls,
+    MPI_Datatype recvtype, MPI_Comm comm) {
+    PerformanceMetrics metrics;
+    auto start_time = MPI_Wtime();
+
+    if (network_config_.topology == NetworkTopology::UNKNOWN) {
+        network_config_ = topology_detector_->detect(comm);
+    }
+
+    TopologyAwareNeighbor neighbor(network_config_);
+    AlgorithmType selected_algo = topology_aware_enabled_ ?
+        neighbor.select_algorithm(comm) : AlgorithmType::NATIVE_MPI;
+    metrics = neighbor.execute(selected_algo, sendbuf, sendcounts, sdispls, sendtype,
+        recvbuf, recvcounts, rdispls, recvtype, comm);
+
+    auto end_time = MPI_Wtime();
+    metrics.execution_time = end_time - start_time;
+
+    update_performance_history(selected_algo, metrics);
+
     return metrics;
 }
 
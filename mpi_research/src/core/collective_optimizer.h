@@ -48,6 +48,44 @@ namespace TopologyAwareResearch {
         MULTI_LEVEL_REDUCE,
         ADAPTIVE_ALLREDUCE,
 
+        // Allgather
+        RING_ALLGATHER,
+        RECURSIVE_DOUBLING_ALLGATHER,
+        BRUCK_ALLGATHER,
+        HIERARCHICAL_ALLGATHER,
+
+        // Reduce-scatter
+        RING_REDUCE_SCATTER,
+        RECURSIVE_HALVING_REDUCE_SCATTER,
+        HIERARCHICAL_REDUCE_SCATTER,
+
+        // Alltoall
+        BRUCK_ALLTOALL,
+        PAIRWISE_ALLTOALL,
+        HIERARCHICAL_ALLTOALL,
+        THROTTLED_ALLTOALL,
+
+        // Reduce
+        SEGMENTED_BINOMIAL_REDUCE,
+        RABENSEIFNER_REDUCE,
+        PIPELINED_CHAIN_REDUCE,
+
+        // Order-preserving reduce / allreduce for non-commutative operations
+        ORDERED_TREE_REDUCE,
+        ORDERED_RECURSIVE_HALVING_REDUCE,
+
+        // Scan / exscan
+        RECURSIVE_DOUBLING_SCAN,
+        HIERARCHICAL_SCAN,
+
+        // Barrier
+        DISSEMINATION_BARRIER,
+        HIERARCHICAL_BARRIER,
+
+        // Neighbourhood collectives
+        DIRECT_NEIGHBOR,
+        AGGREGATED_NEIGHBOR,
+
         // Graph-based
         SHORTEST_PATH_TREE,
         MINIMUM_SPANNING_TREE,
@@ -133,6 +171,8 @@ namespace TopologyAwareResearch {
         // Process mapping
         std::vector<int> node_mapping;  // process_id -> node_id
         std::vector<std::vector<int>> node_processes;  // node_id -> process_ids
+        std::vector<int> group_mapping;   // process_id -> dragonfly group_id
+        std::vector<int> router_mapping;  // process_id -> dragonfly router_id
 
         // Communication cost matrix (simplified)
         std::vector<std::vector<double>> communication_costs;
@@ -226,12 +266,63 @@ namespace TopologyAwareResearch {
             int count, MPI_Datatype datatype,
             MPI_Comm comm);
 
+        // Uneven blocks: aggregated per node on multi-node runs
+        PerformanceMetrics optimize_allgatherv(const void* sendbuf, int sendcount, MPI_Datatype sendtype,
+            void* recvbuf, const int* recvcounts, const int* displs,
+            MPI_Datatype recvtype, MPI_Comm comm);
+
+        PerformanceMetrics optimize_gatherv(const void* sendbuf, int sendcount, MPI_Datatype sendtype,
+            void* recvbuf, const int* recvcounts, const int* displs,
+            MPI_Datatype recvtype, int root, MPI_Comm comm);
+
+        PerformanceMetrics optimize_scatterv(const void* sendbuf, const int* sendcounts, const int* displs,
+            MPI_Datatype sendtype, void* recvbuf, int recvcount,
+            MPI_Datatype recvtype, int root, MPI_Comm comm);
+
+        PerformanceMetrics optimize_alltoall(const void* sendbuf, void* recvbuf,
+            int count, MPI_Datatype datatype,
+            MPI_Comm comm);
+
+        PerformanceMetrics optimize_alltoallv(const void* sendbuf, const int* sendcounts, const int* sdispls,
+            MPI_Datatype sendtype, void* recvbuf, const int* recvcounts, const int* rdispls,
+            MPI_Datatype recvtype, MPI_Comm comm);
+
         PerformanceMetrics optimize_reduce(const void* sendbuf, void* recvbuf,
             int count, MPI_Datatype datatype,
             MPI_Op op, int root, MPI_Comm comm);
 
+        // Prefix reductions; operand order is kept for non-commutative ops
+        PerformanceMetrics optimize_scan(const void* sendbuf, void* recvbuf,
+            int count, MPI_Datatype datatype,
+            MPI_Op op, MPI_Comm comm);
+
+        PerformanceMetrics optimize_exscan(const void* sendbuf, void* recvbuf,
+            int count, MPI_Datatype datatype,
+            MPI_Op op, MPI_Comm comm);
+
+        // Rank i receives recvcounts[i] elements of the reduction
+        PerformanceMetrics optimize_reduce_scatter(const void* sendbuf, void* recvbuf,
+            const int* recvcounts, MPI_Datatype datatype,
+            MPI_Op op, MPI_Comm comm);
+
+        PerformanceMetrics optimize_reduce_scatter_block(const void* sendbuf, void* recvbuf,
+            int recvcount, MPI_Datatype datatype,
+            MPI_Op op, MPI_Comm comm);
+
         PerformanceMetrics optimize_barrier(MPI_Comm comm);
 
+        // Periodic 3D halo graph (6, 18 or 26 neighbours) laid out on the
+        // detected node placement; the caller frees it
+        MPI_Comm create_halo_graph(MPI_Comm comm, int stencil_points);
+
+        // comm must carry a distributed graph topology
+        PerformanceMetrics optimize_neighbor_allgather(const void* sendbuf, int sendcount, MPI_Datatype sendtype,
+            void* recvbuf, int recvcount, MPI_Datatype recvtype, MPI_Comm comm);
+
+        PerformanceMetrics optimize_neighbor_alltoallv(const void* sendbuf, const int* sendcounts, const int* sdispls,
+            MPI_Datatype sendtype, void* recvbuf, const int* recvcounts, const int* rdispls,
+            MPI_Datatype recvtype, MPI_Comm comm);
+
         PerformanceMetrics binomial_tree_broadcast(void* buffer, int count,
                                              MPI_Datatype datatype, int root,
                                              MPI_Comm comm);
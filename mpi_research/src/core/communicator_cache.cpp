@@ -0,0 +1,366 @@
+#include "communicator_cache.h"
+#include <algorithm>
+#include <new>
+#include <numeric>
+
+namespace TopologyAwareResearch {
+
+    int CommunicatorCache::keyval_ = MPI_KEYVAL_INVALID;
+    int CommunicatorCache::finalize_keyval_ = MPI_KEYVAL_INVALID;
+    std::set<CommunicatorCache::CacheEntry*> CommunicatorCache::window_entries_;
+
+    CommunicatorCache::CacheEntry& CommunicatorCache::entry(MPI_Comm comm) {
+        if (keyval_ == MPI_KEYVAL_INVALID) {
+            MPI_Comm_create_keyval(MPI_COMM_NULL_COPY_FN, &CommunicatorCache::delete_entry,
+                &keyval_, nullptr);
+        }
+
+        void* attribute_val = nullptr;
+        int found = 0;
+        MPI_Comm_get_attr(comm, keyval_, &attribute_val, &found);
+        if (found) {
+            return *static_cast<CacheEntry*>(attribute_val);
+        }
+
+        CacheEntry* cache_entry = new CacheEntry();
+        MPI_Comm_set_attr(comm, keyval_, cache_entry);
+        return *cache_entry;
+    }
+
+    int CommunicatorCache::delete_entry(MPI_Comm /*comm*/, int /*keyval*/,
+        void* attribute_val, void* /*extra_state*/) {
+        CacheEntry* cache_entry = static_cast<CacheEntry*>(attribute_val);
+
+        free_windows(*cache_entry);
+
+        for (auto& item : cache_entry->torus) {
+            TorusCommunicators& torus = item.second;
+            if (torus.row_comm != MPI_COMM_NULL) MPI_Comm_free(&torus.row_comm);
+            if (torus.column_comm != MPI_COMM_NULL) MPI_Comm_free(&torus.column_comm);
+            if (torus.plane_comm != MPI_COMM_NULL) MPI_Comm_free(&torus.plane_comm);
+        }
+
+        for (auto& item : cache_entry->node) {
+            NodeCommunicators& node = item.second;
+            if (node.node_comm != MPI_COMM_NULL) MPI_Comm_free(&node.node_comm);
+            if (node.leader_comm != MPI_COMM_NULL) MPI_Comm_free(&node.leader_comm);
+        }
+
+        delete cache_entry;
+        return MPI_SUCCESS;
+    }
+
+    const TorusCommunicators& CommunicatorCache::torus(MPI_Comm comm, int dim_x, int dim_y, int dim_z) {
+        CacheEntry& cache_entry = entry(comm);
+        std::vector<int> key = { dim_x, dim_y, dim_z };
+
+        auto it = cache_entry.torus.find(key);
+        if (it != cache_entry.torus.end()) {
+            return it->second;
+        }
+
+        int world_rank, world_size;
+        MPI_Comm_rank(comm, &world_rank);
+        MPI_Comm_size(comm, &world_size);
+
+        int dims[3] = { dim_x, dim_y, std::max(dim_z, 1) };
+        if (dims[0] <= 0 || dims[1] <= 0 ||
+            static_cast<long long>(dims[0]) * dims[1] * dims[2] < world_size) {
+            // Configured grid cannot hold every rank: build a balanced one
+            int ndims = (dims[2] > 1) ? 3 : 2;
+            int created[3] = { 0, 0, 0 };
+            MPI_Dims_create(world_size, ndims, created);
+            dims[0] = created[0];
+            dims[1] = created[1];
+            dims[2] = (ndims == 3) ? created[2] : 1;
+        }
+
+        // Trim extents so that only the last slab can be partial
+        dims[0] = std::min(dims[0], world_size);
+        dims[1] = std::min(dims[1], (world_size + dims[0] - 1) / dims[0]);
+        dims[2] = std::min(dims[2], (world_size + dims[0] * dims[1] - 1) / (dims[0] * dims[1]));
+
+        TorusCommunicators torus;
+        torus.total_processes = world_size;
+        for (int d = 0; d < 3; ++d) {
+            torus.dims[d] = dims[d];
+        }
+        torus.coords[0] = world_rank % dims[0];
+        torus.coords[1] = (world_rank / dims[0]) % dims[1];
+        torus.coords[2] = world_rank / (dims[0] * dims[1]);
+
+        const int* c = torus.coords;
+        MPI_Comm_split(comm, c[1] + dims[1] * c[2], c[0], &torus.row_comm);
+        MPI_Comm_split(comm, c[0] + dims[0] * c[2], c[1], &torus.column_comm);
+        MPI_Comm_split(comm, c[0] + dims[0] * c[1], c[2], &torus.plane_comm);
+
+        return cache_entry.torus.emplace(key, torus).first->second;
+    }
+
+    std::vector<int> CommunicatorCache::node_key(MPI_Comm comm, const std::vector<int>& node_mapping) {
+        int world_size;
+        MPI_Comm_size(comm, &world_size);
+        return (static_cast<int>(node_mapping.size()) == world_size) ? node_mapping : std::vector<int>();
+    }
+
+    const NodeCommunicators& CommunicatorCache::node(MPI_Comm comm, const std::vector<int>& node_mapping) {
+        CacheEntry& cache_entry = entry(comm);
+
+        int world_rank, world_size;
+        MPI_Comm_rank(comm, &world_rank);
+        MPI_Comm_size(comm, &world_size);
+
+        std::vector<int> key = node_key(comm, node_mapping);
+
+        auto it = cache_entry.node.find(key);
+        if (it != cache_entry.node.end()) {
+            return it->second;
+        }
+
+        // Without a usable mapping, let MPI tell us who shares memory; the
+        // node id is the parent rank of the node's lowest member
+        std::vector<int> mapping = key;
+        if (mapping.empty()) {
+            MPI_Comm shared_comm;
+            MPI_Comm_split_type(comm, MPI_COMM_TYPE_SHARED, world_rank, MPI_INFO_NULL, &shared_comm);
+            int node_id = world_rank;
+            MPI_Bcast(&node_id, 1, MPI_INT, 0, shared_comm);
+            MPI_Comm_free(&shared_comm);
+
+            mapping.resize(world_size);
+            MPI_Allgather(&node_id, 1, MPI_INT, mapping.data(), 1, MPI_INT, comm);
+        }
+
+        std::vector<int> node_ids(mapping);
+        std::sort(node_ids.begin(), node_ids.end());
+        node_ids.erase(std::unique(node_ids.begin(), node_ids.end()), node_ids.end());
+        auto index_of = [&](int node_id) {
+            return static_cast<int>(std::lower_bound(node_ids.begin(), node_ids.end(), node_id) - node_ids.begin());
+        };
+
+        NodeCommunicators node;
+        node.node_count = static_cast<int>(node_ids.size());
+        node.node_index = index_of(mapping[world_rank]);
+        node.node_sizes.assign(node.node_count, 0);
+        std::vector<std::vector<int>> members(node.node_count);
+        for (int i = 0; i < world_size; ++i) {
+            int index = index_of(mapping[i]);
+            ++node.node_sizes[index];
+            members[index].push_back(i);
+        }
+        for (const auto& ranks : members) {
+            node.node_order.insert(node.node_order.end(), ranks.begin(), ranks.end());
+        }
+
+        MPI_Comm_split(comm, node.node_index, world_rank, &node.node_comm);
+        MPI_Comm_rank(node.node_comm, &node.node_rank);
+        MPI_Comm_split(comm, node.is_leader() ? 0 : MPI_UNDEFINED, node.node_index, &node.leader_comm);
+
+        return cache_entry.node.emplace(key, node).first->second;
+    }
+
+    void CommunicatorCache::free_windows(CacheEntry& cache_entry) {
+        if (cache_entry.node_barrier != nullptr) {
+            MPI_Win_free(&cache_entry.node_barrier->window);
+            delete cache_entry.node_barrier;
+            cache_entry.node_barrier = nullptr;
+        }
+        for (auto& item : cache_entry.node_segments) {
+            MPI_Win_unlock_all(item.second->window);
+            MPI_Win_free(&item.second->window);
+            delete item.second;
+        }
+        cache_entry.node_segments.clear();
+        window_entries_.erase(&cache_entry);
+    }
+
+    void CommunicatorCache::track_windows(CacheEntry& cache_entry) {
+        if (finalize_keyval_ == MPI_KEYVAL_INVALID) {
+            MPI_Comm_create_keyval(MPI_COMM_NULL_COPY_FN, &CommunicatorCache::release_windows,
+                &finalize_keyval_, nullptr);
+            MPI_Comm_set_attr(MPI_COMM_SELF, finalize_keyval_, nullptr);
+        }
+        window_entries_.insert(&cache_entry);
+    }
+
+    int CommunicatorCache::release_windows(MPI_Comm /*comm*/, int /*keyval*/,
+        void* /*attribute_val*/, void* /*extra_state*/) {
+        while (!window_entries_.empty()) {
+            free_windows(**window_entries_.begin());
+        }
+        return MPI_SUCCESS;
+    }
+
+    NodeBarrierWindow& CommunicatorCache::node_barrier(MPI_Comm comm) {
+        CacheEntry& cache_entry = entry(comm);
+        if (cache_entry.node_barrier != nullptr) {
+            return *cache_entry.node_barrier;
+        }
+
+        static_assert(std::atomic<int>::is_always_lock_free,
+            "barrier flags are shared between processes and must be lock free");
+
+        const NodeCommunicators& node = CommunicatorCache::node(comm, std::vector<int>());
+
+        NodeBarrierWindow* barrier = new NodeBarrierWindow();
+        MPI_Aint flags_bytes = node.is_leader() ? 2 * sizeof(std::atomic<int>) : 0;
+        void* base = nullptr;
+        MPI_Win_allocate_shared(flags_bytes, sizeof(std::atomic<int>), MPI_INFO_NULL,
+            node.node_comm, &base, &barrier->window);
+
+        MPI_Aint leader_bytes;
+        int displacement_unit;
+        MPI_Win_shared_query(barrier->window, 0, &leader_bytes, &displacement_unit, &base);
+        std::atomic<int>* flags = static_cast<std::atomic<int>*>(base);
+        if (node.is_leader()) {
+            new (&flags[0]) std::atomic<int>(0);
+            new (&flags[1]) std::atomic<int>(0);
+        }
+        barrier->arrived = &flags[0];
+        barrier->sense = &flags[1];
+        MPI_Barrier(node.node_comm);
+
+        cache_entry.node_barrier = barrier;
+        track_windows(cache_entry);
+        return *barrier;
+    }
+
+    bool CommunicatorCache::node_shares_memory(MPI_Comm comm, const std::vector<int>& node_mapping) {
+        CacheEntry& cache_entry = entry(comm);
+        std::vector<int> key = node_key(comm, node_mapping);
+
+        auto it = cache_entry.node_shared.find(key);
+        if (it != cache_entry.node_shared.end()) {
+            return it->second;
+        }
+
+        // A node shares memory if splitting it by MPI_COMM_TYPE_SHARED leaves it whole
+        const NodeCommunicators& node = CommunicatorCache::node(comm, node_mapping);
+        MPI_Comm shared_comm;
+        MPI_Comm_split_type(node.node_comm, MPI_COMM_TYPE_SHARED, 0, MPI_INFO_NULL, &shared_comm);
+        int node_size, shared_size;
+        MPI_Comm_size(node.node_comm, &node_size);
+        MPI_Comm_size(shared_comm, &shared_size);
+        MPI_Comm_free(&shared_comm);
+
+        int shared = (shared_size == node_size) ? 1 : 0;
+        MPI_Allreduce(MPI_IN_PLACE, &shared, 1, MPI_INT, MPI_LAND, comm);
+        return cache_entry.node_shared.emplace(key, shared != 0).first->second;
+    }
+
+    const NodeSharedSegments& CommunicatorCache::node_segments(MPI_Comm comm,
+        const std::vector<int>& node_mapping, MPI_Aint bytes) {
+        CacheEntry& cache_entry = entry(comm);
+        NodeSharedSegments*& shared = cache_entry.node_segments[node_key(comm, node_mapping)];
+        if (shared != nullptr && shared->capacity >= bytes) {
+            return *shared;
+        }
+
+        const NodeCommunicators& node = CommunicatorCache::node(comm, node_mapping);
+        if (shared == nullptr) {
+            shared = new NodeSharedSegments();
+        }
+        else {
+            MPI_Win_unlock_all(shared->window);
+            MPI_Win_free(&shared->window);
+        }
+
+        void* base = nullptr;
+        MPI_Win_allocate_shared(bytes, 1, MPI_INFO_NULL, node.node_comm, &base, &shared->window);
+        MPI_Win_lock_all(MPI_MODE_NOCHECK, shared->window);
+        shared->capacity = bytes;
+
+        int node_size;
+        MPI_Comm_size(node.node_comm, &node_size);
+        shared->segments.resize(node_size);
+        for (int i = 0; i < node_size; ++i) {
+            MPI_Aint segment_bytes;
+            int displacement_unit;
+            void* segment = nullptr;
+            MPI_Win_shared_query(shared->window, i, &segment_bytes, &displacement_unit, &segment);
+            shared->segments[i] = static_cast<char*>(segment);
+        }
+
+        track_windows(cache_entry);
+        return *shared;
+    }
+
+    const std::vector<std::vector<int>>& CommunicatorCache::graph_destinations(MPI_Comm comm) {
+        CacheEntry& cache_entry = entry(comm);
+        if (cache_entry.has_graph_destinations) {
+            return cache_entry.graph_destinations;
+        }
+
+        int world_size;
+        MPI_Comm_size(comm, &world_size);
+
+        int indegree, outdegree, weighted;
+        MPI_Dist_graph_neighbors_count(comm, &indegree, &outdegree, &weighted);
+        std::vector<int> sources(indegree), destinations(outdegree);
+        MPI_Dist_graph_neighbors(comm, indegree, sources.data(), MPI_UNWEIGHTED,
+            outdegree, destinations.data(), MPI_UNWEIGHTED);
+
+        std::vector<int> degrees(world_size), displacements(world_size, 0);
+        MPI_Allgather(&outdegree, 1, MPI_INT, degrees.data(), 1, MPI_INT, comm);
+        for (int i = 1; i < world_size; ++i) {
+            displacements[i] = displacements[i - 1] + degrees[i - 1];
+        }
+        std::vector<int> all_destinations(displacements[world_size - 1] + degrees[world_size - 1]);
+        MPI_Allgatherv(destinations.data(), outdegree, MPI_INT,
+            all_destinations.data(), degrees.data(), displacements.data(), MPI_INT, comm);
+
+        cache_entry.graph_destinations.resize(world_size);
+        for (int i = 0; i < world_size; ++i) {
+            cache_entry.graph_destinations[i].assign(all_destinations.begin() + displacements[i],
+                all_destinations.begin() + displacements[i] + degrees[i]);
+        }
+        cache_entry.has_graph_destinations = true;
+        return cache_entry.graph_destinations;
+    }
+
+    int CommunicatorCache::torus_rank(const TorusCommunicators& torus, int x, int y, int z) {
+        int rank = x + torus.dims[0] * (y + torus.dims[1] * z);
+        return (rank < torus.total_processes) ? rank : -1;
+    }
+
+    std::vector<int> node_grouped_order(const std::vector<int>& node_mapping, int world_size) {
+        std::vector<int> order(world_size);
+        std::iota(order.begin(), order.end(), 0);
+        if (static_cast<int>(node_mapping.size()) == world_size) {
+            std::stable_sort(order.begin(), order.end(), [&](int a, int b) {
+                return node_mapping[a] < node_mapping[b];
+            });
+        }
+        return order;
+    }
+
+    bool has_node_hierarchy(const std::vector<int>& node_mapping, int world_size) {
+        if (static_cast<int>(node_mapping.size()) != world_size) {
+            return false;
+        }
+
+        std::vector<int> node_ids(node_mapping);
+        std::sort(node_ids.begin(), node_ids.end());
+        int nodes = static_cast<int>(std::unique(node_ids.begin(), node_ids.end()) - node_ids.begin());
+        return nodes > 1 && nodes < world_size;
+    }
+
+    bool has_contiguous_nodes(const std::vector<int>& node_mapping, int world_size) {
+        if (static_cast<int>(node_mapping.size()) != world_size || world_size == 0) {
+            return false;
+        }
+
+        std::set<int> finished;
+        for (int i = 1; i < world_size; ++i) {
+            if (node_mapping[i] != node_mapping[i - 1]) {
+                finished.insert(node_mapping[i - 1]);
+                if (finished.count(node_mapping[i])) {
+                    return false;
+                }
+            }
+        }
+        int nodes = static_cast<int>(finished.size()) + 1;
+        return nodes > 1 && nodes < world_size;
+    }
+
+} // namespace TopologyAwareResearch
@@ -0,0 +1,151 @@
+#ifndef COMMUNICATOR_CACHE_H
+#define COMMUNICATOR_CACHE_H
+
+#include <mpi.h>
+#include <atomic>
+#include <vector>
+#include <map>
+#include <set>
+
+namespace TopologyAwareResearch {
+
+    // Process grid laid over a (possibly partial) 2D/3D torus.
+    // Ranks are placed row-major: x varies fastest, then y, then z.
+    struct TorusCommunicators {
+        int dims[3];     // Grid extents actually used (x, y, z)
+        int coords[3];   // This rank's coordinates
+        int total_processes;
+
+        MPI_Comm row_comm;     // Same (y, z): ranks ordered by x
+        MPI_Comm column_comm;  // Same (x, z): ranks ordered by y
+        MPI_Comm plane_comm;   // Same (x, y) across z-planes: ranks ordered by z
+
+        TorusCommunicators() : total_processes(0), row_comm(MPI_COMM_NULL),
+            column_comm(MPI_COMM_NULL), plane_comm(MPI_COMM_NULL) {
+            dims[0] = dims[1] = dims[2] = 1;
+            coords[0] = coords[1] = coords[2] = 0;
+        }
+
+        MPI_Comm line_comm(int dim) const {
+            return dim == 0 ? row_comm : (dim == 1 ? column_comm : plane_comm);
+        }
+    };
+
+    // Two-level node/leader split of a communicator. Nodes are numbered by
+    // ascending node id; within a node ranks keep their parent order and the
+    // lowest one is the leader.
+    struct NodeCommunicators {
+        int node_index;   // This rank's node
+        int node_count;
+        int node_rank;    // Rank within node_comm (0 = leader)
+
+        MPI_Comm node_comm;    // Ranks sharing this node
+        MPI_Comm leader_comm;  // One leader per node, ordered by node index; MPI_COMM_NULL on non-leaders
+
+        std::vector<int> node_sizes;  // Ranks per node, by node index
+        std::vector<int> node_order;  // Parent ranks grouped by node index, then rank
+
+        NodeCommunicators() : node_index(0), node_count(0), node_rank(0),
+            node_comm(MPI_COMM_NULL), leader_comm(MPI_COMM_NULL) {}
+
+        bool is_leader() const { return node_rank == 0; }
+    };
+
+    // Ranks grouped by node id, in rank order within a node; plain rank
+    // order when node_mapping does not cover world_size ranks
+    std::vector<int> node_grouped_order(const std::vector<int>& node_mapping, int world_size);
+
+    // True when node_mapping covers world_size ranks and has several nodes,
+    // one of them shared
+    bool has_node_hierarchy(const std::vector<int>& node_mapping, int world_size);
+
+    // has_node_hierarchy() with every node's ranks consecutive
+    bool has_contiguous_nodes(const std::vector<int>& node_mapping, int world_size);
+
+    // Sense-reversing barrier flags in a shared-memory window spanning the
+    // ranks of one node (the MPI_COMM_TYPE_SHARED split). Both flags live in
+    // the node leader's segment.
+    struct NodeBarrierWindow {
+        MPI_Win window;
+        std::atomic<int>* arrived;  // Ranks that reached the current barrier
+        std::atomic<int>* sense;    // Flipped by the leader to release the node
+        int local_sense;            // This rank's sense for the next barrier
+
+        NodeBarrierWindow() : window(MPI_WIN_NULL), arrived(nullptr), sense(nullptr), local_sense(0) {}
+    };
+
+    // One segment per node rank in a shared-memory window over
+    // node(comm, mapping).node_comm. The window stays locked (lock_all) for
+    // its lifetime; callers order accesses with MPI_Win_sync and node barriers.
+    struct NodeSharedSegments {
+        MPI_Win window;
+        MPI_Aint capacity;             // Bytes per segment
+        std::vector<char*> segments;   // By node rank
+
+        NodeSharedSegments() : window(MPI_WIN_NULL), capacity(0) {}
+    };
+
+    // Caches derived communicators on the parent communicator through MPI
+    // attributes, so they are built once and released when the parent is freed.
+    class CommunicatorCache {
+    public:
+        // Row/column/plane communicators for the given grid. Requested
+        // extents are trimmed to the communicator size; a zero or too small
+        // grid is replaced by an MPI_Dims_create decomposition.
+        static const TorusCommunicators& torus(MPI_Comm comm, int dim_x, int dim_y, int dim_z);
+
+        // Rank of the process at the given coordinates, or -1 if the grid
+        // position is beyond the last (partial) plane.
+        static int torus_rank(const TorusCommunicators& torus, int x, int y, int z);
+
+        // Node and leader communicators for a process -> node mapping. An
+        // empty or mis-sized mapping falls back to MPI_COMM_TYPE_SHARED.
+        static const NodeCommunicators& node(MPI_Comm comm, const std::vector<int>& node_mapping);
+
+        // Barrier window over node(comm, {}).node_comm; collective on first use
+        static NodeBarrierWindow& node_barrier(MPI_Comm comm);
+
+        // True when the ranks of every node of node(comm, node_mapping) can
+        // share memory. Collective over comm on first use.
+        static bool node_shares_memory(MPI_Comm comm, const std::vector<int>& node_mapping);
+
+        // Shared segments of at least `bytes` each, reallocated when too small.
+        // Collective over the node; all its ranks must pass the same size.
+        // Only valid when node_shares_memory() holds.
+        static const NodeSharedSegments& node_segments(MPI_Comm comm, const std::vector<int>& node_mapping,
+            MPI_Aint bytes);
+
+        // Destination lists of every rank of a distributed graph communicator.
+        // Collective over comm on first use.
+        static const std::vector<std::vector<int>>& graph_destinations(MPI_Comm comm);
+
+    private:
+        struct CacheEntry {
+            std::map<std::vector<int>, TorusCommunicators> torus;
+            std::map<std::vector<int>, NodeCommunicators> node;
+            NodeBarrierWindow* node_barrier = nullptr;
+            std::map<std::vector<int>, NodeSharedSegments*> node_segments;
+            std::map<std::vector<int>, bool> node_shared;
+            std::vector<std::vector<int>> graph_destinations;
+            bool has_graph_destinations = false;
+        };
+
+        static CacheEntry& entry(MPI_Comm comm);
+        // Lookup key of a node mapping: empty unless it covers comm
+        static std::vector<int> node_key(MPI_Comm comm, const std::vector<int>& node_mapping);
+        static int delete_entry(MPI_Comm comm, int keyval, void* attribute_val, void* extra_state);
+        static int keyval_;
+
+        // Windows must be freed while MPI is fully up, which is no longer the
+        // case when MPI_COMM_WORLD's attributes go at MPI_Finalize. An
+        // attribute on MPI_COMM_SELF (deleted first) releases the leftovers.
+        static void track_windows(CacheEntry& cache_entry);
+        static void free_windows(CacheEntry& cache_entry);
+        static int release_windows(MPI_Comm comm, int keyval, void* attribute_val, void* extra_state);
+        static int finalize_keyval_;
+        static std::set<CacheEntry*> window_entries_;
+    };
+
+} // namespace TopologyAwareResearch
+
+#endif // COMMUNICATOR_CACHE_H
@@ -0,0 +1,148 @@
+#include "datatype_layout.h"
+
+namespace TopologyAwareResearch {
+
+    int DatatypeLayoutCache::keyval_ = MPI_KEYVAL_INVALID;
+
+    const std::vector<DatatypeRun>* DatatypeLayoutCache::runs(MPI_Datatype datatype) {
+        int integers, addresses, datatypes, combiner;
+        MPI_Type_get_envelope(datatype, &integers, &addresses, &datatypes, &combiner);
+        if (combiner == MPI_COMBINER_NAMED) {
+            return nullptr;
+        }
+
+        if (keyval_ == MPI_KEYVAL_INVALID) {
+            MPI_Type_create_keyval(MPI_TYPE_NULL_COPY_FN, &DatatypeLayoutCache::delete_layout,
+                &keyval_, nullptr);
+        }
+
+        void* attribute_val = nullptr;
+        int found = 0;
+        MPI_Type_get_attr(datatype, keyval_, &attribute_val, &found);
+        Layout* layout = static_cast<Layout*>(attribute_val);
+        if (!found) {
+            layout = new Layout();
+            layout->flattened = flatten(datatype, 0, layout->runs);
+            if (!layout->flattened) {
+                layout->runs.clear();
+            }
+            MPI_Type_set_attr(datatype, keyval_, layout);
+        }
+        return layout->flattened ? &layout->runs : nullptr;
+    }
+
+    bool DatatypeLayoutCache::flatten(MPI_Datatype datatype, MPI_Aint base, std::vector<DatatypeRun>& runs) {
+        int integer_count, address_count, datatype_count, combiner;
+        MPI_Type_get_envelope(datatype, &integer_count, &address_count, &datatype_count, &combiner);
+        if (combiner == MPI_COMBINER_NAMED) {
+            append_run(runs, { base, datatype, 1 });
+            return true;
+        }
+
+        std::vector<int> integers(integer_count);
+        std::vector<MPI_Aint> addresses(address_count);
+        std::vector<MPI_Datatype> types(datatype_count);
+        MPI_Type_get_contents(datatype, integer_count, address_count, datatype_count,
+            integers.data(), addresses.data(), types.data());
+
+        // The constituent types are flattened once and then placed at each
+        // displacement: element j of block i of a vector sits at
+        // (i * stride + j) * extent, and so on
+        std::vector<std::vector<DatatypeRun>> inner(types.size());
+        std::vector<MPI_Aint> extents(types.size());
+        bool flattened = true;
+        for (size_t t = 0; t < types.size(); ++t) {
+            MPI_Aint lower_bound;
+            MPI_Type_get_extent(types[t], &lower_bound, &extents[t]);
+            flattened = flattened && flatten(types[t], 0, inner[t]);
+        }
+        auto place = [&](size_t t, MPI_Aint displacement, int blocklength) {
+            for (int j = 0; j < blocklength; ++j) {
+                for (const DatatypeRun& run : inner[t]) {
+                    append_run(runs, { base + displacement + j * extents[t] + run.offset, run.type, run.count });
+                }
+            }
+        };
+
+        if (flattened) {
+            switch (combiner) {
+            case MPI_COMBINER_DUP:
+            case MPI_COMBINER_RESIZED:
+                // Resizing only changes the spacing of consecutive elements
+                place(0, 0, 1);
+                break;
+            case MPI_COMBINER_CONTIGUOUS:
+                place(0, 0, integers[0]);
+                break;
+            case MPI_COMBINER_VECTOR:
+                for (int i = 0; i < integers[0]; ++i) {
+                    place(0, i * integers[2] * extents[0], integers[1]);
+                }
+                break;
+            case MPI_COMBINER_HVECTOR:
+                for (int i = 0; i < integers[0]; ++i) {
+                    place(0, i * addresses[0], integers[1]);
+                }
+                break;
+            case MPI_COMBINER_INDEXED:
+                for (int i = 0; i < integers[0]; ++i) {
+                    place(0, integers[1 + integers[0] + i] * extents[0], integers[1 + i]);
+                }
+                break;
+            case MPI_COMBINER_HINDEXED:
+                for (int i = 0; i < integers[0]; ++i) {
+                    place(0, addresses[i], integers[1 + i]);
+                }
+                break;
+            case MPI_COMBINER_INDEXED_BLOCK:
+                for (int i = 0; i < integers[0]; ++i) {
+                    place(0, integers[2 + i] * extents[0], integers[1]);
+                }
+                break;
+            case MPI_COMBINER_HINDEXED_BLOCK:
+                for (int i = 0; i < integers[0]; ++i) {
+                    place(0, addresses[i], integers[1]);
+                }
+                break;
+            case MPI_COMBINER_STRUCT:
+                for (int i = 0; i < integers[0]; ++i) {
+                    place(i, addresses[i], integers[1 + i]);
+                }
+                break;
+            default:
+                flattened = false;
+                break;
+            }
+        }
+
+        // get_contents hands out new handles for derived constituents
+        for (MPI_Datatype& type : types) {
+            int a, b, c, type_combiner;
+            MPI_Type_get_envelope(type, &a, &b, &c, &type_combiner);
+            if (type_combiner != MPI_COMBINER_NAMED) {
+                MPI_Type_free(&type);
+            }
+        }
+        return flattened;
+    }
+
+    void DatatypeLayoutCache::append_run(std::vector<DatatypeRun>& runs, const DatatypeRun& run) {
+        if (!runs.empty()) {
+            DatatypeRun& last = runs.back();
+            MPI_Aint lower_bound, extent;
+            MPI_Type_get_extent(last.type, &lower_bound, &extent);
+            if (last.type == run.type && last.offset + last.count * extent == run.offset) {
+                last.count += run.count;
+                return;
+            }
+        }
+        runs.push_back(run);
+    }
+
+    int DatatypeLayoutCache::delete_layout(MPI_Datatype /*datatype*/, int /*keyval*/,
+        void* attribute_val, void* /*extra_state*/) {
+        delete static_cast<Layout*>(attribute_val);
+        return MPI_SUCCESS;
+    }
+
+} // namespace TopologyAwareResearch
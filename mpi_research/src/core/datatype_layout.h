@@ -0,0 +1,45 @@
+#ifndef DATATYPE_LAYOUT_H
+#define DATATYPE_LAYOUT_H
+
+#include <mpi.h>
+#include <vector>
+
+namespace TopologyAwareResearch {
+
+    // Consecutive elements of one predefined datatype inside the typemap of
+    // a derived datatype
+    struct DatatypeRun {
+        MPI_Aint offset;     // Bytes from the start of the element
+        MPI_Datatype type;   // Named (predefined) datatype
+        int count;
+    };
+
+    // Flattened layouts of derived datatypes, cached on the datatype handle
+    // through an MPI attribute so they are built once and dropped when the
+    // datatype is freed.
+    class DatatypeLayoutCache {
+    public:
+        // Runs of one element of datatype in typemap order, with adjacent
+        // runs of the same type merged. Built on first use from
+        // MPI_Type_get_envelope/MPI_Type_get_contents; contiguous, vector,
+        // indexed, struct, dup and resized constructors are understood.
+        // nullptr for named datatypes and for anything else (subarray,
+        // darray, ...), which is also remembered.
+        static const std::vector<DatatypeRun>* runs(MPI_Datatype datatype);
+
+    private:
+        struct Layout {
+            bool flattened = false;
+            std::vector<DatatypeRun> runs;
+        };
+
+        // Appends the runs of one element of datatype, shifted by base
+        static bool flatten(MPI_Datatype datatype, MPI_Aint base, std::vector<DatatypeRun>& runs);
+        static void append_run(std::vector<DatatypeRun>& runs, const DatatypeRun& run);
+        static int delete_layout(MPI_Datatype datatype, int keyval, void* attribute_val, void* extra_state);
+        static int keyval_;
+    };
+
+} // namespace TopologyAwareResearch
+
+#endif // DATATYPE_LAYOUT_H
@@ -0,0 +1,218 @@
+#include "dragonfly_layout.h"
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+#include <map>
+#include <set>
+
+namespace TopologyAwareResearch {
+
+    DragonflyLayout DragonflyLayoutDetector::detect(MPI_Comm comm, const std::vector<int>& node_mapping,
+        const std::string& config_path) {
+        DragonflyLayout layout;
+
+        std::string path = config_path;
+        if (path.empty()) {
+            const char* env_path = std::getenv(config_environment_variable());
+            if (env_path != nullptr) {
+                path = env_path;
+            }
+        }
+
+        // Rank 0 decides whether a file is in play so every rank takes the same path
+        int world_rank;
+        MPI_Comm_rank(comm, &world_rank);
+        int use_file = path.empty() ? 0 : 1;
+        MPI_Bcast(&use_file, 1, MPI_INT, 0, comm);
+
+        if (use_file && load_config(comm, path, node_mapping, layout)) {
+            return layout;
+        }
+        if (detect_cray(comm, node_mapping, layout)) {
+            return layout;
+        }
+
+        int world_size;
+        MPI_Comm_size(comm, &world_size);
+        std::vector<int> router_mapping(world_size);
+        for (int i = 0; i < world_size; ++i) {
+            router_mapping[i] = (static_cast<int>(node_mapping.size()) == world_size) ? node_mapping[i] : i;
+        }
+        layout = infer(router_mapping, 0);
+        fill_summary(node_mapping, layout);
+        return layout;
+    }
+
+    bool DragonflyLayoutDetector::load_config(MPI_Comm comm, const std::string& path,
+        const std::vector<int>& node_mapping, DragonflyLayout& layout) {
+        int world_rank;
+        MPI_Comm_rank(comm, &world_rank);
+
+        // Only rank 0 touches the file system; the text is shared with everyone
+        std::string contents;
+        int length = -1;
+        if (world_rank == 0) {
+            std::ifstream file(path);
+            if (file) {
+                std::stringstream buffer;
+                buffer << file.rdbuf();
+                contents = buffer.str();
+                length = static_cast<int>(contents.size());
+            }
+        }
+        MPI_Bcast(&length, 1, MPI_INT, 0, comm);
+        if (length < 0) {
+            return false;
+        }
+        contents.resize(length);
+        MPI_Bcast(&contents[0], length, MPI_CHAR, 0, comm);
+
+        char processor_name[MPI_MAX_PROCESSOR_NAME];
+        int name_len;
+        MPI_Get_processor_name(processor_name, &name_len);
+        std::string hostname(processor_name, name_len);
+
+        long long group_key = -1, router_key = -1;
+        std::istringstream lines(contents);
+        std::string line;
+        while (std::getline(lines, line)) {
+            size_t comment = line.find('#');
+            if (comment != std::string::npos) {
+                line.erase(comment);
+            }
+            std::istringstream fields(line);
+            std::string host;
+            long long group, router;
+            if (!(fields >> host >> group >> router)) {
+                continue;
+            }
+            if (host == hostname) {
+                group_key = group;
+                router_key = router;
+            }
+        }
+
+        if (!assemble(comm, group_key, router_key, node_mapping, layout)) {
+            return false;
+        }
+        layout.source = "config";
+        return true;
+    }
+
+    bool DragonflyLayoutDetector::detect_cray(MPI_Comm comm, const std::vector<int>& node_mapping,
+        DragonflyLayout& layout) {
+        // cname looks like c<cab_x>-<cab_y>c<chassis>s<slot>n<node>; an Aries
+        // group spans two cabinets and each blade (slot) carries one router
+        long long group_key = -1, router_key = -1;
+        std::ifstream file("/proc/cray_xt/cname");
+        std::string cname;
+        if (file >> cname) {
+            int cab_x, cab_y, chassis, slot, node;
+            if (std::sscanf(cname.c_str(), "c%d-%dc%ds%dn%d", &cab_x, &cab_y, &chassis, &slot, &node) == 5) {
+                group_key = static_cast<long long>(cab_y) * 100000 + cab_x / 2;
+                router_key = static_cast<long long>(cab_x % 2) * 1000 + chassis * 16 + slot;
+            }
+        }
+
+        if (!assemble(comm, group_key, router_key, node_mapping, layout)) {
+            return false;
+        }
+        layout.source = "cray";
+        return true;
+    }
+
+    bool DragonflyLayoutDetector::assemble(MPI_Comm comm, long long group_key, long long router_key,
+        const std::vector<int>& node_mapping, DragonflyLayout& layout) {
+        int world_size;
+        MPI_Comm_size(comm, &world_size);
+
+        long long my_keys[2] = { group_key, router_key };
+        std::vector<long long> all_keys(2 * world_size);
+        MPI_Allgather(my_keys, 2, MPI_LONG_LONG, all_keys.data(), 2, MPI_LONG_LONG, comm);
+
+        std::map<long long, int> group_ids;
+        std::map<std::pair<long long, long long>, int> router_ids;
+        for (int i = 0; i < world_size; ++i) {
+            if (all_keys[2 * i] < 0 || all_keys[2 * i + 1] < 0) {
+                return false;
+            }
+            group_ids[all_keys[2 * i]] = 0;
+            router_ids[{ all_keys[2 * i], all_keys[2 * i + 1] }] = 0;
+        }
+
+        // Dense ids in key order; routers of one group end up consecutive
+        int next_id = 0;
+        for (auto& item : group_ids) item.second = next_id++;
+        next_id = 0;
+        for (auto& item : router_ids) item.second = next_id++;
+
+        layout.group_mapping.resize(world_size);
+        layout.router_mapping.resize(world_size);
+        for (int i = 0; i < world_size; ++i) {
+            layout.group_mapping[i] = group_ids[all_keys[2 * i]];
+            layout.router_mapping[i] = router_ids[{ all_keys[2 * i], all_keys[2 * i + 1] }];
+        }
+
+        fill_summary(node_mapping, layout);
+        return true;
+    }
+
+    DragonflyLayout DragonflyLayoutDetector::infer(const std::vector<int>& router_mapping, int routers_per_group) {
+        DragonflyLayout layout;
+        layout.source = "inferred";
+
+        // Renumber routers densely in order of first appearance
+        std::map<int, int> router_ids;
+        layout.router_mapping.resize(router_mapping.size());
+        for (size_t i = 0; i < router_mapping.size(); ++i) {
+            auto it = router_ids.emplace(router_mapping[i], static_cast<int>(router_ids.size())).first;
+            layout.router_mapping[i] = it->second;
+        }
+
+        int total_routers = static_cast<int>(router_ids.size());
+        if (routers_per_group <= 0) {
+            routers_per_group = estimate_routers_per_group(total_routers);
+        }
+
+        layout.group_mapping.resize(router_mapping.size());
+        for (size_t i = 0; i < router_mapping.size(); ++i) {
+            layout.group_mapping[i] = layout.router_mapping[i] / routers_per_group;
+        }
+
+        fill_summary(std::vector<int>(), layout);
+        return layout;
+    }
+
+    int DragonflyLayoutDetector::estimate_routers_per_group(int total_routers) {
+        int a = 1;
+        while (static_cast<long long>(a) * (a * a / 2 + 1) < total_routers) {
+            ++a;
+        }
+        return a;
+    }
+
+    void DragonflyLayoutDetector::fill_summary(const std::vector<int>& node_mapping, DragonflyLayout& layout) {
+        size_t processes = layout.group_mapping.size();
+        bool have_nodes = (node_mapping.size() == processes);
+
+        std::map<int, std::set<int>> routers_in_group;
+        std::map<int, std::set<int>> nodes_on_router;
+        for (size_t i = 0; i < processes; ++i) {
+            routers_in_group[layout.group_mapping[i]].insert(layout.router_mapping[i]);
+            nodes_on_router[layout.router_mapping[i]].insert(have_nodes ? node_mapping[i] : static_cast<int>(i));
+        }
+
+        layout.groups = static_cast<int>(routers_in_group.size());
+        layout.routers_per_group = 0;
+        for (const auto& item : routers_in_group) {
+            layout.routers_per_group = std::max(layout.routers_per_group, static_cast<int>(item.second.size()));
+        }
+        layout.nodes_per_router = 0;
+        for (const auto& item : nodes_on_router) {
+            layout.nodes_per_router = std::max(layout.nodes_per_router, static_cast<int>(item.second.size()));
+        }
+    }
+
+} // namespace TopologyAwareResearch
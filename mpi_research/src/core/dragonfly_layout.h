@@ -0,0 +1,67 @@
+#ifndef DRAGONFLY_LAYOUT_H
+#define DRAGONFLY_LAYOUT_H
+
+#include <mpi.h>
+#include <vector>
+#include <string>
+
+namespace TopologyAwareResearch {
+
+    // Group/router placement of every process on a dragonfly network.
+    // Group ids are dense (0..groups-1); router ids are dense and unique
+    // across the whole machine, so two processes share a router iff their
+    // router ids match.
+    struct DragonflyLayout {
+        std::vector<int> group_mapping;   // process_id -> group_id
+        std::vector<int> router_mapping;  // process_id -> router_id
+        int groups;
+        int routers_per_group;   // Largest group
+        int nodes_per_router;    // Most nodes attached to one router
+        std::string source;      // "config", "cray" or "inferred"
+
+        DragonflyLayout() : groups(0), routers_per_group(0), nodes_per_router(0) {}
+    };
+
+    // Works out the dragonfly layout of a communicator. Sources are tried in
+    // order and the first one that places every process wins:
+    //   1. a layout file (explicit path, else $TOPO_DRAGONFLY_CONFIG) with
+    //      one "<hostname> <group> <router>" line per node, '#' comments;
+    //   2. Cray XC cnames from /proc/cray_xt/cname (a group is a cabinet
+    //      pair, a router is a blade);
+    //   3. an estimate from the node mapping that assumes one node per router
+    //      and a balanced dragonfly.
+    class DragonflyLayoutDetector {
+    public:
+        // Collective over comm
+        static DragonflyLayout detect(MPI_Comm comm, const std::vector<int>& node_mapping,
+            const std::string& config_path = "");
+
+        // Collective over comm; false unless the file covers every process
+        static bool load_config(MPI_Comm comm, const std::string& path,
+            const std::vector<int>& node_mapping, DragonflyLayout& layout);
+
+        // Layout from a process -> router map, packing routers_per_group
+        // consecutive routers into each group (estimated when <= 0)
+        static DragonflyLayout infer(const std::vector<int>& router_mapping, int routers_per_group);
+
+        // Routers per group of a balanced dragonfly (a = 2h) with the given
+        // number of routers, i.e. a such that a * (a * a / 2 + 1) >= routers
+        static int estimate_routers_per_group(int total_routers);
+
+        static const char* config_environment_variable() { return "TOPO_DRAGONFLY_CONFIG"; }
+
+    private:
+        static bool detect_cray(MPI_Comm comm, const std::vector<int>& node_mapping,
+            DragonflyLayout& layout);
+
+        // Allgathers each process's (group, router) key and renumbers densely;
+        // false if any process has no placement (negative key)
+        static bool assemble(MPI_Comm comm, long long group_key, long long router_key,
+            const std::vector<int>& node_mapping, DragonflyLayout& layout);
+
+        static void fill_summary(const std::vector<int>& node_mapping, DragonflyLayout& layout);
+    };
+
+} // namespace TopologyAwareResearch
+
+#endif // DRAGONFLY_LAYOUT_H
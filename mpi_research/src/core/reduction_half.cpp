@@ -0,0 +1,397 @@
+#include "reduction_half.h"
+#include <cstring>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace TopologyAwareResearch {
+
+namespace {
+
+enum class HalfOp { SUM, PROD, MAX, MIN };
+enum class HalfFormat { FLOAT16, BFLOAT16 };
+
+// Datatypes and ops, created together on first use
+struct HalfPrecisionState {
+    MPI_Datatype float16 = MPI_DATATYPE_NULL;
+    MPI_Datatype bfloat16 = MPI_DATATYPE_NULL;
+    MPI_Op ops[4] = { MPI_OP_NULL, MPI_OP_NULL, MPI_OP_NULL, MPI_OP_NULL };  // By HalfOp
+    int finalize_keyval = MPI_KEYVAL_INVALID;
+};
+
+HalfPrecisionState g_half;
+
+uint32_t float_bits(float value) {
+    uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+float bits_float(uint32_t bits) {
+    float value;
+    std::memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+template<HalfFormat F>
+float widen(uint16_t value) {
+    if constexpr (F == HalfFormat::FLOAT16) {
+        return half_to_float(value);
+    }
+    else {
+        return bfloat16_to_float(value);
+    }
+}
+
+template<HalfFormat F>
+uint16_t narrow(float value) {
+    if constexpr (F == HalfFormat::FLOAT16) {
+        return float_to_half(value);
+    }
+    else {
+        return float_to_bfloat16(value);
+    }
+}
+
+template<HalfOp Op>
+float combine_float(float a, float b) {
+    if constexpr (Op == HalfOp::SUM) return a + b;
+    else if constexpr (Op == HalfOp::PROD) return a * b;
+    else if constexpr (Op == HalfOp::MAX) return a > b ? a : b;
+    else return a < b ? a : b;
+}
+
+template<HalfFormat F, HalfOp Op>
+void scalar_half_kernel(const ReductionKernel&, void* dst, const void* a, const void* b,
+                        void* forward, int count) {
+    uint16_t* d = static_cast<uint16_t*>(dst);
+    uint16_t* f = static_cast<uint16_t*>(forward);
+    const uint16_t* x = static_cast<const uint16_t*>(a);
+    const uint16_t* y = static_cast<const uint16_t*>(b);
+    for (int i = 0; i < count; ++i) {
+        uint16_t result = narrow<F>(combine_float<Op>(widen<F>(x[i]), widen<F>(y[i])));
+        d[i] = result;
+        if (f != nullptr) {
+            f[i] = result;
+        }
+    }
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+
+// right = left op right on fp32 vectors; a macro so the intrinsics expand
+// inside each kernel's target
+#define HALF_COMBINE(PREFIX, left, right)                                         \
+    if constexpr (Op == HalfOp::SUM) { right = PREFIX##_add_ps(left, right); }    \
+    else if constexpr (Op == HalfOp::PROD) { right = PREFIX##_mul_ps(left, right); } \
+    else if constexpr (Op == HalfOp::MAX) { right = PREFIX##_max_ps(left, right); } \
+    else { right = PREFIX##_min_ps(left, right); }
+
+// Shared body: LANES elements per step, WIDEN(pointer) gives the fp32
+// vector and NARROW(vector) the packed 16-bit result, stored with STORE
+#define DEFINE_HALF_KERNEL(NAME, ISA, FORMAT, LANES, WIDEN, NARROW, STORE)        \
+    template<HalfOp Op>                                                           \
+    __attribute__((target(ISA)))                                                  \
+    void NAME(const ReductionKernel& kernel, void* dst, const void* a, const void* b, \
+              void* forward, int count) {                                         \
+        uint16_t* d = static_cast<uint16_t*>(dst);                                \
+        uint16_t* f = static_cast<uint16_t*>(forward);                            \
+        const uint16_t* x = static_cast<const uint16_t*>(a);                      \
+        const uint16_t* y = static_cast<const uint16_t*>(b);                      \
+        int i = 0;                                                                \
+        for (; i + LANES <= count; i += LANES) {                                  \
+            auto left = WIDEN(x + i);                                             \
+            auto right = WIDEN(y + i);                                            \
+            HALF_COMBINE_FOR(LANES, left, right)                                  \
+            auto result = NARROW(right);                                          \
+            STORE(d + i, result);                                                 \
+            if (f != nullptr) {                                                   \
+                STORE(f + i, result);                                             \
+            }                                                                     \
+        }                                                                         \
+        scalar_half_kernel<FORMAT, Op>(kernel, d + i, x + i, y + i,               \
+            f != nullptr ? f + i : nullptr, count - i);                           \
+    }
+
+// GCC 12's unmasked AVX-512 conversions, shifts and min/max merge into an
+// undefined vector, which -Wmaybe-uninitialized reports; the AVX-512 code
+// below uses the zero-masking forms with every lane set instead
+#define ALL_16 static_cast<__mmask16>(0xFFFF)
+
+#define HALF_COMBINE_FOR(LANES, left, right) HALF_COMBINE_##LANES(left, right)
+#define HALF_COMBINE_8(left, right) HALF_COMBINE(_mm256, left, right)
+#define HALF_COMBINE_16(left, right)                                              \
+    if constexpr (Op == HalfOp::SUM) { right = _mm512_add_ps(left, right); }      \
+    else if constexpr (Op == HalfOp::PROD) { right = _mm512_mul_ps(left, right); } \
+    else if constexpr (Op == HalfOp::MAX) { right = _mm512_maskz_max_ps(ALL_16, left, right); } \
+    else { right = _mm512_maskz_min_ps(ALL_16, left, right); }
+
+// binary16 through the F16C / AVX-512F conversions
+#define F16C_WIDEN(p) _mm256_cvtph_ps(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p)))
+#define F16C_NARROW(v) _mm256_cvtps_ph(v, _MM_FROUND_TO_NEAREST_INT)
+#define STORE_128(p, v) _mm_storeu_si128(reinterpret_cast<__m128i*>(p), v)
+#define AVX512_HALF_WIDEN(p) _mm512_maskz_cvtph_ps(ALL_16,                         \
+    _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p)))
+#define AVX512_HALF_NARROW(v) _mm512_maskz_cvtps_ph(ALL_16, v, _MM_FROUND_TO_NEAREST_INT)
+#define STORE_256(p, v) _mm256_storeu_si256(reinterpret_cast<__m256i*>(p), v)
+
+DEFINE_HALF_KERNEL(float16_avx2_kernel, "avx2,f16c", HalfFormat::FLOAT16, 8, F16C_WIDEN, F16C_NARROW, STORE_128)
+DEFINE_HALF_KERNEL(float16_avx512_kernel, "avx512f", HalfFormat::FLOAT16, 16, AVX512_HALF_WIDEN,
+    AVX512_HALF_NARROW, STORE_256)
+
+// bfloat16 widens by a shift. Narrowing rounds to nearest even on the
+// integer bits (NaNs kept quiet), like float_to_bfloat16, unless the CPU
+// has AVX-512-BF16, whose conversion also flushes subnormals.
+#define BF16_AVX2_WIDEN(p) _mm256_castsi256_ps(_mm256_slli_epi32(                 \
+    _mm256_cvtepu16_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(p))), 16))
+#define BF16_AVX512_WIDEN(p) _mm512_castsi512_ps(_mm512_maskz_slli_epi32(ALL_16,  \
+    _mm512_maskz_cvtepu16_epi32(ALL_16, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p))), 16))
+#define BF16_AVX512BF16_NARROW(v) ((__m256i)_mm512_maskz_cvtneps_pbh(ALL_16, v))
+
+__attribute__((target("avx2")))
+inline __m128i bfloat16_narrow_avx2(__m256 value) {
+    __m256i bits = _mm256_castps_si256(value);
+    __m256i lsb = _mm256_and_si256(_mm256_srli_epi32(bits, 16), _mm256_set1_epi32(1));
+    __m256i rounded = _mm256_srli_epi32(_mm256_add_epi32(bits, _mm256_add_epi32(lsb, _mm256_set1_epi32(0x7FFF))), 16);
+    __m256i quiet = _mm256_or_si256(_mm256_srli_epi32(bits, 16), _mm256_set1_epi32(0x40));
+    __m256 nan = _mm256_cmp_ps(value, value, _CMP_UNORD_Q);
+    rounded = _mm256_blendv_epi8(rounded, quiet, _mm256_castps_si256(nan));
+    // packus interleaves 128-bit lanes; the permute puts both halves low
+    __m256i packed = _mm256_permute4x64_epi64(_mm256_packus_epi32(rounded, rounded), 0xD8);
+    return _mm256_castsi256_si128(packed);
+}
+
+__attribute__((target("avx512f")))
+inline __m256i bfloat16_narrow_avx512(__m512 value) {
+    __m512i bits = _mm512_castps_si512(value);
+    __m512i high = _mm512_maskz_srli_epi32(ALL_16, bits, 16);
+    __m512i lsb = _mm512_and_si512(high, _mm512_set1_epi32(1));
+    __m512i rounded = _mm512_maskz_srli_epi32(ALL_16,
+        _mm512_add_epi32(bits, _mm512_add_epi32(lsb, _mm512_set1_epi32(0x7FFF))), 16);
+    __m512i quiet = _mm512_or_si512(high, _mm512_set1_epi32(0x40));
+    __mmask16 nan = _mm512_cmp_ps_mask(value, value, _CMP_UNORD_Q);
+    rounded = _mm512_mask_mov_epi32(rounded, nan, quiet);
+    return _mm512_maskz_cvtepi32_epi16(ALL_16, rounded);
+}
+
+DEFINE_HALF_KERNEL(bfloat16_avx2_kernel, "avx2", HalfFormat::BFLOAT16, 8, BF16_AVX2_WIDEN,
+    bfloat16_narrow_avx2, STORE_128)
+DEFINE_HALF_KERNEL(bfloat16_avx512_kernel, "avx512f", HalfFormat::BFLOAT16, 16, BF16_AVX512_WIDEN,
+    bfloat16_narrow_avx512, STORE_256)
+DEFINE_HALF_KERNEL(bfloat16_avx512bf16_kernel, "avx512f,avx512bf16", HalfFormat::BFLOAT16, 16,
+    BF16_AVX512_WIDEN, BF16_AVX512BF16_NARROW, STORE_256)
+
+#undef DEFINE_HALF_KERNEL
+#undef HALF_COMBINE
+#undef HALF_COMBINE_FOR
+#undef HALF_COMBINE_8
+#undef HALF_COMBINE_16
+#undef F16C_WIDEN
+#undef F16C_NARROW
+#undef AVX512_HALF_WIDEN
+#undef AVX512_HALF_NARROW
+#undef BF16_AVX2_WIDEN
+#undef BF16_AVX512_WIDEN
+#undef BF16_AVX512BF16_NARROW
+#undef STORE_128
+#undef STORE_256
+#undef ALL_16
+
+bool cpu_has_f16c() {
+    static const bool supported = [] {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("f16c") != 0;
+    }();
+    return supported;
+}
+
+bool cpu_has_avx512_bf16() {
+    static const bool supported = [] {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx512bf16") != 0;
+    }();
+    return supported;
+}
+
+#endif
+
+template<HalfFormat F, HalfOp Op>
+ReductionKernel::Function format_kernel(SimdLevel level) {
+#if defined(__x86_64__) || defined(__i386__)
+    if constexpr (F == HalfFormat::FLOAT16) {
+        if (level >= SimdLevel::AVX512) return &float16_avx512_kernel<Op>;
+        if (level >= SimdLevel::AVX2 && cpu_has_f16c()) return &float16_avx2_kernel<Op>;
+    }
+    else {
+        if (level >= SimdLevel::AVX512) {
+            return cpu_has_avx512_bf16() ? &bfloat16_avx512bf16_kernel<Op> : &bfloat16_avx512_kernel<Op>;
+        }
+        if (level >= SimdLevel::AVX2) return &bfloat16_avx2_kernel<Op>;
+    }
+#else
+    (void)level;
+#endif
+    return &scalar_half_kernel<F, Op>;
+}
+
+template<HalfFormat F>
+ReductionKernel::Function op_kernel(int op_index, SimdLevel level) {
+    switch (op_index) {
+    case 0: return format_kernel<F, HalfOp::SUM>(level);
+    case 1: return format_kernel<F, HalfOp::PROD>(level);
+    case 2: return format_kernel<F, HalfOp::MAX>(level);
+    default: return format_kernel<F, HalfOp::MIN>(level);
+    }
+}
+
+// Position of op (predefined or its half_precision_op) in HalfOp, or -1
+int half_op_index(MPI_Op op) {
+    const MPI_Op predefined[4] = { MPI_SUM, MPI_PROD, MPI_MAX, MPI_MIN };
+    for (int i = 0; i < 4; ++i) {
+        if (op == predefined[i] || (op != MPI_OP_NULL && op == g_half.ops[i])) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// MPI_User_function: inoutvec = invec op inoutvec
+template<int Index>
+void half_user_function(void* invec, void* inoutvec, int* len, MPI_Datatype* datatype) {
+    if (ReductionKernel::Function function = half_precision_kernel(*datatype, g_half.ops[Index], active_simd_level())) {
+        function(ReductionKernel(), inoutvec, invec, inoutvec, nullptr, *len);
+    }
+}
+
+int release_half_precision(MPI_Comm /*comm*/, int /*keyval*/, void* /*attribute_val*/, void* /*extra_state*/) {
+    MPI_Type_free(&g_half.float16);
+    MPI_Type_free(&g_half.bfloat16);
+    for (MPI_Op& op : g_half.ops) {
+        MPI_Op_free(&op);
+    }
+    return MPI_SUCCESS;
+}
+
+void create_half_precision() {
+    if (g_half.float16 != MPI_DATATYPE_NULL) {
+        return;
+    }
+    MPI_Type_contiguous(2, MPI_BYTE, &g_half.float16);
+    MPI_Type_set_name(g_half.float16, "TOPO_FLOAT16");
+    MPI_Type_commit(&g_half.float16);
+    MPI_Type_contiguous(2, MPI_BYTE, &g_half.bfloat16);
+    MPI_Type_set_name(g_half.bfloat16, "TOPO_BFLOAT16");
+    MPI_Type_commit(&g_half.bfloat16);
+
+    MPI_Op_create(&half_user_function<0>, 1, &g_half.ops[0]);
+    MPI_Op_create(&half_user_function<1>, 1, &g_half.ops[1]);
+    MPI_Op_create(&half_user_function<2>, 1, &g_half.ops[2]);
+    MPI_Op_create(&half_user_function<3>, 1, &g_half.ops[3]);
+
+    // Freed when MPI_COMM_SELF's attributes go at MPI_Finalize
+    MPI_Comm_create_keyval(MPI_COMM_NULL_COPY_FN, &release_half_precision, &g_half.finalize_keyval, nullptr);
+    MPI_Comm_set_attr(MPI_COMM_SELF, g_half.finalize_keyval, nullptr);
+}
+
+} // namespace
+
+MPI_Datatype float16_datatype() {
+    create_half_precision();
+    return g_half.float16;
+}
+
+MPI_Datatype bfloat16_datatype() {
+    create_half_precision();
+    return g_half.bfloat16;
+}
+
+bool is_half_precision(MPI_Datatype datatype) {
+    // Never creates the types: nothing can use them before they exist
+    return datatype != MPI_DATATYPE_NULL && (datatype == g_half.float16 || datatype == g_half.bfloat16);
+}
+
+MPI_Op half_precision_op(MPI_Op op) {
+    create_half_precision();
+    int index = half_op_index(op);
+    return index >= 0 ? g_half.ops[index] : MPI_OP_NULL;
+}
+
+ReductionKernel::Function half_precision_kernel(MPI_Datatype datatype, MPI_Op op, SimdLevel level) {
+    if (!is_half_precision(datatype)) {
+        return nullptr;
+    }
+    int index = half_op_index(op);
+    if (index < 0) {
+        return nullptr;
+    }
+    return datatype == g_half.float16 ? op_kernel<HalfFormat::FLOAT16>(index, level)
+                                      : op_kernel<HalfFormat::BFLOAT16>(index, level);
+}
+
+float half_to_float(uint16_t value) {
+    uint32_t sign = static_cast<uint32_t>(value & 0x8000) << 16;
+    uint32_t exponent = (value >> 10) & 0x1F;
+    uint32_t mantissa = value & 0x3FF;
+    if (exponent == 0x1F) {
+        return bits_float(sign | 0x7F800000 | (mantissa << 13));  // Inf, NaN
+    }
+    if (exponent != 0) {
+        return bits_float(sign | ((exponent + 112) << 23) | (mantissa << 13));
+    }
+    // Zero or subnormal: mantissa * 2^-24, exact in fp32
+    float magnitude = static_cast<float>(mantissa) * bits_float(0x33800000);
+    return sign != 0 ? -magnitude : magnitude;
+}
+
+uint16_t float_to_half(float value) {
+    uint32_t bits = float_bits(value);
+    uint16_t sign = static_cast<uint16_t>((bits >> 16) & 0x8000);
+    bits &= 0x7FFFFFFF;
+    uint32_t exponent = bits >> 23;
+
+    if (exponent == 0xFF) {
+        return sign | ((bits & 0x7FFFFF) != 0 ? 0x7E00 : 0x7C00);
+    }
+    if (exponent >= 143) {
+        return sign | 0x7C00;  // |value| >= 65536
+    }
+
+    uint32_t mantissa = bits & 0x7FFFFF;
+    uint32_t shift;
+    uint32_t result;
+    if (exponent >= 113) {
+        result = ((exponent - 112) << 10) | (mantissa >> 13);
+        shift = 13;
+    }
+    else {
+        // Subnormal half: the significand in units of 2^-24
+        shift = 126 - exponent;
+        if (shift > 24) {
+            return sign;
+        }
+        mantissa |= 0x800000;
+        result = mantissa >> shift;
+    }
+    // Round to nearest even; a carry may step into the next exponent or Inf
+    uint32_t remainder = mantissa & ((1u << shift) - 1);
+    uint32_t halfway = 1u << (shift - 1);
+    if (remainder > halfway || (remainder == halfway && (result & 1) != 0)) {
+        ++result;
+    }
+    return sign | static_cast<uint16_t>(result);
+}
+
+float bfloat16_to_float(uint16_t value) {
+    return bits_float(static_cast<uint32_t>(value) << 16);
+}
+
+uint16_t float_to_bfloat16(float value) {
+    uint32_t bits = float_bits(value);
+    if ((bits & 0x7FFFFFFF) > 0x7F800000) {
+        return static_cast<uint16_t>((bits >> 16) | 0x40);  // Keep NaNs quiet
+    }
+    uint32_t lsb = (bits >> 16) & 1;
+    return static_cast<uint16_t>((bits + 0x7FFF + lsb) >> 16);
+}
+
+} // namespace TopologyAwareResearch
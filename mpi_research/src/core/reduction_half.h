@@ -0,0 +1,39 @@
+#ifndef REDUCTION_HALF_H
+#define REDUCTION_HALF_H
+
+#include <mpi.h>
+#include <cstdint>
+#include "reduction_ops.h"
+#include "reduction_simd.h"
+
+namespace TopologyAwareResearch {
+
+// MPI has no 16-bit floating-point datatypes, so these are 2-byte
+// contiguous types, created on first use (after MPI_Init) and freed at
+// MPI_Finalize. Collectives move them at half the bytes of MPI_FLOAT.
+MPI_Datatype float16_datatype();   // IEEE 754 binary16
+MPI_Datatype bfloat16_datatype();  // bfloat16: the upper half of a binary32
+
+// True for float16_datatype() or bfloat16_datatype()
+bool is_half_precision(MPI_Datatype datatype);
+
+// User op doing MPI_SUM, MPI_PROD, MPI_MAX or MPI_MIN on the half types,
+// for calls that may reach native MPI; MPI_OP_NULL for any other op. The
+// library's own collectives also take the predefined op with these types.
+MPI_Op half_precision_op(MPI_Op op);
+
+// Kernel for a half type with one of the ops above (or its
+// half_precision_op): operands are widened to fp32, combined there and
+// rounded to nearest even once. F16C and AVX-512 conversions, plus
+// AVX-512-BF16 rounding where the CPU has it; scalar below AVX2. nullptr
+// for other datatypes and ops.
+ReductionKernel::Function half_precision_kernel(MPI_Datatype datatype, MPI_Op op, SimdLevel level);
+
+float half_to_float(uint16_t value);
+uint16_t float_to_half(float value);
+float bfloat16_to_float(uint16_t value);
+uint16_t float_to_bfloat16(float value);
+
+} // namespace TopologyAwareResearch
+
+#endif // REDUCTION_HALF_H
@@ -1,9 +1,20 @@
 #include "reduction_ops.h"
+#include "reduction_simd.h"
+#include "reduction_half.h"
+#include "scratch_pool.h"
 #include <iostream>
 #include <algorithm>
+#include <array>
 #include <cstring>
 #include <complex>
 #include <type_traits>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <vector>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 namespace TopologyAwareResearch {
 
@@ -30,128 +41,452 @@ bool is_mpi_op_equal(MPI_Op op1, MPI_Op op2) {
     return (op1 == op2); // Direct comparison might work with some MPI implementations
 }
 
-// Template function for reduction operations
-template<typename T>
-void reduce_elements(T* dest, const T* src, int count, MPI_Op op) {
-    // Use direct comparison with MPI predefined operations
-    if (op == MPI_SUM) {
+// True for the reduction operations predefined by MPI
+bool is_predefined_op(MPI_Op op) {
+    return op == MPI_SUM || op == MPI_PROD || op == MPI_MAX || op == MPI_MIN ||
+           op == MPI_LAND || op == MPI_BAND || op == MPI_LOR || op == MPI_BOR ||
+           op == MPI_LXOR || op == MPI_BXOR || op == MPI_MAXLOC || op == MPI_MINLOC ||
+           op == MPI_REPLACE;
+}
+
+// Element-wise operations; src is the left operand as in reduce_segments
+template<typename T> struct SumOp { static T combine(T s, T d) { return s + d; } };
+template<typename T> struct ProdOp { static T combine(T s, T d) { return s * d; } };
+template<typename T> struct MaxOp { static T combine(T s, T d) { return s > d ? s : d; } };
+template<typename T> struct MinOp { static T combine(T s, T d) { return s < d ? s : d; } };
+template<typename T> struct LandOp { static T combine(T s, T d) { return d && s; } };
+template<typename T> struct LorOp { static T combine(T s, T d) { return d || s; } };
+template<typename T> struct LxorOp { static T combine(T s, T d) { return !d != !s; } };
+template<typename T> struct BandOp { static T combine(T s, T d) { return d & s; } };
+template<typename T> struct BorOp { static T combine(T s, T d) { return d | s; } };
+template<typename T> struct BxorOp { static T combine(T s, T d) { return d ^ s; } };
+template<typename T> struct ReplaceOp { static T combine(T s, T) { return s; } };
+
+template<typename T, template<typename> class Op>
+void elementwise_kernel(const ReductionKernel&, void* dst, const void* a, const void* b,
+                        void* forward, int count) {
+    T* d = static_cast<T*>(dst);
+    const T* x = static_cast<const T*>(a);
+    const T* y = static_cast<const T*>(b);
+    if (forward == nullptr) {
         for (int i = 0; i < count; ++i) {
-            dest[i] += src[i];
+            d[i] = Op<T>::combine(x[i], y[i]);
         }
     }
-    else if (op == MPI_PROD) {
+    else {
+        T* f = static_cast<T*>(forward);
         for (int i = 0; i < count; ++i) {
-            dest[i] *= src[i];
+            T result = Op<T>::combine(x[i], y[i]);
+            d[i] = result;
+            f[i] = result;
         }
     }
-    else if (op == MPI_MAX) {
-        for (int i = 0; i < count; ++i) {
-            if (src[i] > dest[i]) {
-                dest[i] = src[i];
-            }
+}
+
+// MAXLOC/MINLOC over {T value; int index;}, the layout of MPI's pair types
+// (MPI_DOUBLE_INT is T = double, MPI_2INT is T = int); ties keep the lower
+// index
+template<typename T, bool Max>
+void location_kernel(const ReductionKernel&, void* dst, const void* a, const void* b,
+                     void* forward, int count) {
+    struct Pair { T value; int index; };
+    Pair* d = static_cast<Pair*>(dst);
+    const Pair* x = static_cast<const Pair*>(a);
+    const Pair* y = static_cast<const Pair*>(b);
+    Pair* f = static_cast<Pair*>(forward);
+    for (int i = 0; i < count; ++i) {
+        bool better = Max ? x[i].value > y[i].value : x[i].value < y[i].value;
+        Pair result = (better || (x[i].value == y[i].value && x[i].index < y[i].index)) ? x[i] : y[i];
+        d[i] = result;
+        if (f != nullptr) {
+            f[i] = result;
         }
     }
-    else if (op == MPI_MIN) {
-        for (int i = 0; i < count; ++i) {
-            if (src[i] < dest[i]) {
-                dest[i] = src[i];
-            }
-        }
+}
+
+// Result is one operand unchanged
+void copy_result(const ReductionKernel& kernel, void* dst, const void* result, void* forward, int count) {
+    size_t bytes = static_cast<size_t>(count) * kernel.extent;
+    if (dst != result) {
+        std::memcpy(dst, result, bytes);
     }
-    else if (op == MPI_LAND) {
-        for (int i = 0; i < count; ++i) {
-            dest[i] = dest[i] && src[i];
-        }
+    if (forward != nullptr) {
+        std::memcpy(forward, result, bytes);
     }
-    else if (op == MPI_BAND) {
-        // Only for integral types
-        if constexpr (std::is_integral_v<T>) {
-            for (int i = 0; i < count; ++i) {
-                dest[i] = dest[i] & src[i];
-            }
+}
+
+// Combinations without a meaningful definition leave the right operand
+void noop_kernel(const ReductionKernel& kernel, void* dst, const void*, const void* b,
+                 void* forward, int count) {
+    copy_result(kernel, dst, b, forward, count);
+}
+
+void replace_bytes_kernel(const ReductionKernel& kernel, void* dst, const void* a, const void*,
+                          void* forward, int count) {
+    copy_result(kernel, dst, a, forward, count);
+}
+
+// Runs an inoutvec = invec op inoutvec function three-operand: b is copied
+// to dst first, or to a scratch buffer when dst is the left operand
+template<typename InPlace>
+void apply_in_place(const ReductionKernel& kernel, void* dst, const void* a, const void* b,
+                    void* forward, int count, InPlace in_place) {
+    size_t bytes = static_cast<size_t>(count) * kernel.extent;
+    if (dst == b) {
+        in_place(a, dst);
+    }
+    else if (dst != a) {
+        std::memcpy(dst, b, bytes);
+        in_place(a, dst);
+    }
+    else {
+        ScratchBuffer result = ScratchPool::local().acquire_copy(b, bytes);
+        in_place(a, result.data());
+        std::memcpy(dst, result.data(), bytes);
+    }
+    if (forward != nullptr) {
+        std::memcpy(forward, dst, bytes);
+    }
+}
+
+void custom_op_kernel(const ReductionKernel& kernel, void* dst, const void* a, const void* b,
+                      void* forward, int count) {
+    apply_in_place(kernel, dst, a, b, forward, count, [&](const void* in, void* inout) {
+        // MPI_User_function computes inoutvec = invec op inoutvec
+        int length = count;
+        MPI_Datatype datatype = kernel.datatype;
+        kernel.user_function(const_cast<void*>(in), inout, &length, &datatype);
+    });
+}
+
+// Unregistered user operations (MPI_Op_create) are applied by MPI itself,
+// which also keeps their operand order
+void user_op_kernel(const ReductionKernel& kernel, void* dst, const void* a, const void* b,
+                    void* forward, int count) {
+    apply_in_place(kernel, dst, a, b, forward, count, [&](const void* in, void* inout) {
+        MPI_Reduce_local(in, inout, count, kernel.datatype, kernel.op);
+    });
+}
+
+// Derived datatypes: each run of each element goes through the kernel of
+// its predefined type, straight on the caller's buffers. A single run that
+// fills the element (contiguous types) is done in one call.
+void derived_kernel(const ReductionKernel& kernel, void* dst, const void* a, const void* b,
+                    void* forward, int count) {
+    const std::vector<DatatypeRun>& runs = *kernel.runs;
+    const std::vector<ReductionKernel>& kernels = *kernel.run_kernels;
+    char* d = static_cast<char*>(dst);
+    char* f = static_cast<char*>(forward);
+    const char* x = static_cast<const char*>(a);
+    const char* y = static_cast<const char*>(b);
+
+    if (runs.size() == 1 && runs[0].offset == 0 && runs[0].count * kernels[0].extent == kernel.extent) {
+        kernels[0].function(kernels[0], d, x, y, f, count * runs[0].count);
+        return;
+    }
+    for (int i = 0; i < count; ++i) {
+        MPI_Aint element = i * kernel.extent;
+        for (size_t r = 0; r < runs.size(); ++r) {
+            MPI_Aint offset = element + runs[r].offset;
+            kernels[r].function(kernels[r], d + offset, x + offset, y + offset,
+                f != nullptr ? f + offset : nullptr, runs[r].count);
         }
     }
-    else if (op == MPI_LOR) {
-        for (int i = 0; i < count; ++i) {
-            dest[i] = dest[i] || src[i];
+}
+
+// Kernel of a predefined op on an arithmetic type
+template<typename T>
+ReductionKernel::Function typed_kernel(MPI_Op op) {
+    if (op == MPI_SUM) return &elementwise_kernel<T, SumOp>;
+    if (op == MPI_PROD) return &elementwise_kernel<T, ProdOp>;
+    if (op == MPI_MAX) return &elementwise_kernel<T, MaxOp>;
+    if (op == MPI_MIN) return &elementwise_kernel<T, MinOp>;
+    if (op == MPI_LAND) return &elementwise_kernel<T, LandOp>;
+    if (op == MPI_LOR) return &elementwise_kernel<T, LorOp>;
+    if (op == MPI_LXOR) return &elementwise_kernel<T, LxorOp>;
+    if (op == MPI_REPLACE) return &elementwise_kernel<T, ReplaceOp>;
+    // Bitwise operations only for integral types
+    if constexpr (std::is_integral_v<T>) {
+        if (op == MPI_BAND) return &elementwise_kernel<T, BandOp>;
+        if (op == MPI_BOR) return &elementwise_kernel<T, BorOp>;
+        if (op == MPI_BXOR) return &elementwise_kernel<T, BxorOp>;
+    }
+    return &noop_kernel;
+}
+
+// MAXLOC/MINLOC on a pair type with value type T
+template<typename T>
+ReductionKernel::Function pair_kernel(MPI_Op op) {
+    if (op == MPI_MAXLOC) return &location_kernel<T, true>;
+    if (op == MPI_MINLOC) return &location_kernel<T, false>;
+    if (op == MPI_REPLACE) return &replace_bytes_kernel;
+    return &noop_kernel;
+}
+
+// SUM/PROD on std::complex<T>, which has the layout of the C complex types
+template<typename T>
+ReductionKernel::Function complex_kernel(MPI_Op op) {
+    if (op == MPI_SUM) return &elementwise_kernel<std::complex<T>, SumOp>;
+    if (op == MPI_PROD) return &elementwise_kernel<std::complex<T>, ProdOp>;
+    if (op == MPI_REPLACE) return &replace_bytes_kernel;
+    return &noop_kernel;
+}
+
+bool is_location_pair_type(MPI_Datatype datatype) {
+    return datatype == MPI_FLOAT_INT || datatype == MPI_DOUBLE_INT || datatype == MPI_LONG_INT ||
+           datatype == MPI_2INT || datatype == MPI_SHORT_INT || datatype == MPI_LONG_DOUBLE_INT;
+}
+
+bool is_complex_type(MPI_Datatype datatype) {
+    return datatype == MPI_C_FLOAT_COMPLEX || datatype == MPI_C_COMPLEX ||
+           datatype == MPI_C_DOUBLE_COMPLEX || datatype == MPI_C_LONG_DOUBLE_COMPLEX ||
+           datatype == MPI_CXX_FLOAT_COMPLEX || datatype == MPI_CXX_DOUBLE_COMPLEX ||
+           datatype == MPI_CXX_LONG_DOUBLE_COMPLEX;
+}
+
+// Kernel of a predefined op, chosen by datatype
+ReductionKernel::Function predefined_kernel(MPI_Datatype datatype, MPI_Op op) {
+    if (datatype == MPI_CHAR) return typed_kernel<char>(op);
+    if (datatype == MPI_SHORT) return typed_kernel<short>(op);
+    if (datatype == MPI_INT) return typed_kernel<int>(op);
+    if (datatype == MPI_LONG) return typed_kernel<long>(op);
+    if (datatype == MPI_UNSIGNED_CHAR) return typed_kernel<unsigned char>(op);
+    if (datatype == MPI_UNSIGNED_SHORT) return typed_kernel<unsigned short>(op);
+    if (datatype == MPI_UNSIGNED) return typed_kernel<unsigned>(op);
+    if (datatype == MPI_UNSIGNED_LONG) return typed_kernel<unsigned long>(op);
+    if (datatype == MPI_FLOAT) return typed_kernel<float>(op);
+    if (datatype == MPI_DOUBLE) return typed_kernel<double>(op);
+    if (datatype == MPI_LONG_DOUBLE) return typed_kernel<long double>(op);
+    if (datatype == MPI_FLOAT_INT) return pair_kernel<float>(op);
+    if (datatype == MPI_DOUBLE_INT) return pair_kernel<double>(op);
+    if (datatype == MPI_LONG_INT) return pair_kernel<long>(op);
+    if (datatype == MPI_2INT) return pair_kernel<int>(op);
+    if (datatype == MPI_SHORT_INT) return pair_kernel<short>(op);
+    if (datatype == MPI_LONG_DOUBLE_INT) return pair_kernel<long double>(op);
+    if (datatype == MPI_C_FLOAT_COMPLEX || datatype == MPI_C_COMPLEX || datatype == MPI_CXX_FLOAT_COMPLEX) {
+        return complex_kernel<float>(op);
+    }
+    if (datatype == MPI_C_DOUBLE_COMPLEX || datatype == MPI_CXX_DOUBLE_COMPLEX) {
+        return complex_kernel<double>(op);
+    }
+    if (datatype == MPI_C_LONG_DOUBLE_COMPLEX || datatype == MPI_CXX_LONG_DOUBLE_COMPLEX) {
+        return complex_kernel<long double>(op);
+    }
+    if (datatype == MPI_BYTE) {
+        if (op == MPI_BAND) return &elementwise_kernel<unsigned char, BandOp>;
+        if (op == MPI_BOR) return &elementwise_kernel<unsigned char, BorOp>;
+        if (op == MPI_BXOR) return &elementwise_kernel<unsigned char, BxorOp>;
+    }
+    // Any other predefined datatype only supports REPLACE
+    return op == MPI_REPLACE ? &replace_bytes_kernel : &noop_kernel;
+}
+
+// Parallel reduction settings, read from the environment on first use
+struct ParallelReductionSettings {
+    std::atomic<int> threads;
+    std::atomic<size_t> min_bytes;
+
+    ParallelReductionSettings() : threads(1), min_bytes(size_t(4) << 20) {
+        if (const char* value = std::getenv("TOPO_REDUCE_THREADS")) {
+            threads = std::max(1, std::atoi(value));
+        }
+        if (const char* value = std::getenv("TOPO_REDUCE_PARALLEL_BYTES")) {
+            min_bytes = std::strtoull(value, nullptr, 10);
         }
     }
-    else if (op == MPI_BOR) {
-        // Only for integral types
-        if constexpr (std::is_integral_v<T>) {
-            for (int i = 0; i < count; ++i) {
-                dest[i] = dest[i] | src[i];
+};
+
+ParallelReductionSettings& parallel_settings() {
+    static ParallelReductionSettings settings;
+    return settings;
+}
+
+void set_parallel_reduction(int threads, size_t min_bytes) {
+    parallel_settings().threads = std::max(1, threads);
+    parallel_settings().min_bytes = min_bytes;
+}
+
+int parallel_reduction_threads() {
+    return parallel_settings().threads;
+}
+
+size_t parallel_reduction_threshold() {
+    return parallel_settings().min_bytes;
+}
+
+// First element of chunk `index` when count elements at dst are split
+// across `threads`. The whole pages of dst are dealt out evenly and the
+// boundaries placed at their addresses, so the first and last chunks also
+// take the partial pages at either end. Boundaries fall on the first
+// element starting at or after the page address; only an element
+// straddling a page boundary puts two threads on one page.
+static MPI_Aint parallel_chunk_start(const char* dst, MPI_Aint extent, int count, int threads, int index) {
+    if (index <= 0) {
+        return 0;
+    }
+    const uintptr_t page_bytes = 4096;
+    uintptr_t begin = reinterpret_cast<uintptr_t>(dst);
+    uintptr_t end = begin + static_cast<uintptr_t>(count) * extent;
+    uintptr_t first_page = (begin + page_bytes - 1) / page_bytes * page_bytes;
+    uintptr_t last_page = end / page_bytes * page_bytes;
+    if (index >= threads || last_page <= first_page) {
+        return count;
+    }
+    uintptr_t pages = (last_page - first_page) / page_bytes;
+    uintptr_t per_thread = (pages + threads - 1) / threads;
+    uintptr_t boundary = std::min(first_page + index * per_thread * page_bytes, end);
+    MPI_Aint start = static_cast<MPI_Aint>((boundary - begin + extent - 1) / extent);
+    return std::min<MPI_Aint>(start, count);
+}
+
+void ReductionKernel::apply_parallel(Function body, char* dst, const char* a, const char* b, char* forward,
+                                     int count) const {
+#ifdef _OPENMP
+    if (parallel_threads > 1 && !omp_in_parallel()) {
+        // Chunks split at page addresses of dst so threads do not share the
+        // pages they write. The only placement is proc_bind(spread), which
+        // spreads the team over the sockets to use all their bandwidth;
+        // pages are not migrated, so they stay where they were first touched.
+        #pragma omp parallel num_threads(parallel_threads) proc_bind(spread)
+        {
+            int thread = omp_get_thread_num();
+            MPI_Aint first = parallel_chunk_start(dst, extent, count, parallel_threads, thread);
+            MPI_Aint next = parallel_chunk_start(dst, extent, count, parallel_threads, thread + 1);
+            if (first < next) {
+                MPI_Aint length = next - first;
+                MPI_Aint offset = first * extent;
+                body(*this, dst + offset, a + offset, b + offset,
+                    forward != nullptr ? forward + offset : nullptr, static_cast<int>(length));
             }
         }
+        return;
     }
-    else if (op == MPI_LXOR) {
-        for (int i = 0; i < count; ++i) {
-            dest[i] = (dest[i] && !src[i]) || (!dest[i] && src[i]);
-        }
+#endif
+    body(*this, dst, a, b, forward, count);
+}
+
+void ReductionKernel::stream_for_total(size_t total_bytes) {
+    if (streaming_function != nullptr && total_bytes >= streaming_store_threshold()) {
+        streaming_min_count = 0;
     }
-    else if (op == MPI_BXOR) {
-        // Only for integral types
-        if constexpr (std::is_integral_v<T>) {
-            for (int i = 0; i < count; ++i) {
-                dest[i] = dest[i] ^ src[i];
+}
+
+void ReductionKernel::combine_many(void* dst, const void* const* sources, int n, int count) const {
+    if (n <= 0 || count <= 0) {
+        return;
+    }
+    if (n == 1) {
+        if (dst != sources[0]) {
+            size_t bytes = static_cast<size_t>(count) * extent;
+            if (count >= streaming_min_count) {
+                stream_copy(dst, sources[0], bytes);
+            }
+            else {
+                std::memcpy(dst, sources[0], bytes);
             }
         }
+        return;
     }
-    else if (op == MPI_MAXLOC) {
-        // Handle MAXLOC operation
-        struct MaxLocType { T value; int index; };
-        MaxLocType* dest_pairs = reinterpret_cast<MaxLocType*>(dest);
-        const MaxLocType* src_pairs = reinterpret_cast<const MaxLocType*>(src);
 
-        for (int i = 0; i < count; ++i) {
-            if (src_pairs[i].value > dest_pairs[i].value ||
-               (src_pairs[i].value == dest_pairs[i].value && src_pairs[i].index < dest_pairs[i].index)) {
-                dest_pairs[i] = src_pairs[i];
+    char* out = static_cast<char*>(dst);
+    Function last = select(count);
+#ifdef _OPENMP
+    if (count >= parallel_min_count && parallel_threads > 1 && !omp_in_parallel()) {
+        // Split as in apply_parallel
+        #pragma omp parallel num_threads(parallel_threads) proc_bind(spread)
+        {
+            int thread = omp_get_thread_num();
+            MPI_Aint first = parallel_chunk_start(out, extent, count, parallel_threads, thread);
+            MPI_Aint next = parallel_chunk_start(out, extent, count, parallel_threads, thread + 1);
+            if (first < next) {
+                MPI_Aint length = next - first;
+                combine_many_range(last, out, sources, n, first, static_cast<int>(length));
             }
         }
+        return;
     }
-    else if (op == MPI_MINLOC) {
-        // Handle MINLOC operation
-        struct MinLocType { T value; int index; };
-        MinLocType* dest_pairs = reinterpret_cast<MinLocType*>(dest);
-        const MinLocType* src_pairs = reinterpret_cast<const MinLocType*>(src);
+#endif
+    combine_many_range(last, out, sources, n, 0, count);
+}
 
-        for (int i = 0; i < count; ++i) {
-            if (src_pairs[i].value < dest_pairs[i].value ||
-               (src_pairs[i].value == dest_pairs[i].value && src_pairs[i].index < dest_pairs[i].index)) {
-                dest_pairs[i] = src_pairs[i];
-            }
+void ReductionKernel::combine_many_range(Function last, char* dst, const void* const* sources, int n,
+                                         MPI_Aint first, int count) const {
+    // A block of dst plus one block per source in flight stays within L1
+    const MPI_Aint block_bytes = 8192;
+    int block = static_cast<int>(std::max<MPI_Aint>(1, block_bytes / std::max<MPI_Aint>(1, extent)));
+
+    for (int done = 0; done < count; done += block) {
+        int length = std::min(block, count - done);
+        MPI_Aint offset = (first + done) * extent;
+        char* out = dst + offset;
+        (n == 2 ? last : function)(*this, out, static_cast<const char*>(sources[1]) + offset,
+            static_cast<const char*>(sources[0]) + offset, nullptr, length);
+        for (int k = 2; k < n; ++k) {
+            (k == n - 1 ? last : function)(*this, out, static_cast<const char*>(sources[k]) + offset,
+                out, nullptr, length);
         }
     }
-    else if (op == MPI_REPLACE) {
-        std::memcpy(dest, src, count * sizeof(T));
+}
+
+ReductionKernel resolve_reduction_kernel(MPI_Datatype datatype, MPI_Op op) {
+    ReductionKernel kernel;
+    kernel.datatype = datatype;
+    kernel.op = op;
+    MPI_Aint lower_bound;
+    MPI_Type_get_extent(datatype, &lower_bound, &kernel.extent);
+
+    // fp16/bf16 come first: their ops are user ops to MPI
+    if (ReductionKernel::Function half = half_precision_kernel(datatype, op, active_simd_level())) {
+        kernel.function = half;
+    }
+    else if (const CustomReduceOp* typed = g_custom_op_manager.typed_op(op, datatype)) {
+        kernel.function = typed->kernel;
+        kernel.state = typed->state;
+    }
+    else if (g_custom_op_manager.has_custom_op(op)) {
+        kernel.user_function = g_custom_op_manager.custom_function(op);
+        kernel.function = &custom_op_kernel;
+    }
+    else if (!is_predefined_op(op)) {
+        kernel.function = &user_op_kernel;
+    }
+    else if ((kernel.runs = DatatypeLayoutCache::runs(datatype)) != nullptr) {
+        auto run_kernels = std::make_shared<std::vector<ReductionKernel>>();
+        for (const DatatypeRun& run : *kernel.runs) {
+            run_kernels->push_back(resolve_reduction_kernel(run.type, op));
+        }
+        kernel.run_kernels = run_kernels;
+        kernel.function = &derived_kernel;
+    }
+    else if (ReductionKernel::Function vector = simd_reduction_kernel(datatype, op, active_simd_level())) {
+        kernel.function = vector;
     }
     else {
-        // Handle custom operations or fallback to SUM
-        for (int i = 0; i < count; ++i) {
-            dest[i] += src[i];
+        kernel.function = predefined_kernel(datatype, op);
+    }
+
+    // Only the library's own loops are split; user functions may not be
+    // thread-safe and MPI_Reduce_local would need MPI_THREAD_MULTIPLE
+    if (kernel.function != &custom_op_kernel && kernel.function != &user_op_kernel &&
+        kernel.function != &noop_kernel) {
+        int threads = parallel_reduction_threads();
+        if (threads > 1 && kernel.extent > 0) {
+            kernel.parallel_threads = threads;
+            size_t min_count = parallel_reduction_threshold() / kernel.extent;
+            kernel.parallel_min_count = static_cast<int>(std::min<size_t>(std::max<size_t>(min_count, 1), INT_MAX));
         }
     }
-}
 
-// Helper function to convert MPI_Datatype to comparable value
-int datatype_to_int(MPI_Datatype datatype) {
-    // Compare with known MPI datatypes
-    if (datatype == MPI_CHAR) return 1;
-    if (datatype == MPI_SHORT) return 2;
-    if (datatype == MPI_INT) return 3;
-    if (datatype == MPI_LONG) return 4;
-    if (datatype == MPI_UNSIGNED_CHAR) return 5;
-    if (datatype == MPI_UNSIGNED_SHORT) return 6;
-    if (datatype == MPI_UNSIGNED) return 7;
-    if (datatype == MPI_UNSIGNED_LONG) return 8;
-    if (datatype == MPI_FLOAT) return 9;
-    if (datatype == MPI_DOUBLE) return 10;
-    if (datatype == MPI_LONG_DOUBLE) return 11;
-    if (datatype == MPI_BYTE) return 12;
-    if (datatype == MPI_C_COMPLEX) return 13;
-    if (datatype == MPI_C_DOUBLE_COMPLEX) return 14;
-    return 0; // Unknown
+    // Streaming stores once a call's destination would not fit in the
+    // last-level cache anyway
+    size_t streaming_bytes = streaming_store_threshold();
+    if (kernel.function != &custom_op_kernel && kernel.function != &user_op_kernel &&
+        streaming_bytes != SIZE_MAX && kernel.extent > 0) {
+        kernel.streaming_function = simd_streaming_kernel(datatype, op, active_simd_level());
+        size_t min_count = streaming_bytes / kernel.extent;
+        kernel.streaming_min_count = static_cast<int>(std::min<size_t>(min_count, INT_MAX));
+    }
+    return kernel;
 }
 
 // Main reduction function
@@ -162,98 +497,36 @@ void reduce_segments(void* dest, void* src, int start, int count,
         return;
     }
 
-    // Check for custom operations first
-    if (g_custom_op_manager.has_custom_op(op)) {
-        g_custom_op_manager.apply_custom_op(dest, src, start, count, datatype, op);
-        return;
+    resolve_reduction_kernel(datatype, op)(dest, src, start, count);
+}
+
+// Check if operation is supported for datatype
+bool is_operation_supported(MPI_Datatype datatype, MPI_Op op) {
+    if (is_half_precision(datatype)) {
+        return half_precision_kernel(datatype, op, SimdLevel::SCALAR) != nullptr;
     }
 
-    // Use if-else instead of switch for MPI_Datatype
-    int dt = datatype_to_int(datatype);
-
-    if (dt == 1) { // MPI_CHAR
-        char* dest_c = static_cast<char*>(dest) + start;
-        const char* src_c = static_cast<const char*>(src);
-        reduce_elements(dest_c, src_c, count, op);
-    }
-    else if (dt == 2) { // MPI_SHORT
-        short* dest_s = static_cast<short*>(dest) + start;
-        const short* src_s = static_cast<const short*>(src);
-        reduce_elements(dest_s, src_s, count, op);
-    }
-    else if (dt == 3) { // MPI_INT
-        int* dest_i = static_cast<int*>(dest) + start;
-        const int* src_i = static_cast<const int*>(src);
-        reduce_elements(dest_i, src_i, count, op);
-    }
-    else if (dt == 4) { // MPI_LONG
-        long* dest_l = static_cast<long*>(dest) + start;
-        const long* src_l = static_cast<const long*>(src);
-        reduce_elements(dest_l, src_l, count, op);
-    }
-    else if (dt == 5) { // MPI_UNSIGNED_CHAR
-        unsigned char* dest_uc = static_cast<unsigned char*>(dest) + start;
-        const unsigned char* src_uc = static_cast<const unsigned char*>(src);
-        reduce_elements(dest_uc, src_uc, count, op);
-    }
-    else if (dt == 6) { // MPI_UNSIGNED_SHORT
-        unsigned short* dest_us = static_cast<unsigned short*>(dest) + start;
-        const unsigned short* src_us = static_cast<const unsigned short*>(src);
-        reduce_elements(dest_us, src_us, count, op);
-    }
-    else if (dt == 7) { // MPI_UNSIGNED
-        unsigned* dest_u = static_cast<unsigned*>(dest) + start;
-        const unsigned* src_u = static_cast<const unsigned*>(src);
-        reduce_elements(dest_u, src_u, count, op);
-    }
-    else if (dt == 8) { // MPI_UNSIGNED_LONG
-        unsigned long* dest_ul = static_cast<unsigned long*>(dest) + start;
-        const unsigned long* src_ul = static_cast<const unsigned long*>(src);
-        reduce_elements(dest_ul, src_ul, count, op);
-    }
-    else if (dt == 9) { // MPI_FLOAT
-        float* dest_f = static_cast<float*>(dest) + start;
-        const float* src_f = static_cast<const float*>(src);
-        reduce_elements(dest_f, src_f, count, op);
-    }
-    else if (dt == 10) { // MPI_DOUBLE
-        double* dest_d = static_cast<double*>(dest) + start;
-        const double* src_d = static_cast<const double*>(src);
-        reduce_elements(dest_d, src_d, count, op);
-    }
-    else if (dt == 11) { // MPI_LONG_DOUBLE
-        long double* dest_ld = static_cast<long double*>(dest) + start;
-        const long double* src_ld = static_cast<const long double*>(src);
-        reduce_elements(dest_ld, src_ld, count, op);
-    }
-    else if (dt == 12) { // MPI_BYTE
-        char* dest_b = static_cast<char*>(dest) + start;
-        const char* src_b = static_cast<const char*>(src);
-
-        // Handle byte operations
-        if (op == MPI_BAND || op == MPI_BOR || op == MPI_BXOR) {
-            for (int i = 0; i < count; ++i) {
-                if (op == MPI_BAND) dest_b[i] &= src_b[i];
-                else if (op == MPI_BOR) dest_b[i] |= src_b[i];
-                else if (op == MPI_BXOR) dest_b[i] ^= src_b[i];
+    // Derived datatypes: every predefined type they are built from
+    if (const std::vector<DatatypeRun>* runs = DatatypeLayoutCache::runs(datatype)) {
+        for (const DatatypeRun& run : *runs) {
+            if (!is_operation_supported(run.type, op)) {
+                return false;
             }
-        } else if (op == MPI_REPLACE) {
-            std::memcpy(dest_b, src_b, count);
         }
+        return true;
     }
-    else {
-        // Handle unknown datatype with memcpy for REPLACE operation
-        char* dest_unknown = static_cast<char*>(dest) + start * get_mpi_type_size(datatype);
-        const char* src_unknown = static_cast<const char*>(src);
 
-        if (op == MPI_REPLACE) {
-            std::memcpy(dest_unknown, src_unknown, count * get_mpi_type_size(datatype));
-        }
+    // Pair types only take the location ops, complex types only SUM and PROD
+    if (op == MPI_MAXLOC || op == MPI_MINLOC) {
+        return is_location_pair_type(datatype);
+    }
+    if (is_location_pair_type(datatype)) {
+        return op == MPI_REPLACE;
+    }
+    if (is_complex_type(datatype)) {
+        return op == MPI_SUM || op == MPI_PROD || op == MPI_REPLACE;
     }
-}
 
-// Check if operation is supported for datatype
-bool is_operation_supported(MPI_Datatype datatype, MPI_Op op) {
     if (op == MPI_LAND || op == MPI_LOR || op == MPI_LXOR) {
         return (datatype == MPI_CHAR || datatype == MPI_SHORT || datatype == MPI_INT ||
                 datatype == MPI_LONG || datatype == MPI_UNSIGNED_CHAR ||
@@ -268,31 +541,22 @@ bool is_operation_supported(MPI_Datatype datatype, MPI_Op op) {
                 datatype == MPI_UNSIGNED_LONG || datatype == MPI_BYTE);
     }
 
-    if (op == MPI_MAXLOC || op == MPI_MINLOC) {
-        return (datatype == MPI_FLOAT || datatype == MPI_DOUBLE || datatype == MPI_INT ||
-                datatype == MPI_LONG);
-    }
-
     return true;
 }
 
-// Check if SIMD optimization can be used
+// Check if a vector kernel exists for this CPU
 bool is_simd_supported(MPI_Datatype datatype, MPI_Op op) {
-    if (op != MPI_SUM && op != MPI_PROD && op != MPI_MAX && op != MPI_MIN) {
-        return false;
-    }
-
-    return (datatype == MPI_FLOAT || datatype == MPI_DOUBLE ||
-            datatype == MPI_INT || datatype == MPI_LONG);
+    return simd_reduction_kernel(datatype, op, active_simd_level()) != nullptr;
 }
 
-// SIMD-optimized reduction (placeholder)
+// Vector reduction at the active SIMD level
 PerformanceMetrics simd_reduce_segments(void* dest, void* src, int start, int count,
                                        MPI_Datatype datatype, MPI_Op op) {
     PerformanceMetrics metrics;
     auto start_time = MPI_Wtime();
 
-    reduce_segments(dest, src, start, count, datatype, op);
+    ReductionKernel kernel = resolve_reduction_kernel(datatype, op);
+    kernel(dest, src, start, count);
 
     auto end_time = MPI_Wtime();
     metrics.execution_time = end_time - start_time;
@@ -340,10 +604,95 @@ PerformanceMetrics optimized_reduce_segments(void* dest, void* src, int start, i
     return metrics;
 }
 
+// MPI_User_function carries no user data, so every typed op is created on
+// its own trampoline out of a fixed set, each reading one slot
+struct TypedOpSlot {
+    std::shared_ptr<const void> state;
+    TypedOpApply apply = nullptr;
+    MPI_Aint element_size = 0;
+};
+
+TypedOpSlot g_typed_op_slots[CustomOpManager::kTypedOpSlots];
+
+template<int Slot>
+void typed_op_trampoline(void* invec, void* inoutvec, int* len, MPI_Datatype* datatype) {
+    const TypedOpSlot& slot = g_typed_op_slots[Slot];
+    if (slot.apply == nullptr) {
+        return;
+    }
+    int size;
+    MPI_Aint lower_bound, extent, true_lower_bound, true_extent;
+    MPI_Type_size(*datatype, &size);
+    MPI_Type_get_extent(*datatype, &lower_bound, &extent);
+    MPI_Type_get_true_extent(*datatype, &true_lower_bound, &true_extent);
+    if (size == extent && size == true_extent && true_lower_bound == 0 && size % slot.element_size == 0) {
+        // Contiguous: every element is size / sizeof(T) values of T
+        slot.apply(slot.state.get(), invec, inoutvec, *len * static_cast<int>(size / slot.element_size));
+    }
+    else if (size == slot.element_size) {
+        // One T per element at the datatype's stride, where its data sits
+        for (int i = 0; i < *len; ++i) {
+            MPI_Aint offset = true_lower_bound + i * extent;
+            slot.apply(slot.state.get(), static_cast<char*>(invec) + offset,
+                static_cast<char*>(inoutvec) + offset, 1);
+        }
+    }
+}
+
+template<int... Slots>
+std::array<MPI_User_function*, sizeof...(Slots)> typed_op_trampolines(std::integer_sequence<int, Slots...>) {
+    return { &typed_op_trampoline<Slots>... };
+}
+
+const std::array<MPI_User_function*, CustomOpManager::kTypedOpSlots> g_typed_op_trampolines =
+    typed_op_trampolines(std::make_integer_sequence<int, CustomOpManager::kTypedOpSlots>());
+
 // CustomOpManager implementation
 void CustomOpManager::register_custom_op(MPI_Op op, MPI_User_function* function,
                                        void* extra_data, bool commutative) {
-    custom_ops_[op] = {function, extra_data, commutative};
+    unregister_custom_op(op);
+    CustomReduceOp registration;
+    registration.function = function;
+    registration.extra_data = extra_data;
+    registration.commutative = commutative;
+    custom_ops_[op] = registration;
+}
+
+void CustomOpManager::unregister_custom_op(MPI_Op op) {
+    auto it = custom_ops_.find(op);
+    if (it != custom_ops_.end()) {
+        // Kernels resolved earlier keep their own reference to the callable
+        if (it->second.slot >= 0) {
+            g_typed_op_slots[it->second.slot] = TypedOpSlot();
+        }
+        custom_ops_.erase(it);
+    }
+}
+
+MPI_Op CustomOpManager::create_typed_op(ReductionKernel::Function kernel, TypedOpApply apply,
+                                        std::shared_ptr<const void> state, MPI_Aint element_size,
+                                        bool commutative) {
+    int slot = 0;
+    while (slot < kTypedOpSlots && g_typed_op_slots[slot].apply != nullptr) {
+        ++slot;
+    }
+    if (slot == kTypedOpSlots) {
+        return MPI_OP_NULL;
+    }
+    g_typed_op_slots[slot] = { state, apply, element_size };
+
+    MPI_Op op;
+    MPI_Op_create(g_typed_op_trampolines[slot], commutative ? 1 : 0, &op);
+    CustomReduceOp registration;
+    registration.function = g_typed_op_trampolines[slot];
+    registration.commutative = commutative;
+    registration.kernel = kernel;
+    registration.state = std::move(state);
+    registration.apply = apply;
+    registration.element_size = element_size;
+    registration.slot = slot;
+    custom_ops_[op] = registration;
+    return op;
 }
 
 bool CustomOpManager::has_custom_op(MPI_Op op) const {
@@ -355,14 +704,60 @@ void CustomOpManager::apply_custom_op(void* dest, void* src, int start, int coun
     auto it = custom_ops_.find(op);
     if (it != custom_ops_.end()) {
         CustomReduceOp& custom_op = it->second;
-        char* dest_ptr = static_cast<char*>(dest) + start * get_mpi_type_size(datatype);
-        char* src_ptr = static_cast<char*>(src);
+        MPI_Aint lower_bound, extent;
+        MPI_Type_get_extent(datatype, &lower_bound, &extent);
+        char* dest_ptr = static_cast<char*>(dest) + start * extent;
 
-        for (int i = 0; i < count; ++i) {
-            custom_op.function(dest_ptr + i * get_mpi_type_size(datatype),
-                              src_ptr + i * get_mpi_type_size(datatype),
-                              &count, &datatype);
-        }
+        // MPI_User_function computes inoutvec = invec op inoutvec
+        int length = count;
+        custom_op.function(src, dest_ptr, &length, &datatype);
+    }
+}
+
+const CustomReduceOp* CustomOpManager::typed_op(MPI_Op op, MPI_Datatype datatype) const {
+    auto it = custom_ops_.find(op);
+    if (it == custom_ops_.end() || it->second.kernel == nullptr) {
+        return nullptr;
+    }
+    int size;
+    MPI_Aint lower_bound, extent;
+    MPI_Type_size(datatype, &size);
+    MPI_Type_get_extent(datatype, &lower_bound, &extent);
+    bool matches = size == it->second.element_size && extent == it->second.element_size && lower_bound == 0;
+    return matches ? &it->second : nullptr;
+}
+
+MPI_User_function* CustomOpManager::custom_function(MPI_Op op) const {
+    auto it = custom_ops_.find(op);
+    return it != custom_ops_.end() ? it->second.function : nullptr;
+}
+
+bool CustomOpManager::is_commutative(MPI_Op op) const {
+    auto it = custom_ops_.find(op);
+    if (it != custom_ops_.end()) {
+        return it->second.commutative;
+    }
+
+    int commutative = 1;
+    MPI_Op_commutative(op, &commutative);
+    return commutative != 0;
+}
+
+AlgorithmType CustomOpManager::order_preserving_algorithm(MPI_Op op, AlgorithmType algo) const {
+    if (algo == AlgorithmType::NATIVE_MPI || is_commutative(op)) {
+        return algo;
+    }
+
+    switch (algo) {
+    case AlgorithmType::ORDERED_TREE_REDUCE:
+    case AlgorithmType::ORDERED_RECURSIVE_HALVING_REDUCE:
+        return algo;
+    case AlgorithmType::RING_ALLREDUCE:
+    case AlgorithmType::ADAPTIVE_ALLREDUCE:
+    case AlgorithmType::RABENSEIFNER_REDUCE:
+        return AlgorithmType::ORDERED_RECURSIVE_HALVING_REDUCE;
+    default:
+        return AlgorithmType::ORDERED_TREE_REDUCE;
     }
 }
 
@@ -3,8 +3,14 @@
 
 #include <mpi.h>
 #include <map>
+#include <climits>
+#include <cstddef>
 #include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
 #include "collective_optimizer.h"
+#include "datatype_layout.h"
 
 namespace TopologyAwareResearch {
 
@@ -13,7 +19,107 @@ int get_mpi_type_size(MPI_Datatype datatype);
 bool is_operation_supported(MPI_Datatype datatype, MPI_Op op);
 bool is_simd_supported(MPI_Datatype datatype, MPI_Op op);
 
+// A (datatype, op) pair resolved once into the loop that applies it.
+// Collectives resolve it before their step loop so per-segment reductions
+// skip the datatype and operation lookup of reduce_segments.
+struct ReductionKernel {
+    // dst[i] = a[i] op b[i] over count elements, a being the left operand,
+    // also stored to forward unless that is null. dst may be a or b but
+    // must not partially overlap them.
+    using Function = void (*)(const ReductionKernel& kernel, void* dst, const void* a,
+        const void* b, void* forward, int count);
+
+    Function function = nullptr;
+    MPI_Datatype datatype = MPI_DATATYPE_NULL;
+    MPI_Op op = MPI_OP_NULL;
+    MPI_Aint extent = 0;
+    MPI_User_function* user_function = nullptr;  // Registered custom ops only
+    int parallel_threads = 1;             // OpenMP team for large calls
+    int parallel_min_count = INT_MAX;     // Calls from this count use the team
+    Function streaming_function = nullptr;  // Non-temporal store variant, if any
+    int streaming_min_count = INT_MAX;      // Calls from this count stream
+
+    // Derived datatypes: the flattened runs of one element and the kernel of
+    // each run's predefined type
+    const std::vector<DatatypeRun>* runs = nullptr;
+    std::shared_ptr<const std::vector<ReductionKernel>> run_kernels;
+
+    // Typed custom ops: the op's callable, kept alive while the kernel is
+    std::shared_ptr<const void> state;
+
+    // dest[start + i] = src[i] op dest[start + i], as reduce_segments
+    void operator()(void* dest, const void* src, int start, int count) const {
+        char* first = static_cast<char*>(dest) + start * extent;
+        run(first, src, first, nullptr, count);
+    }
+
+    // dst[i] = a[i] op b[i]: reduces two inputs into a third buffer without
+    // copying one of them there first
+    void combine(void* dst, const void* a, const void* b, int count) const {
+        run(dst, a, b, nullptr, count);
+    }
+
+    // combine() that also writes the result to forward (typically the next
+    // step's send buffer) in the same pass
+    void combine_forward(void* dst, void* forward, const void* a, const void* b, int count) const {
+        run(dst, a, b, forward, count);
+    }
+
+    void run(void* dst, const void* a, const void* b, void* forward, int count) const {
+        Function body = select(count);
+        if (count >= parallel_min_count) {
+            apply_parallel(body, static_cast<char*>(dst), static_cast<const char*>(a),
+                static_cast<const char*>(b), static_cast<char*>(forward), count);
+        }
+        else {
+            body(*this, dst, a, b, forward, count);
+        }
+    }
+
+    // Algorithms that reduce a buffer in segments (ring blocks, pipeline
+    // segments) call this with the collective's total bytes: once those
+    // reach streaming_store_threshold() every call streams, however small,
+    // as the buffer does not stay in cache between segments anyway
+    void stream_for_total(size_t total_bytes);
+
+    // Streaming variant for calls of at least streaming_min_count elements
+    Function select(int count) const {
+        return (streaming_function != nullptr && count >= streaming_min_count) ? streaming_function : function;
+    }
+
+    // dst[i] = sources[n-1][i] op ... op sources[1][i] op sources[0][i]:
+    // later sources are left operands, as in reduce_segments. Works through
+    // cache-sized blocks, folding every source into a block before moving
+    // on, so dst is streamed through memory once rather than n-1 times.
+    // dst may be sources[0] but must not overlap any other source. Only the
+    // last fold of a block uses streaming stores, as earlier ones re-read dst.
+    void combine_many(void* dst, const void* const* sources, int n, int count) const;
+
+    // One chunk per thread of the team, split at page addresses of dst;
+    // runs serially when called from inside a parallel region
+    void apply_parallel(Function body, char* dst, const char* a, const char* b, char* forward, int count) const;
+
+    // combine_many over elements [first, first + count), the final fold of
+    // each block done by last
+    void combine_many_range(Function last, char* dst, const void* const* sources, int n,
+        MPI_Aint first, int count) const;
+};
+
+ReductionKernel resolve_reduction_kernel(MPI_Datatype datatype, MPI_Op op);
+
+// Reductions of at least min_bytes with a predefined op are split across an
+// OpenMP team of `threads`, so a node leader reducing large buffers uses
+// the cores its node peers leave idle. Defaults come from
+// TOPO_REDUCE_THREADS (1, i.e. serial, when unset) and
+// TOPO_REDUCE_PARALLEL_BYTES (4 MiB). Kernels keep the setting they were
+// resolved with.
+void set_parallel_reduction(int threads, size_t min_bytes);
+int parallel_reduction_threads();
+size_t parallel_reduction_threshold();
+
 // Main reduction functions
+// dest[start + i] = src[i] op dest[start + i]: like MPI's inoutvec, src is
+// the left operand, which matters for non-commutative user operations
 void reduce_segments(void* dest, void* src, int start, int count,
                     MPI_Datatype datatype, MPI_Op op);
 
@@ -22,10 +128,55 @@ PerformanceMetrics optimized_reduce_segments(void* dest, void* src, int start, i
                                            const NetworkCharacteristics& network_config);
 
 // Custom operation support
+// inoutvec = invec op inoutvec over count elements for a typed op whose
+// callable is state
+using TypedOpApply = void (*)(const void* state, const void* invec, void* inoutvec, int count);
+
 struct CustomReduceOp {
-    MPI_User_function* function;
-    void* extra_data;
-    bool commutative;
+    MPI_User_function* function = nullptr;
+    void* extra_data = nullptr;
+    bool commutative = true;
+    ReductionKernel::Function kernel = nullptr;  // Typed ops: the library's own loop
+    std::shared_ptr<const void> state;  // Typed ops: the callable
+    TypedOpApply apply = nullptr;       // Typed ops: the loop for native MPI
+    MPI_Aint element_size = 0;          // Typed ops: sizeof(T)
+    int slot = -1;                      // Typed ops: trampoline behind function
+};
+
+// Loops for a custom op on T built from a Combine callable with
+// result = combine(left, right). Each instantiation is its own loop, so the
+// compiler inlines the callable and can vectorize it.
+template<typename T, typename Combine>
+struct TypedCustomOp {
+    // The library's loop, on the callable the resolved kernel carries
+    static void kernel(const ReductionKernel& kernel, void* dst, const void* a, const void* b,
+                       void* forward, int count) {
+        loop(*static_cast<const Combine*>(kernel.state.get()), dst, a, b, forward, count);
+    }
+
+    // inoutvec = invec op inoutvec, for native MPI calls
+    static void apply(const void* state, const void* invec, void* inoutvec, int count) {
+        loop(*static_cast<const Combine*>(state), inoutvec, invec, inoutvec, nullptr, count);
+    }
+
+    static void loop(const Combine& op, void* dst, const void* a, const void* b, void* forward, int count) {
+        T* d = static_cast<T*>(dst);
+        const T* x = static_cast<const T*>(a);
+        const T* y = static_cast<const T*>(b);
+        if (forward == nullptr) {
+            for (int i = 0; i < count; ++i) {
+                d[i] = op(x[i], y[i]);
+            }
+        }
+        else {
+            T* f = static_cast<T*>(forward);
+            for (int i = 0; i < count; ++i) {
+                T result = op(x[i], y[i]);
+                d[i] = result;
+                f[i] = result;
+            }
+        }
+    }
 };
 
 class CustomOpManager {
@@ -35,9 +186,46 @@ private:
 public:
     void register_custom_op(MPI_Op op, MPI_User_function* function,
                            void* extra_data, bool commutative);
+    // Call before MPI_Op_free: MPI may hand the same handle out again
+    void unregister_custom_op(MPI_Op op);
+
+    // Creates and registers an op on T elements from a callable returning
+    // combine(left, right); each op keeps its own copy of the callable.
+    // Collectives on a datatype of T's size and extent reduce with an
+    // inlined loop, split across threads like the predefined ops, so
+    // combine must be safe to call concurrently. Other datatypes, and
+    // native MPI calls, go through an MPI_User_function that reads
+    // contiguous datatypes as runs of T. MPI_User_function has no user
+    // data, so at most kTypedOpSlots typed ops can exist at once; beyond
+    // that MPI_OP_NULL is returned. Release with unregister_custom_op and
+    // MPI_Op_free.
+    template<typename T, typename Combine>
+    MPI_Op register_typed_op(Combine combine, bool commutative = true) {
+        using Typed = TypedCustomOp<T, Combine>;
+        return create_typed_op(&Typed::kernel, &Typed::apply,
+            std::make_shared<const Combine>(std::move(combine)), sizeof(T), commutative);
+    }
+    static const int kTypedOpSlots = 64;
+
     bool has_custom_op(MPI_Op op) const;
+    MPI_User_function* custom_function(MPI_Op op) const;
+    // The registration of a register_typed_op op when datatype has T's
+    // size and extent, nullptr for anything else
+    const CustomReduceOp* typed_op(MPI_Op op, MPI_Datatype datatype) const;
     void apply_custom_op(void* dest, void* src, int start, int count,
                         MPI_Datatype datatype, MPI_Op op);
+
+    // Registered flag for custom ops, MPI_Op_commutative for anything else
+    bool is_commutative(MPI_Op op) const;
+
+    // Order-preserving counterpart of a reduce/allreduce algorithm when op
+    // is not commutative (ordered tree for latency-oriented algorithms,
+    // ordered recursive halving for bandwidth-oriented ones); algo otherwise
+    AlgorithmType order_preserving_algorithm(MPI_Op op, AlgorithmType algo) const;
+
+private:
+    MPI_Op create_typed_op(ReductionKernel::Function kernel, TypedOpApply apply,
+                           std::shared_ptr<const void> state, MPI_Aint element_size, bool commutative);
 };
 
 // External declaration for global custom op manager
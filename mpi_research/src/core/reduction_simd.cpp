@@ -0,0 +1,524 @@
+#include "reduction_simd.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <string>
+#include <type_traits>
+#include <unistd.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#endif
+
+namespace TopologyAwareResearch {
+
+namespace {
+
+enum class VectorOp { SUM, PROD, MAX, MIN, BAND, BOR, BXOR };
+
+// dest = src op dest for one vector or element. Expanded inside each kernel
+// rather than called, so it is compiled for that kernel's instruction set
+// whatever the default target of this file is.
+#define VECTOR_COMBINE(d, s)                                      \
+    if constexpr (Op == VectorOp::SUM) { d = s + d; }             \
+    else if constexpr (Op == VectorOp::PROD) { d = s * d; }       \
+    else if constexpr (Op == VectorOp::MAX) { d = s > d ? s : d; } \
+    else if constexpr (Op == VectorOp::MIN) { d = s < d ? s : d; } \
+    else if constexpr (Op == VectorOp::BAND) { d = d & s; }       \
+    else if constexpr (Op == VectorOp::BOR) { d = d | s; }        \
+    else { d = d ^ s; }
+
+// Unaligned vector access through the kernel's `Unaligned` typedef (its
+// vector type with alignment 1). Copying through std::memcpy instead would
+// be expanded for this file's default target, i.e. in 16-byte pieces
+// bounced through the stack.
+#define LOAD_VECTOR(p) (*reinterpret_cast<const Unaligned*>(p))
+#define STORE_VECTOR(p, v) (*reinterpret_cast<Unaligned*>(p) = (v))
+
+// Stores `vectors` vectors from `from` to `to`, non-temporal if `streamed`.
+// A macro for the same reason as VECTOR_COMBINE.
+#define STORE_VECTORS(STREAM_STORE, to, from, vectors, streamed)                     \
+    for (int k = 0; k < vectors; ++k) {                                              \
+        if (streamed) {                                                              \
+            STREAM_STORE((to) + k * lanes, (from)[k]);                               \
+        }                                                                            \
+        else {                                                                       \
+            STORE_VECTOR((to) + k * lanes, (from)[k]);                               \
+        }                                                                            \
+    }
+
+// dst = a op b (and forward = dst unless null). Four independent vectors
+// per iteration keep enough loads in flight to run at memory bandwidth;
+// unaligned loads, scalar tail. With Stream, a scalar prologue aligns dst
+// and whole vectors go out through non-temporal stores, which skip the
+// read-for-ownership of dst and leave the cache to the application;
+// forward is streamed too when it shares dst's alignment.
+#define DEFINE_VECTOR_KERNEL(NAME, ISA, BYTES, STREAM_STORE)                         \
+    template<typename T, VectorOp Op, bool Stream>                                   \
+    __attribute__((target(ISA)))                                                     \
+    void NAME(const ReductionKernel&, void* dst, const void* a, const void* b,       \
+              void* forward, int count) {                                            \
+        typedef T Vec __attribute__((vector_size(BYTES)));                           \
+        typedef T Unaligned __attribute__((vector_size(BYTES), aligned(1), may_alias)); \
+        constexpr int lanes = BYTES / sizeof(T);                                     \
+        T* d = static_cast<T*>(dst);                                                 \
+        T* f = static_cast<T*>(forward);                                             \
+        const T* x = static_cast<const T*>(a);                                       \
+        const T* y = static_cast<const T*>(b);                                       \
+        bool stream = Stream && reinterpret_cast<uintptr_t>(d) % sizeof(T) == 0;     \
+        bool stream_forward = stream && f != nullptr &&                              \
+            (reinterpret_cast<uintptr_t>(f) - reinterpret_cast<uintptr_t>(d)) % BYTES == 0; \
+        int i = 0;                                                                   \
+        if (stream) {                                                                \
+            for (; i < count && reinterpret_cast<uintptr_t>(d + i) % BYTES != 0; ++i) { \
+                T left = x[i], right = y[i];                                         \
+                VECTOR_COMBINE(right, left)                                          \
+                d[i] = right;                                                        \
+                if (f != nullptr) {                                                  \
+                    f[i] = right;                                                    \
+                }                                                                    \
+            }                                                                        \
+        }                                                                            \
+        for (; i + 4 * lanes <= count; i += 4 * lanes) {                             \
+            Vec left[4], right[4];                                                   \
+            for (int k = 0; k < 4; ++k) {                                            \
+                left[k] = LOAD_VECTOR(x + i + k * lanes);                            \
+                right[k] = LOAD_VECTOR(y + i + k * lanes);                           \
+                VECTOR_COMBINE(right[k], left[k])                                    \
+            }                                                                        \
+            STORE_VECTORS(STREAM_STORE, d + i, right, 4, stream)                     \
+            if (f != nullptr) {                                                      \
+                STORE_VECTORS(STREAM_STORE, f + i, right, 4, stream_forward)         \
+            }                                                                        \
+        }                                                                            \
+        for (; i + lanes <= count; i += lanes) {                                     \
+            Vec left = LOAD_VECTOR(x + i), right = LOAD_VECTOR(y + i);               \
+            VECTOR_COMBINE(right, left)                                              \
+            STORE_VECTORS(STREAM_STORE, d + i, &right, 1, stream)                    \
+            if (f != nullptr) {                                                      \
+                STORE_VECTORS(STREAM_STORE, f + i, &right, 1, stream_forward)        \
+            }                                                                        \
+        }                                                                            \
+        for (; i < count; ++i) {                                                     \
+            T left = x[i], right = y[i];                                             \
+            VECTOR_COMBINE(right, left)                                              \
+            d[i] = right;                                                            \
+            if (f != nullptr) {                                                      \
+                f[i] = right;                                                        \
+            }                                                                        \
+        }                                                                            \
+        if (stream) {                                                                \
+            _mm_sfence();                                                            \
+        }                                                                            \
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+#define SSE_STREAM(p, v) _mm_stream_si128(reinterpret_cast<__m128i*>(p), (__m128i)(v))
+#define AVX_STREAM(p, v) _mm256_stream_si256(reinterpret_cast<__m256i*>(p), (__m256i)(v))
+#define AVX512_STREAM(p, v) _mm512_stream_si512(reinterpret_cast<__m512i*>(p), (__m512i)(v))
+DEFINE_VECTOR_KERNEL(sse42_kernel, "sse4.2", 16, SSE_STREAM)
+DEFINE_VECTOR_KERNEL(avx2_kernel, "avx2", 32, AVX_STREAM)
+DEFINE_VECTOR_KERNEL(avx512_kernel, "avx512f,avx512bw,avx512dq,avx512vl", 64, AVX512_STREAM)
+#undef SSE_STREAM
+#undef AVX_STREAM
+#undef AVX512_STREAM
+#endif
+
+// MAXLOC/MINLOC on MPI's {V value; int index;} pair types whose value is
+// 4 or 8 bytes, so a pair fills two lanes of V's width (the index padded in
+// the upper half of an 8-byte lane). Values are compared in the even
+// lanes, indices in the odd ones, and the winning lane pair is copied
+// whole; ties keep the lower index.
+#define DEFINE_PAIR_KERNEL(NAME, ISA, BYTES)                                          \
+    template<typename V, bool Max>                                                   \
+    __attribute__((target(ISA)))                                                     \
+    void NAME(const ReductionKernel&, void* dst, const void* a, const void* b,       \
+              void* forward, int count) {                                            \
+        using Lane = std::conditional_t<sizeof(V) == 4, int32_t, int64_t>;           \
+        typedef Lane Bits __attribute__((vector_size(BYTES)));                       \
+        typedef V Values __attribute__((vector_size(BYTES)));                        \
+        typedef Lane Unaligned __attribute__((vector_size(BYTES), aligned(1), may_alias)); \
+        constexpr int lanes = BYTES / sizeof(V);                                     \
+        Bits even, odd;                                                              \
+        for (int k = 0; k < lanes; ++k) {                                            \
+            even[k] = k & ~1;                                                        \
+            odd[k] = k | 1;                                                          \
+        }                                                                            \
+        Lane* d = static_cast<Lane*>(dst);                                           \
+        Lane* f = static_cast<Lane*>(forward);                                       \
+        const Lane* x = static_cast<const Lane*>(a);                                 \
+        const Lane* y = static_cast<const Lane*>(b);                                 \
+        int total = 2 * count;                                                       \
+        int i = 0;                                                                   \
+        for (; i + lanes <= total; i += lanes) {                                     \
+            Bits left = LOAD_VECTOR(x + i), right = LOAD_VECTOR(y + i);              \
+            Values left_values = (Values)left, right_values = (Values)right;         \
+            Bits better = Max ? (Bits)(left_values > right_values)                   \
+                              : (Bits)(left_values < right_values);                  \
+            Bits equal = (Bits)(left_values == right_values);                        \
+            Bits left_index = left, right_index = right;                             \
+            if constexpr (sizeof(V) == 8) {                                          \
+                left_index = (left << 32) >> 32;                                     \
+                right_index = (right << 32) >> 32;                                   \
+            }                                                                        \
+            Bits lower = (Bits)(left_index < right_index);                           \
+            Bits take = __builtin_shuffle(better, even) |                            \
+                (__builtin_shuffle(equal, even) & __builtin_shuffle(lower, odd));    \
+            Bits result = (left & take) | (right & ~take);                           \
+            STORE_VECTOR(d + i, result);                                             \
+            if (f != nullptr) {                                                      \
+                STORE_VECTOR(f + i, result);                                         \
+            }                                                                        \
+        }                                                                            \
+        for (; i < total; i += 2) {                                                  \
+            V left_value, right_value;                                               \
+            std::memcpy(&left_value, x + i, sizeof(V));                              \
+            std::memcpy(&right_value, y + i, sizeof(V));                             \
+            int32_t left_index = static_cast<int32_t>(x[i + 1]);                     \
+            int32_t right_index = static_cast<int32_t>(y[i + 1]);                    \
+            bool better = Max ? left_value > right_value : left_value < right_value; \
+            const Lane* result = (better || (left_value == right_value &&            \
+                left_index < right_index)) ? x + i : y + i;                          \
+            Lane value = result[0], index = result[1];                               \
+            d[i] = value;                                                            \
+            d[i + 1] = index;                                                        \
+            if (f != nullptr) {                                                      \
+                f[i] = value;                                                        \
+                f[i + 1] = index;                                                    \
+            }                                                                        \
+        }                                                                            \
+    }
+
+// SUM and PROD on interleaved (re, im) complex numbers of T. Products use
+// duplicated real and imaginary parts of b and the swapped pairs of a:
+// (a.re, a.im) * b.re + (a.im, a.re) * b.im * (-1, 1).
+#define DEFINE_COMPLEX_KERNEL(NAME, ISA, BYTES)                                       \
+    template<typename T, bool Prod>                                                  \
+    __attribute__((target(ISA)))                                                     \
+    void NAME(const ReductionKernel&, void* dst, const void* a, const void* b,       \
+              void* forward, int count) {                                            \
+        using Lane = std::conditional_t<sizeof(T) == 4, int32_t, int64_t>;           \
+        typedef T Vec __attribute__((vector_size(BYTES)));                           \
+        typedef Lane Mask __attribute__((vector_size(BYTES)));                       \
+        typedef T Unaligned __attribute__((vector_size(BYTES), aligned(1), may_alias)); \
+        constexpr int lanes = BYTES / sizeof(T);                                     \
+        Mask real, imaginary, swap;                                                  \
+        Vec sign;                                                                    \
+        for (int k = 0; k < lanes; ++k) {                                            \
+            real[k] = k & ~1;                                                        \
+            imaginary[k] = k | 1;                                                    \
+            swap[k] = k ^ 1;                                                         \
+            sign[k] = (k & 1) ? T(1) : T(-1);                                        \
+        }                                                                            \
+        T* d = static_cast<T*>(dst);                                                 \
+        T* f = static_cast<T*>(forward);                                             \
+        const T* x = static_cast<const T*>(a);                                       \
+        const T* y = static_cast<const T*>(b);                                       \
+        int total = 2 * count;                                                       \
+        int i = 0;                                                                   \
+        for (; i + lanes <= total; i += lanes) {                                     \
+            Vec left = LOAD_VECTOR(x + i), right = LOAD_VECTOR(y + i), result;       \
+            if constexpr (Prod) {                                                    \
+                result = left * __builtin_shuffle(right, real) +                     \
+                    __builtin_shuffle(left, swap) * __builtin_shuffle(right, imaginary) * sign; \
+            }                                                                        \
+            else {                                                                   \
+                result = left + right;                                               \
+            }                                                                        \
+            STORE_VECTOR(d + i, result);                                             \
+            if (f != nullptr) {                                                      \
+                STORE_VECTOR(f + i, result);                                         \
+            }                                                                        \
+        }                                                                            \
+        for (; i < total; i += 2) {                                                  \
+            T re = Prod ? x[i] * y[i] - x[i + 1] * y[i + 1] : x[i] + y[i];           \
+            T im = Prod ? x[i + 1] * y[i] + x[i] * y[i + 1] : x[i + 1] + y[i + 1];   \
+            d[i] = re;                                                               \
+            d[i + 1] = im;                                                           \
+            if (f != nullptr) {                                                      \
+                f[i] = re;                                                           \
+                f[i + 1] = im;                                                       \
+            }                                                                        \
+        }                                                                            \
+    }
+
+#if defined(__x86_64__) || defined(__i386__)
+DEFINE_PAIR_KERNEL(sse42_pair_kernel, "sse4.2", 16)
+DEFINE_PAIR_KERNEL(avx2_pair_kernel, "avx2", 32)
+DEFINE_PAIR_KERNEL(avx512_pair_kernel, "avx512f,avx512bw,avx512dq,avx512vl", 64)
+DEFINE_COMPLEX_KERNEL(sse42_complex_kernel, "sse4.2", 16)
+DEFINE_COMPLEX_KERNEL(avx2_complex_kernel, "avx2", 32)
+DEFINE_COMPLEX_KERNEL(avx512_complex_kernel, "avx512f,avx512bw,avx512dq,avx512vl", 64)
+#endif
+
+#undef DEFINE_COMPLEX_KERNEL
+#undef DEFINE_PAIR_KERNEL
+#undef STORE_VECTOR
+#undef LOAD_VECTOR
+#undef DEFINE_VECTOR_KERNEL
+#undef STORE_VECTORS
+#undef VECTOR_COMBINE
+
+template<typename T, VectorOp Op, bool Stream>
+ReductionKernel::Function level_kernel(SimdLevel level) {
+    switch (level) {
+#if defined(__x86_64__) || defined(__i386__)
+    case SimdLevel::AVX512:
+        return &avx512_kernel<T, Op, Stream>;
+    case SimdLevel::AVX2:
+        return &avx2_kernel<T, Op, Stream>;
+    case SimdLevel::SSE42:
+        return &sse42_kernel<T, Op, Stream>;
+#endif
+    default:
+        return nullptr;
+    }
+}
+
+template<typename T, bool Stream>
+ReductionKernel::Function vector_kernel(MPI_Op op, SimdLevel level) {
+    if (op == MPI_SUM) return level_kernel<T, VectorOp::SUM, Stream>(level);
+    if (op == MPI_PROD) return level_kernel<T, VectorOp::PROD, Stream>(level);
+    if (op == MPI_MAX) return level_kernel<T, VectorOp::MAX, Stream>(level);
+    if (op == MPI_MIN) return level_kernel<T, VectorOp::MIN, Stream>(level);
+    if constexpr (std::is_integral_v<T>) {
+        if (op == MPI_BAND) return level_kernel<T, VectorOp::BAND, Stream>(level);
+        if (op == MPI_BOR) return level_kernel<T, VectorOp::BOR, Stream>(level);
+        if (op == MPI_BXOR) return level_kernel<T, VectorOp::BXOR, Stream>(level);
+    }
+    return nullptr;
+}
+
+template<typename V, bool Max>
+ReductionKernel::Function pair_kernel(SimdLevel level) {
+    switch (level) {
+#if defined(__x86_64__) || defined(__i386__)
+    case SimdLevel::AVX512:
+        return &avx512_pair_kernel<V, Max>;
+    case SimdLevel::AVX2:
+        return &avx2_pair_kernel<V, Max>;
+    case SimdLevel::SSE42:
+        return &sse42_pair_kernel<V, Max>;
+#endif
+    default:
+        return nullptr;
+    }
+}
+
+template<typename V>
+ReductionKernel::Function location_vector_kernel(MPI_Op op, SimdLevel level) {
+    if (op == MPI_MAXLOC) return pair_kernel<V, true>(level);
+    if (op == MPI_MINLOC) return pair_kernel<V, false>(level);
+    return nullptr;
+}
+
+template<typename T>
+ReductionKernel::Function complex_vector_kernel(MPI_Op op, SimdLevel level) {
+    if (op != MPI_SUM && op != MPI_PROD) {
+        return nullptr;
+    }
+    bool prod = (op == MPI_PROD);
+    switch (level) {
+#if defined(__x86_64__) || defined(__i386__)
+    case SimdLevel::AVX512:
+        return prod ? &avx512_complex_kernel<T, true> : &avx512_complex_kernel<T, false>;
+    case SimdLevel::AVX2:
+        return prod ? &avx2_complex_kernel<T, true> : &avx2_complex_kernel<T, false>;
+    case SimdLevel::SSE42:
+        return prod ? &sse42_complex_kernel<T, true> : &sse42_complex_kernel<T, false>;
+#endif
+    default:
+        return nullptr;
+    }
+}
+
+template<bool Stream>
+ReductionKernel::Function select_vector_kernel(MPI_Datatype datatype, MPI_Op op, SimdLevel level) {
+    if (level == SimdLevel::SCALAR) {
+        return nullptr;
+    }
+
+    if (datatype == MPI_INT) return vector_kernel<int, Stream>(op, level);
+    if (datatype == MPI_LONG) return vector_kernel<long, Stream>(op, level);
+    if (datatype == MPI_UNSIGNED_CHAR) return vector_kernel<unsigned char, Stream>(op, level);
+    if (datatype == MPI_UNSIGNED_SHORT) return vector_kernel<unsigned short, Stream>(op, level);
+    if (datatype == MPI_UNSIGNED) return vector_kernel<unsigned, Stream>(op, level);
+    if (datatype == MPI_UNSIGNED_LONG) return vector_kernel<unsigned long, Stream>(op, level);
+    if (datatype == MPI_FLOAT) return vector_kernel<float, Stream>(op, level);
+    if (datatype == MPI_DOUBLE) return vector_kernel<double, Stream>(op, level);
+    if (datatype == MPI_BYTE && (op == MPI_BAND || op == MPI_BOR || op == MPI_BXOR)) {
+        return vector_kernel<unsigned char, Stream>(op, level);
+    }
+
+    // Pair and complex kernels store through the cache only
+    if constexpr (!Stream) {
+        if (datatype == MPI_FLOAT_INT) return location_vector_kernel<float>(op, level);
+        if (datatype == MPI_DOUBLE_INT) return location_vector_kernel<double>(op, level);
+        if (datatype == MPI_LONG_INT) return location_vector_kernel<long>(op, level);
+        if (datatype == MPI_2INT) return location_vector_kernel<int>(op, level);
+        if (datatype == MPI_C_FLOAT_COMPLEX || datatype == MPI_C_COMPLEX ||
+            datatype == MPI_CXX_FLOAT_COMPLEX) {
+            return complex_vector_kernel<float>(op, level);
+        }
+        if (datatype == MPI_C_DOUBLE_COMPLEX || datatype == MPI_CXX_DOUBLE_COMPLEX) {
+            return complex_vector_kernel<double>(op, level);
+        }
+    }
+    return nullptr;
+}
+
+std::atomic<SimdLevel> g_simd_level{ detect_simd_level() };
+
+// TOPO_STREAMING_STORES=always|never|auto, read on first use
+StreamingStores initial_streaming_mode() {
+    const char* value = std::getenv("TOPO_STREAMING_STORES");
+    if (value != nullptr && std::strcmp(value, "always") == 0) return StreamingStores::ALWAYS;
+    if (value != nullptr && std::strcmp(value, "never") == 0) return StreamingStores::NEVER;
+    return StreamingStores::AUTO;
+}
+
+std::atomic<StreamingStores> g_streaming_mode{ initial_streaming_mode() };
+
+// Largest cache sysfs lists for cpu0; sizes read like "32768K"
+size_t sysfs_cache_bytes() {
+    size_t largest = 0;
+    for (int index = 0; index < 8; ++index) {
+        std::ifstream file("/sys/devices/system/cpu/cpu0/cache/index" + std::to_string(index) + "/size");
+        size_t value;
+        if (!(file >> value)) {
+            break;
+        }
+        char unit = 0;
+        file >> unit;
+        if (unit == 'K') value <<= 10;
+        else if (unit == 'M') value <<= 20;
+        largest = std::max(largest, value);
+    }
+    return largest;
+}
+
+} // namespace
+
+SimdLevel detect_simd_level() {
+#if defined(__x86_64__) || defined(__i386__)
+    // __builtin_cpu_supports also checks that the OS saves the vector state
+    static const SimdLevel detected = [] {
+        __builtin_cpu_init();
+        if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx512bw") &&
+            __builtin_cpu_supports("avx512dq") && __builtin_cpu_supports("avx512vl")) {
+            return SimdLevel::AVX512;
+        }
+        if (__builtin_cpu_supports("avx2")) {
+            return SimdLevel::AVX2;
+        }
+        if (__builtin_cpu_supports("sse4.2")) {
+            return SimdLevel::SSE42;
+        }
+        return SimdLevel::SCALAR;
+    }();
+    return detected;
+#else
+    return SimdLevel::SCALAR;
+#endif
+}
+
+SimdLevel active_simd_level() {
+    return g_simd_level.load(std::memory_order_relaxed);
+}
+
+void set_simd_level(SimdLevel level) {
+    g_simd_level.store(std::min(level, detect_simd_level()), std::memory_order_relaxed);
+}
+
+const char* simd_level_name(SimdLevel level) {
+    switch (level) {
+    case SimdLevel::SSE42: return "SSE4.2";
+    case SimdLevel::AVX2: return "AVX2";
+    case SimdLevel::AVX512: return "AVX-512";
+    default: return "scalar";
+    }
+}
+
+ReductionKernel::Function simd_reduction_kernel(MPI_Datatype datatype, MPI_Op op, SimdLevel level) {
+    return select_vector_kernel<false>(datatype, op, level);
+}
+
+ReductionKernel::Function simd_streaming_kernel(MPI_Datatype datatype, MPI_Op op, SimdLevel level) {
+    return select_vector_kernel<true>(datatype, op, level);
+}
+
+size_t last_level_cache_bytes() {
+    static const size_t detected = [] {
+        size_t bytes = 0;
+#ifdef _SC_LEVEL3_CACHE_SIZE
+        long level3 = sysconf(_SC_LEVEL3_CACHE_SIZE);
+        bytes = level3 > 0 ? static_cast<size_t>(level3) : 0;
+#endif
+        if (bytes == 0) {
+            bytes = sysfs_cache_bytes();
+        }
+        return bytes > 0 ? bytes : size_t(32) << 20;
+    }();
+    return detected;
+}
+
+void set_streaming_stores(StreamingStores mode) {
+    g_streaming_mode.store(mode, std::memory_order_relaxed);
+}
+
+StreamingStores streaming_stores() {
+    return g_streaming_mode.load(std::memory_order_relaxed);
+}
+
+size_t streaming_store_threshold() {
+    switch (streaming_stores()) {
+    case StreamingStores::ALWAYS: return 0;
+    case StreamingStores::NEVER: return SIZE_MAX;
+    default: return last_level_cache_bytes();
+    }
+}
+
+void stream_copy(void* dst, const void* src, size_t bytes) {
+    char* to = static_cast<char*>(dst);
+    const char* from = static_cast<const char*>(src);
+#if defined(__x86_64__)
+    // SSE2 is part of x86-64, so this needs no dispatch
+    size_t head = std::min(bytes, (16 - reinterpret_cast<uintptr_t>(to) % 16) % 16);
+    std::memcpy(to, from, head);
+    size_t i = head;
+    for (; i + 64 <= bytes; i += 64) {
+        __m128i v0 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(from + i));
+        __m128i v1 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(from + i + 16));
+        __m128i v2 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(from + i + 32));
+        __m128i v3 = _mm_loadu_si128(reinterpret_cast<const __m128i*>(from + i + 48));
+        _mm_stream_si128(reinterpret_cast<__m128i*>(to + i), v0);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(to + i + 16), v1);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(to + i + 32), v2);
+        _mm_stream_si128(reinterpret_cast<__m128i*>(to + i + 48), v3);
+    }
+    for (; i + 16 <= bytes; i += 16) {
+        _mm_stream_si128(reinterpret_cast<__m128i*>(to + i),
+            _mm_loadu_si128(reinterpret_cast<const __m128i*>(from + i)));
+    }
+    std::memcpy(to + i, from + i, bytes - i);
+    _mm_sfence();
+#else
+    std::memcpy(to, from, bytes);
+#endif
+}
+
+void bulk_copy(void* dst, const void* src, size_t bytes) {
+    if (dst == src) {
+        return;
+    }
+    if (bytes >= streaming_store_threshold()) {
+        stream_copy(dst, src, bytes);
+    }
+    else {
+        std::memcpy(dst, src, bytes);
+    }
+}
+
+} // namespace TopologyAwareResearch
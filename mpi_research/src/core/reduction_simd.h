@@ -0,0 +1,71 @@
+#ifndef REDUCTION_SIMD_H
+#define REDUCTION_SIMD_H
+
+#include <mpi.h>
+#include <cstddef>
+#include "reduction_ops.h"
+
+namespace TopologyAwareResearch {
+
+// Instruction sets the vector reduction kernels are built for, lowest first.
+// Every level is compiled into the library; the one used is picked at run
+// time, so the library itself needs no -march flag.
+enum class SimdLevel {
+    SCALAR,
+    SSE42,
+    AVX2,
+    AVX512
+};
+
+// Best level this CPU and OS support, from cpuid (SCALAR off x86)
+SimdLevel detect_simd_level();
+
+// Level resolve_reduction_kernel uses; detect_simd_level() unless lowered
+SimdLevel active_simd_level();
+
+// Select a level for the whole process, clamped to detect_simd_level().
+// Meant for benchmarks and tests comparing the instruction sets.
+void set_simd_level(SimdLevel level);
+
+const char* simd_level_name(SimdLevel level);
+
+// Vector kernel for a predefined op on float, double or a 8-64 bit
+// unsigned/int/long type at the given level: SUM, PROD, MIN, MAX, plus
+// BAND, BOR, BXOR on integers and MPI_BYTE. Also MAXLOC/MINLOC on
+// MPI_FLOAT_INT, MPI_DOUBLE_INT, MPI_LONG_INT and MPI_2INT, and SUM/PROD on
+// the float and double complex types. nullptr when there is none.
+ReductionKernel::Function simd_reduction_kernel(MPI_Datatype datatype, MPI_Op op, SimdLevel level);
+
+// simd_reduction_kernel() writing whole vectors with non-temporal stores.
+// For destinations too large to stay cached: it avoids reading every dst
+// line before overwriting it and keeps the application's data in cache.
+ReductionKernel::Function simd_streaming_kernel(MPI_Datatype datatype, MPI_Op op, SimdLevel level);
+
+// When reductions and bulk copies switch to streaming stores: from
+// last_level_cache_bytes() up (AUTO), always, or never. The default comes
+// from TOPO_STREAMING_STORES (auto, always or never). Kernels keep the
+// setting they were resolved with.
+enum class StreamingStores {
+    AUTO,
+    ALWAYS,
+    NEVER
+};
+
+void set_streaming_stores(StreamingStores mode);
+StreamingStores streaming_stores();
+
+// Last-level cache size from sysconf or sysfs; 32 MiB if neither knows
+size_t last_level_cache_bytes();
+
+// Bytes from which the current mode streams (0 = always, SIZE_MAX = never)
+size_t streaming_store_threshold();
+
+// memcpy through non-temporal stores
+void stream_copy(void* dst, const void* src, size_t bytes);
+
+// memcpy that streams from streaming_store_threshold() up; no-op if dst == src
+void bulk_copy(void* dst, const void* src, size_t bytes);
+
+} // namespace TopologyAwareResearch
+
+#endif // REDUCTION_SIMD_H
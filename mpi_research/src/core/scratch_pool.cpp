@@ -0,0 +1,173 @@
+#include "scratch_pool.h"
+#include <atomic>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <utility>
+
+namespace TopologyAwareResearch {
+
+    namespace {
+        const size_t kScratchAlignment = 64;
+        const size_t kMinimumClass = 4096;
+        const size_t kPageBytes = 4096;
+
+        // Pool settings, read from the environment on first use
+        struct ScratchSettings {
+            std::atomic<size_t> max_cached_bytes;
+            std::atomic<bool> prefault;
+
+            ScratchSettings() : max_cached_bytes(size_t(64) << 20), prefault(false) {
+                if (const char* value = std::getenv("TOPO_SCRATCH_POOL_BYTES")) {
+                    max_cached_bytes = std::strtoull(value, nullptr, 10);
+                }
+                if (const char* value = std::getenv("TOPO_SCRATCH_PREFAULT")) {
+                    prefault = std::atoi(value) != 0;
+                }
+            }
+        };
+
+        ScratchSettings& scratch_settings() {
+            static ScratchSettings settings;
+            return settings;
+        }
+    }
+
+    ScratchBuffer::ScratchBuffer(ScratchBuffer&& other) noexcept
+        : pool_(other.pool_), data_(other.data_), size_(other.size_), capacity_(other.capacity_) {
+        other.pool_ = nullptr;
+        other.data_ = nullptr;
+        other.size_ = other.capacity_ = 0;
+    }
+
+    ScratchBuffer& ScratchBuffer::operator=(ScratchBuffer&& other) noexcept {
+        if (this != &other) {
+            release();
+            pool_ = other.pool_;
+            data_ = other.data_;
+            size_ = other.size_;
+            capacity_ = other.capacity_;
+            other.pool_ = nullptr;
+            other.data_ = nullptr;
+            other.size_ = other.capacity_ = 0;
+        }
+        return *this;
+    }
+
+    void ScratchBuffer::swap(ScratchBuffer& other) noexcept {
+        std::swap(pool_, other.pool_);
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+        std::swap(capacity_, other.capacity_);
+    }
+
+    ScratchBuffer::~ScratchBuffer() {
+        release();
+    }
+
+    void ScratchBuffer::release() {
+        if (pool_ != nullptr && data_ != nullptr) {
+            pool_->release(data_, capacity_);
+        }
+        pool_ = nullptr;
+        data_ = nullptr;
+        size_ = capacity_ = 0;
+    }
+
+    ScratchPool& ScratchPool::local() {
+        thread_local ScratchPool pool;
+        return pool;
+    }
+
+    size_t ScratchPool::size_class(size_t bytes) {
+        if (bytes <= kMinimumClass) {
+            return kMinimumClass;
+        }
+        size_t power = kMinimumClass;
+        while (power < bytes && power < (size_t(1) << 20)) {
+            power <<= 1;
+        }
+        if (power >= bytes) {
+            return power;
+        }
+
+        // Above 1 MiB: quarters of the power of two below bytes
+        size_t below = size_t(1) << 20;
+        while (below * 2 <= bytes) {
+            below <<= 1;
+        }
+        size_t step = below / 4;
+        return (bytes + step - 1) / step * step;
+    }
+
+    ScratchBuffer ScratchPool::acquire(size_t bytes) {
+        if (bytes == 0) {
+            return ScratchBuffer();
+        }
+
+        size_t capacity = size_class(bytes);
+        auto it = free_blocks_.find(capacity);
+        if (it != free_blocks_.end() && !it->second.empty()) {
+            char* block = it->second.back();
+            it->second.pop_back();
+            cached_bytes_ -= capacity;
+            return ScratchBuffer(this, block, bytes, capacity);
+        }
+
+        char* block = static_cast<char*>(std::aligned_alloc(kScratchAlignment, capacity));
+        if (block == nullptr) {
+            throw std::bad_alloc();
+        }
+        if (scratch_prefault()) {
+            for (size_t offset = 0; offset < capacity; offset += kPageBytes) {
+                block[offset] = 0;
+            }
+        }
+        return ScratchBuffer(this, block, bytes, capacity);
+    }
+
+    ScratchBuffer ScratchPool::acquire_copy(const void* source, size_t bytes) {
+        ScratchBuffer buffer = acquire(bytes);
+        if (bytes > 0) {
+            std::memcpy(buffer.data(), source, bytes);
+        }
+        return buffer;
+    }
+
+    void ScratchPool::release(char* block, size_t capacity) {
+        if (cached_bytes_ + capacity > scratch_pool_limit()) {
+            std::free(block);
+            return;
+        }
+        free_blocks_[capacity].push_back(block);
+        cached_bytes_ += capacity;
+    }
+
+    void ScratchPool::trim() {
+        for (auto& entry : free_blocks_) {
+            for (char* block : entry.second) {
+                std::free(block);
+            }
+        }
+        free_blocks_.clear();
+        cached_bytes_ = 0;
+    }
+
+    ScratchPool::~ScratchPool() {
+        trim();
+    }
+
+    void set_scratch_pool(size_t max_cached_bytes, bool prefault) {
+        scratch_settings().max_cached_bytes = max_cached_bytes;
+        scratch_settings().prefault = prefault;
+    }
+
+    size_t scratch_pool_limit() {
+        return scratch_settings().max_cached_bytes;
+    }
+
+    bool scratch_prefault() {
+        return scratch_settings().prefault;
+    }
+
+} // namespace TopologyAwareResearch
@@ -0,0 +1,88 @@
+#ifndef SCRATCH_POOL_H
+#define SCRATCH_POOL_H
+
+#include <cstddef>
+#include <map>
+#include <vector>
+
+namespace TopologyAwareResearch {
+
+    class ScratchPool;
+
+    // Scratch memory leased from a ScratchPool, handed back when the lease
+    // is destroyed, which must happen on the thread that acquired it.
+    // Move-only.
+    class ScratchBuffer {
+    public:
+        ScratchBuffer() = default;
+        ScratchBuffer(ScratchBuffer&& other) noexcept;
+        ScratchBuffer& operator=(ScratchBuffer&& other) noexcept;
+        ScratchBuffer(const ScratchBuffer&) = delete;
+        ScratchBuffer& operator=(const ScratchBuffer&) = delete;
+        ~ScratchBuffer();
+
+        char* data() const { return data_; }
+        size_t size() const { return size_; }
+        void swap(ScratchBuffer& other) noexcept;
+
+    private:
+        friend class ScratchPool;
+        ScratchBuffer(ScratchPool* pool, char* data, size_t size, size_t capacity)
+            : pool_(pool), data_(data), size_(size), capacity_(capacity) {}
+        void release();
+
+        ScratchPool* pool_ = nullptr;
+        char* data_ = nullptr;
+        size_t size_ = 0;
+        size_t capacity_ = 0;  // Size class of the block
+    };
+
+    // Per-thread cache of 64-byte aligned blocks for collective temporaries
+    // (receive staging, partial results), so steady-state calls neither
+    // allocate nor take page faults. Requests are rounded up to a size
+    // class: 4 KiB, then powers of two up to 1 MiB (a block may be nearly
+    // twice the request), then quarter steps of the power of two below
+    // (at most 25% larger). Blocks are kept per class until the thread
+    // exits.
+    class ScratchPool {
+    public:
+        // The calling thread's pool
+        static ScratchPool& local();
+
+        // At least `bytes` bytes, 64-byte aligned, contents unspecified.
+        // Zero bytes gives an empty lease with a null data().
+        ScratchBuffer acquire(size_t bytes);
+
+        // acquire() filled with a copy of `bytes` bytes from source
+        ScratchBuffer acquire_copy(const void* source, size_t bytes);
+
+        // Frees every cached (not leased) block
+        void trim();
+        size_t cached_bytes() const { return cached_bytes_; }
+
+        ScratchPool() = default;
+        ScratchPool(const ScratchPool&) = delete;
+        ScratchPool& operator=(const ScratchPool&) = delete;
+        ~ScratchPool();
+
+    private:
+        friend class ScratchBuffer;
+        void release(char* block, size_t capacity);
+        static size_t size_class(size_t bytes);
+
+        std::map<size_t, std::vector<char*>> free_blocks_;  // By size class
+        size_t cached_bytes_ = 0;
+    };
+
+    // Bytes each thread's pool keeps cached (larger releases are freed) and
+    // whether new blocks are pre-faulted, one write per page, so the first
+    // collective using them does not fault inside its communication.
+    // Defaults come from TOPO_SCRATCH_POOL_BYTES (64 MiB) and
+    // TOPO_SCRATCH_PREFAULT (0 or 1, off when unset).
+    void set_scratch_pool(size_t max_cached_bytes, bool prefault);
+    size_t scratch_pool_limit();
+    bool scratch_prefault();
+
+} // namespace TopologyAwareResearch
+
+#endif // SCRATCH_POOL_H
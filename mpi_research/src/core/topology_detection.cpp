@@ -1,4 +1,5 @@
 #include "topology_detection.h"
+#include "dragonfly_layout.h"
 #include <iostream>
 #include <fstream>
 #include <sstream>
@@ -256,9 +257,11 @@ namespace TopologyAwareResearch {
         }
         else if (topology.topology_type == "DRAGONFLY") {
             // Infer dragonfly parameters
-            topology.dragonfly.groups = 8;
-            topology.dragonfly.routers_per_group = topology.total_nodes / 8;
-            topology.dragonfly.nodes_per_router = topology.processes_per_node;
+            // Without a layout source assume one node per router in a balanced dragonfly
+            int routers_per_group = DragonflyLayoutDetector::estimate_routers_per_group(topology.total_nodes);
+            topology.dragonfly.routers_per_group = routers_per_group;
+            topology.dragonfly.groups = (topology.total_nodes + routers_per_group - 1) / routers_per_group;
+            topology.dragonfly.nodes_per_router = 1;
         }
     }
 